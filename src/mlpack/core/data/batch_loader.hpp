@@ -0,0 +1,215 @@
+/**
+ * @file core/data/batch_loader.hpp
+ *
+ * Definition of the BatchLoader class, which decodes the batches of a dataset
+ * in background threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_LOADER_HPP
+#define MLPACK_CORE_DATA_BATCH_LOADER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace mlpack {
+namespace data /** Functions to load and save matrices and models. */ {
+
+/**
+ * The BatchLoader class streams the batches of a dataset that does not have to
+ * be held in memory as one matrix.  The points are decoded on demand by a
+ * user-given function, e.g. one that loads images with data::Load(), and can
+ * then be transformed by a second function, e.g. one that applies random
+ * augmentations.  Both run in background threads, which keep a few batches
+ * ready while the current one is used, so that the loading overlaps with the
+ * training.  With the default of two prefetched batches, the batches are double
+ * buffered.
+ *
+ * The points are visited in epochs.  Each epoch visits every point once, in a
+ * new random order if shuffling is enabled, and the stream continues with the
+ * next epoch when one is finished; the last batch of an epoch may be smaller
+ * than the others.  The order of the points only depends on the mlpack random
+ * seed, not on the number of threads.
+ *
+ * The batches can be obtained with Next(), or the loader can be given to the
+ * Train() overload of FFN and RNN that takes a BatchLoader.
+ *
+ * @code
+ * std::vector<std::string> files = ...; // One image per point.
+ * arma::rowvec labels = ...;
+ *
+ * BatchLoader<> loader(files.size(), 32,
+ *     [&](const arma::Col<size_t>& indices,
+ *         arma::mat& predictors,
+ *         arma::mat& responses)
+ *     {
+ *       // Decode the images of the given points, one per column.
+ *       ...
+ *       responses = labels.cols(arma::conv_to<arma::uvec>::from(indices));
+ *     });
+ *
+ * arma::mat predictors, responses;
+ * loader.Next(predictors, responses);
+ * @endcode
+ *
+ * @tparam PredictorsType Type of the batches of predictors.
+ * @tparam ResponsesType Type of the batches of responses.
+ */
+template<typename PredictorsType = arma::mat,
+         typename ResponsesType = arma::mat>
+class BatchLoader
+{
+ public:
+  /**
+   * Function that decodes the points with the given indices into the columns
+   * of the given predictors and responses.  It is called concurrently by the
+   * worker threads, so it must be thread-safe.
+   */
+  typedef std::function<void(const arma::Col<size_t>&,
+                             PredictorsType&,
+                             ResponsesType&)> DecodeFunctionType;
+
+  /**
+   * Function that transforms a decoded batch in place, e.g. to augment it.  It
+   * is called concurrently by the worker threads, so it must be thread-safe.
+   */
+  typedef std::function<void(PredictorsType&, ResponsesType&)>
+      TransformFunctionType;
+
+  /**
+   * Create the loader and start decoding the first batches in the background.
+   *
+   * @param numPoints Number of points in the dataset.
+   * @param batchSize Number of points in each batch.
+   * @param decode Function used to decode the points of a batch.
+   * @param shuffle Whether to visit the points in a new random order in each
+   *     epoch.
+   * @param numThreads Number of worker threads used to decode the batches.
+   * @param prefetch Maximum number of batches that are decoded ahead of the
+   *     one that is used.
+   * @param transform Optional function applied to each decoded batch.
+   */
+  BatchLoader(const size_t numPoints,
+              const size_t batchSize,
+              DecodeFunctionType decode,
+              const bool shuffle = true,
+              const size_t numThreads = 1,
+              const size_t prefetch = 2,
+              TransformFunctionType transform = TransformFunctionType());
+
+  //! Stop the worker threads.
+  ~BatchLoader();
+
+  //! The worker threads refer to the loader, so it cannot be copied.
+  BatchLoader(const BatchLoader& other) = delete;
+  //! The worker threads refer to the loader, so it cannot be copied.
+  BatchLoader& operator=(const BatchLoader& other) = delete;
+
+  /**
+   * Get the next batch of the stream, waiting for it to be decoded if
+   * necessary.  If the decode or transform function threw an exception for
+   * this batch, the exception is rethrown here.
+   *
+   * @param predictors Matrix to store the predictors of the batch into.
+   * @param responses Matrix to store the responses of the batch into.
+   */
+  void Next(PredictorsType& predictors, ResponsesType& responses);
+
+  //! Get the number of points in the dataset.
+  size_t NumPoints() const { return numPoints; }
+
+  //! Get the number of points in each batch.
+  size_t BatchSize() const { return batchSize; }
+
+  //! Get the number of batches in each epoch.
+  size_t BatchesPerEpoch() const
+  { return (numPoints + batchSize - 1) / batchSize; }
+
+  //! Get whether the points are visited in a new random order in each epoch.
+  bool Shuffle() const { return shuffle; }
+
+  //! Get the number of worker threads.
+  size_t NumThreads() const { return workers.size(); }
+
+  //! Get the maximum number of batches decoded ahead of the one that is used.
+  size_t Prefetch() const { return prefetch; }
+
+ private:
+  //! Decode batches until the loader is destroyed.
+  void Work();
+
+  //! The number of points in the dataset.
+  size_t numPoints;
+
+  //! The number of points in each batch.
+  size_t batchSize;
+
+  //! The function used to decode the points of a batch.
+  DecodeFunctionType decode;
+
+  //! The function applied to each decoded batch.
+  TransformFunctionType transform;
+
+  //! Whether the points are visited in a new random order in each epoch.
+  bool shuffle;
+
+  //! The maximum number of batches decoded ahead of the one that is used.
+  size_t prefetch;
+
+  //! The random number generator used to shuffle the points.
+  std::mt19937 generator;
+
+  //! The order of the points in the current epoch.
+  arma::Col<size_t> order;
+
+  //! The position in the current epoch of the first point of the next batch.
+  size_t position;
+
+  //! The sequence number of the next batch to be decoded.
+  size_t nextBatch;
+
+  //! The sequence number of the next batch to be returned by Next().
+  size_t currentBatch;
+
+  //! The decoded batches that have not been returned yet, by sequence number.
+  std::map<size_t, std::pair<PredictorsType, ResponsesType>> ready;
+
+  //! The exception thrown by a worker for the earliest batch, if any.
+  std::exception_ptr failure;
+
+  //! The sequence number of the batch that failed.
+  size_t failedBatch;
+
+  //! Whether the worker threads must stop.
+  bool stop;
+
+  //! The mutex that protects the state shared with the workers.
+  std::mutex mutex;
+
+  //! Signaled when a batch has been decoded.
+  std::condition_variable batchDecoded;
+
+  //! Signaled when a batch has been returned, or the workers must stop.
+  std::condition_variable batchReturned;
+
+  //! The worker threads.
+  std::vector<std::thread> workers;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_loader_impl.hpp"
+
+#endif
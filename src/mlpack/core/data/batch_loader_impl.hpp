@@ -0,0 +1,170 @@
+/**
+ * @file core/data/batch_loader_impl.hpp
+ *
+ * Implementation of the BatchLoader class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BATCH_LOADER_IMPL_HPP
+#define MLPACK_CORE_DATA_BATCH_LOADER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "batch_loader.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename PredictorsType, typename ResponsesType>
+BatchLoader<PredictorsType, ResponsesType>::BatchLoader(
+    const size_t numPoints,
+    const size_t batchSize,
+    DecodeFunctionType decode,
+    const bool shuffle,
+    const size_t numThreads,
+    const size_t prefetch,
+    TransformFunctionType transform) :
+    numPoints(numPoints),
+    batchSize(batchSize),
+    decode(std::move(decode)),
+    transform(std::move(transform)),
+    shuffle(shuffle),
+    prefetch(prefetch),
+    generator((uint32_t) math::randGen()),
+    order(numPoints),
+    position(numPoints),
+    nextBatch(0),
+    currentBatch(0),
+    failedBatch(0),
+    stop(false)
+{
+  if (numPoints == 0 || batchSize == 0)
+  {
+    throw std::invalid_argument("BatchLoader::BatchLoader(): the number of "
+        "points and the batch size must be positive");
+  }
+
+  if (numThreads == 0 || prefetch == 0)
+  {
+    throw std::invalid_argument("BatchLoader::BatchLoader(): the number of "
+        "threads and the number of prefetched batches must be positive");
+  }
+
+  if (!this->decode)
+  {
+    throw std::invalid_argument("BatchLoader::BatchLoader(): no decode "
+        "function given");
+  }
+
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+
+  for (size_t i = 0; i < numThreads; ++i)
+    workers.push_back(std::thread(&BatchLoader::Work, this));
+}
+
+template<typename PredictorsType, typename ResponsesType>
+BatchLoader<PredictorsType, ResponsesType>::~BatchLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+
+  batchReturned.notify_all();
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+}
+
+template<typename PredictorsType, typename ResponsesType>
+void BatchLoader<PredictorsType, ResponsesType>::Next(
+    PredictorsType& predictors,
+    ResponsesType& responses)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    // The batches before the one that failed are still returned.
+    batchDecoded.wait(lock, [this] { return ready.count(currentBatch) > 0 ||
+        (failure && currentBatch >= failedBatch); });
+
+    typename std::map<size_t, std::pair<PredictorsType, ResponsesType>>::
+        iterator it = ready.find(currentBatch);
+    if (it == ready.end())
+      std::rethrow_exception(failure);
+
+    predictors = std::move(it->second.first);
+    responses = std::move(it->second.second);
+    ready.erase(it);
+    ++currentBatch;
+  }
+
+  batchReturned.notify_all();
+}
+
+template<typename PredictorsType, typename ResponsesType>
+void BatchLoader<PredictorsType, ResponsesType>::Work()
+{
+  while (true)
+  {
+    arma::Col<size_t> indices;
+    size_t batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      batchReturned.wait(lock, [this]
+          { return stop || failure || nextBatch < currentBatch + prefetch; });
+      if (stop || failure)
+        return;
+
+      // The batches are assigned in order while the lock is held, so the order
+      // of the points does not depend on the number of threads.
+      if (position == numPoints)
+      {
+        position = 0;
+        if (shuffle)
+          std::shuffle(order.begin(), order.end(), generator);
+      }
+
+      const size_t end = std::min(position + batchSize, numPoints);
+      indices = order.subvec(position, end - 1);
+      position = end;
+      batch = nextBatch++;
+    }
+
+    std::pair<PredictorsType, ResponsesType> decoded;
+    try
+    {
+      decode(indices, decoded.first, decoded.second);
+      if (transform)
+        transform(decoded.first, decoded.second);
+    }
+    catch (...)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failure || batch < failedBatch)
+        {
+          failure = std::current_exception();
+          failedBatch = batch;
+        }
+      }
+
+      batchDecoded.notify_all();
+      batchReturned.notify_all();
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ready[batch] = std::move(decoded);
+    }
+
+    batchDecoded.notify_all();
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file core/kernels/pairwise_kernels.hpp
+ *
+ * Compute a whole block of kernel evaluations between two sets of points at
+ * once.  Kernels that are functions of the dot product evaluate all the dot
+ * products with a single matrix multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_PAIRWISE_KERNELS_HPP
+#define MLPACK_CORE_KERNELS_PAIRWISE_KERNELS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "linear_kernel.hpp"
+#include "polynomial_kernel.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Evaluate the kernel between every point a.col(aIndices[i]) and every point
+ * b.col(bIndices[j]), and store it in kernels(i, j).  This generic version
+ * simply calls kernel.Evaluate() for each pair.
+ *
+ * @param kernel Kernel to use.
+ * @param a First dataset.
+ * @param aIndices Indices of the points of the first dataset to use.
+ * @param b Second dataset.
+ * @param bIndices Indices of the points of the second dataset to use.
+ * @param kernels Matrix to store the kernel evaluations in (aIndices.n_elem x
+ *     bIndices.n_elem).
+ */
+template<typename KernelType, typename MatType>
+void PairwiseKernels(KernelType& kernel,
+                     const MatType& a,
+                     const arma::uvec& aIndices,
+                     const MatType& b,
+                     const arma::uvec& bIndices,
+                     arma::mat& kernels)
+{
+  kernels.set_size(aIndices.n_elem, bIndices.n_elem);
+  for (size_t j = 0; j < bIndices.n_elem; ++j)
+    for (size_t i = 0; i < aIndices.n_elem; ++i)
+      kernels(i, j) = kernel.Evaluate(a.col(aIndices[i]), b.col(bIndices[j]));
+}
+
+//! Evaluate the linear kernel for a block of points with one matrix product.
+template<typename eT>
+void PairwiseKernels(LinearKernel& /* kernel */,
+                     const arma::Mat<eT>& a,
+                     const arma::uvec& aIndices,
+                     const arma::Mat<eT>& b,
+                     const arma::uvec& bIndices,
+                     arma::mat& kernels)
+{
+  kernels = arma::conv_to<arma::mat>::from(
+      a.cols(aIndices).t() * b.cols(bIndices));
+}
+
+//! Evaluate the polynomial kernel for a block of points with one matrix
+//! product.
+template<typename eT>
+void PairwiseKernels(PolynomialKernel& kernel,
+                     const arma::Mat<eT>& a,
+                     const arma::uvec& aIndices,
+                     const arma::Mat<eT>& b,
+                     const arma::uvec& bIndices,
+                     arma::mat& kernels)
+{
+  kernels = arma::pow(arma::conv_to<arma::mat>::from(
+      a.cols(aIndices).t() * b.cols(bIndices)) + kernel.Offset(),
+      kernel.Degree());
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
@@ -57,6 +57,15 @@ class RangeType
    */
   inline RangeType(const T lo, const T hi);
 
+  /**
+   * Convert a range with a different element type.  This allows, e.g., the
+   * double-precision bounds of a tree to be used with float data.
+   *
+   * @param other Range to convert.
+   */
+  template<typename U>
+  inline RangeType(const RangeType<U>& other);
+
   //! Get the lower bound.
   inline T Lo() const { return lo; }
   //! Modify the lower bound.
@@ -0,0 +1,101 @@
+/**
+ * @file core/metrics/pairwise_distances.hpp
+ *
+ * Compute a whole block of distances between two sets of points at once.  For
+ * the Euclidean and squared Euclidean distances on dense data this uses the
+ * expansion ||a - b||^2 = ||a||^2 + ||b||^2 - 2 a^T b, so that most of the work
+ * is done by a single matrix multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_METRICS_PAIRWISE_DISTANCES_HPP
+#define MLPACK_CORE_METRICS_PAIRWISE_DISTANCES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "lmetric.hpp"
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * Compute the distance between every point a.col(aIndices[i]) and every point
+ * b.col(bIndices[j]), and store it in distances(i, j).  This generic version
+ * simply calls metric.Evaluate() for each pair.
+ *
+ * @param metric Metric to use.
+ * @param a First dataset.
+ * @param aIndices Indices of the points of the first dataset to use.
+ * @param b Second dataset.
+ * @param bIndices Indices of the points of the second dataset to use.
+ * @param distances Matrix to store the distances in (aIndices.n_elem x
+ *     bIndices.n_elem).
+ */
+template<typename MetricType, typename MatType>
+void PairwiseDistances(MetricType& metric,
+                       const MatType& a,
+                       const arma::uvec& aIndices,
+                       const MatType& b,
+                       const arma::uvec& bIndices,
+                       arma::mat& distances)
+{
+  distances.set_size(aIndices.n_elem, bIndices.n_elem);
+  for (size_t j = 0; j < bIndices.n_elem; ++j)
+    for (size_t i = 0; i < aIndices.n_elem; ++i)
+      distances(i, j) = metric.Evaluate(a.col(aIndices[i]), b.col(bIndices[j]));
+}
+
+/**
+ * Compute the (squared) Euclidean distance between every point
+ * a.col(aIndices[i]) and every point b.col(bIndices[j]), and store it in
+ * distances(i, j), using one matrix multiplication for the cross terms.
+ *
+ * The expansion loses precision when two points are much closer to each other
+ * than they are to the origin.  Those pairs are detected from the norms and
+ * computed directly instead, so the results agree with LMetric::Evaluate() up
+ * to a small relative error.
+ */
+template<bool TakeRoot, typename eT>
+void PairwiseDistances(LMetric<2, TakeRoot>& /* metric */,
+                       const arma::Mat<eT>& a,
+                       const arma::uvec& aIndices,
+                       const arma::Mat<eT>& b,
+                       const arma::uvec& bIndices,
+                       arma::mat& distances)
+{
+  const arma::Mat<eT> aPoints = a.cols(aIndices);
+  const arma::Mat<eT> bPoints = b.cols(bIndices);
+  const arma::Col<eT> aNorms = arma::sum(arma::square(aPoints), 0).t();
+  const arma::Row<eT> bNorms = arma::sum(arma::square(bPoints), 0);
+
+  arma::Mat<eT> squared = -2 * aPoints.t() * bPoints;
+  squared.each_col() += aNorms;
+  squared.each_row() += bNorms;
+
+  // Below this fraction of ||a||^2 + ||b||^2 the cancellation error of the
+  // expansion would be noticeable, so the distance is recomputed directly.
+  const eT cutoff = std::max(eT(1e-4),
+      100 * std::sqrt(std::numeric_limits<eT>::epsilon()));
+
+  distances.set_size(aIndices.n_elem, bIndices.n_elem);
+  for (size_t j = 0; j < bIndices.n_elem; ++j)
+  {
+    for (size_t i = 0; i < aIndices.n_elem; ++i)
+    {
+      double d = squared(i, j);
+      if (d < cutoff * (aNorms[i] + bNorms[j]))
+      {
+        d = LMetric<2, false>::Evaluate(aPoints.col(i), bPoints.col(j));
+      }
+
+      distances(i, j) = TakeRoot ? std::sqrt(d) : d;
+    }
+  }
+}
+
+} // namespace metric
+} // namespace mlpack
+
+#endif
@@ -185,7 +185,8 @@ class BallBound
    * to be the center of all of the given points.
    *
    * @tparam MatType Type of matrix; could be arma::mat, arma::spmat, or a
-   *     vector.
+   *     vector.  Its element type may differ from the element type of the
+   *     bound (e.g. arma::fmat data with a double-precision bound).
    * @tparam data Data points to add.
    */
   template<typename MatType>
@@ -204,6 +205,30 @@ class BallBound
   //! Serialize the bound.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version);
+
+ private:
+  //! Get column i of the given data as a VecType (same element type).
+  template<typename MatType>
+  static VecType Column(
+      const MatType& data,
+      const size_t i,
+      typename std::enable_if_t<std::is_same<typename MatType::elem_type,
+          ElemType>::value>* = 0)
+  {
+    return VecType(data.col(i));
+  }
+
+  //! Get column i of the given data as a VecType, converting the element
+  //! type.
+  template<typename MatType>
+  static VecType Column(
+      const MatType& data,
+      const size_t i,
+      typename std::enable_if_t<!std::is_same<typename MatType::elem_type,
+          ElemType>::value>* = 0)
+  {
+    return arma::conv_to<VecType>::from(data.col(i));
+  }
 };
 
 //! A specialization of BoundTraits for this bound type.
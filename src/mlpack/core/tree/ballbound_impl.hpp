@@ -257,21 +257,22 @@ BallBound<MetricType, VecType>::operator|=(const MatType& data)
 {
   if (radius < 0)
   {
-    center = data.col(0);
+    center = Column(data, 0);
     radius = 0;
   }
 
   // Now iteratively add points.
   for (size_t i = 0; i < data.n_cols; ++i)
   {
-    const ElemType dist = metric->Evaluate(center, (VecType) data.col(i));
+    const VecType point = Column(data, i);
+    const ElemType dist = metric->Evaluate(center, point);
 
     // See if the new point lies outside the bound.
     if (dist > radius)
     {
       // Move towards the new point and increase the radius just enough to
       // accommodate the new point.
-      const VecType diff = data.col(i) - center;
+      const VecType diff = point - center;
       center += ((dist - radius) / (2 * dist)) * diff;
       radius = 0.5 * (dist + radius);
     }
@@ -19,6 +19,19 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+/**
+ * The orders in which BinarySpaceTree::Compact() can store the nodes of a tree.
+ */
+enum NodeLayout
+{
+  //! The nodes are stored level by level.
+  BREADTH_FIRST_LAYOUT,
+  //! The nodes are stored in van Emde Boas order: the top half of the levels
+  //! is stored first (recursively in the same order), and is followed by each
+  //! of the subtrees hanging below it.
+  VAN_EMDE_BOAS_LAYOUT
+};
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -88,6 +101,17 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If Compact() has been called on this node, the contiguous block of memory
+  //! holding all of its descendants (NULL otherwise).
+  BinarySpaceTree* nodeBlock;
+  //! The number of nodes in nodeBlock.
+  size_t nodeBlockSize;
+  //! The order of the nodes in nodeBlock.
+  NodeLayout nodeBlockLayout;
+  //! If Compact() has been called on this node and the bounds are
+  //! HRectBounds, the contiguous block of memory holding the ranges of the
+  //! bounds of the nodes in nodeBlock, in the same order (NULL otherwise).
+  math::Range* boundBlock;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -315,6 +339,32 @@ class BinarySpaceTree
    */
   ~BinarySpaceTree();
 
+  /**
+   * Move all of the descendants of this node into one contiguous block of
+   * memory, stored in the given order, so that traversals touch fewer cache
+   * lines and pages than when every node is allocated separately.  The van Emde
+   * Boas layout is cache-oblivious: every subtree of height h is stored in
+   * O(2^h) contiguous nodes, whatever the size of the cache lines is.
+   * The ranges of HRectBounds, which are otherwise allocated separately for
+   * every node, are moved into one block in the same order.
+   *
+   * The tree keeps the same structure and can be used in the same way
+   * afterwards; only the addresses of the descendants change, so any pointers
+   * or references to them are invalidated.  Statistics that hold pointers to
+   * other nodes should therefore be (re)built after the tree is compacted.  A
+   * compacted tree stays compacted when it is copied or serialized.  This may
+   * only be called on the root of the tree, and may be called again to change
+   * the layout.
+   *
+   * @param layout Order in which to store the nodes.
+   */
+  void Compact(const NodeLayout layout = VAN_EMDE_BOAS_LAYOUT);
+
+  //! Return whether the descendants of this node are stored contiguously.
+  bool IsCompact() const { return nodeBlock != NULL; }
+  //! Return the order of the descendants, if IsCompact() is true.
+  NodeLayout Layout() const { return nodeBlockLayout; }
+
   //! Return the bound object for this node.
   const BoundType<MetricType>& Bound() const { return bound; }
   //! Return the bound object for this node.
@@ -546,6 +596,42 @@ class BinarySpaceTree
    */
   void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
 
+  /**
+   * Destroy the nodes held in nodeBlock and free it.  The children of this node
+   * are set to NULL.
+   */
+  void FreeNodeBlock();
+
+  /**
+   * Store the ranges of the HRectBounds of the nodes in nodeBlock in one
+   * contiguous block of memory (boundBlock), in the same order as the nodes, so
+   * that the bounds a traversal reads are next to each other too.
+   */
+  template<typename BoundType2 = BoundType<MetricType>>
+  void CompactBounds(const typename std::enable_if_t<
+      std::is_same<BoundType2, bound::HRectBound<MetricType>>::value>* = 0);
+
+  /**
+   * Other bound types hold their data inside the node, so it is already stored
+   * in nodeBlock and there is nothing to do.
+   */
+  template<typename BoundType2 = BoundType<MetricType>>
+  void CompactBounds(const typename std::enable_if_t<
+      !std::is_same<BoundType2, bound::HRectBound<MetricType>>::value>* = 0)
+  { }
+
+  /**
+   * Append the nodes in the top given number of levels of the subtree rooted
+   * at the given node to the given vector, in van Emde Boas order.
+   *
+   * @param node Root of the subtree.
+   * @param levels Number of levels to append.
+   * @param order Vector to append the nodes to.
+   */
+  static void VanEmdeBoasOrder(BinarySpaceTree* node,
+                               const size_t levels,
+                               std::vector<BinarySpaceTree*>& order);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -569,6 +655,34 @@ class BinarySpaceTree
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the BinarySpaceTree class.  We cannot use
+//! BOOST_TEMPLATE_CLASS_VERSION because of the commas in the template
+//! signature.
+namespace boost {
+namespace serialization {
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct version<mlpack::tree::BinarySpaceTree<MetricType,
+                                             StatisticType,
+                                             MatType,
+                                             BoundType,
+                                             SplitType>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+  BOOST_MPL_ASSERT((boost::mpl::less<boost::mpl::int_<1>,
+                    boost::mpl::int_<256>>));
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "binary_space_tree_impl.hpp"
 
@@ -39,7 +39,11 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -67,7 +71,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
@@ -101,7 +109,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
@@ -136,7 +148,11 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
@@ -164,7 +180,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -198,7 +218,11 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -237,7 +261,11 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
@@ -266,7 +294,11 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -300,7 +332,11 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -342,7 +378,11 @@ BinarySpaceTree(
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -376,6 +416,10 @@ BinarySpaceTree(
       if (node->right)
         queue.push(node->right);
     }
+
+    // Store the copy in the same layout as the other tree.
+    if (other.nodeBlock)
+      Compact(other.nodeBlockLayout);
   }
 }
 
@@ -398,6 +442,8 @@ operator=(const BinarySpaceTree& other)
 
   // Freeing memory that will not be used anymore.
   delete dataset;
+  if (nodeBlock)
+    FreeNodeBlock();
   delete left;
   delete right;
 
@@ -446,6 +492,10 @@ operator=(const BinarySpaceTree& other)
       if (node->right)
         queue.push(node->right);
     }
+
+    // Store the copy in the same layout as the other tree.
+    if (other.nodeBlock)
+      Compact(other.nodeBlockLayout);
   }
 
   return *this;
@@ -470,6 +520,8 @@ operator=(BinarySpaceTree&& other)
 
   // Freeing memory that will not be used anymore.
   delete dataset;
+  if (nodeBlock)
+    FreeNodeBlock();
   delete left;
   delete right;
 
@@ -484,6 +536,10 @@ operator=(BinarySpaceTree&& other)
   furthestDescendantDistance = other.FurthestDescendantDistance();
   minimumBoundDistance = other.MinimumBoundDistance();
   dataset = other.dataset;
+  nodeBlock = other.nodeBlock;
+  nodeBlockSize = other.nodeBlockSize;
+  nodeBlockLayout = other.nodeBlockLayout;
+  boundBlock = other.boundBlock;
 
   other.left = NULL;
   other.right = NULL;
@@ -494,6 +550,9 @@ operator=(BinarySpaceTree&& other)
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodeBlock = NULL;
+  other.nodeBlockSize = 0;
+  other.boundBlock = NULL;
 
   return *this;
 }
@@ -520,7 +579,11 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    nodeBlock(other.nodeBlock),
+    nodeBlockSize(other.nodeBlockSize),
+    nodeBlockLayout(other.nodeBlockLayout),
+    boundBlock(other.boundBlock)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -533,6 +596,9 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodeBlock = NULL;
+  other.nodeBlockSize = 0;
+  other.boundBlock = NULL;
 
   // Set new parent.
   if (left)
@@ -576,6 +642,8 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
+  if (nodeBlock)
+    FreeNodeBlock();
   delete left;
   delete right;
 
@@ -584,6 +652,208 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     delete dataset;
 }
 
+/**
+ * Move the descendants of this node into one contiguous block of memory, in
+ * the given order.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Compact(const NodeLayout layout)
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::Compact(): only the root of "
+        "a tree can be compacted");
+  }
+
+  // Collect the nodes in the order they will be stored in.  This node is first
+  // in both orders, and it stays where it is.
+  std::vector<BinarySpaceTree*> order;
+  if (layout == BREADTH_FIRST_LAYOUT)
+  {
+    std::queue<BinarySpaceTree*> queue;
+    queue.push(this);
+    while (!queue.empty())
+    {
+      BinarySpaceTree* node = queue.front();
+      queue.pop();
+
+      order.push_back(node);
+      if (node->left)
+        queue.push(node->left);
+      if (node->right)
+        queue.push(node->right);
+    }
+  }
+  else
+  {
+    // Find the number of levels of the tree.
+    size_t levels = 0;
+    std::vector<BinarySpaceTree*> level(1, this), nextLevel;
+    while (!level.empty())
+    {
+      ++levels;
+      nextLevel.clear();
+      for (size_t i = 0; i < level.size(); ++i)
+      {
+        if (level[i]->left)
+          nextLevel.push_back(level[i]->left);
+        if (level[i]->right)
+          nextLevel.push_back(level[i]->right);
+      }
+      level.swap(nextLevel);
+    }
+
+    VanEmdeBoasOrder(this, levels, order);
+  }
+
+  // Move every descendant into its place in the new block.  The move
+  // constructor takes care of the pointers of the children of the node; the
+  // pointer of its parent must be updated here.  The descendants may be in a
+  // previous block, in which case they are left there as empty nodes.
+  BinarySpaceTree* oldBlock = nodeBlock;
+  const size_t oldBlockSize = nodeBlockSize;
+  const size_t blockSize = order.size() - 1;
+  BinarySpaceTree* block = (blockSize == 0) ? NULL :
+      static_cast<BinarySpaceTree*>(::operator new(blockSize *
+      sizeof(BinarySpaceTree)));
+  for (size_t i = 0; i < blockSize; ++i)
+  {
+    BinarySpaceTree* node = order[i + 1];
+    BinarySpaceTree* newNode = new (block + i) BinarySpaceTree(
+        std::move(*node));
+
+    if (newNode->parent->left == node)
+      newNode->parent->left = newNode;
+    else
+      newNode->parent->right = newNode;
+
+    if (oldBlock == NULL || node < oldBlock || node >= oldBlock + oldBlockSize)
+      delete node;
+  }
+
+  if (oldBlock)
+  {
+    for (size_t i = 0; i < oldBlockSize; ++i)
+      oldBlock[i].~BinarySpaceTree();
+    ::operator delete(oldBlock);
+  }
+
+  nodeBlock = block;
+  nodeBlockSize = blockSize;
+  nodeBlockLayout = layout;
+
+  // The bounds of the nodes may still be held in the previous block of bounds,
+  // so that one is only freed once they have been moved.
+  math::Range* oldBoundBlock = boundBlock;
+  boundBlock = NULL;
+  CompactBounds();
+  delete[] oldBoundBlock;
+}
+
+/**
+ * Destroy the nodes held in the block of this node and free it.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    FreeNodeBlock()
+{
+  // Every child of a node in the block is also in the block, so the nodes must
+  // not delete their children themselves.
+  for (size_t i = 0; i < nodeBlockSize; ++i)
+  {
+    nodeBlock[i].left = NULL;
+    nodeBlock[i].right = NULL;
+    nodeBlock[i].~BinarySpaceTree();
+  }
+  ::operator delete(nodeBlock);
+  delete[] boundBlock;
+
+  nodeBlock = NULL;
+  nodeBlockSize = 0;
+  boundBlock = NULL;
+  left = NULL;
+  right = NULL;
+}
+
+/**
+ * Store the ranges of the bounds of the nodes in the block of this node in one
+ * block of memory, in the same order as the nodes.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename BoundType2>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    CompactBounds(const typename std::enable_if_t<
+        std::is_same<BoundType2, bound::HRectBound<MetricType>>::value>*)
+{
+  if (nodeBlockSize == 0)
+    return;
+
+  const size_t dim = bound.Dim();
+  boundBlock = new math::Range[nodeBlockSize * dim];
+  for (size_t i = 0; i < nodeBlockSize; ++i)
+    nodeBlock[i].bound.Relocate(boundBlock + i * dim);
+}
+
+/**
+ * Append the nodes in the top levels of the given subtree in van Emde Boas
+ * order: the top half of the levels first, and then each of the subtrees below
+ * them, all recursively in the same order.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    VanEmdeBoasOrder(BinarySpaceTree* node,
+                     const size_t levels,
+                     std::vector<BinarySpaceTree*>& order)
+{
+  if (levels == 1)
+  {
+    order.push_back(node);
+    return;
+  }
+
+  const size_t topLevels = levels / 2;
+  VanEmdeBoasOrder(node, topLevels, order);
+
+  // Find the roots of the bottom subtrees, topLevels levels below the node.
+  std::vector<BinarySpaceTree*> roots(1, node), nextRoots;
+  for (size_t l = 0; l < topLevels; ++l)
+  {
+    nextRoots.clear();
+    for (size_t i = 0; i < roots.size(); ++i)
+    {
+      if (roots[i]->left)
+        nextRoots.push_back(roots[i]->left);
+      if (roots[i]->right)
+        nextRoots.push_back(roots[i]->right);
+    }
+    roots.swap(nextRoots);
+  }
+
+  for (size_t i = 0; i < roots.size(); ++i)
+    VanEmdeBoasOrder(roots[i], levels - topLevels, order);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -1049,7 +1319,11 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    nodeBlock(NULL),
+    nodeBlockSize(0),
+    nodeBlockLayout(VAN_EMDE_BOAS_LAYOUT),
+    boundBlock(NULL)
 {
   // Nothing to do.
 }
@@ -1065,11 +1339,13 @@ template<typename MetricType,
              class SplitType>
 template<typename Archive>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-    serialize(Archive& ar, const unsigned int /* version */)
+    serialize(Archive& ar, const unsigned int version)
 {
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
+    if (nodeBlock)
+      FreeNodeBlock();
     if (left)
       delete left;
     if (right)
@@ -1109,6 +1385,21 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     if (right)
       right->parent = this;
   }
+
+  // The nodes of a compacted tree are saved one by one like those of any other
+  // tree; only the layout is saved, and the block is rebuilt after loading.
+  if (version > 0)
+  {
+    bool compact = (nodeBlock != NULL);
+    ar & BOOST_SERIALIZATION_NVP(compact);
+    if (compact)
+    {
+      int layout = (int) nodeBlockLayout;
+      ar & BOOST_SERIALIZATION_NVP(layout);
+      if (Archive::is_loading::value)
+        Compact((NodeLayout) layout);
+    }
+  }
 }
 
 } // namespace tree
@@ -74,6 +74,15 @@ DualTreeTraverser<RuleType>::Traverse(
     // Loop through each of the points in each node.
     const size_t queryEnd = queryNode.Begin() + queryNode.Count();
     const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
+
+    // If the rules can run a whole block of base cases at once, first find the
+    // query points we need to investigate, then run all of their base cases
+    // with one call.
+    arma::uvec queries;
+    if (HasBlockBaseCase<RuleType>::value)
+      queries.set_size(queryNode.Count());
+    size_t numQueries = 0;
+
     for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
     {
       // See if we need to investigate this point (this function should be
@@ -85,11 +94,26 @@ DualTreeTraverser<RuleType>::Traverse(
       if (childScore == DBL_MAX)
         continue; // We can't improve this particular point.
 
-      for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
-        rule.BaseCase(query, ref);
+      if (HasBlockBaseCase<RuleType>::value)
+      {
+        queries[numQueries++] = query;
+      }
+      else
+      {
+        for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
+          rule.BaseCase(query, ref);
+      }
 
       numBaseCases += referenceNode.Count();
     }
+
+    if (HasBlockBaseCase<RuleType>::value && numQueries > 0 &&
+        referenceNode.Count() > 0)
+    {
+      queries.resize(numQueries);
+      BlockBaseCase(rule, queries, arma::regspace<arma::uvec>(
+          referenceNode.Begin(), refEnd - 1));
+    }
   }
   else if (((!queryNode.IsLeaf()) && referenceNode.IsLeaf()) ||
            (queryNode.NumDescendants() > 3 * referenceNode.NumDescendants() &&
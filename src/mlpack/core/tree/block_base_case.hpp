@@ -0,0 +1,83 @@
+/**
+ * @file core/tree/block_base_case.hpp
+ *
+ * Utilities that let tree traversers run all the base cases between two leaves
+ * with one call, for the rules that provide a BlockBaseCase() method.
+ *
+ * A RuleType may implement
+ *
+ * @code
+ * void BlockBaseCase(const arma::uvec& queryIndices,
+ *                    const arma::uvec& referenceIndices);
+ * @endcode
+ *
+ * which must have the same effect as calling BaseCase(q, r) for every q in
+ * queryIndices (in order) and every r in referenceIndices (in order).  This
+ * allows the distances between the two sets of points to be computed as one
+ * block, which is much faster than one pair at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BLOCK_BASE_CASE_HPP
+#define MLPACK_CORE_TREE_BLOCK_BASE_CASE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+//! The form of the BlockBaseCase() method of a RuleType.
+template<typename Class, typename... Ts>
+using BlockBaseCaseForm = void(Class::*)(const arma::uvec&, const arma::uvec&,
+    Ts...);
+
+HAS_EXACT_METHOD_FORM(BlockBaseCase, HasBlockBaseCaseForm);
+
+/**
+ * HasBlockBaseCase<RuleType>::value is true if RuleType provides a
+ * BlockBaseCase() method.
+ */
+template<typename RuleType>
+struct HasBlockBaseCase
+{
+  static const bool value =
+      HasBlockBaseCaseForm<RuleType, BlockBaseCaseForm>::value;
+};
+
+/**
+ * Run the base cases between every point in queryIndices and every point in
+ * referenceIndices, with a single call to the rules' BlockBaseCase().
+ */
+template<typename RuleType>
+typename std::enable_if<HasBlockBaseCase<RuleType>::value>::type
+BlockBaseCase(RuleType& rule,
+              const arma::uvec& queryIndices,
+              const arma::uvec& referenceIndices)
+{
+  rule.BlockBaseCase(queryIndices, referenceIndices);
+}
+
+/**
+ * Run the base cases between every point in queryIndices and every point in
+ * referenceIndices, one pair at a time, for rules that do not provide
+ * BlockBaseCase().
+ */
+template<typename RuleType>
+typename std::enable_if<!HasBlockBaseCase<RuleType>::value>::type
+BlockBaseCase(RuleType& rule,
+              const arma::uvec& queryIndices,
+              const arma::uvec& referenceIndices)
+{
+  for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    for (size_t j = 0; j < referenceIndices.n_elem; ++j)
+      rule.BaseCase(queryIndices[i], referenceIndices[j]);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
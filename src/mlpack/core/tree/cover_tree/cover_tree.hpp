@@ -364,11 +364,12 @@ class CoverTree
   ElemType MinDistance(const CoverTree& other, const ElemType distance) const;
 
   //! Return the minimum distance to another point.
-  ElemType MinDistance(const arma::vec& other) const;
+  ElemType MinDistance(const arma::Col<ElemType>& other) const;
 
   //! Return the minimum distance to another point given that the distance from
   //! the center to the point has already been calculated.
-  ElemType MinDistance(const arma::vec& other, const ElemType distance) const;
+  ElemType MinDistance(const arma::Col<ElemType>& other,
+                       const ElemType distance) const;
 
   //! Return the maximum distance to another node.
   ElemType MaxDistance(const CoverTree& other) const;
@@ -378,11 +379,12 @@ class CoverTree
   ElemType MaxDistance(const CoverTree& other, const ElemType distance) const;
 
   //! Return the maximum distance to another point.
-  ElemType MaxDistance(const arma::vec& other) const;
+  ElemType MaxDistance(const arma::Col<ElemType>& other) const;
 
   //! Return the maximum distance to another point given that the distance from
   //! the center to the point has already been calculated.
-  ElemType MaxDistance(const arma::vec& other, const ElemType distance) const;
+  ElemType MaxDistance(const arma::Col<ElemType>& other,
+                       const ElemType distance) const;
 
   //! Return the minimum and maximum distance to another node.
   math::RangeType<ElemType> RangeDistance(const CoverTree& other) const;
@@ -393,11 +395,12 @@ class CoverTree
                                           const ElemType distance) const;
 
   //! Return the minimum and maximum distance to another point.
-  math::RangeType<ElemType> RangeDistance(const arma::vec& other) const;
+  math::RangeType<ElemType> RangeDistance(
+      const arma::Col<ElemType>& other) const;
 
   //! Return the minimum and maximum distance to another point given that the
   //! point-to-point distance has already been calculated.
-  math::RangeType<ElemType> RangeDistance(const arma::vec& other,
+  math::RangeType<ElemType> RangeDistance(const arma::Col<ElemType>& other,
                                           const ElemType distance) const;
 
   //! Get the parent node.
@@ -425,9 +428,9 @@ class CoverTree
   ElemType MinimumBoundDistance() const { return furthestDescendantDistance; }
 
   //! Get the center of the node and store it in the given vector.
-  void Center(arma::vec& center) const
+  void Center(arma::Col<ElemType>& center) const
   {
-    center = arma::vec(dataset->col(point));
+    center = arma::Col<ElemType>(dataset->col(point));
   }
 
   //! Get the instantiated metric.
@@ -462,7 +465,8 @@ class CoverTree
   MetricType* metric;
 
   /**
-   * Create the children for this node.
+   * Create the children for this node.  If OpenMP is available, the children
+   * of large dense nodes are built in parallel.
    */
   void CreateChildren(arma::Col<size_t>& indices,
                       arma::vec& distances,
@@ -470,11 +474,36 @@ class CoverTree
                       size_t& farSetSize,
                       size_t& usedSetSize);
 
+  //! A child that CreateChildren() builds as an OpenMP task.
+  struct ChildTask
+  {
+    //! The index of the point of the child.
+    size_t point;
+    //! The distance from the point of the child to the point of this node.
+    ElemType parentDistance;
+    //! The indices of the near set of the child, followed by its point.
+    arma::Col<size_t> indices;
+    //! The distances of the near set of the child to its point.
+    arma::vec distances;
+    //! The size of the near set of the child.
+    size_t nearSetSize;
+    //! The child, once it is built.
+    CoverTree* node;
+  };
+
+  /**
+   * Build each of the given children (at the given scale) as an OpenMP task,
+   * and wait for all of them to finish.
+   */
+  void BuildChildTasks(std::vector<ChildTask>& childTasks,
+                       const int childScale);
+
   /**
    * Fill the vector of distances with the distances between the point specified
    * by pointIndex and each point in the indices array.  The distances of the
    * first pointSetSize points in indices are calculated (so, this does not
-   * necessarily need to use all of the points in the arrays).
+   * necessarily need to use all of the points in the arrays).  If OpenMP is
+   * available, large dense point sets are processed in parallel.
    *
    * @param pointIndex Point to build the distances for.
    * @param indices List of indices to compute distances for.
@@ -18,6 +18,10 @@
 #include <queue>
 #include <string>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -929,7 +933,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
     MinDistance(const CoverTree& other) const
 {
   // Every cover tree node will contain points up to base^(scale + 1) away.
-  return std::max(metric->Evaluate(dataset->col(point),
+  return std::max<ElemType>(metric->Evaluate(dataset->col(point),
       other.Dataset().col(other.Point())) -
       furthestDescendantDistance - other.FurthestDescendantDistance(), 0.0);
 }
@@ -946,7 +950,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
     MinDistance(const CoverTree& other, const ElemType distance) const
 {
   // We already have the distance as evaluated by the metric.
-  return std::max(distance - furthestDescendantDistance -
+  return std::max<ElemType>(distance - furthestDescendantDistance -
       other.FurthestDescendantDistance(), 0.0);
 }
 
@@ -959,9 +963,9 @@ template<
 typename CoverTree<MetricType, StatisticType, MatType,
     RootPointPolicy>::ElemType
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-    MinDistance(const arma::vec& other) const
+    MinDistance(const arma::Col<ElemType>& other) const
 {
-  return std::max(metric->Evaluate(dataset->col(point), other) -
+  return std::max<ElemType>(metric->Evaluate(dataset->col(point), other) -
       furthestDescendantDistance, 0.0);
 }
 
@@ -974,9 +978,10 @@ template<
 typename CoverTree<MetricType, StatisticType, MatType,
     RootPointPolicy>::ElemType
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-    MinDistance(const arma::vec& /* other */, const ElemType distance) const
+    MinDistance(const arma::Col<ElemType>& /* other */,
+                const ElemType distance) const
 {
-  return std::max(distance - furthestDescendantDistance, 0.0);
+  return std::max<ElemType>(distance - furthestDescendantDistance, 0.0);
 }
 
 template<
@@ -1020,7 +1025,7 @@ template<
 typename CoverTree<MetricType, StatisticType, MatType,
     RootPointPolicy>::ElemType
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-    MaxDistance(const arma::vec& other) const
+    MaxDistance(const arma::Col<ElemType>& other) const
 {
   return metric->Evaluate(dataset->col(point), other) +
       furthestDescendantDistance;
@@ -1035,7 +1040,8 @@ template<
 typename CoverTree<MetricType, StatisticType, MatType,
     RootPointPolicy>::ElemType
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-    MaxDistance(const arma::vec& /* other */, const ElemType distance) const
+    MaxDistance(const arma::Col<ElemType>& /* other */,
+                const ElemType distance) const
 {
   return distance + furthestDescendantDistance;
 }
@@ -1056,7 +1062,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
       other.Dataset().col(other.Point()));
 
   math::RangeType<ElemType> result;
-  result.Lo() = std::max(distance - furthestDescendantDistance -
+  result.Lo() = std::max<ElemType>(distance - furthestDescendantDistance -
       other.FurthestDescendantDistance(), 0.0);
   result.Hi() = distance + furthestDescendantDistance +
       other.FurthestDescendantDistance();
@@ -1079,7 +1085,7 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
                   const ElemType distance) const
 {
   math::RangeType<ElemType> result;
-  result.Lo() = std::max(distance - furthestDescendantDistance -
+  result.Lo() = std::max<ElemType>(distance - furthestDescendantDistance -
       other.FurthestDescendantDistance(), 0.0);
   result.Hi() = distance + furthestDescendantDistance +
       other.FurthestDescendantDistance();
@@ -1097,12 +1103,12 @@ template<
 math::RangeType<typename
     CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::ElemType>
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-    RangeDistance(const arma::vec& other) const
+    RangeDistance(const arma::Col<ElemType>& other) const
 {
   const ElemType distance = metric->Evaluate(dataset->col(point), other);
 
   return math::RangeType<ElemType>(
-      std::max(distance - furthestDescendantDistance, 0.0),
+      std::max<ElemType>(distance - furthestDescendantDistance, 0.0),
       distance + furthestDescendantDistance);
 }
 
@@ -1117,11 +1123,11 @@ template<
 math::RangeType<typename
     CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::ElemType>
 CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
-    RangeDistance(const arma::vec& /* other */,
+    RangeDistance(const arma::Col<ElemType>& /* other */,
                   const ElemType distance) const
 {
   return math::RangeType<ElemType>(
-      std::max(distance - furthestDescendantDistance, 0.0),
+      std::max<ElemType>(distance - furthestDescendantDistance, 0.0),
       distance + furthestDescendantDistance);
 }
 
@@ -1224,6 +1230,21 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
   nearSetSize -= childUsedSetSize;
   usedSetSize += childUsedSetSize;
 
+  // Large nodes build their other children as OpenMP tasks.  Such a child only
+  // takes the points of its near set, and not the points of its far set, so
+  // the points it uses are known before it is built and the next child does
+  // not have to wait for it.  The node may get a few more children than with
+  // the serial construction, but the tree still does not depend on the number
+  // of threads.  Sparse matrices are left alone, because column access may
+  // update their internal cache.
+  #ifdef HAS_OPENMP
+  const bool buildTasks = (nearSetSize + farSetSize >= 4096) &&
+      !arma::is_arma_sparse_type<MatType>::value;
+  #else
+  const bool buildTasks = false;
+  #endif
+  std::vector<ChildTask> childTasks;
+
   // Now for each point in the near set, we need to make children.  To save
   // computation later, we'll create an array holding the points in the near
   // set, and then after each run we'll check which of those (if any) were used
@@ -1282,6 +1303,31 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
     // Split into near and far sets for this point.
     childNearSetSize = SplitNearFar(childIndices, childDistances, bound,
         nearSetSize + farSetSize - 1);
+
+    if (buildTasks)
+    {
+      // The child will use its point and its near set, so we can move them to
+      // our used set now and build the child later.
+      childIndices(childNearSetSize) = indices[0];
+      childDistances(childNearSetSize) = 0;
+
+      childTasks.push_back(ChildTask());
+      ChildTask& task = childTasks.back();
+      task.point = indices[0];
+      task.parentDistance = distances[0];
+      task.nearSetSize = childNearSetSize;
+      task.node = NULL;
+
+      // The child only works on its near set and its point, so the task keeps
+      // a copy of just that part; all the tasks of this node are queued before
+      // any of them runs.
+      task.indices = childIndices.head(childNearSetSize + 1);
+      task.distances = childDistances.head(childNearSetSize + 1);
+      MoveToUsedSet(indices, distances, nearSetSize, farSetSize, usedSetSize,
+          childIndices, 0, childNearSetSize + 1);
+      continue;
+    }
+
     childFarSetSize = PruneFarSet(childIndices, childDistances,
         base * bound, childNearSetSize,
         (nearSetSize + farSetSize - 1));
@@ -1314,6 +1360,35 @@ CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::CreateChildren(
         childIndices, childFarSetSize, childUsedSetSize);
   }
 
+  if (!childTasks.empty())
+  {
+    // Start a team of threads, unless we are already a task of one.
+    #ifdef HAS_OPENMP
+    if (!omp_in_parallel())
+    {
+      #pragma omp parallel
+      #pragma omp single
+      BuildChildTasks(childTasks, nextScale);
+    }
+    else
+    {
+      BuildChildTasks(childTasks, nextScale);
+    }
+    #endif
+
+    // Add the children in the order they were chosen.
+    for (size_t i = 0; i < childTasks.size(); ++i)
+    {
+      children.push_back(childTasks[i].node);
+      numDescendants += children.back()->NumDescendants();
+
+      // Remove any implicit nodes.
+      RemoveNewImplicitNodes();
+
+      distanceComps += children.back()->DistanceComps();
+    }
+  }
+
   // Calculate furthest descendant.
   for (size_t i = (nearSetSize + farSetSize); i < (nearSetSize + farSetSize +
       usedSetSize); ++i)
@@ -1378,6 +1453,33 @@ size_t CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
   return left;
 }
 
+template<
+    typename MetricType,
+    typename StatisticType,
+    typename MatType,
+    typename RootPointPolicy
+>
+void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
+    BuildChildTasks(std::vector<ChildTask>& childTasks, const int childScale)
+{
+  for (size_t i = 0; i < childTasks.size(); ++i)
+  {
+    ChildTask* task = &childTasks[i];
+    #pragma omp task firstprivate(task)
+    {
+      // The child has no far set, and its point is its only used point.
+      size_t childFarSetSize = 0;
+      size_t childUsedSetSize = 1;
+      task->node = new CoverTree(*dataset, base, task->point, childScale, this,
+          task->parentDistance, task->indices, task->distances,
+          task->nearSetSize, childFarSetSize, childUsedSetSize, *metric);
+    }
+  }
+
+  // Each child is complete before the node uses it.
+  #pragma omp taskwait
+}
+
 // Returns the maximum distance between points.
 template<
     typename MetricType,
@@ -1394,7 +1496,16 @@ void CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>::
   // For each point, rebuild the distances.  The indices do not need to be
   // modified.
   distanceComps += pointSetSize;
-  for (size_t i = 0; i < pointSetSize; ++i)
+
+  // Near the top of the tree the point sets hold most of the dataset, and most
+  // of the construction time is spent here, so large sets are split between
+  // threads.  Each distance is computed the same way either way, so the tree
+  // does not depend on the number of threads.  Sparse matrices are left alone,
+  // because column access may update their internal cache.
+  const bool parallel = (pointSetSize >= 4096) &&
+      !arma::is_arma_sparse_type<MatType>::value;
+  #pragma omp parallel for if (parallel)
+  for (omp_size_t i = 0; i < (omp_size_t) pointSetSize; ++i)
   {
     distances[i] = metric->Evaluate(dataset->col(pointIndex),
         dataset->col(indices[i]));
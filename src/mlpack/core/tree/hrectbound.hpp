@@ -98,6 +98,16 @@ class HRectBound
   const math::RangeType<ElemType>& operator[](const size_t i) const
   { return bounds[i]; }
 
+  /**
+   * Store the ranges of the bound in the given memory, which must hold at least
+   * Dim() ranges and must outlive the bound (or the next reallocation of its
+   * ranges).  The bound does not free that memory.  This lets a tree keep the
+   * ranges of all its nodes in one block; see BinarySpaceTree::Compact().
+   *
+   * @param storage Memory to hold the ranges of the bound.
+   */
+  void Relocate(math::RangeType<ElemType>* storage);
+
   //! Get the minimum width of the bound.
   ElemType MinWidth() const { return minWidth; }
   //! Modify the minimum width of the bound.
@@ -179,7 +189,7 @@ class HRectBound
    * Expands this region to include new points.
    *
    * @tparam MatType Type of matrix; could be Mat, SpMat, a subview, or just a
-   *   vector.
+   *   vector.  Its element type may differ from the element type of the bound.
    * @param data Data points to expand this region to include.
    */
   template<typename MatType>
@@ -236,6 +246,9 @@ class HRectBound
   size_t dim;
   //! The bounds for each dimension.
   math::RangeType<ElemType>* bounds;
+  //! If false, bounds is held in memory given to Relocate(), which must not be
+  //! freed by the bound.
+  bool ownsBounds;
   //! Cached minimum width of bound.
   ElemType minWidth;
   //! Instantiated metric (likely has size 0).
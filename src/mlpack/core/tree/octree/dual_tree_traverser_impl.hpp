@@ -58,6 +58,17 @@ void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
   {
     const size_t begin = queryNode.Point(0);
     const size_t end = begin + queryNode.NumPoints();
+    const size_t rBegin = referenceNode.Point(0);
+    const size_t rEnd = rBegin + referenceNode.NumPoints();
+
+    // If the rules can run a whole block of base cases at once, first find the
+    // query points we need to investigate, then run all of their base cases
+    // with one call.
+    arma::uvec queries;
+    if (HasBlockBaseCase<RuleType>::value)
+      queries.set_size(queryNode.NumPoints());
+    size_t numQueries = 0;
+
     for (size_t q = begin; q < end; ++q)
     {
       // First, see if we can prune the reference node for this query point.
@@ -69,13 +80,26 @@ void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
         continue;
       }
 
-      const size_t rBegin = referenceNode.Point(0);
-      const size_t rEnd = rBegin + referenceNode.NumPoints();
-      for (size_t r = rBegin; r < rEnd; ++r)
-        rule.BaseCase(q, r);
+      if (HasBlockBaseCase<RuleType>::value)
+      {
+        queries[numQueries++] = q;
+      }
+      else
+      {
+        for (size_t r = rBegin; r < rEnd; ++r)
+          rule.BaseCase(q, r);
+      }
 
       numBaseCases += referenceNode.NumPoints();
     }
+
+    if (HasBlockBaseCase<RuleType>::value && numQueries > 0 &&
+        referenceNode.NumPoints() > 0)
+    {
+      queries.resize(numQueries);
+      BlockBaseCase(rule, queries, arma::regspace<arma::uvec>(rBegin,
+          rEnd - 1));
+    }
   }
   else if (!queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
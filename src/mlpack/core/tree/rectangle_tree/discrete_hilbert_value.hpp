@@ -197,6 +197,25 @@ class DiscreteHilbertValue
   template<typename TreeType>
   void UpdateLargestValue(TreeType* node);
 
+  /**
+   * Set the Hilbert values of a node built by bulk loading.  The points of a
+   * leaf (or the children of an intermediate node) should already be arranged
+   * according to their Hilbert values.
+   *
+   * @param node The node in which the information should be set.
+   */
+  template<typename TreeType>
+  void BulkLoadNode(TreeType* node);
+
+  /**
+   * Sort the given points by their Hilbert values.
+   *
+   * @param dataset The dataset that holds the points.
+   * @param order The indices of the points; they are sorted in place.
+   */
+  template<typename MatType>
+  static void SortPoints(const MatType& dataset, std::vector<size_t>& order);
+
   /**
    * This method updates the largest Hilbert value of a leaf node and
    * redistributes the Hilbert values of points according to their new position
@@ -50,10 +50,11 @@ DiscreteHilbertValue<TreeElemType>::DiscreteHilbertValue(const TreeType* tree) :
   // Calculate the Hilbert value for all points.
   if (!tree->Parent()) // This is the root node.
     ownsLocalHilbertValues = true;
-  else if (tree->Parent()->Child(0).IsLeaf())
+  else if (tree->Parent()->NumChildren() == 0 ||
+      tree->Parent()->Child(0).IsLeaf())
   {
-    // This is a leaf node.
-    assert(tree->Parent()->NumChildren() > 0);
+    // This is a leaf node (or a node built by bulk loading, which is set up in
+    // BulkLoadNode() once its children are known).
     ownsLocalHilbertValues = true;
   }
 
@@ -470,6 +471,61 @@ void DiscreteHilbertValue<TreeElemType>::UpdateLargestValue(TreeType* node)
   }
 }
 
+template<typename TreeElemType>
+template<typename TreeType>
+void DiscreteHilbertValue<TreeElemType>::BulkLoadNode(TreeType* node)
+{
+  if (node->IsLeaf())
+  {
+    assert(ownsLocalHilbertValues);
+
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+    {
+      localHilbertValues->col(i) =
+          CalculateValue(node->Dataset().col(node->Point(i)));
+    }
+    numValues = node->NumPoints();
+  }
+  else
+  {
+    // Only leaf nodes own the local Hilbert values; intermediate nodes point
+    // to the values of their last child.
+    if (ownsLocalHilbertValues)
+      delete localHilbertValues;
+    ownsLocalHilbertValues = false;
+
+    UpdateLargestValue(node);
+  }
+}
+
+template<typename TreeElemType>
+template<typename MatType>
+void DiscreteHilbertValue<TreeElemType>::SortPoints(
+    const MatType& dataset,
+    std::vector<size_t>& order)
+{
+  // Calculate the Hilbert value of each point only once.
+  std::vector<arma::Col<HilbertElemType>> values(order.size());
+  std::vector<size_t> positions(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    values[i] = CalculateValue(dataset.col(order[i]));
+    positions[i] = i;
+  }
+
+  std::stable_sort(positions.begin(), positions.end(),
+      [&values](const size_t a, const size_t b)
+      {
+        return CompareValues(values[a], values[b]) < 0;
+      });
+
+  std::vector<size_t> sortedOrder(order.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    sortedOrder[i] = order[positions[i]];
+
+  order.swap(sortedOrder);
+}
+
 template<typename TreeElemType>
 template<typename TreeType>
 void DiscreteHilbertValue<TreeElemType>::RedistributeHilbertValues(
@@ -66,6 +66,14 @@ DualTreeTraverser<RuleType>::Traverse(RectangleTree& queryNode,
 
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
+    // If the rules can run a whole block of base cases at once, first find the
+    // query points we need to investigate, then run all of their base cases
+    // with one call.
+    arma::uvec queries;
+    if (HasBlockBaseCase<RuleType>::value)
+      queries.set_size(queryNode.Count());
+    size_t numQueries = 0;
+
     // Evaluate the base case.  Do the query points on the outside so we can
     // possibly prune the reference node for that particular point.
     for (size_t query = 0; query < queryNode.Count(); ++query)
@@ -78,11 +86,28 @@ DualTreeTraverser<RuleType>::Traverse(RectangleTree& queryNode,
       if (childScore == DBL_MAX)
         continue;  // We don't require a search in this reference node.
 
-      for (size_t ref = 0; ref < referenceNode.Count(); ++ref)
-        rule.BaseCase(queryNode.Point(query), referenceNode.Point(ref));
+      if (HasBlockBaseCase<RuleType>::value)
+      {
+        queries[numQueries++] = queryNode.Point(query);
+      }
+      else
+      {
+        for (size_t ref = 0; ref < referenceNode.Count(); ++ref)
+          rule.BaseCase(queryNode.Point(query), referenceNode.Point(ref));
+      }
 
       numBaseCases += referenceNode.Count();
     }
+
+    if (HasBlockBaseCase<RuleType>::value && numQueries > 0)
+    {
+      arma::uvec references(referenceNode.Count());
+      for (size_t ref = 0; ref < referenceNode.Count(); ++ref)
+        references[ref] = referenceNode.Point(ref);
+
+      queries.resize(numQueries);
+      BlockBaseCase(rule, queries, references);
+    }
   }
   else if (!queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
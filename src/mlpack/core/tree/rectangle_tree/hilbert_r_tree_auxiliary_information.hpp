@@ -109,6 +109,25 @@ class HilbertRTreeAuxiliaryInformation
    */
   bool HandleNodeRemoval(TreeType* node, const size_t nodeIndex);
 
+  /**
+   * The Hilbert R tree requires all points to be arranged according to their
+   * Hilbert value.  This method sorts the points by their Hilbert value when
+   * the tree is bulk-loaded, so that they are packed in that order, and
+   * returns true.
+   *
+   * @param node The root of the tree being bulk-loaded.
+   * @param order The global numbers of the points, sorted in place.
+   */
+  bool HandleBulkLoadOrder(TreeType* node, std::vector<size_t>& order);
+
+  /**
+   * Set the largest Hilbert value of a node built by bulk loading (and the
+   * Hilbert values of the points of a leaf).
+   *
+   * @param node The node that has been built.
+   */
+  void BulkLoadNode(TreeType* node);
+
   /**
    * Update the auxiliary information in the node. The method returns true if
    * the update should be propagated downward.
@@ -150,6 +150,23 @@ HandleNodeRemoval(TreeType* node, const size_t nodeIndex)
   return true;
 }
 
+template<typename TreeType,
+         template<typename> class HilbertValueType>
+bool HilbertRTreeAuxiliaryInformation<TreeType, HilbertValueType>::
+HandleBulkLoadOrder(TreeType* node, std::vector<size_t>& order)
+{
+  HilbertValueType<ElemType>::SortPoints(node->Dataset(), order);
+  return true;
+}
+
+template<typename TreeType,
+         template<typename> class HilbertValueType>
+void HilbertRTreeAuxiliaryInformation<TreeType, HilbertValueType>::
+BulkLoadNode(TreeType* node)
+{
+  hilbertValue.BulkLoadNode(node);
+}
+
 template<typename TreeType,
          template<typename> class HilbertValueType>
 bool HilbertRTreeAuxiliaryInformation<TreeType, HilbertValueType>::
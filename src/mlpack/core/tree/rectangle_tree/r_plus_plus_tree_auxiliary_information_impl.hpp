@@ -89,6 +89,18 @@ bool RPlusPlusTreeAuxiliaryInformation<TreeType>::HandleNodeRemoval(
   return false;
 }
 
+template<typename TreeType>
+bool RPlusPlusTreeAuxiliaryInformation<TreeType>::HandleBulkLoadOrder(
+    TreeType* /* node */, std::vector<size_t>& /* order */)
+{
+  return false;
+}
+
+template<typename TreeType>
+void RPlusPlusTreeAuxiliaryInformation<TreeType>::BulkLoadNode(
+    TreeType* /* node */)
+{ }
+
 template<typename TreeType>
 bool RPlusPlusTreeAuxiliaryInformation<TreeType>::UpdateAuxiliaryInfo(
     TreeType* /* node */)
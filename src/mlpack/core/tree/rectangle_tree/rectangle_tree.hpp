@@ -17,6 +17,7 @@
 
 #include "../hrectbound.hpp"
 #include "../statistic.hpp"
+#include "../tree_traits.hpp"
 #include "r_tree_split.hpp"
 #include "r_tree_descent_heuristic.hpp"
 #include "no_auxiliary_information.hpp"
@@ -24,6 +25,19 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+/**
+ * The ways in which a RectangleTree can be built from a dataset.
+ */
+enum RectangleTreeBuild
+{
+  //! The points are inserted one at a time, and nodes are split when they
+  //! overflow.
+  INSERTION_BUILD,
+  //! The points are packed bottom-up into full nodes in Sort-Tile-Recursive
+  //! order (in Hilbert order for Hilbert R trees).
+  STR_BULK_LOAD
+};
+
 /**
  * A rectangle type tree tree, such as an R-tree or X-tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -156,6 +170,62 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset, with the given build method.  With STR_BULK_LOAD, the tree is
+   * built bottom-up with the Sort-Tile-Recursive algorithm of Leutenegger et
+   * al.: the points are sorted along the first dimension and cut into slabs,
+   * each slab is sorted along the next dimension and cut again, and so on, so
+   * that each leaf holds a compact tile of maxLeafSize points (or nearly so).
+   * The nodes of each level are packed into nodes of maxNumChildren children
+   * in the same way.  This is much faster than inserting the points one by
+   * one, and gives full nodes with little overlap.  Points can be inserted and
+   * deleted afterwards as usual.
+   *
+   * Hilbert R trees are packed in the Hilbert order of the points instead:
+   * the points are sorted by their Hilbert values and cut into consecutive
+   * leaves, and the nodes of each level are grouped in the same order.
+   *
+   * Bulk loading is only available for trees whose children may overlap (not
+   * for R+ and R++ trees).
+   *
+   * @param data Dataset from which to create the tree.
+   * @param build Method used to build the tree.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(const MatType& data,
+                const RectangleTreeBuild build,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
+  /**
+   * Construct this as the root node of a rectangle type tree using the given
+   * dataset and build method, and taking ownership of the given dataset.  See
+   * the constructor above for details about the build methods.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param build Method used to build the tree.
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  RectangleTree(MatType&& data,
+                const RectangleTreeBuild build,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -312,9 +382,11 @@ class RectangleTree
   RectangleTree* FindByBeginCount(size_t begin, size_t count);
 
   //! Return the bound object for this node.
-  const bound::HRectBound<MetricType>& Bound() const { return bound; }
+  const bound::HRectBound<metric::EuclideanDistance, ElemType>& Bound() const
+  { return bound; }
   //! Modify the bound object for this node.
-  bound::HRectBound<MetricType>& Bound() { return bound; }
+  bound::HRectBound<metric::EuclideanDistance, ElemType>& Bound()
+  { return bound; }
 
   //! Return the statistic object for this node.
   const StatisticType& Stat() const { return stat; }
@@ -365,7 +437,7 @@ class RectangleTree
   MetricType Metric() const { return MetricType(); }
 
   //! Get the centroid of the node and store it in the given vector.
-  void Center(arma::vec& center) { bound.Center(center); }
+  void Center(arma::Col<ElemType>& center) { bound.Center(center); }
 
   //! Return the number of child nodes.  (One level beneath this one only.)
   size_t NumChildren() const { return numChildren; }
@@ -564,6 +636,49 @@ class RectangleTree
    */
   void BuildStatistics(RectangleTree* node);
 
+  /**
+   * Build the tree bottom-up from all the points of the dataset with the
+   * Sort-Tile-Recursive algorithm, or in the order given by the auxiliary
+   * information (the Hilbert order for Hilbert R trees).  This node must be an
+   * empty root.
+   */
+  void BulkLoad();
+
+  /**
+   * Sort the given range of indices into Sort-Tile-Recursive order along the
+   * given dimension and the ones after it, and cut it into groups of at most
+   * capacity elements.  The groups are as even as possible.
+   *
+   * @param centers The centers of the elements to sort.
+   * @param order Indices of the elements; the range is sorted in place.
+   * @param begin First position of the range.
+   * @param end Position after the end of the range.
+   * @param dim Dimension to sort along.
+   * @param capacity Maximum number of elements in each group.
+   * @param groupEnds Vector to append the end position of each group to.
+   */
+  static void STRPartition(const arma::Mat<ElemType>& centers,
+                           std::vector<size_t>& order,
+                           const size_t begin,
+                           const size_t end,
+                           const size_t dim,
+                           const size_t capacity,
+                           std::vector<size_t>& groupEnds);
+
+  /**
+   * Cut the given range of ordered elements into groups of at most capacity
+   * elements.  The groups are as even as possible.
+   *
+   * @param begin First position of the range.
+   * @param end Position after the end of the range.
+   * @param capacity Maximum number of elements in each group.
+   * @param groupEnds Vector to append the end position of each group to.
+   */
+  static void EvenPartition(const size_t begin,
+                            const size_t end,
+                            const size_t capacity,
+                            std::vector<size_t>& groupEnds);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -599,7 +714,7 @@ class RectangleTree
    * @param relevels The levels that have been reinserted to on this top level
    *      insertion.
    */
-  void CondenseTree(const arma::vec& point,
+  void CondenseTree(const arma::Col<ElemType>& point,
                     std::vector<bool>& relevels,
                     const bool usePoint);
 
@@ -610,7 +725,7 @@ class RectangleTree
    *      shrinking.
    * @return true if the bound needed to be changed, false if it did not.
    */
-  bool ShrinkBoundForPoint(const arma::vec& point);
+  bool ShrinkBoundForPoint(const arma::Col<ElemType>& point);
 
   /**
    * Shrink the bound object of this node for the removal of a child node.
@@ -619,7 +734,9 @@ class RectangleTree
    *      shrinking.
    * @return true if the bound needed to be changed, false if it did not.
    */
-  bool ShrinkBoundForBound(const bound::HRectBound<MetricType>& changedBound);
+  bool ShrinkBoundForBound(
+      const bound::HRectBound<metric::EuclideanDistance, ElemType>&
+          changedBound);
 
   /**
    * Make an exact copy of this node, pointers and everything.
@@ -121,6 +121,96 @@ RectangleTree(MatType&& data,
   BuildStatistics(this);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const RectangleTreeBuild build,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  if (build == STR_BULK_LOAD)
+  {
+    BulkLoad();
+  }
+  else
+  {
+    for (size_t i = 0; i < dataset->n_cols; ++i)
+      InsertPoint(i);
+  }
+
+  // Initialize statistic recursively after tree construction is complete.
+  BuildStatistics(this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const RectangleTreeBuild build,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  if (build == STR_BULK_LOAD)
+  {
+    BulkLoad();
+  }
+  else
+  {
+    for (size_t i = 0; i < dataset->n_cols; ++i)
+      InsertPoint(i);
+  }
+
+  // Initialize statistic recursively after tree construction is complete.
+  BuildStatistics(this);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -398,6 +488,208 @@ RectangleTree(
   ar >> BOOST_SERIALIZATION_NVP(*this);
 }
 
+/**
+ * Build the tree bottom-up with the Sort-Tile-Recursive algorithm.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    BulkLoad()
+{
+  // Packed nodes may overlap.
+  static_assert(TreeTraits<RectangleTree>::HasOverlappingChildren,
+      "RectangleTree: bulk loading is not supported for trees with "
+      "non-overlapping children.");
+
+  const size_t numPoints = dataset->n_cols;
+  if (numPoints == 0)
+    return;
+
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+
+  // Some tree types (e.g. the Hilbert R tree) keep their points in a given
+  // order.  Then the points are sorted by the auxiliary information, and the
+  // elements of each level are cut into consecutive groups.
+  const bool ordered = auxiliaryInfo.HandleBulkLoadOrder(this, order);
+
+  // If all the points fit in one leaf, the root is that leaf.
+  if (numPoints <= maxLeafSize)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      bound |= dataset->col(order[i]);
+      points[count++] = order[i];
+    }
+    numDescendants = numPoints;
+    auxiliaryInfo.BulkLoadNode(this);
+    return;
+  }
+
+  // Pack the points into leaves.  The nodes are created as children of this
+  // node so that they get the right parameters; their parents are set when the
+  // level above them is packed.
+  std::vector<size_t> groupEnds;
+  if (ordered)
+    EvenPartition(0, numPoints, maxLeafSize, groupEnds);
+  else
+    STRPartition(*dataset, order, 0, numPoints, 0, maxLeafSize, groupEnds);
+
+  std::vector<RectangleTree*> nodes(groupEnds.size());
+  size_t groupBegin = 0;
+  for (size_t g = 0; g < groupEnds.size(); ++g)
+  {
+    RectangleTree* leaf = new RectangleTree(this);
+    for (size_t i = groupBegin; i < groupEnds[g]; ++i)
+    {
+      leaf->bound |= dataset->col(order[i]);
+      leaf->points[leaf->count++] = order[i];
+    }
+    leaf->numDescendants = leaf->count;
+    leaf->auxiliaryInfo.BulkLoadNode(leaf);
+
+    nodes[g] = leaf;
+    groupBegin = groupEnds[g];
+  }
+
+  // Pack each level into the level above it until the nodes fit in the root.
+  arma::Col<ElemType> center;
+  while (nodes.size() > maxNumChildren)
+  {
+    order.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+      order[i] = i;
+
+    groupEnds.clear();
+    if (ordered)
+    {
+      EvenPartition(0, nodes.size(), maxNumChildren, groupEnds);
+    }
+    else
+    {
+      arma::Mat<ElemType> centers(dataset->n_rows, nodes.size());
+      for (size_t i = 0; i < nodes.size(); ++i)
+      {
+        nodes[i]->bound.Center(center);
+        centers.col(i) = center;
+      }
+
+      STRPartition(centers, order, 0, nodes.size(), 0, maxNumChildren,
+          groupEnds);
+    }
+
+    std::vector<RectangleTree*> parents(groupEnds.size());
+    groupBegin = 0;
+    for (size_t g = 0; g < groupEnds.size(); ++g)
+    {
+      RectangleTree* node = new RectangleTree(this);
+      for (size_t i = groupBegin; i < groupEnds[g]; ++i)
+      {
+        RectangleTree* child = nodes[order[i]];
+        node->children[node->numChildren++] = child;
+        child->parent = node;
+        node->bound |= child->bound;
+        node->numDescendants += child->numDescendants;
+      }
+      node->auxiliaryInfo.BulkLoadNode(node);
+
+      parents[g] = node;
+      groupBegin = groupEnds[g];
+    }
+
+    nodes.swap(parents);
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    children[numChildren++] = nodes[i];
+    nodes[i]->parent = this;
+    bound |= nodes[i]->bound;
+    numDescendants += nodes[i]->numDescendants;
+  }
+  auxiliaryInfo.BulkLoadNode(this);
+}
+
+/**
+ * Sort the given range into Sort-Tile-Recursive order and cut it into groups.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    STRPartition(const arma::Mat<ElemType>& centers,
+                 std::vector<size_t>& order,
+                 const size_t begin,
+                 const size_t end,
+                 const size_t dim,
+                 const size_t capacity,
+                 std::vector<size_t>& groupEnds)
+{
+  const size_t numElements = end - begin;
+  const size_t numGroups = (numElements + capacity - 1) / capacity;
+
+  std::sort(order.begin() + begin, order.begin() + end,
+      [&centers, dim](const size_t a, const size_t b)
+      {
+        return centers(dim, a) < centers(dim, b);
+      });
+
+  // On the last dimension (or if there is nothing left to cut), cut the range
+  // into even groups.
+  if (dim + 1 == centers.n_rows || numGroups <= 1)
+  {
+    EvenPartition(begin, end, capacity, groupEnds);
+    return;
+  }
+
+  // Otherwise cut the range into slabs of whole groups, so that the groups of
+  // each of the remaining dimensions are as square as possible, and recurse.
+  const size_t numSlabs = std::min(numGroups, (size_t) std::ceil(
+      std::pow((double) numGroups, 1.0 / (centers.n_rows - dim))));
+  size_t slabBegin = begin;
+  for (size_t s = 1; s <= numSlabs; ++s)
+  {
+    const size_t slabGroups = s * numGroups / numSlabs;
+    const size_t slabEnd = begin + slabGroups * numElements / numGroups;
+    STRPartition(centers, order, slabBegin, slabEnd, dim + 1, capacity,
+        groupEnds);
+    slabBegin = slabEnd;
+  }
+}
+
+/**
+ * Cut the given range into even groups.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+    EvenPartition(const size_t begin,
+                  const size_t end,
+                  const size_t capacity,
+                  std::vector<size_t>& groupEnds)
+{
+  const size_t numElements = end - begin;
+  const size_t numGroups = (numElements + capacity - 1) / capacity;
+
+  for (size_t g = 1; g <= numGroups; ++g)
+    groupEnds.push_back(begin + g * numElements / numGroups);
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling
  * their destructors in turn.  This will invalidate any pointers or references
@@ -697,7 +989,7 @@ bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
         tree->numDescendants -= node->numDescendants;
         tree = tree->Parent();
       }
-      CondenseTree(arma::vec(), relevels, false);
+      CondenseTree(arma::Col<ElemType>(), relevels, false);
       return true;
     }
 
@@ -1074,7 +1366,7 @@ template<typename MetricType,
          template<typename> class AuxiliaryInformationType>
 void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
                    AuxiliaryInformationType>::
-    CondenseTree(const arma::vec& point,
+    CondenseTree(const arma::Col<ElemType>& point,
                  std::vector<bool>& relevels,
                  const bool usePoint)
 {
@@ -1258,7 +1550,7 @@ template<typename MetricType,
          template<typename> class AuxiliaryInformationType>
 bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
                    AuxiliaryInformationType>::
-    ShrinkBoundForPoint(const arma::vec& point)
+    ShrinkBoundForPoint(const arma::Col<ElemType>& point)
 {
   bool shrunk = false;
   if (IsLeaf())
@@ -1356,7 +1648,8 @@ template<typename MetricType,
          template<typename> class AuxiliaryInformationType>
 bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
                    AuxiliaryInformationType>::
-    ShrinkBoundForBound(const bound::HRectBound<MetricType>& /* b */)
+    ShrinkBoundForBound(
+        const bound::HRectBound<metric::EuclideanDistance, ElemType>& /* b */)
 {
   // Using the sum is safe since none of the dimensions can increase.
   ElemType sum = 0;
@@ -145,6 +145,33 @@ class XTreeAuxiliaryInformation
     return false;
   }
 
+  /**
+   * Some tree types require the points to be arranged in a particular order
+   * when the tree is bulk-loaded.  This method allows the auxiliary
+   * information the option of sorting the points.  If the auxiliary
+   * information does that, then the method should return true, and the points
+   * and the nodes of each level are packed in that order; if the method
+   * returns false the RectangleTree uses Sort-Tile-Recursive order.
+   *
+   * @param * (node) The root of the tree being bulk-loaded.
+   * @param * (order) The global numbers of the points, sorted in place.
+   */
+  bool HandleBulkLoadOrder(TreeType* /* node */,
+                           std::vector<size_t>& /* order */)
+  {
+    return false;
+  }
+
+  /**
+   * Some tree types require to set up some properties of the nodes built by
+   * bulk loading.  This method is called for each node once its points or
+   * children have been added, from the leaves up to the root.
+   *
+   * @param * (node) The node that has been built.
+   */
+  void BulkLoadNode(TreeType* /* node */)
+  { }
+
   /**
    * Some tree types require to propagate the information upward.
    * This method should return false if this is not the case. If true is
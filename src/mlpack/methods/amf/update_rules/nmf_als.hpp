@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_LMF_UPDATE_RULES_NMF_ALS_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "sparse_products.hpp"
 
 namespace mlpack {
 namespace amf {
@@ -123,6 +124,47 @@ class NMFALSUpdate
   void serialize(Archive& /* ar */, const unsigned int /* version */) { }
 }; // class NMFALSUpdate
 
+/**
+ * WUpdate function specialization for sparse matrices.  H * V^T is computed in
+ * parallel over blocks of rows of V, and the Gram matrix H * H^T is
+ * pseudo-inverted once and shared by the least squares solves of all the rows
+ * of W.
+ */
+template<>
+inline void NMFALSUpdate::WUpdate<arma::sp_mat>(const arma::sp_mat& V,
+                                                arma::mat& W,
+                                                const arma::mat& H)
+{
+  arma::mat HVt;
+  TimesSparseTrans(H, V, HVt);
+
+  // The Gram matrix is symmetric, so W^T = pinv(H * H^T) * H * V^T.
+  W = (pinv(H * H.t()) * HVt).t();
+
+  // Set all negative numbers to 0.
+  W.transform([](const double val) { return (val < 0.0) ? 0.0 : val; });
+}
+
+/**
+ * HUpdate function specialization for sparse matrices.  W^T * V is computed in
+ * parallel over the columns of V, and the Gram matrix W^T * W is
+ * pseudo-inverted once and shared by the least squares solves of all the
+ * columns of H.
+ */
+template<>
+inline void NMFALSUpdate::HUpdate<arma::sp_mat>(const arma::sp_mat& V,
+                                                const arma::mat& W,
+                                                arma::mat& H)
+{
+  arma::mat WtV;
+  SparseTransTimes(W, V, WtV);
+
+  H = pinv(W.t() * W) * WtV;
+
+  // Set all negative numbers to 0.
+  H.transform([](const double val) { return (val < 0.0) ? 0.0 : val; });
+}
+
 } // namespace amf
 } // namespace mlpack
 
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_LMF_UPDATE_RULES_NMF_MULT_DIST_UPDATE_RULES_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "sparse_products.hpp"
 
 namespace mlpack {
 namespace amf {
@@ -101,6 +102,40 @@ class NMFMultiplicativeDistanceUpdate
   void serialize(Archive& /* ar */, const unsigned int /* version */) { }
 };
 
+/**
+ * WUpdate function specialization for sparse matrices.  V * H^T is computed in
+ * parallel over blocks of rows of V, and the denominator goes through the small
+ * Gram matrix H * H^T instead of the dense product W * H.
+ */
+template<>
+inline void NMFMultiplicativeDistanceUpdate::WUpdate<arma::sp_mat>(
+    const arma::sp_mat& V,
+    arma::mat& W,
+    const arma::mat& H)
+{
+  arma::mat HVt;
+  TimesSparseTrans(H, V, HVt);
+
+  W = (W % HVt.t()) / (W * (H * H.t()));
+}
+
+/**
+ * HUpdate function specialization for sparse matrices.  W^T * V is computed in
+ * parallel over the columns of V, and the denominator goes through the small
+ * Gram matrix W^T * W instead of the dense product W * H.
+ */
+template<>
+inline void NMFMultiplicativeDistanceUpdate::HUpdate<arma::sp_mat>(
+    const arma::sp_mat& V,
+    const arma::mat& W,
+    arma::mat& H)
+{
+  arma::mat WtV;
+  SparseTransTimes(W, V, WtV);
+
+  H = (H % WtV) / ((W.t() * W) * H);
+}
+
 } // namespace amf
 } // namespace mlpack
 
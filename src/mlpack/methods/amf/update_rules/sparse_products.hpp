@@ -0,0 +1,142 @@
+/**
+ * @file methods/amf/update_rules/sparse_products.hpp
+ *
+ * Parallel sparse-dense products and nonzero traversals used by the sparse
+ * specializations of the AMF update rules.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_PRODUCTS_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_PRODUCTS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <algorithm>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * Call f(row, col, value) for every nonzero of V.  The columns of V are
+ * distributed over the available threads, and all the nonzeros of one column
+ * are visited by the same thread, in order of increasing row.  So f may write
+ * to anything indexed by the column without synchronization.
+ *
+ * @param V Sparse matrix to traverse.
+ * @param f Function to call on every nonzero.
+ */
+template<typename FunctionType>
+inline void ParallelForEachNonZeroByColumn(const arma::sp_mat& V,
+                                           FunctionType f)
+{
+  V.sync();
+
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (omp_size_t j = 0; j < (omp_size_t) V.n_cols; ++j)
+  {
+    for (size_t k = V.col_ptrs[j]; k < V.col_ptrs[j + 1]; ++k)
+      f((size_t) V.row_indices[k], (size_t) j, V.values[k]);
+  }
+}
+
+/**
+ * Call f(row, col, value) for every nonzero of V.  The rows of V are split
+ * into contiguous blocks, and all the nonzeros of one block are visited by the
+ * same thread, in order of increasing column.  So f may write to anything
+ * indexed by the row without synchronization.
+ *
+ * V is stored by column, so rather than transposing V each thread walks every
+ * column and uses a binary search to find the part of the column that lies in
+ * its block of rows.
+ *
+ * @param V Sparse matrix to traverse.
+ * @param f Function to call on every nonzero.
+ */
+template<typename FunctionType>
+inline void ParallelForEachNonZeroByRow(const arma::sp_mat& V, FunctionType f)
+{
+  V.sync();
+
+  // Use a few more blocks than threads to even out the load when the rows have
+  // very different numbers of nonzeros.
+  #ifdef HAS_OPENMP
+    const size_t numBlocks = std::min((size_t) V.n_rows,
+        4 * (size_t) omp_get_max_threads());
+  #else
+    const size_t numBlocks = std::min((size_t) V.n_rows, (size_t) 1);
+  #endif
+  if (numBlocks == 0)
+    return;
+  const size_t rowsPerBlock = (V.n_rows + numBlocks - 1) / numBlocks;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const arma::uword rowBegin = b * rowsPerBlock;
+    const arma::uword rowEnd = std::min((size_t) V.n_rows,
+        (b + 1) * rowsPerBlock);
+
+    for (size_t j = 0; j < V.n_cols; ++j)
+    {
+      const arma::uword* last = V.row_indices + V.col_ptrs[j + 1];
+      const arma::uword* it = (numBlocks == 1) ?
+          V.row_indices + V.col_ptrs[j] :
+          std::lower_bound(V.row_indices + V.col_ptrs[j], last, rowBegin);
+      for (; it != last && *it < rowEnd; ++it)
+        f((size_t) *it, j, V.values[it - V.row_indices]);
+    }
+  }
+}
+
+/**
+ * Compute W^T * V for a dense W and a sparse V, in parallel over the columns
+ * of V.
+ *
+ * @param W Dense matrix with V.n_rows rows.
+ * @param V Sparse matrix.
+ * @param output Matrix to store W^T * V in (W.n_cols x V.n_cols).
+ */
+inline void SparseTransTimes(const arma::mat& W,
+                             const arma::sp_mat& V,
+                             arma::mat& output)
+{
+  // Transpose W so that the rows we accumulate are contiguous in memory.
+  const arma::mat Wt = W.t();
+  output.zeros(W.n_cols, V.n_cols);
+  ParallelForEachNonZeroByColumn(V,
+      [&](const size_t row, const size_t col, const double value)
+      {
+        output.col(col) += value * Wt.col(row);
+      });
+}
+
+/**
+ * Compute H * V^T (that is, the transpose of V * H^T) for a dense H and a
+ * sparse V, in parallel over blocks of rows of V.
+ *
+ * @param H Dense matrix with V.n_cols columns.
+ * @param V Sparse matrix.
+ * @param output Matrix to store H * V^T in (H.n_rows x V.n_rows).
+ */
+inline void TimesSparseTrans(const arma::mat& H,
+                             const arma::sp_mat& V,
+                             arma::mat& output)
+{
+  output.zeros(H.n_rows, V.n_rows);
+  ParallelForEachNonZeroByRow(V,
+      [&](const size_t row, const size_t col, const double value)
+      {
+        output.col(row) += value * H.col(col);
+      });
+}
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
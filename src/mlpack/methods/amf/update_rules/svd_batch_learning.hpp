@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_AMF_UPDATE_RULES_SVD_BATCH_LEARNING_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "sparse_products.hpp"
 
 namespace mlpack {
 namespace amf {
@@ -196,7 +197,8 @@ class SVDBatchLearning
 //!        common row_col_iterator
 
 /**
- * WUpdate function specialization for sparse matrix
+ * WUpdate function specialization for sparse matrix.  The nonzeros are visited
+ * in parallel, with each thread owning a block of rows of W.
  */
 template<>
 inline void SVDBatchLearning::WUpdate<arma::sp_mat>(const arma::sp_mat& V,
@@ -208,24 +210,29 @@ inline void SVDBatchLearning::WUpdate<arma::sp_mat>(const arma::sp_mat& V,
 
   mW = momentum * mW;
 
-  arma::mat deltaW;
-  deltaW.zeros(n, r);
+  // Work on the transposes so that the rows of W are contiguous in memory.
+  const arma::mat Wt = W.t();
+  arma::mat deltaWt;
+  deltaWt.zeros(r, n);
 
-  for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
-  {
-    const size_t row = it.row();
-    const size_t col = it.col();
-    deltaW.row(it.row()) += (*it - arma::dot(W.row(row), H.col(col))) *
-                                             arma::trans(H.col(col));
-  }
+  ParallelForEachNonZeroByRow(V,
+      [&](const size_t row, const size_t col, const double value)
+      {
+        deltaWt.col(row) += (value - arma::dot(Wt.col(row), H.col(col))) *
+            H.col(col);
+      });
 
   if (kw != 0)
-    deltaW -= kw * W;
+    deltaWt -= kw * Wt;
 
-  mW += u * deltaW;
+  mW += u * deltaWt.t();
   W += mW;
 }
 
+/**
+ * HUpdate function specialization for sparse matrix.  The nonzeros are visited
+ * in parallel, with each thread owning a set of columns of H.
+ */
 template<>
 inline void SVDBatchLearning::HUpdate<arma::sp_mat>(const arma::sp_mat& V,
                                                     const arma::mat& W,
@@ -236,16 +243,16 @@ inline void SVDBatchLearning::HUpdate<arma::sp_mat>(const arma::sp_mat& V,
 
   mH = momentum * mH;
 
+  const arma::mat Wt = W.t();
   arma::mat deltaH;
   deltaH.zeros(r, m);
 
-  for (arma::sp_mat::const_iterator it = V.begin(); it != V.end(); ++it)
-  {
-    const size_t row = it.row();
-    const size_t col = it.col();
-    deltaH.col(col) += (*it - arma::dot(W.row(row), H.col(col))) *
-        W.row(row).t();
-  }
+  ParallelForEachNonZeroByColumn(V,
+      [&](const size_t row, const size_t col, const double value)
+      {
+        deltaH.col(col) += (value - arma::dot(Wt.col(row), H.col(col))) *
+            Wt.col(row);
+      });
 
   if (kh != 0)
     deltaH -= kh * H;
@@ -72,9 +72,10 @@ class NaiveConvolution
         const eT* kernelPtr = filter.memptr();
         for (size_t kj = 0; kj < filter.n_cols; ++kj)
         {
-          const eT* inputPtr = input.colptr(kj * dilationW + j * dW) + i * dH;
+          // The rows are the x direction, and the columns the y direction.
+          const eT* inputPtr = input.colptr(kj * dilationH + j * dH) + i * dW;
           for (size_t ki = 0; ki < filter.n_rows; ++ki, ++kernelPtr,
-              inputPtr += dilationH)
+              inputPtr += dilationW)
             *outputPtr += *kernelPtr * (*inputPtr);
         }
       }
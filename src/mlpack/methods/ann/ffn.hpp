@@ -26,6 +26,10 @@
 #include "visitor/loss_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
+#include "quantization/quantized_layer.hpp"
+#include "fusion/fused_layer.hpp"
+
+#include <mlpack/core/data/batch_loader.hpp>
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
@@ -37,23 +41,33 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 /**
- * Implementation of a standard feed forward network.
+ * Implementation of a standard feed forward network on the given matrix type.
+ * Most code will use the FFN alias below, which works on arma::mat.
  *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the data and of the parameters of the network
+ *         (arma::mat or arma::fmat).  All the modules of the network must work
+ *         on this matrix type, e.g. Linear<arma::fmat, arma::fmat> for an
+ *         arma::fmat network; the container layers such as Sequential only
+ *         work on arma::mat.
  * @tparam CustomLayers Any set of custom layers that could be a part of the
  *         feed forward network.
  */
 template<
   typename OutputLayerType = NegativeLogLikelihood<>,
   typename InitializationRuleType = RandomInitialization,
+  typename MatType = arma::mat,
   typename... CustomLayers
 >
-class FFN
+class FFNType
 {
  public:
   //! Convenience typedef for the internal model construction.
-  using NetworkType = FFN<OutputLayerType, InitializationRuleType>;
+  using NetworkType = FFNType<OutputLayerType, InitializationRuleType, MatType>;
+
+  //! The element type of the data and parameters of the network.
+  typedef typename MatType::elem_type ElemType;
 
   /**
    * Create the FFN object.
@@ -68,20 +82,20 @@ class FFN
    * @param initializeRule Optional instantiated InitializationRule object
    *        for initializing the network parameter.
    */
-  FFN(OutputLayerType outputLayer = OutputLayerType(),
+  FFNType(OutputLayerType outputLayer = OutputLayerType(),
       InitializationRuleType initializeRule = InitializationRuleType());
 
   //! Copy constructor.
-  FFN(const FFN&);
+  FFNType(const FFNType&);
 
   //! Move constructor.
-  FFN(FFN&&);
+  FFNType(FFNType&&);
 
   //! Copy/move assignment operator.
-  FFN& operator = (FFN);
+  FFNType& operator = (FFNType);
 
   //! Destructor to release allocated memory.
-  ~FFN();
+  ~FFNType();
 
   /**
    * Check if the optimizer has MaxIterations() parameter, if it does
@@ -123,7 +137,14 @@ class FFN
    * If you want to pass in a parameter and discard the original parameter
    * object, be sure to use std::move to avoid unnecessary copy.
    *
+   * The gradient can be represented as an arma::sp_mat instead of a dense
+   * matrix by setting GradType, for optimizers that accept sparse gradients
+   * such as ens::SGD.  This is useful for networks that start with a large
+   * Lookup layer, since only the embeddings of the tokens in each batch are
+   * then written and updated; see EvaluateWithGradient().
+   *
    * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @tparam GradType Type of the gradient (MatType or arma::SpMat).
    * @tparam CallbackTypes Types of Callback Functions.
    * @param predictors Input training variables.
    * @param responses Outputs results from input training variables.
@@ -132,9 +153,11 @@ class FFN
    *      See https://www.ensmallen.org/docs.html#callback-documentation.
    * @return The final objective of the trained model (NaN or Inf on error).
    */
-  template<typename OptimizerType, typename... CallbackTypes>
-  double Train(arma::mat predictors,
-               arma::mat responses,
+  template<typename OptimizerType,
+           typename GradType = MatType,
+           typename... CallbackTypes>
+  double Train(MatType predictors,
+               MatType responses,
                OptimizerType& optimizer,
                CallbackTypes&&... callbacks);
 
@@ -151,6 +174,7 @@ class FFN
    * object, be sure to use std::move to avoid unnecessary copy.
    *
    * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @tparam GradType Type of the gradient (MatType or arma::SpMat).
    * @param predictors Input training variables.
    * @tparam CallbackTypes Types of Callback Functions.
    * @param responses Outputs results from input training variables.
@@ -158,9 +182,34 @@ class FFN
    *      See https://www.ensmallen.org/docs.html#callback-documentation.
    * @return The final objective of the trained model (NaN or Inf on error).
    */
-  template<typename OptimizerType = ens::RMSProp, typename... CallbackTypes>
-  double Train(arma::mat predictors,
-               arma::mat responses,
+  template<typename OptimizerType = ens::RMSProp,
+           typename GradType = MatType,
+           typename... CallbackTypes>
+  double Train(MatType predictors,
+               MatType responses,
+               CallbackTypes&&... callbacks);
+
+  /**
+   * Train the feedforward network on the batches of the given loader, which
+   * are decoded in the background while the network is trained on the current
+   * batch.  Each evaluation of the optimizer uses the next batch of the loader,
+   * so the optimizer must be one that visits the points in batches, such as
+   * ens::SGD or ens::Adam, and its batch size must be the same as the batch
+   * size of the loader.  The number of iterations of the optimizer counts
+   * points, as usual.  The loader shuffles the points itself, so shuffling in
+   * the optimizer has no effect.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @tparam CallbackTypes Types of Callback Functions.
+   * @param loader Loader of the batches of predictors and responses.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @param callbacks Callback function for ensmallen optimizer `OptimizerType`.
+   *      See https://www.ensmallen.org/docs.html#callback-documentation.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType, typename... CallbackTypes>
+  double Train(data::BatchLoader<MatType, MatType>& loader,
+               OptimizerType& optimizer,
                CallbackTypes&&... callbacks);
 
   /**
@@ -174,7 +223,51 @@ class FFN
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
    */
-  void Predict(arma::mat predictors, arma::mat& results);
+  void Predict(MatType predictors, MatType& results);
+
+  /**
+   * Quantize the Linear and Convolution layers of the trained network to 8-bit
+   * integers for inference.  The range of the input of each of these layers is
+   * measured on the given calibration data, which should be a representative
+   * sample of the data the network will be used on.  After this, Predict()
+   * computes these layers with integer arithmetic and the other layers as
+   * usual.  The quantized layers are serialized along with the model, and are
+   * discarded when the network is trained again or its parameters are reset.
+   *
+   * The floating point parameters are kept alongside the quantized weights, so
+   * that the network can still be trained or used without quantization;
+   * quantizing therefore adds to the memory used by the model instead of
+   * reducing it.  The activations between layers also stay in floating point
+   * and are quantized again at the input of each quantized layer, so only the
+   * layer products themselves use integer arithmetic.
+   *
+   * @param calibrationData Data used to measure the range of the layer inputs.
+   */
+  void Quantize(const MatType& calibrationData);
+
+  //! Return whether the network has been quantized with Quantize().
+  bool Quantized() const { return !quantizedNetwork.empty(); }
+
+  /**
+   * Build an inference graph of the trained network in which fewer passes are
+   * made over the activations.  Each Linear and Convolution module is fused
+   * with the modules that follow it: a BatchNorm module is folded into its
+   * weights and bias with the running mean and variance, and a ReLU, Sigmoid
+   * or TanH module is applied in place together with the bias.  Dropout and
+   * AlphaDropout modules, which do nothing in deterministic mode, are dropped.
+   * After this, Predict() evaluates the whole batch with the fused graph, and
+   * the other modules as usual; the results are the same up to rounding.
+   *
+   * The fused graph is serialized along with the model, and is discarded when
+   * the network is trained again, its parameters are reset or it is
+   * quantized; fusing the network discards the quantized layers.  The input
+   * sizes of the convolutions must be known, i.e. the network must have been
+   * used for a forward pass.
+   */
+  void Fuse();
+
+  //! Return whether the network has been fused with Fuse().
+  bool Fused() const { return !fusedModules.empty(); }
 
   /**
    * Evaluate the feedforward network with the given predictors and responses.
@@ -193,7 +286,7 @@ class FFN
    *
    * @param parameters Matrix model parameters.
    */
-  double Evaluate(const arma::mat& parameters);
+  ElemType Evaluate(const MatType& parameters);
 
    /**
    * Evaluate the feedforward network with the given parameters, but using only
@@ -208,10 +301,10 @@ class FFN
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& parameters,
-                  const size_t begin,
-                  const size_t batchSize,
-                  const bool deterministic);
+  ElemType Evaluate(const MatType& parameters,
+                    const size_t begin,
+                    const size_t batchSize,
+                    const bool deterministic);
 
    /**
    * Evaluate the feedforward network with the given parameters, but using only
@@ -225,9 +318,9 @@ class FFN
    * @param batchSize Number of points to be passed at a time to use for
    *        objective function evaluation.
    */
-  double Evaluate(const arma::mat& parameters,
-                  const size_t begin,
-                  const size_t batchSize);
+  ElemType Evaluate(const MatType& parameters,
+                    const size_t begin,
+                    const size_t batchSize);
 
   /**
    * Evaluate the feedforward network with the given parameters.
@@ -238,7 +331,8 @@ class FFN
    * @param gradient Matrix to output gradient into.
    */
   template<typename GradType>
-  double EvaluateWithGradient(const arma::mat& parameters, GradType& gradient);
+  ElemType EvaluateWithGradient(const MatType& parameters,
+                                GradType& gradient);
 
    /**
    * Evaluate the feedforward network with the given parameters, but using only
@@ -253,10 +347,31 @@ class FFN
    *        objective function evaluation.
    */
   template<typename GradType>
-  double EvaluateWithGradient(const arma::mat& parameters,
-                              const size_t begin,
-                              GradType& gradient,
-                              const size_t batchSize);
+  ElemType EvaluateWithGradient(const MatType& parameters,
+                                const size_t begin,
+                                GradType& gradient,
+                                const size_t batchSize);
+
+  /**
+   * Evaluate the feedforward network with the given parameters, but using only
+   * a number of data points, and store the gradient as a sparse matrix.  The
+   * gradient of each Lookup layer only holds the embeddings of the tokens in
+   * the batch, so neither the evaluation nor the update of the optimizer has
+   * to touch the whole embedding table; the gradient of the other layers is
+   * stored in full.  The gradient is the same as the dense one.  The batch is
+   * always evaluated by a single worker, whatever the value of Threads().
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the starting point to use for objective function
+   *        evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   * @param batchSize Number of points to be passed at a time to use for
+   *        objective function evaluation.
+   */
+  ElemType EvaluateWithGradient(const MatType& parameters,
+                                const size_t begin,
+                                arma::SpMat<ElemType>& gradient,
+                                const size_t batchSize);
 
   /**
    * Evaluate the gradient of the feedforward network with the given parameters,
@@ -270,9 +385,9 @@ class FFN
    * @param batchSize Number of points to be processed as a batch for objective
    *        function gradient evaluation.
    */
-  void Gradient(const arma::mat& parameters,
+  void Gradient(const MatType& parameters,
                 const size_t begin,
-                arma::mat& gradient,
+                MatType& gradient,
                 const size_t batchSize);
 
   /**
@@ -310,19 +425,59 @@ class FFN
   size_t NumFunctions() const { return numFunctions; }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameter; }
+  const MatType& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameter; }
+  MatType& Parameters() { return parameter; }
 
   //! Get the matrix of responses to the input data points.
-  const arma::mat& Responses() const { return responses; }
+  const MatType& Responses() const { return responses; }
   //! Modify the matrix of responses to the input data points.
-  arma::mat& Responses() { return responses; }
+  MatType& Responses() { return responses; }
 
   //! Get the matrix of data points (predictors).
-  const arma::mat& Predictors() const { return predictors; }
+  const MatType& Predictors() const { return predictors; }
   //! Modify the matrix of data points (predictors).
-  arma::mat& Predictors() { return predictors; }
+  MatType& Predictors() { return predictors; }
+
+  /**
+   * Get the number of worker threads used to evaluate the gradient of a batch
+   * during training.  If it is larger than one, each batch is split across the
+   * workers, each with its own replica of the layers, and the gradients of the
+   * workers are summed into the gradient of the batch.  0 means that all the
+   * available OpenMP threads are used.  Networks with layers that compute
+   * statistics over the batch, such as BatchNorm or Reparametrization, are
+   * always trained with one thread, since each worker only sees its share of
+   * the batch.
+   */
+  size_t Threads() const { return threads; }
+  //! Modify the number of worker threads used during training.
+  size_t& Threads() { return threads; }
+
+  /**
+   * Get the indices of the modules whose outputs are kept during training.  If
+   * the list is empty (the default), the forward pass of training keeps the
+   * output of every module for the backward pass.  Otherwise, it only keeps
+   * the outputs of these modules, of the last module, and of the modules that
+   * behave differently during training (such as Dropout or BatchNorm), draw
+   * random samples (such as Reparametrization) or hold state (the modules with
+   * a Reset() or ResetCell() function, such as Linear or LSTM); the other
+   * outputs are recomputed one segment at a time during the backward pass.
+   * Keeping the output of every k-th module, with k close to the square root
+   * of the number of modules, takes the memory of the outputs down to about
+   * its square root, for the cost of about one more forward pass.  The
+   * gradient is the same as without checkpoints.
+   */
+  const std::vector<size_t>& Checkpoints() const { return checkpoints; }
+  //! Modify the indices of the modules whose outputs are kept during training.
+  std::vector<size_t>& Checkpoints() { return checkpoints; }
+
+  //! Get the largest size, in bytes, of the module outputs held at the same
+  //! time during the last training step.
+  size_t ActivationMemory() const { return activationMemory; }
+
+  //! Get the time, in seconds, spent recomputing module outputs since Train()
+  //! was last called.
+  double RecomputationTime() const { return recomputationTime; }
 
   /**
    * Reset the module infomration (weights/parameters).
@@ -393,6 +548,80 @@ class FFN
   template<typename InputType>
   void Forward(const InputType& input);
 
+  /**
+   * The Forward algorithm used during training.  If checkpoints are set, the
+   * outputs that are not kept are freed as soon as the next module has used
+   * them.
+   *
+   * @param input Data sequence to compute probabilities for.
+   */
+  template<typename InputType>
+  void TrainingForward(const InputType& input);
+
+  /**
+   * The Backward algorithm followed by the computation of the gradient of each
+   * module, used during training.  If checkpoints are set, the outputs freed by
+   * TrainingForward() are recomputed one segment at a time, from the last
+   * segment to the first.
+   *
+   * @param input Data sequence the forward pass was computed for.
+   * @param gradient Matrix to output gradient into.
+   */
+  template<typename InputType>
+  void TrainingBackward(const InputType& input, MatType& gradient);
+
+  /**
+   * Return whether the output of each module is kept during training when
+   * checkpoints are set.
+   */
+  std::vector<bool> KeptOutputs();
+
+  /**
+   * If the network is trained from a loader, replace the predictors and
+   * responses with the next batch of the loader and return 0, the index of the
+   * first point of the batch; otherwise, return the given index.
+   *
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  size_t LoadBatch(const size_t begin, const size_t batchSize);
+
+  /**
+   * Optimize the parameters of the network with the given optimizer and a
+   * dense gradient.
+   */
+  template<typename GradType, typename OptimizerType, typename... CallbackTypes>
+  typename std::enable_if<std::is_same<GradType, MatType>::value,
+      double>::type
+  Optimize(OptimizerType& optimizer, CallbackTypes&&... callbacks);
+
+  /**
+   * Optimize the parameters of the network with the given optimizer and a
+   * gradient of the given type.
+   */
+  template<typename GradType, typename OptimizerType, typename... CallbackTypes>
+  typename std::enable_if<!std::is_same<GradType, MatType>::value,
+      double>::type
+  Optimize(OptimizerType& optimizer, CallbackTypes&&... callbacks);
+
+  /**
+   * Predict the responses to the given predictors with the quantized layers
+   * of the network.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  void QuantizedPredict(const MatType& predictors, MatType& results);
+
+  /**
+   * Predict the responses to the given predictors with the fused inference
+   * graph of the network.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  void FusedPredict(const MatType& predictors, MatType& results);
+
   /**
    * Prepare the network for the given data.
    * This function won't actually trigger training process.
@@ -400,7 +629,7 @@ class FFN
    * @param predictors Input data variables.
    * @param responses Outputs results from input data variables.
    */
-  void ResetData(arma::mat predictors, arma::mat responses);
+  void ResetData(MatType predictors, MatType responses);
 
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
@@ -424,14 +653,38 @@ class FFN
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
-  void ResetGradients(arma::mat& gradient);
+  void ResetGradients(MatType& gradient);
+
+  /**
+   * Evaluate the network and its gradient on the given batch by splitting it
+   * across the given number of workers.  The output layer is evaluated on the
+   * whole batch, so the result is the same as the one of the serial pass.
+   *
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points in the batch.
+   * @param workers Number of workers to split the batch across.
+   */
+  template<typename GradType>
+  ElemType EvaluateWithGradientParallel(const size_t begin,
+                                        GradType& gradient,
+                                        const size_t batchSize,
+                                        const size_t workers);
+
+  /**
+   * Delete the current replicas of the network and create the given number of
+   * new ones, whose layers share the parameters of this network.
+   *
+   * @param workers Number of replicas to create.
+   */
+  void ResetReplicas(const size_t workers);
 
   /**
    * Swap the content of this network with given network.
    *
    * @param network Desired source network.
    */
-  void Swap(FFN& network);
+  void Swap(FFNType& network);
 
   //! Instantiated outputlayer used to evaluate the network.
   OutputLayerType outputLayer;
@@ -452,26 +705,38 @@ class FFN
   //! Locally-stored model modules.
   std::vector<LayerTypes<CustomLayers...> > network;
 
+  //! Quantized version of each module, if the network was quantized; the
+  //! modules that are not quantized have an empty QuantizedLayer.
+  std::vector<QuantizedLayer> quantizedNetwork;
+
+  //! The module evaluated by each step of the fused inference graph, if the
+  //! network was fused.
+  std::vector<size_t> fusedModules;
+
+  //! The fused layer of each step of the fused inference graph; the steps that
+  //! evaluate a module as usual have an empty FusedLayer.
+  std::vector<FusedLayer> fusedNetwork;
+
   //! The matrix of data points (predictors).
-  arma::mat predictors;
+  MatType predictors;
 
   //! The matrix of responses to the input data points.
-  arma::mat responses;
+  MatType responses;
 
   //! Matrix of (trained) parameters.
-  arma::mat parameter;
+  MatType parameter;
 
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
   //! The current error for the backward pass.
-  arma::mat error;
+  MatType error;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitorType<MatType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitorType<MatType> outputParameterVisitor;
 
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
@@ -495,20 +760,52 @@ class FFN
   bool deterministic;
 
   //! Locally-stored delta object.
-  arma::mat delta;
+  MatType delta;
 
   //! Locally-stored input parameter object.
-  arma::mat inputParameter;
+  MatType inputParameter;
 
   //! Locally-stored output parameter object.
-  arma::mat outputParameter;
+  MatType outputParameter;
 
   //! Locally-stored gradient parameter.
-  arma::mat gradient;
+  MatType gradient;
+
+  //! The dense gradient the layers write into when a sparse gradient is
+  //! evaluated; it is zero between evaluations, and reset when the layout of
+  //! the parameters changes.
+  MatType denseGradient;
+
+  //! The entries of the parameters of the layers other than Lookup, which the
+  //! sparse gradient always holds.
+  arma::uvec sparseEntries;
+
+  //! The index and parameter offset of each Lookup layer.
+  std::vector<std::pair<size_t, size_t> > lookupOffsets;
 
   //! Locally-stored copy visitor
   CopyVisitor<CustomLayers...> copyVisitor;
 
+  //! The number of worker threads used during training.
+  size_t threads;
+
+  //! Replicas of the network used by the workers during training.
+  std::vector<FFNType*> replicas;
+
+  //! The loader the network is trained from, if any.
+  data::BatchLoader<MatType, MatType>* loader;
+
+  //! The indices of the modules whose outputs are kept during training.
+  std::vector<size_t> checkpoints;
+
+  //! The largest size of the module outputs held during the last training
+  //! step, in bytes.
+  size_t activationMemory;
+
+  //! The time spent recomputing module outputs since Train() was last called,
+  //! in seconds.
+  double recomputationTime;
+
   // The GAN class should have access to internal members.
   template<
     typename Model,
@@ -517,7 +814,23 @@ class FFN
     typename PolicyType
   >
   friend class GAN;
-}; // class FFN
+}; // class FFNType
+
+/**
+ * Standard feed forward network of arma::mat; see FFNType.
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam CustomLayers Any set of custom layers that could be a part of the
+ *         feed forward network.
+ */
+template<
+  typename OutputLayerType = NegativeLogLikelihood<>,
+  typename InitializationRuleType = RandomInitialization,
+  typename... CustomLayers
+>
+using FFN = FFNType<OutputLayerType, InitializationRuleType, arma::mat,
+                    CustomLayers...>;
 
 } // namespace ann
 } // namespace mlpack
@@ -529,11 +842,14 @@ namespace serialization {
 
 template<typename OutputLayerType,
          typename InitializationRuleType,
+         typename MatType,
          typename... CustomLayer>
-struct version<
-    mlpack::ann::FFN<OutputLayerType, InitializationRuleType, CustomLayer...>>
+struct version<mlpack::ann::FFNType<OutputLayerType,
+                                    InitializationRuleType,
+                                    MatType,
+                                    CustomLayer...>>
 {
-  BOOST_STATIC_CONSTANT(int, value = 2);
+  BOOST_STATIC_CONSTANT(int, value = 4);
 };
 
 } // namespace serialization
@@ -17,21 +17,27 @@
 
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
+#include "visitor/batch_statistics_check_visitor.hpp"
+#include "visitor/forward_state_check_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
 
 #include <boost/serialization/variant.hpp>
 
+#include <chrono>
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
+         typename MatType, typename... CustomLayers>
+FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::FFNType(
     OutputLayerType outputLayer, InitializationRuleType initializeRule) :
     outputLayer(std::move(outputLayer)),
     initializeRule(std::move(initializeRule)),
@@ -39,41 +45,60 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     height(0),
     reset(false),
     numFunctions(0),
-    deterministic(false)
+    deterministic(false),
+    threads(1),
+    loader(NULL),
+    activationMemory(0),
+    recomputationTime(0.0)
 {
   /* Nothing to do here. */
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::~FFN()
+         typename MatType, typename... CustomLayers>
+FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::~FFNType()
 {
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
+
+  ResetReplicas(0);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::ResetData(
-    arma::mat predictors, arma::mat responses)
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::ResetData(
+    MatType predictors, MatType responses)
 {
   numFunctions = responses.n_cols;
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
+  this->loader = NULL;
   this->deterministic = false;
   ResetDeterministic();
 
+  // The quantized and fused layers are no longer valid once the network is
+  // trained.
+  quantizedNetwork.clear();
+  fusedModules.clear();
+  fusedNetwork.clear();
+  ResetReplicas(0);
+
+  activationMemory = 0;
+  recomputationTime = 0.0;
+
   if (!reset)
     ResetParameters();
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType>
 typename std::enable_if<
       HasMaxIterations<OptimizerType, size_t&(OptimizerType::*)()>
       ::value, void>::type
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
 WarnMessageMaxIterations(OptimizerType& optimizer, size_t samples) const
 {
   if (optimizer.MaxIterations() < samples &&
@@ -90,12 +115,12 @@ WarnMessageMaxIterations(OptimizerType& optimizer, size_t samples) const
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType>
 typename std::enable_if<
       !HasMaxIterations<OptimizerType, size_t&(OptimizerType::*)()>
       ::value, void>::type
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
 WarnMessageMaxIterations(OptimizerType& /* optimizer */, size_t /* samples */)
     const
 {
@@ -103,11 +128,12 @@ WarnMessageMaxIterations(OptimizerType& /* optimizer */, size_t /* samples */)
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-template<typename OptimizerType, typename... CallbackTypes>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
-      arma::mat predictors,
-      arma::mat responses,
+         typename MatType, typename... CustomLayers>
+template<typename OptimizerType, typename GradType, typename... CallbackTypes>
+double FFNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Train(
+      MatType predictors,
+      MatType responses,
       OptimizerType& optimizer,
       CallbackTypes&&... callbacks)
 {
@@ -117,7 +143,7 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 
   // Train the model.
   Timer::Start("ffn_optimization");
-  const double out = optimizer.Optimize(*this, parameter, callbacks...);
+  const double out = Optimize<GradType>(optimizer, callbacks...);
   Timer::Stop("ffn_optimization");
 
   Log::Info << "FFN::FFN(): final objective of trained model is " << out
@@ -126,11 +152,51 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType, typename... CallbackTypes>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
-    arma::mat predictors,
-    arma::mat responses,
+double FFNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Train(
+    data::BatchLoader<MatType, MatType>& loader,
+    OptimizerType& optimizer,
+    CallbackTypes&&... callbacks)
+{
+  // The predictors and responses only hold the current batch.
+  ResetData(MatType(), MatType());
+  numFunctions = loader.NumPoints();
+  this->loader = &loader;
+
+  // Stop using the loader when the training ends, even if the optimizer
+  // throws; the network then holds the last batch.
+  struct LoaderReset
+  {
+    ~LoaderReset()
+    {
+      network.loader = NULL;
+      network.numFunctions = network.responses.n_cols;
+    }
+
+    FFNType& network;
+  } loaderReset = { *this };
+
+  WarnMessageMaxIterations<OptimizerType>(optimizer, numFunctions);
+
+  // Train the model.
+  Timer::Start("ffn_optimization");
+  const double out = optimizer.Optimize(*this, parameter, callbacks...);
+  Timer::Stop("ffn_optimization");
+
+  Log::Info << "FFN::FFN(): final objective of trained model is " << out
+      << "." << std::endl;
+  return out;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+template<typename OptimizerType, typename GradType, typename... CallbackTypes>
+double FFNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Train(
+    MatType predictors,
+    MatType responses,
     CallbackTypes&&... callbacks)
 {
   ResetData(std::move(predictors), std::move(responses));
@@ -141,7 +207,7 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 
   // Train the model.
   Timer::Start("ffn_optimization");
-  const double out = optimizer.Optimize(*this, parameter, callbacks...);
+  const double out = Optimize<GradType>(optimizer, callbacks...);
   Timer::Stop("ffn_optimization");
 
   Log::Info << "FFN::FFN(): final objective of trained model is " << out
@@ -150,9 +216,10 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename PredictorsType, typename ResponsesType>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Forward(
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Forward(
     const PredictorsType& inputs, ResponsesType& results)
 {
   if (parameter.is_empty())
@@ -163,21 +230,22 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Forward(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename PredictorsType, typename ResponsesType>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Forward(
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Forward(
     const PredictorsType& inputs,
     ResponsesType& results,
     const size_t begin,
     const size_t end)
 {
-  boost::apply_visitor(ForwardVisitor(inputs,
+  boost::apply_visitor(ForwardVisitorType<MatType>(inputs,
       boost::apply_visitor(outputParameterVisitor, network[begin])),
       network[begin]);
 
   for (size_t i = 1; i < end - begin + 1; ++i)
   {
-    boost::apply_visitor(ForwardVisitor(boost::apply_visitor(
+    boost::apply_visitor(ForwardVisitorType<MatType>(boost::apply_visitor(
         outputParameterVisitor, network[begin + i - 1]),
         boost::apply_visitor(outputParameterVisitor, network[begin + i])),
         network[begin + i]);
@@ -187,9 +255,10 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Forward(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename PredictorsType, typename TargetsType, typename GradientsType>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
+double FFNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Backward(
     const PredictorsType& inputs,
     const TargetsType& targets,
     GradientsType& gradients)
@@ -205,7 +274,7 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
   outputLayer.Backward(boost::apply_visitor(outputParameterVisitor,
       network.back()), targets, error);
 
-  gradients = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+  gradients = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
 
   Backward();
   ResetGradients(gradients);
@@ -215,9 +284,10 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
-    arma::mat predictors, arma::mat& results)
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Predict(
+    MatType predictors, MatType& results)
 {
   if (parameter.is_empty())
     ResetParameters();
@@ -228,17 +298,29 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
     ResetDeterministic();
   }
 
-  arma::mat resultsTemp;
-  Forward(arma::mat(predictors.colptr(0), predictors.n_rows, 1, false, true));
+  if (!quantizedNetwork.empty())
+  {
+    QuantizedPredict(predictors, results);
+    return;
+  }
+
+  if (!fusedModules.empty())
+  {
+    FusedPredict(predictors, results);
+    return;
+  }
+
+  MatType resultsTemp;
+  Forward(MatType(predictors.colptr(0), predictors.n_rows, 1, false, true));
   resultsTemp = boost::apply_visitor(outputParameterVisitor,
       network.back()).col(0);
 
-  results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
+  results = MatType(resultsTemp.n_elem, predictors.n_cols);
   results.col(0) = resultsTemp.col(0);
 
   for (size_t i = 1; i < predictors.n_cols; ++i)
   {
-    Forward(arma::mat(predictors.colptr(i), predictors.n_rows, 1, false, true));
+    Forward(MatType(predictors.colptr(i), predictors.n_rows, 1, false, true));
 
     resultsTemp = boost::apply_visitor(outputParameterVisitor,
         network.back());
@@ -247,9 +329,211 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Quantize(
+    const MatType& calibrationData)
+{
+  if (!std::is_same<MatType, arma::mat>::value)
+  {
+    Log::Fatal << "FFN::Quantize(): only networks of arma::mat can be "
+        << "quantized!" << std::endl;
+  }
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  // Run the calibration data through the network, so that the input of every
+  // layer is known (and so that the input sizes of the convolutions are set).
+  Forward(calibrationData);
+
+  fusedModules.clear();
+  fusedNetwork.clear();
+  quantizedNetwork.clear();
+  quantizedNetwork.resize(network.size());
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    const MatType& layerInput = (i == 0) ? calibrationData :
+        boost::apply_visitor(outputParameterVisitor, network[i - 1]);
+    const double inputRange = arma::abs(layerInput).max();
+
+    if (Linear<>** linear = boost::get<Linear<>*>(&network[i]))
+      quantizedNetwork[i] = QuantizedLayer(**linear, inputRange);
+    else if (Convolution<>** conv = boost::get<Convolution<>*>(&network[i]))
+      quantizedNetwork[i] = QuantizedLayer(**conv, inputRange);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+QuantizedPredict(const MatType& predictors, MatType& results)
+{
+  // The quantized layers work on the whole batch at once; the other layers are
+  // evaluated with their usual forward pass.  Only networks of arma::mat can
+  // be quantized.
+  arma::mat input = arma::conv_to<arma::mat>::from(predictors);
+  arma::mat output;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    // The quantized layers don't run the forward pass of the original layers,
+    // so the width and height are passed on here as in Forward().
+    if (i > 0)
+    {
+      boost::apply_visitor(SetInputWidthVisitor(width), network[i]);
+      boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
+    }
+
+    size_t outputWidth, outputHeight;
+    if (!quantizedNetwork[i].IsEmpty())
+    {
+      quantizedNetwork[i].Forward(input, output);
+      outputWidth = quantizedNetwork[i].OutputWidth();
+      outputHeight = quantizedNetwork[i].OutputHeight();
+    }
+    else
+    {
+      boost::apply_visitor(ForwardVisitor(input, output), network[i]);
+      outputWidth = boost::apply_visitor(outputWidthVisitor, network[i]);
+      outputHeight = boost::apply_visitor(outputHeightVisitor, network[i]);
+    }
+
+    if (outputWidth != 0)
+      width = outputWidth;
+    if (outputHeight != 0)
+      height = outputHeight;
+
+    input = std::move(output);
+  }
+
+  results = arma::conv_to<MatType>::from(input);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Fuse()
+{
+  if (!std::is_same<MatType, arma::mat>::value)
+  {
+    Log::Fatal << "FFN::Fuse(): only networks of arma::mat can be fused!"
+        << std::endl;
+  }
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  // Dropout modules only copy their input in deterministic mode.
+  auto dropped = [this](const size_t i)
+  {
+    return boost::get<Dropout<>*>(&network[i]) != NULL ||
+        boost::get<AlphaDropout<>*>(&network[i]) != NULL;
+  };
+
+  quantizedNetwork.clear();
+  fusedModules.clear();
+  fusedNetwork.clear();
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (dropped(i))
+      continue;
+
+    FusedLayer layer;
+    if (Linear<>** linear = boost::get<Linear<>*>(&network[i]))
+      layer = FusedLayer(**linear);
+    else if (Convolution<>** conv = boost::get<Convolution<>*>(&network[i]))
+      layer = FusedLayer(**conv);
+
+    fusedModules.push_back(i);
+    if (!layer.IsEmpty())
+    {
+      // Fold a BatchNorm module that follows the layer, and then fuse an
+      // activation module that follows.
+      size_t next = i + 1;
+      while (next < network.size() && dropped(next))
+        ++next;
+
+      BatchNorm<>** batchNorm = (next < network.size()) ?
+          boost::get<BatchNorm<>*>(&network[next]) : NULL;
+      if (batchNorm && (*batchNorm)->InputSize() == layer.Units())
+      {
+        layer.Fold(**batchNorm);
+        i = next++;
+        while (next < network.size() && dropped(next))
+          ++next;
+      }
+
+      if (next < network.size())
+      {
+        if (boost::get<ReLULayer<>*>(&network[next]))
+        {
+          layer.Activation() = FusedLayer::RECTIFIER;
+          i = next;
+        }
+        else if (boost::get<SigmoidLayer<>*>(&network[next]))
+        {
+          layer.Activation() = FusedLayer::LOGISTIC;
+          i = next;
+        }
+        else if (boost::get<TanHLayer<>*>(&network[next]))
+        {
+          layer.Activation() = FusedLayer::TANH;
+          i = next;
+        }
+      }
+    }
+
+    fusedNetwork.push_back(std::move(layer));
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+FusedPredict(const MatType& predictors, MatType& results)
+{
+  // The fused layers work on the whole batch at once; the other modules are
+  // evaluated with their usual forward pass.  Only networks of arma::mat can
+  // be fused.
+  arma::mat input = arma::conv_to<arma::mat>::from(predictors);
+  arma::mat output;
+  for (size_t i = 0; i < fusedModules.size(); ++i)
+  {
+    if (!fusedNetwork[i].IsEmpty())
+    {
+      fusedNetwork[i].Forward(input, output);
+    }
+    else
+    {
+      boost::apply_visitor(ForwardVisitor(input, output),
+          network[fusedModules[i]]);
+    }
+
+    input = std::move(output);
+  }
+
+  results = arma::conv_to<MatType>::from(input);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
 template<typename PredictorsType, typename ResponsesType>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
+double FFNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Evaluate(
     const PredictorsType& predictors, const ResponsesType& responses)
 {
   if (parameter.is_empty())
@@ -275,9 +559,10 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
-    const arma::mat& parameters)
+         typename MatType, typename... CustomLayers>
+typename MatType::elem_type FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::Evaluate(
+    const MatType& parameters)
 {
   double res = 0;
   for (size_t i = 0; i < predictors.n_cols; ++i)
@@ -287,13 +572,16 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
-    const arma::mat& /* parameters */,
-    const size_t begin,
+         typename MatType, typename... CustomLayers>
+typename MatType::elem_type FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::Evaluate(
+    const MatType& /* parameters */,
+    const size_t batchBegin,
     const size_t batchSize,
     const bool deterministic)
 {
+  const size_t begin = LoadBatch(batchBegin, batchSize);
+
   if (parameter.is_empty())
     ResetParameters();
 
@@ -317,18 +605,20 @@ double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
-    const arma::mat& parameters, const size_t begin, const size_t batchSize)
+         typename MatType, typename... CustomLayers>
+typename MatType::elem_type FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::Evaluate(
+    const MatType& parameters, const size_t begin, const size_t batchSize)
 {
   return Evaluate(parameters, begin, batchSize, true);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename GradType>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
-EvaluateWithGradient(const arma::mat& parameters, GradType& gradient)
+typename MatType::elem_type
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
+EvaluateWithGradient(const MatType& parameters, GradType& gradient)
 {
   double res = 0;
   for (size_t i = 0; i < predictors.n_cols; ++i)
@@ -338,20 +628,23 @@ EvaluateWithGradient(const arma::mat& parameters, GradType& gradient)
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename GradType>
-double FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::
-EvaluateWithGradient(const arma::mat& /* parameters */,
-                     const size_t begin,
+typename MatType::elem_type
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
+EvaluateWithGradient(const MatType& /* parameters */,
+                     const size_t batchBegin,
                      GradType& gradient,
                      const size_t batchSize)
 {
+  const size_t begin = LoadBatch(batchBegin, batchSize);
+
   if (gradient.is_empty())
   {
     if (parameter.is_empty())
       ResetParameters();
 
-    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
   }
   else
   {
@@ -364,7 +657,27 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     ResetDeterministic();
   }
 
-  Forward(predictors.cols(begin, begin + batchSize - 1));
+  #ifdef HAS_OPENMP
+    const size_t maxThreads = (threads == 0) ?
+        (size_t) omp_get_max_threads() : threads;
+  #else
+    const size_t maxThreads = 1;
+  #endif
+  const size_t workers = std::min(maxThreads, batchSize);
+
+  // The layers that compute statistics over the batch must see all of it, so
+  // the batch is only split if there are none.
+  bool batchStatistics = false;
+  for (size_t i = 0; i < network.size() && !batchStatistics; ++i)
+  {
+    batchStatistics = boost::apply_visitor(BatchStatisticsCheckVisitor(),
+        network[i]);
+  }
+
+  if (workers > 1 && !batchStatistics)
+    return EvaluateWithGradientParallel(begin, gradient, batchSize, workers);
+
+  TrainingForward(predictors.cols(begin, begin + batchSize - 1));
   double res = outputLayer.Forward(
       boost::apply_visitor(outputParameterVisitor, network.back()),
       responses.cols(begin, begin + batchSize - 1));
@@ -379,38 +692,331 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       responses.cols(begin, begin + batchSize - 1),
       error);
 
-  Backward();
-  ResetGradients(gradient);
-  Gradient(predictors.cols(begin, begin + batchSize - 1));
+  TrainingBackward(predictors.cols(begin, begin + batchSize - 1), gradient);
 
   return res;
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Gradient(
-    const arma::mat& parameters,
+         typename MatType, typename... CustomLayers>
+typename MatType::elem_type
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
+EvaluateWithGradient(const MatType& /* parameters */,
+                     const size_t batchBegin,
+                     arma::SpMat<typename MatType::elem_type>& gradient,
+                     const size_t batchSize)
+{
+  const size_t begin = LoadBatch(batchBegin, batchSize);
+
+  if (parameter.is_empty())
+    ResetParameters();
+
+  // The layers only write the part of the gradient they use, so the dense
+  // gradient only has to be cleared when it is created.  The entries written
+  // by the layers other than Lookup do not depend on the batch, so they are
+  // collected at the same time.
+  if (arma::size(denseGradient) != arma::size(parameter))
+  {
+    denseGradient.zeros(arma::size(parameter));
+
+    std::vector<arma::uword> entries;
+    lookupOffsets.clear();
+    size_t offset = 0;
+    for (size_t i = 0; i < network.size(); ++i)
+    {
+      const size_t weights = boost::apply_visitor(weightSizeVisitor,
+          network[i]);
+      if (boost::get<Lookup<>*>(&network[i]))
+      {
+        lookupOffsets.push_back(std::make_pair(i, offset));
+      }
+      else
+      {
+        for (size_t j = 0; j < weights; ++j)
+          entries.push_back(offset + j);
+      }
+
+      offset += weights;
+    }
+
+    sparseEntries = arma::conv_to<arma::uvec>::from(entries);
+  }
+
+  if (this->deterministic)
+  {
+    this->deterministic = false;
+    ResetDeterministic();
+  }
+
+  TrainingForward(predictors.cols(begin, begin + batchSize - 1));
+  double res = outputLayer.Forward(
+      boost::apply_visitor(outputParameterVisitor, network.back()),
+      responses.cols(begin, begin + batchSize - 1));
+
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    res += boost::apply_visitor(lossVisitor, network[i]);
+  }
+
+  outputLayer.Backward(
+      boost::apply_visitor(outputParameterVisitor, network.back()),
+      responses.cols(begin, begin + batchSize - 1),
+      error);
+
+  TrainingBackward(predictors.cols(begin, begin + batchSize - 1),
+      denseGradient);
+
+  // Add the columns of the tokens of the batch of each Lookup layer to the
+  // entries of the other layers.
+  size_t lookupEntries = 0;
+  for (size_t i = 0; i < lookupOffsets.size(); ++i)
+  {
+    const Lookup<>* lookup = boost::get<Lookup<>*>(
+        network[lookupOffsets[i].first]);
+    lookupEntries += lookup->GradientColumns().n_elem *
+        lookup->EmbeddingSize();
+  }
+
+  arma::uvec rows(sparseEntries.n_elem + lookupEntries);
+  std::copy(sparseEntries.begin(), sparseEntries.end(), rows.begin());
+  size_t entry = sparseEntries.n_elem;
+  for (size_t i = 0; i < lookupOffsets.size(); ++i)
+  {
+    const Lookup<>* lookup = boost::get<Lookup<>*>(
+        network[lookupOffsets[i].first]);
+    const arma::uvec& columns = lookup->GradientColumns();
+    const size_t embeddingSize = lookup->EmbeddingSize();
+    for (size_t j = 0; j < columns.n_elem; ++j)
+    {
+      for (size_t k = 0; k < embeddingSize; ++k)
+      {
+        rows[entry++] = lookupOffsets[i].second + columns[j] * embeddingSize +
+            k;
+      }
+    }
+  }
+
+  // The written entries are kept even if they are zero, so that an update
+  // rule such as LazyAdamUpdate sees every entry the batch used.
+  arma::umat locations(2, rows.n_elem, arma::fill::zeros);
+  locations.row(0) = rows.t();
+  gradient = arma::SpMat<typename MatType::elem_type>(locations,
+      denseGradient.elem(rows), parameter.n_rows, parameter.n_cols, true,
+      false);
+
+  // Clear the written entries again, for the next batch.
+  denseGradient.elem(rows).zeros();
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+template<typename GradType>
+typename MatType::elem_type
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
+EvaluateWithGradientParallel(const size_t begin,
+                             GradType& gradient,
+                             const size_t batchSize,
+                             const size_t workers)
+{
+  if (replicas.size() != workers)
+    ResetReplicas(workers);
+
+  // Split the batch as evenly as possible across the workers.
+  std::vector<size_t> bounds(workers + 1);
+  for (size_t i = 0; i <= workers; ++i)
+    bounds[i] = begin + i * batchSize / workers;
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) workers; ++i)
+  {
+    FFNType& replica = *replicas[i];
+    if (replica.deterministic)
+    {
+      replica.deterministic = false;
+      replica.ResetDeterministic();
+    }
+
+    replica.recomputationTime = 0.0;
+    replica.TrainingForward(predictors.cols(bounds[i], bounds[i + 1] - 1));
+  }
+
+  // Gather the outputs of the workers, so that the output layer sees the whole
+  // batch.
+  MatType networkOutput;
+  for (size_t i = 0; i < workers; ++i)
+  {
+    const MatType& replicaOutput = boost::apply_visitor(
+        outputParameterVisitor, replicas[i]->network.back());
+    if (i == 0)
+      networkOutput.set_size(replicaOutput.n_rows, batchSize);
+
+    networkOutput.cols(bounds[i] - begin, bounds[i + 1] - begin - 1) =
+        replicaOutput;
+  }
+
+  // The layers with a Loss() are never trained on a split batch, so the output
+  // layer gives the whole objective.
+  const double res = outputLayer.Forward(networkOutput,
+      responses.cols(begin, begin + batchSize - 1));
+
+  outputLayer.Backward(networkOutput,
+      responses.cols(begin, begin + batchSize - 1), error);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) workers; ++i)
+  {
+    FFNType& replica = *replicas[i];
+    replica.error = error.cols(bounds[i] - begin, bounds[i + 1] - begin - 1);
+    replica.gradient.zeros(parameter.n_rows, parameter.n_cols);
+
+    replica.TrainingBackward(predictors.cols(bounds[i], bounds[i + 1] - 1),
+        replica.gradient);
+  }
+
+  // The workers hold their outputs at the same time.
+  activationMemory = 0;
+  for (size_t i = 0; i < workers; ++i)
+  {
+    activationMemory += replicas[i]->activationMemory;
+    recomputationTime += replicas[i]->recomputationTime;
+  }
+
+  // All-reduce the gradients of the workers into the gradient of the batch.
+  #pragma omp parallel for
+  for (omp_size_t j = 0; j < (omp_size_t) gradient.n_elem; ++j)
+  {
+    double sum = 0.0;
+    for (size_t i = 0; i < workers; ++i)
+      sum += replicas[i]->gradient[j];
+
+    gradient[j] = sum;
+  }
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+size_t FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+LoadBatch(const size_t begin, const size_t batchSize)
+{
+  if (loader == NULL)
+    return begin;
+
+  loader->Next(predictors, responses);
+  if (predictors.n_cols != batchSize)
+  {
+    Log::Fatal << "FFN::LoadBatch(): the loader returned a batch of "
+        << predictors.n_cols << " points, but " << batchSize << " points were "
+        << "requested; the batch size of the optimizer must be the same as the "
+        << "batch size of the loader!" << std::endl;
+  }
+
+  return 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+template<typename GradType, typename OptimizerType, typename... CallbackTypes>
+typename std::enable_if<std::is_same<GradType, MatType>::value, double>::type
+FFNType<OutputLayerType, InitializationRuleType, MatType,
+    CustomLayers...>::Optimize(
+    OptimizerType& optimizer, CallbackTypes&&... callbacks)
+{
+  return optimizer.Optimize(*this, parameter, callbacks...);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+template<typename GradType, typename OptimizerType, typename... CallbackTypes>
+typename std::enable_if<!std::is_same<GradType, MatType>::value, double>::type
+FFNType<OutputLayerType, InitializationRuleType, MatType,
+    CustomLayers...>::Optimize(
+    OptimizerType& optimizer, CallbackTypes&&... callbacks)
+{
+  return optimizer.template Optimize<FFNType, MatType, GradType>(*this,
+      parameter, callbacks...);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetReplicas(const size_t workers)
+{
+  for (size_t i = 0; i < replicas.size(); ++i)
+    delete replicas[i];
+  replicas.clear();
+
+  for (size_t i = 0; i < workers; ++i)
+  {
+    FFNType* replica = new FFNType(outputLayer, initializeRule);
+    replica->width = width;
+    replica->height = height;
+    replica->reset = reset;
+    replica->checkpoints = checkpoints;
+
+    // The layers of the replica use the parameters of this network, so they
+    // never need to be synchronized.
+    size_t offset = 0;
+    for (size_t j = 0; j < network.size(); ++j)
+    {
+      replica->network.push_back(boost::apply_visitor(copyVisitor,
+          network[j]));
+      offset += boost::apply_visitor(
+          WeightSetVisitorType<MatType>(parameter, offset),
+          replica->network[j]);
+      boost::apply_visitor(resetVisitor, replica->network[j]);
+    }
+
+    replica->ResetDeterministic();
+    replicas.push_back(replica);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Gradient(
+    const MatType& parameters,
     const size_t begin,
-    arma::mat& gradient,
+    MatType& gradient,
     const size_t batchSize)
 {
   this->EvaluateWithGradient(parameters, begin, gradient, batchSize);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Shuffle()
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Shuffle()
 {
+  // The loader shuffles the points of each epoch itself.
+  if (loader != NULL)
+    return;
+
   math::ShuffleData(predictors, responses, predictors, responses);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetParameters()
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetParameters()
 {
   ResetDeterministic();
 
+  // The quantized and fused layers and the replicas are no longer valid with
+  // the new parameters.
+  quantizedNetwork.clear();
+  fusedModules.clear();
+  fusedNetwork.clear();
+  ResetReplicas(0);
+
+  // The layout of the sparse gradient may change too.
+  denseGradient.reset();
+
   // Reset the network parameter with the given initialization rule.
   NetworkInitialization<InitializationRuleType,
                         CustomLayers...> networkInit(initializeRule);
@@ -418,9 +1024,9 @@ void FFN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetDeterministic()
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetDeterministic()
 {
   DeterministicSetVisitor deterministicSetVisitor(deterministic);
   std::for_each(network.begin(), network.end(),
@@ -428,25 +1034,25 @@ void FFN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetGradients(arma::mat& gradient)
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetGradients(MatType& gradient)
 {
   size_t offset = 0;
   for (size_t i = 0; i < network.size(); ++i)
   {
-    offset += boost::apply_visitor(GradientSetVisitor(gradient, offset),
-        network[i]);
+    offset += boost::apply_visitor(
+        GradientSetVisitorType<MatType>(gradient, offset), network[i]);
   }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename InputType>
-void FFN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::Forward(const InputType& input)
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::Forward(const InputType& input)
 {
-  boost::apply_visitor(ForwardVisitor(input,
+  boost::apply_visitor(ForwardVisitorType<MatType>(input,
       boost::apply_visitor(outputParameterVisitor, network.front())),
       network.front());
 
@@ -474,7 +1080,7 @@ void FFN<OutputLayerType, InitializationRuleType,
       boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
     }
 
-    boost::apply_visitor(ForwardVisitor(boost::apply_visitor(
+    boost::apply_visitor(ForwardVisitorType<MatType>(boost::apply_visitor(
         outputParameterVisitor, network[i - 1]),
         boost::apply_visitor(outputParameterVisitor, network[i])), network[i]);
 
@@ -499,16 +1105,218 @@ void FFN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward()
+         typename MatType, typename... CustomLayers>
+template<typename InputType>
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::TrainingForward(const InputType& input)
+{
+  if (checkpoints.empty() || !reset)
+  {
+    // The first pass also sets the input sizes of the modules, so it keeps
+    // every output.
+    Forward(input);
+
+    size_t size = 0;
+    for (size_t i = 0; i < network.size(); ++i)
+      size += boost::apply_visitor(outputParameterVisitor, network[i]).n_elem;
+    activationMemory = size * sizeof(typename MatType::elem_type);
+
+    if (!checkpoints.empty())
+    {
+      const std::vector<bool> kept = KeptOutputs();
+      for (size_t i = 0; i < network.size(); ++i)
+      {
+        if (!kept[i])
+          boost::apply_visitor(outputParameterVisitor, network[i]).reset();
+      }
+    }
+
+    return;
+  }
+
+  const std::vector<bool> kept = KeptOutputs();
+
+  boost::apply_visitor(ForwardVisitorType<MatType>(input,
+      boost::apply_visitor(outputParameterVisitor, network.front())),
+      network.front());
+
+  size_t size = boost::apply_visitor(outputParameterVisitor,
+      network.front()).n_elem;
+  size_t peak = size;
+  for (size_t i = 1; i < network.size(); ++i)
+  {
+    boost::apply_visitor(ForwardVisitorType<MatType>(boost::apply_visitor(
+        outputParameterVisitor, network[i - 1]),
+        boost::apply_visitor(outputParameterVisitor, network[i])), network[i]);
+
+    size += boost::apply_visitor(outputParameterVisitor, network[i]).n_elem;
+    peak = std::max(peak, size);
+
+    // The output of the previous module is not needed anymore.
+    if (!kept[i - 1])
+    {
+      MatType& output = boost::apply_visitor(outputParameterVisitor,
+          network[i - 1]);
+      size -= output.n_elem;
+      output.reset();
+    }
+  }
+
+  activationMemory = peak * sizeof(typename MatType::elem_type);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+template<typename InputType>
+void FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+TrainingBackward(const InputType& input, MatType& gradient)
+{
+  if (checkpoints.empty())
+  {
+    Backward();
+    ResetGradients(gradient);
+    Gradient(input);
+    return;
+  }
+
+  ResetGradients(gradient);
+
+  const std::vector<bool> kept = KeptOutputs();
+  size_t size = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+    size += boost::apply_visitor(outputParameterVisitor, network[i]).n_elem;
+  size_t peak = activationMemory / sizeof(typename MatType::elem_type);
+
+  // Each segment ends with a module whose output is kept, and starts after the
+  // previous one; the outputs of the other modules of the segment are
+  // recomputed from the output of the previous segment.
+  size_t last = network.size() - 1;
+  while (true)
+  {
+    size_t first = last;
+    while (first > 0 && !kept[first - 1])
+      --first;
+
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    for (size_t i = first; i < last; ++i)
+    {
+      if (i == 0)
+      {
+        boost::apply_visitor(ForwardVisitorType<MatType>(input,
+            boost::apply_visitor(outputParameterVisitor, network[i])),
+            network[i]);
+      }
+      else
+      {
+        boost::apply_visitor(ForwardVisitorType<MatType>(boost::apply_visitor(
+            outputParameterVisitor, network[i - 1]),
+            boost::apply_visitor(outputParameterVisitor, network[i])),
+            network[i]);
+      }
+
+      size += boost::apply_visitor(outputParameterVisitor, network[i]).n_elem;
+    }
+    recomputationTime += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    peak = std::max(peak, size);
+
+    // Run the backward pass and compute the gradient of the modules of the
+    // segment, in the same way as Backward() and Gradient().
+    for (size_t i = last + 1; i-- > first; )
+    {
+      if (i == network.size() - 1)
+      {
+        boost::apply_visitor(BackwardVisitorType<MatType>(boost::apply_visitor(
+            outputParameterVisitor, network[i]), error,
+            boost::apply_visitor(deltaVisitor, network[i])), network[i]);
+        boost::apply_visitor(GradientVisitorType<MatType>(boost::apply_visitor(
+            outputParameterVisitor, network[i - 1]), error), network[i]);
+        continue;
+      }
+
+      if (i > 0)
+      {
+        boost::apply_visitor(BackwardVisitorType<MatType>(boost::apply_visitor(
+            outputParameterVisitor, network[i]),
+            boost::apply_visitor(deltaVisitor, network[i + 1]),
+            boost::apply_visitor(deltaVisitor, network[i])), network[i]);
+        boost::apply_visitor(GradientVisitorType<MatType>(boost::apply_visitor(
+            outputParameterVisitor, network[i - 1]),
+            boost::apply_visitor(deltaVisitor, network[i + 1])), network[i]);
+      }
+      else
+      {
+        boost::apply_visitor(GradientVisitorType<MatType>(input,
+            boost::apply_visitor(deltaVisitor, network[1])), network[i]);
+      }
+
+      // The delta of the next module is not needed anymore.
+      boost::apply_visitor(deltaVisitor, network[i + 1]).reset();
+    }
+
+    // Free the recomputed outputs.
+    for (size_t i = first; i < last; ++i)
+    {
+      MatType& output = boost::apply_visitor(outputParameterVisitor,
+          network[i]);
+      size -= output.n_elem;
+      output.reset();
+    }
+
+    if (first == 0)
+      break;
+
+    last = first - 1;
+  }
+
+  activationMemory = peak * sizeof(typename MatType::elem_type);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+std::vector<bool> FFNType<OutputLayerType, InitializationRuleType,
+                      MatType, CustomLayers...>::KeptOutputs()
+{
+  std::vector<bool> kept(network.size(), false);
+  for (size_t i = 0; i < checkpoints.size(); ++i)
+  {
+    if (checkpoints[i] >= network.size())
+    {
+      Log::Fatal << "FFN::KeptOutputs(): checkpoint " << checkpoints[i]
+          << " is not the index of a module; the network has "
+          << network.size() << " modules!" << std::endl;
+    }
+
+    kept[checkpoints[i]] = true;
+  }
+
+  // The modules that behave differently during training, draw random samples
+  // or hold state must not run their forward pass twice; otherwise the
+  // gradient would not match the objective of the first pass.
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (boost::apply_visitor(ForwardStateCheckVisitor(), network[i]))
+      kept[i] = true;
+  }
+
+  kept.back() = true;
+  return kept;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
+  boost::apply_visitor(BackwardVisitorType<MatType>(boost::apply_visitor(
       outputParameterVisitor, network.back()), error,
       boost::apply_visitor(deltaVisitor, network.back())), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
+    boost::apply_visitor(BackwardVisitorType<MatType>(boost::apply_visitor(
         outputParameterVisitor, network[network.size() - i]),
         boost::apply_visitor(deltaVisitor, network[network.size() - i + 1]),
         boost::apply_visitor(deltaVisitor, network[network.size() - i])),
@@ -517,30 +1325,31 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward()
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename InputType>
-void FFN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::Gradient(const InputType& input)
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::Gradient(const InputType& input)
 {
-  boost::apply_visitor(GradientVisitor(input,
+  boost::apply_visitor(GradientVisitorType<MatType>(input,
       boost::apply_visitor(deltaVisitor, network[1])), network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(boost::apply_visitor(
+    boost::apply_visitor(GradientVisitorType<MatType>(boost::apply_visitor(
         outputParameterVisitor, network[i - 1]),
         boost::apply_visitor(deltaVisitor, network[i + 1])), network[i]);
   }
 
-  boost::apply_visitor(GradientVisitor(boost::apply_visitor(
+  boost::apply_visitor(GradientVisitorType<MatType>(boost::apply_visitor(
       outputParameterVisitor, network[network.size() - 2]), error),
       network[network.size() - 1]);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename Archive>
-void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
+void FFNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::serialize(
     Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(parameter);
@@ -550,7 +1359,7 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
   // Early versions used the currentInput member, which is now no longer needed.
   if (version < 2)
   {
-    arma::mat currentInput; // Temporary matrix to output.
+    MatType currentInput; // Temporary matrix to output.
     ar & BOOST_SERIALIZATION_NVP(currentInput);
   }
 
@@ -571,9 +1380,30 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
 
   ar & BOOST_SERIALIZATION_NVP(network);
 
+  // Earlier versions could not be quantized.
+  if (version > 2)
+    ar & BOOST_SERIALIZATION_NVP(quantizedNetwork);
+  else if (Archive::is_loading::value)
+    quantizedNetwork.clear();
+
+  // Earlier versions could not be fused.
+  if (version > 3)
+  {
+    ar & BOOST_SERIALIZATION_NVP(fusedModules);
+    ar & BOOST_SERIALIZATION_NVP(fusedNetwork);
+  }
+  else if (Archive::is_loading::value)
+  {
+    fusedModules.clear();
+    fusedNetwork.clear();
+  }
+
   // If we are loading, we need to initialize the weights.
   if (Archive::is_loading::value)
   {
+    ResetReplicas(0);
+    denseGradient.reset();
+
     // The behavior in earlier versions was to always assume the weights needed
     // to be reset.
     if (version == 0)
@@ -582,8 +1412,8 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
     size_t offset = 0;
     for (size_t i = 0; i < network.size(); ++i)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(parameter, offset),
-          network[i]);
+      offset += boost::apply_visitor(
+          WeightSetVisitorType<MatType>(parameter, offset), network[i]);
 
       boost::apply_visitor(resetVisitor, network[i]);
     }
@@ -594,9 +1424,9 @@ void FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void FFN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::Swap(FFN& network)
+         typename MatType, typename... CustomLayers>
+void FFNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::Swap(FFNType& network)
 {
   std::swap(outputLayer, network.outputLayer);
   std::swap(initializeRule, network.initializeRule);
@@ -604,6 +1434,9 @@ void FFN<OutputLayerType, InitializationRuleType,
   std::swap(height, network.height);
   std::swap(reset, network.reset);
   std::swap(this->network, network.network);
+  std::swap(quantizedNetwork, network.quantizedNetwork);
+  std::swap(fusedModules, network.fusedModules);
+  std::swap(fusedNetwork, network.fusedNetwork);
   std::swap(predictors, network.predictors);
   std::swap(responses, network.responses);
   std::swap(parameter, network.parameter);
@@ -614,17 +1447,30 @@ void FFN<OutputLayerType, InitializationRuleType,
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(denseGradient, network.denseGradient);
+  std::swap(sparseEntries, network.sparseEntries);
+  std::swap(lookupOffsets, network.lookupOffsets);
+  std::swap(threads, network.threads);
+  std::swap(replicas, network.replicas);
+  std::swap(loader, network.loader);
+  std::swap(checkpoints, network.checkpoints);
+  std::swap(activationMemory, network.activationMemory);
+  std::swap(recomputationTime, network.recomputationTime);
 };
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
-    const FFN& network):
+         typename MatType, typename... CustomLayers>
+FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::FFNType(
+    const FFNType& network):
     outputLayer(network.outputLayer),
     initializeRule(network.initializeRule),
     width(network.width),
     height(network.height),
     reset(network.reset),
+    quantizedNetwork(network.quantizedNetwork),
+    fusedModules(network.fusedModules),
+    fusedNetwork(network.fusedNetwork),
     predictors(network.predictors),
     responses(network.responses),
     parameter(network.parameter),
@@ -634,7 +1480,12 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    threads(network.threads),
+    loader(NULL),
+    checkpoints(network.checkpoints),
+    activationMemory(network.activationMemory),
+    recomputationTime(network.recomputationTime)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -645,14 +1496,18 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
 };
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
-    FFN&& network):
+         typename MatType, typename... CustomLayers>
+FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::FFNType(
+    FFNType&& network):
     outputLayer(std::move(network.outputLayer)),
     initializeRule(std::move(network.initializeRule)),
     width(network.width),
     height(network.height),
     reset(network.reset),
+    quantizedNetwork(std::move(network.quantizedNetwork)),
+    fusedModules(std::move(network.fusedModules)),
+    fusedNetwork(std::move(network.fusedNetwork)),
     predictors(std::move(network.predictors)),
     responses(std::move(network.responses)),
     parameter(std::move(network.parameter)),
@@ -662,16 +1517,23 @@ FFN<OutputLayerType, InitializationRuleType, CustomLayers...>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    threads(network.threads),
+    replicas(std::move(network.replicas)),
+    loader(network.loader),
+    checkpoints(std::move(network.checkpoints)),
+    activationMemory(network.activationMemory),
+    recomputationTime(network.recomputationTime)
 {
   this->network = std::move(network.network);
+  network.replicas.clear();
 };
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-FFN<OutputLayerType, InitializationRuleType, CustomLayers...>&
-FFN<OutputLayerType, InitializationRuleType,
-    CustomLayers...>::operator = (FFN network)
+         typename MatType, typename... CustomLayers>
+FFNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>&
+FFNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::operator = (FFNType network)
 {
   Swap(network);
   return *this;
@@ -0,0 +1,185 @@
+/**
+ * @file methods/ann/fusion/fused_layer.hpp
+ *
+ * Definition of the FusedLayer class, which evaluates a Linear or Convolution
+ * layer together with the BatchNorm and activation layers that follow it for
+ * inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_FUSION_FUSED_LAYER_HPP
+#define MLPACK_METHODS_ANN_FUSION_FUSED_LAYER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/layer/linear.hpp>
+#include <mlpack/methods/ann/layer/convolution.hpp>
+#include <mlpack/methods/ann/layer/batch_norm.hpp>
+#include <mlpack/methods/ann/activation_functions/identity_function.hpp>
+#include <mlpack/methods/ann/activation_functions/logistic_function.hpp>
+#include <mlpack/methods/ann/activation_functions/rectifier_function.hpp>
+#include <mlpack/methods/ann/activation_functions/tanh_function.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * The FusedLayer class holds a copy of the weights of a trained Linear or
+ * Convolution layer, into which the BatchNorm layer that follows it can be
+ * folded: in deterministic mode the normalization is an affine map of each
+ * output unit (or output map), so it can be applied to the weights and the
+ * bias once instead of to every output.  The bias and an optional activation
+ * (rectifier, logistic or tanh) are then applied to the result of the
+ * matrix product in a single pass, in place.
+ *
+ * The output is the same as the output of the original layers in
+ * deterministic mode, up to rounding.
+ */
+class FusedLayer
+{
+ public:
+  //! The activations that can be fused into the layer.
+  enum ActivationType
+  {
+    IDENTITY,
+    RECTIFIER,
+    LOGISTIC,
+    TANH
+  };
+
+  //! Create an empty FusedLayer object.
+  FusedLayer();
+
+  /**
+   * Create a fused layer from the given Linear layer.
+   *
+   * @param layer Linear layer to copy the weights of.
+   */
+  FusedLayer(const Linear<>& layer);
+
+  /**
+   * Create a fused layer from the given Convolution layer.  The input width
+   * and height of the layer must be known, i.e. the layer must have been used
+   * for a forward pass.
+   *
+   * @param layer Convolution layer to copy the weights of.
+   */
+  FusedLayer(const Convolution<>& layer);
+
+  /**
+   * Fold the given BatchNorm layer, which follows the layer, into the weights
+   * and the bias.  The running mean and variance of the BatchNorm layer are
+   * used, as in deterministic mode.  The BatchNorm layer must normalize the
+   * output units (or output maps) of the layer, and no activation may have
+   * been fused yet.
+   *
+   * @param layer BatchNorm layer to fold.
+   */
+  void Fold(const BatchNorm<>& layer);
+
+  /**
+   * Compute the output of the layer for the given input, one point per
+   * column.
+   *
+   * @param input Input data used for evaluating the layer.
+   * @param output Resulting output activation.
+   */
+  void Forward(const arma::mat& input, arma::mat& output) const;
+
+  //! Return whether the layer is empty, i.e. holds no weights.
+  bool IsEmpty() const { return weights.is_empty(); }
+
+  //! Get the number of input units of the layer.
+  size_t InputSize() const { return inputSize; }
+  //! Get the number of output units of the layer.
+  size_t OutputSize() const { return outputSize; }
+  //! Get the number of output units (or output maps) with their own bias.
+  size_t Units() const { return bias.n_elem; }
+
+  //! Get the activation applied to the output.
+  ActivationType Activation() const { return activation; }
+  //! Modify the activation applied to the output.
+  ActivationType& Activation() { return activation; }
+
+  /**
+   * Serialize the layer.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Add the bias and apply the given activation function to the output, in a
+   * single pass.
+   */
+  template<typename ActivationFunction>
+  void BiasActivation(arma::mat& output) const;
+
+  //! Compute the matrix product of a Linear layer.
+  void LinearForward(const arma::mat& input, arma::mat& output) const;
+
+  //! Compute the convolution of a Convolution layer, without the bias.
+  void ConvolutionForward(const arma::mat& input, arma::mat& output) const;
+
+  //! The number of input units.
+  size_t inputSize;
+
+  //! The number of output units.
+  size_t outputSize;
+
+  //! The weights; for a Linear layer the weight matrix, for a Convolution
+  //! layer one column with the kernels of each output map.
+  arma::mat weights;
+
+  //! The bias of each output unit (or output map).
+  arma::vec bias;
+
+  //! The activation applied to the output.
+  ActivationType activation;
+
+  //! Whether the layer is a convolution.
+  bool convolution;
+
+  //! The number of input maps of the convolution.
+  size_t inMaps;
+
+  //! The width of the input maps.
+  size_t inputWidth;
+
+  //! The height of the input maps.
+  size_t inputHeight;
+
+  //! The width of the output maps.
+  size_t outputWidth;
+
+  //! The height of the output maps.
+  size_t outputHeight;
+
+  //! The width of the kernel.
+  size_t kernelWidth;
+
+  //! The height of the kernel.
+  size_t kernelHeight;
+
+  //! The stride of the convolution in the x direction.
+  size_t strideWidth;
+
+  //! The stride of the convolution in the y direction.
+  size_t strideHeight;
+
+  //! The left padding of the input maps.
+  size_t padWLeft;
+
+  //! The top padding of the input maps.
+  size_t padHTop;
+}; // class FusedLayer
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "fused_layer_impl.hpp"
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ * @file methods/ann/fusion/fused_layer_impl.hpp
+ *
+ * Implementation of the FusedLayer class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_FUSION_FUSED_LAYER_IMPL_HPP
+#define MLPACK_METHODS_ANN_FUSION_FUSED_LAYER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "fused_layer.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline FusedLayer::FusedLayer() :
+    inputSize(0),
+    outputSize(0),
+    activation(IDENTITY),
+    convolution(false),
+    inMaps(0),
+    inputWidth(0),
+    inputHeight(0),
+    outputWidth(0),
+    outputHeight(0),
+    kernelWidth(0),
+    kernelHeight(0),
+    strideWidth(1),
+    strideHeight(1),
+    padWLeft(0),
+    padHTop(0)
+{
+  // Nothing to do here.
+}
+
+inline FusedLayer::FusedLayer(const Linear<>& layer) :
+    inputSize(layer.InputSize()),
+    outputSize(layer.OutputSize()),
+    weights(layer.Weight()),
+    bias(arma::vectorise(layer.Bias())),
+    activation(IDENTITY),
+    convolution(false),
+    inMaps(0),
+    inputWidth(0),
+    inputHeight(0),
+    outputWidth(0),
+    outputHeight(0),
+    kernelWidth(0),
+    kernelHeight(0),
+    strideWidth(1),
+    strideHeight(1),
+    padWLeft(0),
+    padHTop(0)
+{
+  // Nothing to do here.
+}
+
+inline FusedLayer::FusedLayer(const Convolution<>& layer) :
+    inputSize(layer.InputSize() * layer.InputWidth() * layer.InputHeight()),
+    outputSize(layer.OutputSize() * layer.OutputWidth() *
+        layer.OutputHeight()),
+    bias(arma::vectorise(layer.Bias())),
+    activation(IDENTITY),
+    convolution(true),
+    inMaps(layer.InputSize()),
+    inputWidth(layer.InputWidth()),
+    inputHeight(layer.InputHeight()),
+    outputWidth(layer.OutputWidth()),
+    outputHeight(layer.OutputHeight()),
+    kernelWidth(layer.KernelWidth()),
+    kernelHeight(layer.KernelHeight()),
+    strideWidth(layer.StrideWidth()),
+    strideHeight(layer.StrideHeight()),
+    padWLeft(layer.PadWLeft()),
+    padHTop(layer.PadHTop())
+{
+  if (inputSize == 0 || outputSize == 0)
+  {
+    throw std::invalid_argument("FusedLayer::FusedLayer(): the input and "
+        "output sizes of the convolution are not known; the layer must be "
+        "used for a forward pass first");
+  }
+
+  // The kernels of each output map are consecutive slices of the weight cube.
+  weights = arma::mat(layer.Weight().memptr(), inMaps * kernelWidth *
+      kernelHeight, layer.OutputSize());
+}
+
+inline void FusedLayer::Fold(const BatchNorm<>& layer)
+{
+  if (layer.InputSize() != bias.n_elem)
+  {
+    Log::Fatal << "FusedLayer::Fold(): the BatchNorm layer normalizes "
+        << layer.InputSize() << " units, but the layer has " << bias.n_elem
+        << "!" << std::endl;
+  }
+
+  if (activation != IDENTITY)
+  {
+    Log::Fatal << "FusedLayer::Fold(): cannot fold a BatchNorm layer after "
+        << "the activation!" << std::endl;
+  }
+
+  // The parameters of the BatchNorm layer are gamma followed by beta.
+  const size_t units = bias.n_elem;
+  const arma::vec gamma = layer.Parameters().rows(0, units - 1);
+  const arma::vec beta = layer.Parameters().rows(units, 2 * units - 1);
+  const arma::vec scale = gamma / arma::sqrt(layer.TrainingVariance() +
+      layer.Epsilon());
+
+  // The weights of each output unit are a row of the weight matrix, and the
+  // kernels of each output map a column.
+  if (convolution)
+    weights.each_row() %= scale.t();
+  else
+    weights.each_col() %= scale;
+
+  bias = (bias - arma::vectorise(layer.TrainingMean())) % scale + beta;
+}
+
+inline void FusedLayer::Forward(const arma::mat& input,
+                                arma::mat& output) const
+{
+  if (input.n_rows != inputSize)
+  {
+    Log::Fatal << "FusedLayer::Forward(): the input has " << input.n_rows
+        << " dimensions, but the layer expects " << inputSize << "!"
+        << std::endl;
+  }
+
+  if (convolution)
+    ConvolutionForward(input, output);
+  else
+    LinearForward(input, output);
+
+  switch (activation)
+  {
+    case RECTIFIER:
+      BiasActivation<RectifierFunction>(output);
+      break;
+    case LOGISTIC:
+      BiasActivation<LogisticFunction>(output);
+      break;
+    case TANH:
+      BiasActivation<TanhFunction>(output);
+      break;
+    default:
+      BiasActivation<IdentityFunction>(output);
+      break;
+  }
+}
+
+inline void FusedLayer::LinearForward(const arma::mat& input,
+                                      arma::mat& output) const
+{
+  output = weights * input;
+}
+
+inline void FusedLayer::ConvolutionForward(const arma::mat& input,
+                                           arma::mat& output) const
+{
+  const size_t patchSize = weights.n_rows;
+  const size_t inputMapSize = inputWidth * inputHeight;
+  const size_t outputMapSize = outputWidth * outputHeight;
+
+  output.set_size(outputSize, input.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t point = 0; point < (omp_size_t) input.n_cols; ++point)
+  {
+    const double* pointInput = input.colptr(point);
+
+    // Gather the input patch of each output position (i, j) into a column, in
+    // the same order as the kernel weights.  As in NaiveConvolution, the rows
+    // of the maps are the width and the columns the height, and the padding
+    // is zero.
+    arma::mat patches(patchSize, outputMapSize);
+    for (size_t j = 0; j < outputHeight; ++j)
+    {
+      for (size_t i = 0; i < outputWidth; ++i)
+      {
+        double* patch = patches.colptr(j * outputWidth + i);
+        for (size_t inMap = 0; inMap < inMaps; ++inMap)
+        {
+          const double* mapInput = pointInput + inMap * inputMapSize;
+          for (size_t kj = 0; kj < kernelHeight; ++kj)
+          {
+            const size_t col = j * strideHeight + kj;
+            for (size_t ki = 0; ki < kernelWidth; ++ki, ++patch)
+            {
+              const size_t row = i * strideWidth + ki;
+              if (row < padWLeft || row - padWLeft >= inputWidth ||
+                  col < padHTop || col - padHTop >= inputHeight)
+              {
+                *patch = 0.0;
+              }
+              else
+              {
+                *patch = mapInput[(col - padHTop) * inputWidth +
+                    (row - padWLeft)];
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // The output maps of the point are consecutive, so they are the columns of
+    // the product.
+    arma::mat pointOutput(output.colptr(point), outputMapSize, weights.n_cols,
+        false, true);
+    pointOutput = arma::trans(patches) * weights;
+  }
+}
+
+template<typename ActivationFunction>
+void FusedLayer::BiasActivation(arma::mat& output) const
+{
+  // The rows of each output unit (or output map) are consecutive.
+  const size_t unitSize = output.n_rows / bias.n_elem;
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) output.n_cols; ++i)
+  {
+    double* column = output.colptr(i);
+    for (size_t unit = 0; unit < bias.n_elem; ++unit)
+    {
+      const double unitBias = bias[unit];
+      for (size_t k = 0; k < unitSize; ++k, ++column)
+        *column = ActivationFunction::Fn(*column + unitBias);
+    }
+  }
+}
+
+template<typename Archive>
+void FusedLayer::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(inputSize);
+  ar & BOOST_SERIALIZATION_NVP(outputSize);
+  ar & BOOST_SERIALIZATION_NVP(weights);
+  ar & BOOST_SERIALIZATION_NVP(bias);
+  ar & BOOST_SERIALIZATION_NVP(activation);
+  ar & BOOST_SERIALIZATION_NVP(convolution);
+  ar & BOOST_SERIALIZATION_NVP(inMaps);
+  ar & BOOST_SERIALIZATION_NVP(inputWidth);
+  ar & BOOST_SERIALIZATION_NVP(inputHeight);
+  ar & BOOST_SERIALIZATION_NVP(outputWidth);
+  ar & BOOST_SERIALIZATION_NVP(outputHeight);
+  ar & BOOST_SERIALIZATION_NVP(kernelWidth);
+  ar & BOOST_SERIALIZATION_NVP(kernelHeight);
+  ar & BOOST_SERIALIZATION_NVP(strideWidth);
+  ar & BOOST_SERIALIZATION_NVP(strideHeight);
+  ar & BOOST_SERIALIZATION_NVP(padWLeft);
+  ar & BOOST_SERIALIZATION_NVP(padHTop);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
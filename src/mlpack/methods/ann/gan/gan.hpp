@@ -25,6 +25,23 @@
 namespace mlpack {
 namespace ann /** Artificial Neural Network. **/ {
 
+/**
+ * Check whether the given noise function fills a whole noise matrix at once,
+ * i.e. whether it can be called as void(arma::mat&).
+ */
+template<typename NoiseType>
+struct IsBatchNoise
+{
+  template<typename T>
+  static auto Check(int) -> decltype(
+      std::declval<T&>()(std::declval<arma::mat&>()), std::true_type());
+
+  template<typename T>
+  static std::false_type Check(...);
+
+  static const bool value = decltype(Check<NoiseType>(0))::value;
+};
+
 /**
  * The implementation of the standard GAN module. Generative Adversarial
  * Networks (GANs) are a class of artificial intelligence algorithms used
@@ -51,7 +68,8 @@ namespace ann /** Artificial Neural Network. **/ {
  *
  * @tparam Model The class type of Generator and Discriminator.
  * @tparam InitializationRuleType Type of Initializer.
- * @tparam Noise The noise function to use.
+ * @tparam Noise The noise function to use.  It either returns one sample of
+ *     the noise, or fills the given noise matrix (void(arma::mat&)).
  * @tparam PolicyType The GAN variant to be used (GAN, DCGAN, WGAN or WGANGP).
  */
 template<
@@ -70,7 +88,10 @@ class GAN
    * @param discriminator Discriminator network.
    * @param initializeRule Initialization rule to use for initializing
    *                       parameters.
-   * @param noiseFunction Function to be used for generating noise.
+   * @param noiseFunction Function to be used for generating noise.  A function
+   *     that returns one sample is called for each element of the noise; a
+   *     function taking an arma::mat& is called once per batch to fill the
+   *     whole noise matrix.
    * @param noiseDim Dimension of noise vector to be created.
    * @param batchSize Batch size to be used for training.
    * @param generatorUpdateStep Number of steps to train Discriminator
@@ -326,6 +347,24 @@ class GAN
   //! Modify the matrix of data points (predictors).
   arma::mat& Predictors() { return predictors; }
 
+  /**
+   * Get whether the real and the generated samples are evaluated in parallel
+   * during training (default false).  If enabled, the Discriminator is
+   * evaluated on the real samples while the Generator produces the fake
+   * samples, and the fake samples are evaluated at the same time by a second
+   * copy of the Discriminator layers, which shares the Discriminator
+   * parameters.  This has an effect only if mlpack was compiled with OpenMP.
+   * Layers that keep statistics of the training data, like BatchNorm, only
+   * update them on the real samples in this mode.  The random number
+   * generator of the thread that evaluates the fake samples (used e.g. by
+   * Dropout) is seeded from the random number generator of the calling
+   * thread at each step.
+   */
+  bool Parallel() const { return parallel; }
+  //! Modify whether the real and the generated samples are evaluated in
+  //! parallel during training.
+  bool& Parallel() { return parallel; }
+
   //! Serialize the model.
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
@@ -337,6 +376,44 @@ class GAN
   */
   void ResetDeterministic();
 
+  /**
+   * Evaluate the given Discriminator on the given samples and compute the
+   * gradient of its parameters.  The Discriminator keeps the state of this
+   * pass, so that the error can then be passed on to the Generator.
+   *
+   * @param model Discriminator to evaluate.
+   * @param input Samples to evaluate the Discriminator on.
+   * @param target Targets of the samples.
+   * @param gradient Matrix to store the gradient of the Discriminator into.
+   */
+  double EvaluateDiscriminator(Model& model,
+                               const arma::mat& input,
+                               const arma::mat& target,
+                               arma::mat& gradient);
+
+  /**
+   * Return the Discriminator used for the generated samples during training:
+   * the copy of the Discriminator layers if the samples are evaluated in
+   * parallel, and the Discriminator itself otherwise.
+   */
+  Model& FakeDiscriminator();
+
+  //! Fill the noise matrix using the noise function.
+  void GenerateNoise()
+  {
+    GenerateNoise(std::integral_constant<bool,
+        IsBatchNoise<Noise>::value>());
+  }
+
+  //! Fill the whole noise matrix with one call of the noise function.
+  void GenerateNoise(std::true_type) { noiseFunction(noise); }
+
+  //! Fill the noise matrix with one call of the noise function per element.
+  void GenerateNoise(std::false_type)
+  {
+    noise.imbue( [&]() { return noiseFunction();} );
+  }
+
   //! Locally stored parameter for training data + noise data.
   arma::mat predictors;
   //! Locally stored parameters of the network.
@@ -345,6 +422,12 @@ class GAN
   Model generator;
   //! Locally stored Discriminator network.
   Model discriminator;
+  //! Copy of the Discriminator layers used for the generated samples when
+  //! they are evaluated in parallel; the layers share the parameters of the
+  //! Discriminator.
+  Model fakeDiscriminator;
+  //! Whether the real and the generated samples are evaluated in parallel.
+  bool parallel;
   //! Locally stored Initializer.
   InitializationRuleType initializeRule;
   //! Locally stored Noise function
@@ -43,6 +43,7 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::GAN(
     const double lambda):
     generator(std::move(generator)),
     discriminator(std::move(discriminator)),
+    parallel(false),
     initializeRule(initializeRule),
     noiseFunction(noiseFunction),
     noiseDim(noiseDim),
@@ -77,6 +78,7 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::GAN(
     responses(network.responses),
     generator(network.generator),
     discriminator(network.discriminator),
+    parallel(network.parallel),
     initializeRule(network.initializeRule),
     noiseFunction(network.noiseFunction),
     noiseDim(network.noiseDim),
@@ -110,6 +112,7 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::GAN(
     responses(std::move(network.responses)),
     generator(std::move(network.generator)),
     discriminator(std::move(network.discriminator)),
+    parallel(network.parallel),
     initializeRule(std::move(network.initializeRule)),
     noiseFunction(std::move(network.noiseFunction)),
     noiseDim(network.noiseDim),
@@ -264,13 +267,12 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::Evaluate(
       outputParameterVisitor,
       discriminator.network.back()), currentTarget);
 
-  noise.imbue( [&]() { return noiseFunction();} );
+  GenerateNoise();
   generator.Forward(noise);
 
-  predictors.cols(numFunctions, numFunctions + batchSize - 1) =
-      boost::apply_visitor(outputParameterVisitor, generator.network.back());
-  discriminator.Forward(predictors.cols(numFunctions,
-      numFunctions + batchSize - 1));
+  // The generated samples are given to the Discriminator without a copy.
+  discriminator.Forward(boost::apply_visitor(outputParameterVisitor,
+      generator.network.back()));
   responses.cols(numFunctions, numFunctions + batchSize - 1) =
       arma::zeros(1, batchSize);
 
@@ -318,16 +320,6 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     ResetDeterministic();
   }
 
-  if (noiseGradientDiscriminator.is_empty())
-  {
-    noiseGradientDiscriminator = arma::zeros<arma::mat>(
-        gradientDiscriminator.n_elem, 1);
-  }
-  else
-  {
-    noiseGradientDiscriminator.zeros();
-  }
-
   gradientGenerator = arma::mat(gradient.memptr(),
       generator.Parameters().n_elem, 1, false, false);
 
@@ -335,20 +327,49 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       gradientGenerator.n_elem,
       discriminator.Parameters().n_elem, 1, false, false);
 
-  // Get the gradients of the Discriminator.
-  double res = discriminator.EvaluateWithGradient(discriminator.parameter,
-      i, gradientDiscriminator, batchSize);
+  noiseGradientDiscriminator.zeros(gradientDiscriminator.n_elem, 1);
 
-  noise.imbue( [&]() { return noiseFunction();} );
-  generator.Forward(noise);
-  predictors.cols(numFunctions, numFunctions + batchSize - 1) =
-      boost::apply_visitor(outputParameterVisitor, generator.network.back());
+  // The noise is generated before the evaluation, so that the noise function
+  // is only called from one thread.
+  GenerateNoise();
   responses.cols(numFunctions, numFunctions + batchSize - 1) =
       arma::zeros(1, batchSize);
 
-  // Get the gradients of the Generator.
-  res += discriminator.EvaluateWithGradient(discriminator.parameter,
-      numFunctions, noiseGradientDiscriminator, batchSize);
+  const arma::mat realInput(predictors.memptr() + (i * predictors.n_rows),
+      predictors.n_rows, batchSize, false, true);
+  const arma::mat realTarget(responses.memptr() + i, 1, batchSize, false,
+      true);
+  const arma::mat fakeTarget(responses.memptr() + numFunctions, 1, batchSize,
+      false, true);
+
+  // Get the gradients of the Discriminator on the real samples, while the
+  // Generator produces the fake samples; these are given to the Discriminator
+  // without a copy.
+  Model& fakeDiscriminator = FakeDiscriminator();
+  // The thread that evaluates the fake samples doesn't use the random number
+  // generator of this thread, so it is seeded from it.
+  const size_t fakeSeed = parallel ?
+      (size_t) arma::as_scalar(arma::randi<arma::uvec>(1)) : 0;
+  double res = 0.0;
+  #pragma omp parallel for reduction(+:res) if (parallel)
+  for (omp_size_t task = 0; task < 2; ++task)
+  {
+    if (task == 0)
+    {
+      res += EvaluateDiscriminator(discriminator, realInput, realTarget,
+          gradientDiscriminator);
+    }
+    else
+    {
+      if (parallel)
+        arma::arma_rng::set_seed(fakeSeed);
+
+      generator.Forward(noise);
+      res += EvaluateDiscriminator(fakeDiscriminator,
+          boost::apply_visitor(outputParameterVisitor,
+          generator.network.back()), fakeTarget, noiseGradientDiscriminator);
+    }
+  }
   gradientDiscriminator += noiseGradientDiscriminator;
 
   if (currentBatch % generatorUpdateStep == 0 && preTrainSize == 0)
@@ -358,19 +379,18 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     responses.cols(numFunctions, numFunctions + batchSize - 1) =
         arma::ones(1, batchSize);
 
-    discriminator.outputLayer.Backward(
+    fakeDiscriminator.outputLayer.Backward(
         boost::apply_visitor(outputParameterVisitor,
-        discriminator.network.back()), discriminator.responses.cols(
-        numFunctions, numFunctions + batchSize - 1), discriminator.error);
-    discriminator.Backward();
+        fakeDiscriminator.network.back()), fakeTarget,
+        fakeDiscriminator.error);
+    fakeDiscriminator.Backward();
 
     generator.error = boost::apply_visitor(deltaVisitor,
-        discriminator.network[1]);
+        fakeDiscriminator.network[1]);
 
-    generator.Predictors() = noise;
     generator.Backward();
     generator.ResetGradients(gradientGenerator);
-    generator.Gradient(generator.Predictors().cols(0, batchSize - 1));
+    generator.Gradient(noise);
 
     gradientGenerator *= multiplier;
   }
@@ -404,6 +424,84 @@ Gradient(const arma::mat& parameters,
   this->EvaluateWithGradient(parameters, i, gradient, batchSize);
 }
 
+template<
+  typename Model,
+  typename InitializationRuleType,
+  typename Noise,
+  typename PolicyType
+>
+double GAN<Model, InitializationRuleType, Noise, PolicyType>::
+EvaluateDiscriminator(Model& model,
+                      const arma::mat& input,
+                      const arma::mat& target,
+                      arma::mat& gradient)
+{
+  model.Forward(input);
+  double res = model.outputLayer.Forward(
+      boost::apply_visitor(outputParameterVisitor, model.network.back()),
+      target);
+
+  for (size_t i = 0; i < model.network.size(); ++i)
+    res += boost::apply_visitor(model.lossVisitor, model.network[i]);
+
+  model.outputLayer.Backward(
+      boost::apply_visitor(outputParameterVisitor, model.network.back()),
+      target, model.error);
+  model.Backward();
+  model.ResetGradients(gradient);
+  model.Gradient(input);
+
+  return res;
+}
+
+template<
+  typename Model,
+  typename InitializationRuleType,
+  typename Noise,
+  typename PolicyType
+>
+Model& GAN<Model, InitializationRuleType, Noise, PolicyType>::
+FakeDiscriminator()
+{
+  if (!parallel)
+    return discriminator;
+
+  // The copy is made again when the parameters of the Discriminator have
+  // been reallocated, e.g. by Reset() or by loading the model.
+  if (fakeDiscriminator.network.size() == discriminator.network.size() &&
+      fakeDiscriminator.parameter.memptr() == discriminator.parameter.memptr())
+  {
+    return fakeDiscriminator;
+  }
+
+  std::for_each(fakeDiscriminator.network.begin(),
+      fakeDiscriminator.network.end(),
+      boost::apply_visitor(fakeDiscriminator.deleteVisitor));
+  fakeDiscriminator.network.clear();
+
+  fakeDiscriminator.outputLayer = discriminator.outputLayer;
+  fakeDiscriminator.width = discriminator.width;
+  fakeDiscriminator.height = discriminator.height;
+  fakeDiscriminator.reset = discriminator.reset;
+  fakeDiscriminator.parameter = arma::mat(discriminator.parameter.memptr(),
+      discriminator.parameter.n_elem, 1, false, false);
+
+  size_t offset = 0;
+  for (size_t i = 0; i < discriminator.network.size(); ++i)
+  {
+    fakeDiscriminator.network.push_back(boost::apply_visitor(
+        discriminator.copyVisitor, discriminator.network[i]));
+    offset += boost::apply_visitor(WeightSetVisitor(discriminator.parameter,
+        offset), fakeDiscriminator.network[i]);
+    boost::apply_visitor(resetVisitor, fakeDiscriminator.network[i]);
+  }
+
+  fakeDiscriminator.deterministic = deterministic;
+  fakeDiscriminator.ResetDeterministic();
+
+  return fakeDiscriminator;
+}
+
 template<
   typename Model,
   typename InitializationRuleType,
@@ -475,8 +573,10 @@ ResetDeterministic()
 {
   this->discriminator.deterministic = deterministic;
   this->generator.deterministic = deterministic;
+  this->fakeDiscriminator.deterministic = deterministic;
   this->discriminator.ResetDeterministic();
   this->generator.ResetDeterministic();
+  this->fakeDiscriminator.ResetDeterministic();
 }
 
 template<
@@ -56,13 +56,12 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::Evaluate(
       outputParameterVisitor,
       discriminator.network.back()), currentTarget);
 
-  noise.imbue( [&]() { return noiseFunction();} );
+  GenerateNoise();
   generator.Forward(noise);
 
-  predictors.cols(numFunctions, numFunctions + batchSize - 1) =
-      boost::apply_visitor(outputParameterVisitor, generator.network.back());
-  discriminator.Forward(predictors.cols(numFunctions,
-      numFunctions + batchSize - 1));
+  // The generated samples are given to the Discriminator without a copy.
+  discriminator.Forward(boost::apply_visitor(outputParameterVisitor,
+      generator.network.back()));
   responses.cols(numFunctions, numFunctions + batchSize - 1) =
       -arma::ones(1, batchSize);
 
@@ -110,16 +109,6 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     ResetDeterministic();
   }
 
-  if (noiseGradientDiscriminator.is_empty())
-  {
-    noiseGradientDiscriminator = arma::zeros<arma::mat>(
-        gradientDiscriminator.n_elem, 1);
-  }
-  else
-  {
-    noiseGradientDiscriminator.zeros();
-  }
-
   gradientGenerator = arma::mat(gradient.memptr(),
       generator.Parameters().n_elem, 1, false, false);
 
@@ -127,20 +116,49 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       gradientGenerator.n_elem,
       discriminator.Parameters().n_elem, 1, false, false);
 
-  // Get the gradients of the Discriminator.
-  double res = discriminator.EvaluateWithGradient(discriminator.parameter,
-      i, gradientDiscriminator, batchSize);
+  noiseGradientDiscriminator.zeros(gradientDiscriminator.n_elem, 1);
 
-  noise.imbue( [&]() { return noiseFunction();} );
-  generator.Forward(noise);
-  predictors.cols(numFunctions, numFunctions + batchSize - 1) =
-      boost::apply_visitor(outputParameterVisitor, generator.network.back());
+  // The noise is generated before the evaluation, so that the noise function
+  // is only called from one thread.
+  GenerateNoise();
   responses.cols(numFunctions, numFunctions + batchSize - 1) =
       -arma::ones(1, batchSize);
 
-  // Get the gradients of the Generator.
-  res += discriminator.EvaluateWithGradient(discriminator.parameter,
-      numFunctions, noiseGradientDiscriminator, batchSize);
+  const arma::mat realInput(predictors.memptr() + (i * predictors.n_rows),
+      predictors.n_rows, batchSize, false, true);
+  const arma::mat realTarget(responses.memptr() + i, 1, batchSize, false,
+      true);
+  const arma::mat fakeTarget(responses.memptr() + numFunctions, 1, batchSize,
+      false, true);
+
+  // Get the gradients of the Discriminator on the real samples, while the
+  // Generator produces the fake samples; these are given to the Discriminator
+  // without a copy.
+  Model& fakeDiscriminator = FakeDiscriminator();
+  // The thread that evaluates the fake samples doesn't use the random number
+  // generator of this thread, so it is seeded from it.
+  const size_t fakeSeed = parallel ?
+      (size_t) arma::as_scalar(arma::randi<arma::uvec>(1)) : 0;
+  double res = 0.0;
+  #pragma omp parallel for reduction(+:res) if (parallel)
+  for (omp_size_t task = 0; task < 2; ++task)
+  {
+    if (task == 0)
+    {
+      res += EvaluateDiscriminator(discriminator, realInput, realTarget,
+          gradientDiscriminator);
+    }
+    else
+    {
+      if (parallel)
+        arma::arma_rng::set_seed(fakeSeed);
+
+      generator.Forward(noise);
+      res += EvaluateDiscriminator(fakeDiscriminator,
+          boost::apply_visitor(outputParameterVisitor,
+          generator.network.back()), fakeTarget, noiseGradientDiscriminator);
+    }
+  }
   gradientDiscriminator += noiseGradientDiscriminator;
   gradientDiscriminator = arma::clamp(gradientDiscriminator,
       -clippingParameter, clippingParameter);
@@ -152,19 +170,18 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     responses.cols(numFunctions, numFunctions + batchSize - 1) =
         arma::ones(1, batchSize);
 
-    discriminator.outputLayer.Backward(
+    fakeDiscriminator.outputLayer.Backward(
         boost::apply_visitor(outputParameterVisitor,
-        discriminator.network.back()), discriminator.responses.cols(
-        numFunctions, numFunctions + batchSize - 1), discriminator.error);
-    discriminator.Backward();
+        fakeDiscriminator.network.back()), fakeTarget,
+        fakeDiscriminator.error);
+    fakeDiscriminator.Backward();
 
     generator.error = boost::apply_visitor(deltaVisitor,
-        discriminator.network[1]);
+        fakeDiscriminator.network[1]);
 
-    generator.Predictors() = noise;
     generator.Backward();
     generator.ResetGradients(gradientGenerator);
-    generator.Gradient(generator.Predictors().cols(0, batchSize - 1));
+    generator.Gradient(noise);
 
     gradientGenerator *= multiplier;
   }
@@ -57,15 +57,13 @@ GAN<Model, InitializationRuleType, Noise, PolicyType>::Evaluate(
       outputParameterVisitor,
       discriminator.network.back())), std::move(currentTarget));
 
-  noise.imbue( [&]() { return noiseFunction();} );
-  generator.Forward(std::move(noise));
+  GenerateNoise();
+  generator.Forward(noise);
 
-  arma::mat generatedData = boost::apply_visitor(outputParameterVisitor,
+  // The generated samples are given to the Discriminator without a copy.
+  const arma::mat& generatedData = boost::apply_visitor(outputParameterVisitor,
       generator.network.back());
-  predictors.cols(numFunctions, numFunctions + batchSize - 1) =
-      generatedData;
-  discriminator.Forward(std::move(predictors.cols(numFunctions,
-      numFunctions + batchSize - 1)));
+  discriminator.Forward(generatedData);
   responses.cols(numFunctions, numFunctions + batchSize - 1) =
       -arma::ones(1, batchSize);
 
@@ -124,16 +122,6 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     ResetDeterministic();
   }
 
-  if (noiseGradientDiscriminator.is_empty())
-  {
-    noiseGradientDiscriminator = arma::zeros<arma::mat>(
-        gradientDiscriminator.n_elem, 1);
-  }
-  else
-  {
-    noiseGradientDiscriminator.zeros();
-  }
-
   gradientGenerator = arma::mat(gradient.memptr(),
       generator.Parameters().n_elem, 1, false, false);
 
@@ -141,16 +129,14 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       gradientGenerator.n_elem,
       discriminator.Parameters().n_elem, 1, false, false);
 
+  noiseGradientDiscriminator.zeros(gradientDiscriminator.n_elem, 1);
+
   currentInput = arma::mat(predictors.memptr() + (i * predictors.n_rows),
       predictors.n_rows, batchSize, false, false);
 
-  // Get the gradients of the Discriminator.
-  double res = discriminator.EvaluateWithGradient(discriminator.parameter,
-      i, gradientDiscriminator, batchSize);
-
-  noise.imbue( [&]() { return noiseFunction();} );
-  generator.Forward(std::move(noise));
-  arma::mat generatedData = boost::apply_visitor(outputParameterVisitor,
+  GenerateNoise();
+  generator.Forward(noise);
+  const arma::mat& generatedData = boost::apply_visitor(outputParameterVisitor,
       generator.network.back());
 
   // Gradient Penalty is calculated here.
@@ -161,12 +147,38 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       -arma::ones(1, batchSize);
   discriminator.Gradient(discriminator.parameter, numFunctions,
       normGradientDiscriminator, batchSize);
-  res += lambda * std::pow(arma::norm(normGradientDiscriminator, 2) - 1, 2);
-
-  predictors.cols(numFunctions, numFunctions + batchSize - 1) =
-      generatedData;
-  res += discriminator.EvaluateWithGradient(discriminator.parameter,
-      numFunctions, noiseGradientDiscriminator, batchSize);
+  double res = lambda * std::pow(arma::norm(normGradientDiscriminator, 2) - 1,
+      2);
+
+  const arma::mat realTarget(responses.memptr() + i, 1, batchSize, false,
+      true);
+  const arma::mat fakeTarget(responses.memptr() + numFunctions, 1, batchSize,
+      false, true);
+
+  // Get the gradients of the Discriminator on the real and the fake samples;
+  // the fake samples are given to the Discriminator without a copy.
+  Model& fakeDiscriminator = FakeDiscriminator();
+  // The thread that evaluates the fake samples doesn't use the random number
+  // generator of this thread, so it is seeded from it.
+  const size_t fakeSeed = parallel ?
+      (size_t) arma::as_scalar(arma::randi<arma::uvec>(1)) : 0;
+  #pragma omp parallel for reduction(+:res) if (parallel)
+  for (omp_size_t task = 0; task < 2; ++task)
+  {
+    if (task == 0)
+    {
+      res += EvaluateDiscriminator(discriminator, currentInput, realTarget,
+          gradientDiscriminator);
+    }
+    else
+    {
+      if (parallel)
+        arma::arma_rng::set_seed(fakeSeed);
+
+      res += EvaluateDiscriminator(fakeDiscriminator, generatedData,
+          fakeTarget, noiseGradientDiscriminator);
+    }
+  }
   gradientDiscriminator += noiseGradientDiscriminator;
 
   if (currentBatch % generatorUpdateStep == 0 && preTrainSize == 0)
@@ -176,19 +188,18 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     responses.cols(numFunctions, numFunctions + batchSize - 1) =
         arma::ones(1, batchSize);
 
-    discriminator.outputLayer.Backward(
+    fakeDiscriminator.outputLayer.Backward(
         boost::apply_visitor(outputParameterVisitor,
-        discriminator.network.back()), discriminator.responses.cols(
-        numFunctions, numFunctions + batchSize - 1), discriminator.error);
-    discriminator.Backward();
+        fakeDiscriminator.network.back()), fakeTarget,
+        fakeDiscriminator.error);
+    fakeDiscriminator.Backward();
 
     generator.error = boost::apply_visitor(deltaVisitor,
-        discriminator.network[1]);
+        fakeDiscriminator.network[1]);
 
-    generator.Predictors() = noise;
     generator.Backward();
     generator.ResetGradients(gradientGenerator);
-    generator.Gradient(generator.Predictors().cols(0, batchSize - 1));
+    generator.Gradient(noise);
 
     gradientGenerator *= multiplier;
   }
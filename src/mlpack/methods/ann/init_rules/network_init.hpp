@@ -75,7 +75,7 @@ class NetworkInitialization
         // initialization rule.
         const size_t weight = boost::apply_visitor(weightSizeVisitor,
             network[i]);
-        arma::Mat<eT> tmp = arma::mat(parameter.memptr() + offset,
+        arma::Mat<eT> tmp = arma::Mat<eT>(parameter.memptr() + offset,
             weight, 1, false, false);
         initializeRule.Initialize(tmp, tmp.n_elem, 1);
 
@@ -94,8 +94,8 @@ class NetworkInitialization
     // hold various other modules.
     for (size_t i = 0, offset = parameterOffset; i < network.size(); ++i)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(parameter, offset),
-          network[i]);
+      offset += boost::apply_visitor(WeightSetVisitorType<arma::Mat<eT> >(
+          parameter, offset), network[i]);
 
       boost::apply_visitor(resetVisitor, network[i]);
     }
@@ -48,6 +48,11 @@ template <
 class Convolution
 {
  public:
+  //! Convenience typedefs.
+  typedef typename OutputDataType::elem_type ElemType;
+  typedef arma::Mat<ElemType> MatType;
+  typedef arma::Cube<ElemType> CubeType;
+
   //! Create the Convolution object.
   Convolution();
 
@@ -158,14 +163,14 @@ class Convolution
   OutputDataType& Parameters() { return weights; }
 
   //! Get the weight of the layer.
-  arma::cube const& Weight() const { return weight; }
+  CubeType const& Weight() const { return weight; }
   //! Modify the weight of the layer.
-  arma::cube& Weight() { return weight; }
+  CubeType& Weight() { return weight; }
 
   //! Get the bias of the layer.
-  arma::mat const& Bias() const { return bias; }
+  MatType const& Bias() const { return bias; }
   //! Modify the bias of the layer.
-  arma::mat& Bias() { return bias; }
+  MatType& Bias() { return bias; }
 
   //! Get the input parameter.
   InputDataType const& InputParameter() const { return inputParameter; }
@@ -350,10 +355,10 @@ class Convolution
   OutputDataType weights;
 
   //! Locally-stored weight object.
-  arma::cube weight;
+  CubeType weight;
 
   //! Locally-stored bias term object.
-  arma::mat bias;
+  MatType bias;
 
   //! Locally-stored input width.
   size_t inputWidth;
@@ -368,16 +373,16 @@ class Convolution
   size_t outputHeight;
 
   //! Locally-stored transformed output parameter.
-  arma::cube outputTemp;
+  CubeType outputTemp;
 
   //! Locally-stored transformed padded input parameter.
-  arma::cube inputPaddedTemp;
+  CubeType inputPaddedTemp;
 
   //! Locally-stored transformed error parameter.
-  arma::cube gTemp;
+  CubeType gTemp;
 
   //! Locally-stored transformed gradient parameter.
-  arma::cube gradientTemp;
+  CubeType gradientTemp;
 
   //! Locally-stored padding layer.
   ann::Padding<> padding;
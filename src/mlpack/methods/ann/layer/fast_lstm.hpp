@@ -138,6 +138,12 @@ class FastLSTM
   //! Modify the maximum number of steps to backpropagate through time (BPTT).
   size_t& Rho() { return rho; }
 
+  //! Get whether the state is kept after rho steps.
+  bool Stateful() const { return stateful; }
+  //! Modify whether the state is kept after rho steps.  If false, the layer
+  //! starts again from the zero state every rho steps.
+  bool& Stateful() { return stateful; }
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
@@ -301,6 +307,15 @@ class FastLSTM
 
   //! Current backpropagate through time steps.
   size_t bpttSteps;
+
+  //! Locally-stored cell state the first step continues from.
+  OutputDataType prevCell;
+
+  //! Whether the state is kept after rho steps.
+  bool stateful;
+
+  //! Whether the next step continues from the state of the last step.
+  bool carryState;
 }; // class FastLSTM
 
 } // namespace ann
@@ -20,7 +20,9 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename InputDataType, typename OutputDataType>
-FastLSTM<InputDataType, OutputDataType>::FastLSTM()
+FastLSTM<InputDataType, OutputDataType>::FastLSTM() :
+    stateful(false),
+    carryState(false)
 {
   // Nothing to do here.
 }
@@ -38,7 +40,9 @@ FastLSTM<InputDataType, OutputDataType>::FastLSTM(
     batchStep(0),
     gradientStepIdx(0),
     rhoSize(rho),
-    bpttSteps(0)
+    bpttSteps(0),
+    stateful(false),
+    carryState(false)
 {
   // Weights for: input to gate layer (4 * outsize * inSize + 4 * outsize)
   // and output to gate (4 * outSize).
@@ -107,6 +111,11 @@ void FastLSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
       outParameter.resize(outSize, (size + 1) * batchSize);
     }
   }
+
+  // Start from the zero state.
+  outParameter.cols(0, batchSize - 1).zeros();
+  prevCell.zeros(outSize, batchSize);
+  carryState = false;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -123,6 +132,17 @@ void FastLSTM<InputDataType, OutputDataType>::Forward(
     ResetCell(rhoSize);
   }
 
+  // Continue from the output and the cell state of the last step.  They are
+  // only copied now, because the backward pass still needs the old ones.
+  if (forwardStep == 0 && carryState)
+  {
+    outParameter.cols(0, batchStep) = outParameter.cols(
+        bpttSteps * batchSize, bpttSteps * batchSize + batchStep);
+    prevCell = cell.cols((bpttSteps - 1) * batchSize,
+        (bpttSteps - 1) * batchSize + batchStep);
+    carryState = false;
+  }
+
   gate.cols(forwardStep, forwardStep + batchStep) = input2GateWeight * input +
       output2GateWeight * outParameter.cols(
       forwardStep, forwardStep + batchStep);
@@ -147,6 +167,13 @@ void FastLSTM<InputDataType, OutputDataType>::Forward(
         gateActivation.submat(0, forwardStep, outSize - 1,
         forwardStep + batchStep) %
         stateActivation.cols(forwardStep, forwardStep + batchStep);
+
+    if (stateful)
+    {
+      cell.cols(forwardStep, forwardStep + batchStep) +=
+          gateActivation.submat(2 * outSize, forwardStep, 3 * outSize - 1,
+          forwardStep + batchStep) % prevCell;
+    }
   }
   else
   {
@@ -174,6 +201,7 @@ void FastLSTM<InputDataType, OutputDataType>::Forward(
   if ((forwardStep / batchSize) == bpttSteps)
   {
     forwardStep = 0;
+    carryState = stateful;
   }
 }
 
@@ -182,6 +210,14 @@ template<typename InputType, typename ErrorType, typename GradientType>
 void FastLSTM<InputDataType, OutputDataType>::Backward(
   const InputType& /* input */, const ErrorType& gy, GradientType& g)
 {
+  // Start at the last step of the forward pass, which may have been shorter
+  // than rho.
+  if (gradientStepIdx == 0)
+  {
+    backwardStep = (forwardStep == 0 ? bpttSteps * batchSize : forwardStep) - 1;
+    gradientStep = backwardStep;
+  }
+
   ErrorType gyLocal;
   if (gradientStepIdx > 0)
   {
@@ -214,6 +250,13 @@ void FastLSTM<InputDataType, OutputDataType>::Backward(
         3 * outSize - 1, backwardStep) % (1.0 - gateActivation.submat(
         2 * outSize, backwardStep - batchStep, 3 * outSize - 1, backwardStep));
   }
+  else if (stateful)
+  {
+    prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchStep) =
+        prevCell % cellActivationError % gateActivation.submat(2 * outSize,
+        0, 3 * outSize - 1, batchStep) % (1.0 - gateActivation.submat(
+        2 * outSize, 0, 3 * outSize - 1, batchStep));
+  }
   else
   {
     prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchStep).zeros();
@@ -26,7 +26,6 @@
 #ifndef MLPACK_METHODS_ANN_LAYER_GRU_HPP
 #define MLPACK_METHODS_ANN_LAYER_GRU_HPP
 
-#include <list>
 #include <limits>
 
 #include <mlpack/prereqs.hpp>
@@ -126,6 +125,12 @@ class GRU
   //! Modify the maximum number of steps to backpropagate through time (BPTT).
   size_t& Rho() { return rho; }
 
+  //! Get whether the state is kept after rho steps.
+  bool Stateful() const { return stateful; }
+  //! Modify whether the state is kept after rho steps.  If false, the layer
+  //! starts again from the zero state every rho steps.
+  bool& Stateful() { return stateful; }
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
@@ -216,24 +221,28 @@ class GRU
   //! Locally-stored number of gradient steps.
   size_t gradientStep;
 
-  //! Locally-stored output parameters.
-  std::list<arma::mat> outParameter;
+  //! Locally-stored output parameters, one block of batchSize columns per
+  //! step.  The memory is kept from one sequence to the next.
+  OutputDataType outParameter;
 
-  //! Matrix of all zeroes to initialize the output
-  arma::mat allZeros;
+  //! The number of outputs stored in outParameter.
+  size_t numOutputs;
 
-  //! Iterator pointed to the last output produced by the cell
-  std::list<arma::mat>::iterator prevOutput;
+  //! Index of the last output produced by the cell.
+  size_t prevOutput;
 
-  //! Iterator pointed to the last output processed by backward
-  std::list<arma::mat>::iterator backIterator;
+  //! Index of the last output processed by backward, or NoOutput.
+  size_t backIterator;
 
-  //! Iterator pointed to the last output processed by gradient
-  std::list<arma::mat>::iterator gradIterator;
+  //! Index of the last output processed by gradient, or NoOutput.
+  size_t gradIterator;
 
   //! Locally-stored previous error.
   arma::mat prevError;
 
+  //! Buffers of the forward and backward passes, reused by every step.
+  arma::mat modInput, outputH, gyLocal, dZt, dOt, dRt, prevGateError;
+
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
 
@@ -245,6 +254,32 @@ class GRU
 
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
+
+  //! Current backpropagate through time steps.
+  size_t bpttSteps;
+
+  //! Whether the state is kept after rho steps.
+  bool stateful;
+
+  //! Whether the outputs before the last one can be dropped.
+  bool carryState;
+
+  //! Value of backIterator and gradIterator before the backward pass starts.
+  static const size_t NoOutput = std::numeric_limits<size_t>::max();
+
+  //! Get the stored output with the given index.
+  arma::subview<typename OutputDataType::elem_type> StoredOutput(
+      const size_t index)
+  {
+    return outParameter.cols(index * batchSize, (index + 1) * batchSize - 1);
+  }
+
+  //! Add a block for a new output at the end of the stored outputs, and
+  //! return its index.
+  size_t NewOutput();
+
+  //! Set the batch size, and start again from the zero state.
+  void SetBatchSize(const size_t size);
 }; // class GRU
 
 } // namespace ann
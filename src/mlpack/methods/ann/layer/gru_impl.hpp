@@ -24,7 +24,13 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename InputDataType, typename OutputDataType>
-GRU<InputDataType, OutputDataType>::GRU()
+GRU<InputDataType, OutputDataType>::GRU() :
+    numOutputs(0),
+    prevOutput(0),
+    backIterator(NoOutput),
+    gradIterator(NoOutput),
+    stateful(false),
+    carryState(false)
 {
   // Nothing to do here.
 }
@@ -41,7 +47,14 @@ GRU<InputDataType, OutputDataType>::GRU(
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
-    deterministic(false)
+    numOutputs(0),
+    prevOutput(0),
+    backIterator(NoOutput),
+    gradIterator(NoOutput),
+    deterministic(false),
+    bpttSteps(rho),
+    stateful(false),
+    carryState(false)
 {
   // Input specific linear layers(for zt, rt, ot).
   input2GateModule = new Linear<>(inSize, 3 * outSize);
@@ -66,14 +79,8 @@ GRU<InputDataType, OutputDataType>::GRU(
 
   prevError = arma::zeros<arma::mat>(3 * outSize, batchSize);
 
-  allZeros = arma::zeros<arma::mat>(outSize, batchSize);
-
-  outParameter.emplace_back(allZeros.memptr(),
-      allZeros.n_rows, allZeros.n_cols, false, true);
-
-  prevOutput = outParameter.begin();
-  backIterator = outParameter.end();
-  gradIterator = outParameter.end();
+  prevOutput = NewOutput();
+  StoredOutput(prevOutput).zeros();
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -82,24 +89,22 @@ void GRU<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>& input, arma::Mat<eT>& output)
 {
   if (input.n_cols != batchSize)
-  {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
-    allZeros.zeros(outSize, batchSize);
-    // Batch size better not change during an iteration...
-    if (outParameter.size() > 1)
-    {
-      Log::Fatal << "GRU<>::Forward(): batch size cannot change during a "
-          << "forward pass!" << std::endl;
-    }
-
-    outParameter.clear();
-    outParameter.emplace_back(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, true);
+    SetBatchSize(input.n_cols);
 
-    prevOutput = outParameter.begin();
-    backIterator = outParameter.end();
-    gradIterator = outParameter.end();
+  // Drop the outputs of the last window, except for the one this step
+  // continues from.  The backward pass of the last window is done by now.
+  // prevOutput is the last stored output here, so it becomes the only one.
+  if (carryState)
+  {
+    if (prevOutput != 0)
+      StoredOutput(0) = StoredOutput(prevOutput);
+
+    numOutputs = 1;
+    prevOutput = 0;
+    backIterator = NoOutput;
+    gradIterator = NoOutput;
+    backwardStep = 0;
+    carryState = false;
   }
 
   // Process the input linearly(zt, rt, ot).
@@ -107,8 +112,12 @@ void GRU<InputDataType, OutputDataType>::Forward(
       boost::apply_visitor(outputParameterVisitor, input2GateModule)),
       input2GateModule);
 
+  // Alias of the previous output; it stays valid until NewOutput() is called.
+  const arma::mat prev(outParameter.colptr(prevOutput * batchSize), outSize,
+      batchSize, false, true);
+
   // Process the output(zt, rt) linearly.
-  boost::apply_visitor(ForwardVisitor(*prevOutput,
+  boost::apply_visitor(ForwardVisitor(prev,
       boost::apply_visitor(outputParameterVisitor, output2GateModule)),
       output2GateModule);
 
@@ -128,8 +137,8 @@ void GRU<InputDataType, OutputDataType>::Forward(
       boost::apply_visitor(outputParameterVisitor, forgetGateModule)),
       forgetGateModule);
 
-  arma::mat modInput = (boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule) % *prevOutput);
+  modInput = (boost::apply_visitor(outputParameterVisitor,
+      forgetGateModule) % prev);
 
   // Pass that through the outputHidden2GateModule.
   boost::apply_visitor(ForwardVisitor(modInput,
@@ -137,7 +146,7 @@ void GRU<InputDataType, OutputDataType>::Forward(
       outputHidden2GateModule);
 
   // Merge for ot.
-  arma::mat outputH = boost::apply_visitor(outputParameterVisitor,
+  outputH = boost::apply_visitor(outputParameterVisitor,
       input2GateModule).submat(2 * outSize, 0, 3 * outSize - 1, batchSize - 1) +
       boost::apply_visitor(outputParameterVisitor, outputHidden2GateModule);
 
@@ -150,44 +159,40 @@ void GRU<InputDataType, OutputDataType>::Forward(
   // Where cmul1 is input gate * prevOutput and
   // cmul2 is (1 - input gate) * hidden gate.
   output = (boost::apply_visitor(outputParameterVisitor, inputGateModule)
-      % (*prevOutput - boost::apply_visitor(outputParameterVisitor,
+      % (prev - boost::apply_visitor(outputParameterVisitor,
       hiddenStateModule))) + boost::apply_visitor(outputParameterVisitor,
       hiddenStateModule);
 
   forwardStep++;
-  if (forwardStep == rho)
+  if (forwardStep == bpttSteps && !stateful)
   {
     forwardStep = 0;
     if (!deterministic)
-    {
-      outParameter.emplace_back(allZeros.memptr(),
-          allZeros.n_rows, allZeros.n_cols, false, true);
-      prevOutput = --outParameter.end();
-    }
-    else
-    {
-      *prevOutput = arma::mat(allZeros.memptr(),
-          allZeros.n_rows, allZeros.n_cols, false, true);
-    }
+      prevOutput = NewOutput();
+
+    StoredOutput(prevOutput).zeros();
   }
   else if (!deterministic)
   {
-    outParameter.push_back(output);
-    prevOutput = --outParameter.end();
+    prevOutput = NewOutput();
+    StoredOutput(prevOutput) = output;
   }
   else
   {
     if (forwardStep == 1)
     {
-      outParameter.clear();
-      outParameter.push_back(output);
-
-      prevOutput = outParameter.begin();
-    }
-    else
-    {
-      *prevOutput = output;
+      numOutputs = 0;
+      prevOutput = NewOutput();
     }
+
+    StoredOutput(prevOutput) = output;
+  }
+
+  // Continue from this output in the next window.
+  if (forwardStep == bpttSteps)
+  {
+    forwardStep = 0;
+    carryState = !deterministic;
   }
 }
 
@@ -197,50 +202,29 @@ void GRU<InputDataType, OutputDataType>::Backward(
   const arma::Mat<eT>& input, const arma::Mat<eT>& gy, arma::Mat<eT>& g)
 {
   if (input.n_cols != batchSize)
-  {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
-    allZeros.zeros(outSize, batchSize);
-    // Batch size better not change during an iteration...
-    if (outParameter.size() > 1)
-    {
-      Log::Fatal << "GRU<>::Forward(): batch size cannot change during a "
-          << "forward pass!" << std::endl;
-    }
-
-    outParameter.clear();
-    outParameter.emplace_back(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, true);
+    SetBatchSize(input.n_cols);
 
-    prevOutput = outParameter.begin();
-    backIterator = outParameter.end();
-    gradIterator = outParameter.end();
-  }
-
-  arma::Mat<eT> gyLocal;
-  if ((outParameter.size() - backwardStep  - 1) % rho != 0 && backwardStep != 0)
+  if ((numOutputs - backwardStep - 1) % bpttSteps != 0 &&
+      backwardStep != 0)
   {
     gyLocal = gy + boost::apply_visitor(deltaVisitor, output2GateModule);
   }
   else
   {
-    gyLocal = arma::Mat<eT>(((arma::Mat<eT>&) gy).memptr(), gy.n_rows,
-        gy.n_cols, false, false);
+    gyLocal = gy;
   }
 
-  if (backIterator == outParameter.end())
-  {
-    backIterator = --(--outParameter.end());
-  }
+  if (backIterator == NoOutput)
+    backIterator = numOutputs - 2;
 
   // Delta zt.
-  arma::mat dZt = gyLocal % (*backIterator -
+  dZt = gyLocal % (StoredOutput(backIterator) -
       boost::apply_visitor(outputParameterVisitor,
       hiddenStateModule));
 
   // Delta ot.
-  arma::mat dOt = gyLocal % (arma::ones<arma::mat>(outSize, batchSize) -
-      boost::apply_visitor(outputParameterVisitor, inputGateModule));
+  dOt = gyLocal % (1 - boost::apply_visitor(outputParameterVisitor,
+      inputGateModule));
 
   // Delta of input gate.
   boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
@@ -262,8 +246,8 @@ void GRU<InputDataType, OutputDataType>::Backward(
       outputHidden2GateModule);
 
   // Delta rt.
-  arma::mat dRt = boost::apply_visitor(deltaVisitor, outputHidden2GateModule) %
-      *backIterator;
+  dRt = boost::apply_visitor(deltaVisitor, outputHidden2GateModule) %
+      StoredOutput(backIterator);
 
   // Delta of forget gate.
   boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
@@ -284,11 +268,10 @@ void GRU<InputDataType, OutputDataType>::Backward(
       boost::apply_visitor(deltaVisitor, hiddenStateModule);
 
   // Get delta ht - 1 for input gate and forget gate.
-  arma::mat prevErrorSubview = prevError.submat(0, 0, 2 * outSize - 1,
-      batchSize - 1);
+  prevGateError = prevError.submat(0, 0, 2 * outSize - 1, batchSize - 1);
   boost::apply_visitor(BackwardVisitor(boost::apply_visitor(
       outputParameterVisitor, input2GateModule),
-      prevErrorSubview,
+      prevGateError,
       boost::apply_visitor(deltaVisitor, output2GateModule)),
       output2GateModule);
 
@@ -321,40 +304,22 @@ void GRU<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>& /* gradient */)
 {
   if (input.n_cols != batchSize)
-  {
-    batchSize = input.n_cols;
-    prevError.resize(3 * outSize, batchSize);
-    allZeros.zeros(outSize, batchSize);
-    // Batch size better not change during an iteration...
-    if (outParameter.size() > 1)
-    {
-      Log::Fatal << "GRU<>::Forward(): batch size cannot change during a "
-          << "forward pass!" << std::endl;
-    }
+    SetBatchSize(input.n_cols);
 
-    outParameter.clear();
-    outParameter.emplace_back(allZeros.memptr(),
-        allZeros.n_rows, allZeros.n_cols, false, true);
+  if (gradIterator == NoOutput)
+    gradIterator = numOutputs - 2;
 
-    prevOutput = outParameter.begin();
-    backIterator = outParameter.end();
-    gradIterator = outParameter.end();
-  }
-
-  if (gradIterator == outParameter.end())
-  {
-    gradIterator = --(--outParameter.end());
-  }
+  const arma::mat prev(outParameter.colptr(gradIterator * batchSize), outSize,
+      batchSize, false, true);
 
   boost::apply_visitor(GradientVisitor(input, prevError), input2GateModule);
 
-  boost::apply_visitor(GradientVisitor(
-      *gradIterator,
+  boost::apply_visitor(GradientVisitor(prev,
       prevError.submat(0, 0, 2 * outSize - 1, batchSize - 1)),
       output2GateModule);
 
   boost::apply_visitor(GradientVisitor(
-      *gradIterator % boost::apply_visitor(outputParameterVisitor,
+      prev % boost::apply_visitor(outputParameterVisitor,
       forgetGateModule),
       prevError.submat(2 * outSize, 0, 3 * outSize - 1, batchSize - 1)),
       outputHidden2GateModule);
@@ -363,20 +328,65 @@ void GRU<InputDataType, OutputDataType>::Gradient(
 }
 
 template<typename InputDataType, typename OutputDataType>
-void GRU<InputDataType, OutputDataType>::ResetCell(const size_t /* size */)
+void GRU<InputDataType, OutputDataType>::ResetCell(const size_t size)
 {
-  outParameter.clear();
-  outParameter.emplace_back(allZeros.memptr(),
-    allZeros.n_rows, allZeros.n_cols, false, true);
+  bpttSteps = std::min(rho, size);
+  carryState = false;
+
+  // Reserve the outputs of a whole window, so that Forward() does not have to
+  // allocate.
+  if (bpttSteps < std::numeric_limits<size_t>::max() &&
+      (outParameter.n_rows != outSize ||
+      outParameter.n_cols < (bpttSteps + 1) * batchSize))
+  {
+    outParameter.set_size(outSize, (bpttSteps + 1) * batchSize);
+  }
 
-  prevOutput = outParameter.begin();
-  backIterator = outParameter.end();
-  gradIterator = outParameter.end();
+  numOutputs = 0;
+  prevOutput = NewOutput();
+  StoredOutput(prevOutput).zeros();
+  backIterator = NoOutput;
+  gradIterator = NoOutput;
 
   forwardStep = 0;
   backwardStep = 0;
 }
 
+template<typename InputDataType, typename OutputDataType>
+size_t GRU<InputDataType, OutputDataType>::NewOutput()
+{
+  // Grow geometrically, so that long stateful sequences are not copied at
+  // every step.
+  if (outParameter.n_rows != outSize ||
+      (numOutputs + 1) * batchSize > outParameter.n_cols)
+  {
+    outParameter.resize(outSize,
+        std::max(2 * numOutputs, numOutputs + 1) * batchSize);
+  }
+
+  return numOutputs++;
+}
+
+template<typename InputDataType, typename OutputDataType>
+void GRU<InputDataType, OutputDataType>::SetBatchSize(const size_t size)
+{
+  // Batch size better not change during an iteration...
+  if (numOutputs > 1)
+  {
+    Log::Fatal << "GRU<>::Forward(): batch size cannot change during a "
+        << "forward pass!" << std::endl;
+  }
+
+  batchSize = size;
+  prevError.resize(3 * outSize, batchSize);
+
+  numOutputs = 0;
+  prevOutput = NewOutput();
+  StoredOutput(prevOutput).zeros();
+  backIterator = NoOutput;
+  gradIterator = NoOutput;
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void GRU<InputDataType, OutputDataType>::serialize(
@@ -397,6 +407,9 @@ void GRU<InputDataType, OutputDataType>::serialize(
   ar & BOOST_SERIALIZATION_NVP(outSize);
   ar & BOOST_SERIALIZATION_NVP(rho);
 
+  if (Archive::is_loading::value)
+    bpttSteps = rho;
+
   ar & BOOST_SERIALIZATION_NVP(input2GateModule);
   ar & BOOST_SERIALIZATION_NVP(output2GateModule);
   ar & BOOST_SERIALIZATION_NVP(outputHidden2GateModule);
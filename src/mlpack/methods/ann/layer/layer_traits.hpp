@@ -64,6 +64,10 @@ HAS_MEM_FUNC(Gradient, HasGradientCheck);
 // function.
 HAS_MEM_FUNC(Deterministic, HasDeterministicCheck);
 
+// This gives us a HasStochasticCheck<T, U> type (where U is a function pointer)
+// we can use with SFINAE to catch when a type has a Stochastic() function.
+HAS_MEM_FUNC(Stochastic, HasStochasticCheck);
+
 // This gives us a HasParametersCheck<T, U> type (where U is a function pointer)
 // we can use with SFINAE to catch when a type has a Parameters() function.
 HAS_MEM_FUNC(Parameters, HasParametersCheck);
@@ -112,6 +116,14 @@ HAS_MEM_FUNC(Loss, HasLoss);
 // can use with SFINAE to catch when a type has a Run() function.
 HAS_MEM_FUNC(Run, HasRunCheck);
 
+// This gives us a HasStatefulCheck<T, U> type (where U is a function pointer)
+// we can use with SFINAE to catch when a type has a Stateful() function.
+HAS_MEM_FUNC(Stateful, HasStatefulCheck);
+
+// This gives us a HasTrainingMeanCheck<T> type we can use with SFINAE to catch
+// when a type has a function named TrainingMean.
+HAS_ANY_METHOD_FORM(TrainingMean, HasTrainingMeanCheck);
+
 // This gives us a HasBiasCheck<T, U> type (where U is a function pointer) we
 // can use with SFINAE to catch when a type has a Bias() function.
 HAS_MEM_FUNC(Bias, HasBiasCheck);
@@ -75,6 +75,11 @@ class Lookup
 
   /**
    * Calculate the gradient using the output delta and the input activation.
+   * Only the embeddings of the tokens in the input have a non-zero gradient;
+   * their (zero-based) columns are stored and can be obtained with
+   * GradientColumns().  If the given gradient is the gradient of the layer,
+   * i.e. a part of the gradient of the network, it is assumed to be zero
+   * already, and only these columns are written.
    *
    * @param input The input parameter used for calculating the gradient.
    * @param error The calculated error.
@@ -105,6 +110,9 @@ class Lookup
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the columns of the gradient written by the last call to Gradient().
+  arma::uvec const& GradientColumns() const { return gradientColumns; }
+
   //! Get the size of the vocabulary.
   size_t VocabSize() const { return vocabSize; }
 
@@ -135,6 +143,9 @@ class Lookup
 
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
+
+  //! The columns of the gradient written by the last call to Gradient().
+  arma::uvec gradientColumns;
 }; // class Lookup
 
 // Alias for using as embedding layer.
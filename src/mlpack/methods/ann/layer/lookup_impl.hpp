@@ -72,8 +72,17 @@ void Lookup<InputDataType, OutputDataType>::Gradient(
   arma::Cube<eT> errorTemp(const_cast<arma::Mat<eT>&>(error).memptr(),
       embeddingSize, seqLength, batchSize, false, false);
 
-  gradient.set_size(arma::size(weights));
-  gradient.zeros();
+  // The gradient of the layer is a part of the gradient of the network, which
+  // the network clears before each batch, so only the embeddings of the tokens
+  // in the batch have to be written.  Any other gradient is cleared here.
+  if ((const void*) &gradient != (const void*) &this->gradient ||
+      arma::size(gradient) != arma::size(weights))
+  {
+    gradient.zeros(arma::size(weights));
+  }
+
+  gradientColumns = arma::unique(arma::conv_to<arma::uvec>::from(
+      arma::vectorise(input)) - 1);
 
   for (size_t i = 0; i < batchSize; ++i)
   {
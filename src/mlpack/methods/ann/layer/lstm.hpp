@@ -145,6 +145,12 @@ class LSTM
   //! Modify the maximum number of steps to backpropagate through time (BPTT).
   size_t& Rho() { return rho; }
 
+  //! Get whether the state is kept after rho steps.
+  bool Stateful() const { return stateful; }
+  //! Modify whether the state is kept after rho steps.  If false, the layer
+  //! starts again from the zero state every rho steps.
+  bool& Stateful() { return stateful; }
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
@@ -320,11 +326,49 @@ class LSTM
   //! Locally-stored hidden layer error.
   OutputDataType hiddenError;
 
+  //! Weights between the input and all gates, in the order input gate, forget
+  //! gate, hidden layer, output gate (a copy of the weights; see
+  //! PackWeights()).
+  OutputDataType input2GateWeight;
+
+  //! Bias between the input and all gates, in the same order.
+  OutputDataType input2GateBias;
+
+  //! Weights between the output and all gates, in the same order.
+  OutputDataType output2GateWeight;
+
+  //! Locally-stored pre-activations of all gates for the current step.
+  OutputDataType gates;
+
+  //! Locally-stored errors of all gates for the current step.
+  OutputDataType gateError;
+
   //! Locally-stored current rho size.
   size_t rhoSize;
 
   //! Current backpropagate through time steps.
   size_t bpttSteps;
+
+  //! Locally-stored cell state the first step continues from.
+  OutputDataType prevCell;
+
+  //! Whether the state is kept after rho steps.
+  bool stateful;
+
+  //! Whether the next step continues from the state of the last step.
+  bool carryState;
+
+  /**
+   * Copy the input and output weights of the four gates into
+   * input2GateWeight, input2GateBias and output2GateWeight, so that each
+   * forward and backward step needs one matrix product for the input and one
+   * for the output, instead of one for each gate.  The weights can't be
+   * aliased directly, because the parameters are stored gate by gate.  This is
+   * called at the start of each window of rho steps, which for streaming
+   * prediction with RNN::PredictStep() is every step, so the parameters may be
+   * changed between windows but not within one.
+   */
+  void PackWeights();
 }; // class LSTM
 
 } // namespace ann
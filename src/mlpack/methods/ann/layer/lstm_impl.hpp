@@ -19,7 +19,9 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename InputDataType, typename OutputDataType>
-LSTM<InputDataType, OutputDataType>::LSTM()
+LSTM<InputDataType, OutputDataType>::LSTM() :
+    stateful(false),
+    carryState(false)
 {
   // Nothing to do here.
 }
@@ -37,7 +39,9 @@ LSTM<InputDataType, OutputDataType>::LSTM(
     batchStep(0),
     gradientStepIdx(0),
     rhoSize(rho),
-    bpttSteps(0)
+    bpttSteps(0),
+    stateful(false),
+    carryState(false)
 {
   weights.set_size(4 * outSize * inSize + 7 * outSize +
       4 * outSize * outSize, 1);
@@ -91,6 +95,11 @@ void LSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
       outParameter.resize(outSize, (size + 1) * batchSize);
     }
   }
+
+  // Start from the zero state.
+  outParameter.cols(0, batchSize - 1).zeros();
+  prevCell.zeros(outSize, batchSize);
+  carryState = false;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -157,6 +166,32 @@ void LSTM<InputDataType, OutputDataType>::Reset()
   // Set the weight parameter for the cell - input gate multiplication.
   cell2GateInputWeight = OutputDataType(weights.memptr() +
       offset, outSize, 1, false, false);
+
+  // The packed weights have to be copied from the new parameters.
+  input2GateWeight.reset();
+}
+
+template<typename InputDataType, typename OutputDataType>
+void LSTM<InputDataType, OutputDataType>::PackWeights()
+{
+  input2GateWeight.set_size(4 * outSize, inSize);
+  input2GateWeight.rows(0, outSize - 1) = input2GateInputWeight;
+  input2GateWeight.rows(outSize, 2 * outSize - 1) = input2GateForgetWeight;
+  input2GateWeight.rows(2 * outSize, 3 * outSize - 1) = input2HiddenWeight;
+  input2GateWeight.rows(3 * outSize, 4 * outSize - 1) = input2GateOutputWeight;
+
+  input2GateBias.set_size(4 * outSize, 1);
+  input2GateBias.rows(0, outSize - 1) = input2GateInputBias;
+  input2GateBias.rows(outSize, 2 * outSize - 1) = input2GateForgetBias;
+  input2GateBias.rows(2 * outSize, 3 * outSize - 1) = input2HiddenBias;
+  input2GateBias.rows(3 * outSize, 4 * outSize - 1) = input2GateOutputBias;
+
+  output2GateWeight.set_size(4 * outSize, outSize);
+  output2GateWeight.rows(0, outSize - 1) = output2GateInputWeight;
+  output2GateWeight.rows(outSize, 2 * outSize - 1) = output2GateForgetWeight;
+  output2GateWeight.rows(2 * outSize, 3 * outSize - 1) = output2HiddenWeight;
+  output2GateWeight.rows(3 * outSize, 4 * outSize - 1) =
+      output2GateOutputWeight;
 }
 
 // Forward when cellState is not needed.
@@ -187,17 +222,35 @@ void LSTM<InputDataType, OutputDataType>::Forward(const InputType& input,
     ResetCell(rhoSize);
   }
 
-  inputGate.cols(forwardStep, forwardStep + batchStep) = input2GateInputWeight *
-      input + output2GateInputWeight * outParameter.cols(forwardStep,
-      forwardStep + batchStep);
-  inputGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2GateInputBias;
+  // The parameters may have changed since the last window (for instance, by an
+  // optimizer step between two windows of truncated backpropagation through
+  // time, or between two calls of RNN::PredictStep()), so they are packed again
+  // at the start of every window.
+  if (forwardStep == 0 || input2GateWeight.n_rows != 4 * outSize)
+    PackWeights();
 
-  forgetGate.cols(forwardStep, forwardStep + batchStep) = input2GateForgetWeight
-      * input + output2GateForgetWeight * outParameter.cols(
+  // Continue from the output and the cell state of the last step.  They are
+  // only copied now, because the backward pass still needs the old ones.
+  if (forwardStep == 0 && carryState)
+  {
+    outParameter.cols(0, batchStep) = outParameter.cols(
+        bpttSteps * batchSize, bpttSteps * batchSize + batchStep);
+    prevCell = cell.cols((bpttSteps - 1) * batchSize,
+        (bpttSteps - 1) * batchSize + batchStep);
+    carryState = false;
+  }
+
+  // Compute the input and output contributions of all gates at once.
+  gates = input2GateWeight * input + output2GateWeight * outParameter.cols(
       forwardStep, forwardStep + batchStep);
-  forgetGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2GateForgetBias;
+  gates.each_col() += input2GateBias;
+
+  inputGate.cols(forwardStep, forwardStep + batchStep) =
+      gates.rows(0, outSize - 1);
+  forgetGate.cols(forwardStep, forwardStep + batchStep) =
+      gates.rows(outSize, 2 * outSize - 1);
+  hiddenLayer.cols(forwardStep, forwardStep + batchStep) =
+      gates.rows(2 * outSize, 3 * outSize - 1);
 
   if (forwardStep > 0)
   {
@@ -214,12 +267,20 @@ void LSTM<InputDataType, OutputDataType>::Forward(const InputType& input,
       }
     }
     inputGate.cols(forwardStep, forwardStep + batchStep) +=
-        arma::repmat(cell2GateInputWeight, 1, batchSize) %
-        cell.cols(forwardStep - batchSize, forwardStep - batchSize + batchStep);
+        cell.cols(forwardStep - batchSize, forwardStep - batchSize +
+        batchStep).each_col() % cell2GateInputWeight;
+
+    forgetGate.cols(forwardStep, forwardStep + batchStep) +=
+        cell.cols(forwardStep - batchSize, forwardStep - batchSize +
+        batchStep).each_col() % cell2GateForgetWeight;
+  }
+  else if (stateful)
+  {
+    inputGate.cols(forwardStep, forwardStep + batchStep) +=
+        prevCell.each_col() % cell2GateInputWeight;
 
     forgetGate.cols(forwardStep, forwardStep + batchStep) +=
-        arma::repmat(cell2GateForgetWeight, 1, batchSize) %
-        cell.cols(forwardStep - batchSize, forwardStep - batchSize + batchStep);
+        prevCell.each_col() % cell2GateForgetWeight;
   }
 
   inputGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
@@ -228,13 +289,6 @@ void LSTM<InputDataType, OutputDataType>::Forward(const InputType& input,
   forgetGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
       (1 + arma::exp(-forgetGate.cols(forwardStep, forwardStep + batchStep)));
 
-  hiddenLayer.cols(forwardStep, forwardStep + batchStep) = input2HiddenWeight *
-      input + output2HiddenWeight * outParameter.cols(
-      forwardStep, forwardStep + batchStep);
-
-  hiddenLayer.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2HiddenBias;
-
   hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep) =
       arma::tanh(hiddenLayer.cols(forwardStep, forwardStep + batchStep));
 
@@ -243,6 +297,13 @@ void LSTM<InputDataType, OutputDataType>::Forward(const InputType& input,
     cell.cols(forwardStep, forwardStep + batchStep) =
         inputGateActivation.cols(forwardStep, forwardStep + batchStep) %
         hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep);
+
+    if (stateful)
+    {
+      cell.cols(forwardStep, forwardStep + batchStep) +=
+          forgetGateActivation.cols(forwardStep, forwardStep + batchStep) %
+          prevCell;
+    }
   }
   else
   {
@@ -253,14 +314,10 @@ void LSTM<InputDataType, OutputDataType>::Forward(const InputType& input,
         hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep);
   }
 
-  outputGate.cols(forwardStep, forwardStep + batchStep) = input2GateOutputWeight
-      * input + output2GateOutputWeight * outParameter.cols(
-      forwardStep, forwardStep + batchStep) + cell.cols(forwardStep,
+  outputGate.cols(forwardStep, forwardStep + batchStep) =
+      gates.rows(3 * outSize, 4 * outSize - 1) + cell.cols(forwardStep,
       forwardStep + batchStep).each_col() % cell2GateOutputWeight;
 
-  outputGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2GateOutputBias;
-
   outputGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
       (1 + arma::exp(-outputGate.cols(forwardStep, forwardStep + batchStep)));
 
@@ -282,6 +339,7 @@ void LSTM<InputDataType, OutputDataType>::Forward(const InputType& input,
   if ((forwardStep / batchSize) == bpttSteps)
   {
     forwardStep = 0;
+    carryState = stateful;
   }
 }
 
@@ -290,6 +348,14 @@ template<typename InputType, typename ErrorType, typename GradientType>
 void LSTM<InputDataType, OutputDataType>::Backward(
   const InputType& /* input */, const ErrorType& gy, GradientType& g)
 {
+  // Start at the last step of the forward pass, which may have been shorter
+  // than rho.
+  if (gradientStepIdx == 0)
+  {
+    backwardStep = (forwardStep == 0 ? bpttSteps * batchSize : forwardStep) - 1;
+    gradientStep = backwardStep;
+  }
+
   ErrorType gyLocal;
   if (gradientStepIdx > 0)
   {
@@ -326,6 +392,11 @@ void LSTM<InputDataType, OutputDataType>::Backward(
       backwardStep - batchStep, backwardStep) % (1.0 -
       forgetGateActivation.cols(backwardStep - batchStep, backwardStep)));
   }
+  else if (stateful)
+  {
+    forgetGateError = prevCell % cellError % (forgetGateActivation.cols(
+        0, batchStep) % (1.0 - forgetGateActivation.cols(0, batchStep)));
+  }
   else
   {
     forgetGateError.zeros();
@@ -344,15 +415,18 @@ void LSTM<InputDataType, OutputDataType>::Backward(
       backwardStep) % cellError + forgetGateError.each_col() %
       cell2GateForgetWeight + inputGateError.each_col() % cell2GateInputWeight;
 
-  g = input2GateInputWeight.t() * inputGateError +
-      input2HiddenWeight.t() * hiddenError +
-      input2GateForgetWeight.t() * forgetGateError +
-      input2GateOutputWeight.t() * outputGateError;
+  // Propagate the errors of all gates at once.
+  gateError.set_size(4 * outSize, batchSize);
+  gateError.rows(0, outSize - 1) = inputGateError;
+  gateError.rows(outSize, 2 * outSize - 1) = forgetGateError;
+  gateError.rows(2 * outSize, 3 * outSize - 1) = hiddenError;
+  gateError.rows(3 * outSize, 4 * outSize - 1) = outputGateError;
+
+  if (input2GateWeight.n_rows != 4 * outSize)
+    PackWeights();
 
-  prevError = output2GateOutputWeight.t() * outputGateError +
-      output2GateForgetWeight.t() * forgetGateError +
-      output2GateInputWeight.t() * inputGateError +
-      output2HiddenWeight.t() * hiddenError;
+  g = input2GateWeight.t() * gateError;
+  prevError = output2GateWeight.t() * gateError;
 
   backwardStep -= batchSize;
   gradientStepIdx++;
@@ -370,61 +444,35 @@ void LSTM<InputDataType, OutputDataType>::Gradient(
     const ErrorType& /* error */,
     GradientType& gradient)
 {
-  // Input2GateOutputWeight and input2GateOutputBias gradients.
-  gradient.submat(0, 0, input2GateOutputWeight.n_elem - 1, 0) =
-      arma::vectorise(outputGateError * input.t());
-  gradient.submat(input2GateOutputWeight.n_elem, 0,
-      input2GateOutputWeight.n_elem + input2GateOutputBias.n_elem - 1, 0) =
-      arma::sum(outputGateError, 1);
-  size_t offset = input2GateOutputWeight.n_elem + input2GateOutputBias.n_elem;
-
-  // Input2GateForgetWeight and input2GateForgetBias gradients.
-  gradient.submat(offset, 0, offset + input2GateForgetWeight.n_elem - 1, 0) =
-      arma::vectorise(forgetGateError * input.t());
-  gradient.submat(offset + input2GateForgetWeight.n_elem, 0,
-      offset + input2GateForgetWeight.n_elem +
-      input2GateForgetBias.n_elem - 1, 0) = arma::sum(forgetGateError, 1);
-  offset += input2GateForgetWeight.n_elem + input2GateForgetBias.n_elem;
-
-  // Input2GateInputWeight and input2GateInputBias gradients.
-  gradient.submat(offset, 0, offset + input2GateInputWeight.n_elem - 1, 0) =
-      arma::vectorise(inputGateError * input.t());
-  gradient.submat(offset + input2GateInputWeight.n_elem, 0,
-      offset + input2GateInputWeight.n_elem +
-      input2GateInputBias.n_elem - 1, 0) = arma::sum(inputGateError, 1);
-  offset += input2GateInputWeight.n_elem + input2GateInputBias.n_elem;
-
-  // Input2HiddenWeight and input2HiddenBias gradients.
-  gradient.submat(offset, 0, offset + input2HiddenWeight.n_elem - 1, 0) =
-      arma::vectorise(hiddenError * input.t());
-  gradient.submat(offset + input2HiddenWeight.n_elem, 0,
-      offset + input2HiddenWeight.n_elem + input2HiddenBias.n_elem - 1, 0) =
-      arma::sum(hiddenError, 1);
-  offset += input2HiddenWeight.n_elem + input2HiddenBias.n_elem;
-
-  // Output2GateOutputWeight gradients.
-  gradient.submat(offset, 0, offset + output2GateOutputWeight.n_elem - 1, 0) =
-      arma::vectorise(outputGateError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2GateOutputWeight.n_elem;
-
-  // Output2GateForgetWeight gradients.
-  gradient.submat(offset, 0, offset + output2GateForgetWeight.n_elem - 1, 0) =
-      arma::vectorise(forgetGateError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2GateForgetWeight.n_elem;
-
-  // Output2GateInputWeight gradients.
-  gradient.submat(offset, 0, offset + output2GateInputWeight.n_elem - 1, 0) =
-      arma::vectorise(inputGateError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2GateInputWeight.n_elem;
+  // Compute the weight gradients of all gates at once, then store them in
+  // the order of the parameters, which are stored gate by gate: output gate,
+  // forget gate, input gate, hidden layer.  The rows of gateError are in the
+  // order input gate, forget gate, hidden layer, output gate.
+  const OutputDataType inputGradient = gateError * input.t();
+  const OutputDataType outputGradient = gateError *
+      outParameter.cols(gradientStep - batchStep, gradientStep).t();
+  const size_t gateRows[4] = { 3 * outSize, outSize, 0, 2 * outSize };
+
+  size_t offset = 0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const size_t row = gateRows[i];
+    gradient.submat(offset, 0, offset + outSize * inSize - 1, 0) =
+        arma::vectorise(inputGradient.rows(row, row + outSize - 1));
+    offset += outSize * inSize;
+
+    gradient.submat(offset, 0, offset + outSize - 1, 0) =
+        arma::sum(gateError.rows(row, row + outSize - 1), 1);
+    offset += outSize;
+  }
 
-  // Output2HiddenWeight gradients.
-  gradient.submat(offset, 0, offset + output2HiddenWeight.n_elem - 1, 0) =
-      arma::vectorise(hiddenError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2HiddenWeight.n_elem;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const size_t row = gateRows[i];
+    gradient.submat(offset, 0, offset + outSize * outSize - 1, 0) =
+        arma::vectorise(outputGradient.rows(row, row + outSize - 1));
+    offset += outSize * outSize;
+  }
 
   // Cell2GateOutputWeight gradients.
   gradient.submat(offset, 0, offset + cell2GateOutputWeight.n_elem - 1, 0) =
@@ -445,6 +493,14 @@ void LSTM<InputDataType, OutputDataType>::Gradient(
                   cell.cols((gradientStep - batchSize) - batchStep,
                             (gradientStep - batchSize)), 1);
   }
+  else if (stateful)
+  {
+    gradient.submat(offset, 0, offset + cell2GateForgetWeight.n_elem - 1, 0) =
+        arma::sum(forgetGateError % prevCell, 1);
+    gradient.submat(offset + cell2GateForgetWeight.n_elem, 0, offset +
+        cell2GateForgetWeight.n_elem + cell2GateInputWeight.n_elem - 1, 0) =
+        arma::sum(inputGateError % prevCell, 1);
+  }
   else
   {
     gradient.submat(offset, 0, offset +
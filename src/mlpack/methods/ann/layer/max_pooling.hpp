@@ -52,6 +52,10 @@ template <
 class MaxPooling
 {
  public:
+  //! Convenience typedefs.
+  typedef typename OutputDataType::elem_type ElemType;
+  typedef arma::Cube<ElemType> CubeType;
+
   //! Create the MaxPooling object.
   MaxPooling();
 
@@ -177,7 +181,7 @@ class MaxPooling
   template<typename eT>
   void PoolingOperation(const arma::Mat<eT>& input,
                         arma::Mat<eT>& output,
-                        arma::Mat<eT>& poolingIndices)
+                        arma::Mat<size_t>& poolingIndices)
   {
     for (size_t j = 0, colidx = 0; j < output.n_cols;
         ++j, colidx += strideHeight)
@@ -185,7 +189,7 @@ class MaxPooling
       for (size_t i = 0, rowidx = 0; i < output.n_rows;
           ++i, rowidx += strideWidth)
       {
-        arma::mat subInput = input(
+        arma::Mat<eT> subInput = input(
             arma::span(rowidx, rowidx + kernelWidth - 1 - offset),
             arma::span(colidx, colidx + kernelHeight - 1 - offset));
 
@@ -214,7 +218,7 @@ class MaxPooling
   template<typename eT>
   void Unpooling(const arma::Mat<eT>& error,
                  arma::Mat<eT>& output,
-                 arma::Mat<eT>& poolingIndices)
+                 const arma::Mat<size_t>& poolingIndices)
   {
     for (size_t i = 0; i < poolingIndices.n_elem; ++i)
     {
@@ -268,13 +272,13 @@ class MaxPooling
   size_t batchSize;
 
   //! Locally-stored output parameter.
-  arma::cube outputTemp;
+  CubeType outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  CubeType inputTemp;
 
   //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
+  CubeType gTemp;
 
   //! Locally-stored pooling strategy.
   MaxPoolingRule pooling;
@@ -295,7 +299,7 @@ class MaxPooling
   arma::Col<size_t> indicesCol;
 
   //! Locally-stored pooling indicies.
-  std::vector<arma::cube> poolingIndices;
+  std::vector<arma::Cube<size_t> > poolingIndices;
 }; // class MaxPooling
 
 } // namespace ann
@@ -58,7 +58,7 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
 {
   batchSize = input.n_cols;
   inSize = input.n_elem / (inputWidth * inputHeight * batchSize);
-  inputTemp = arma::cube(const_cast<arma::Mat<eT>&>(input).memptr(),
+  inputTemp = arma::Cube<eT>(const_cast<arma::Mat<eT>&>(input).memptr(),
       inputWidth, inputHeight, batchSize * inSize, false, false);
 
   if (floor)
@@ -83,7 +83,8 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
 
   if (!deterministic)
   {
-    poolingIndices.push_back(outputTemp);
+    poolingIndices.push_back(arma::zeros<arma::Cube<size_t> >(outputWidth,
+        outputHeight, batchSize * inSize));
   }
 
   if (!reset)
@@ -106,8 +107,8 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     }
     else
     {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-          inputTemp.slice(s));
+      // The indices are not written in deterministic mode.
+      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s), indices);
     }
   }
 
@@ -124,10 +125,10 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>& /* input */, const arma::Mat<eT>& gy, arma::Mat<eT>& g)
 {
-  arma::cube mappedError = arma::cube(((arma::Mat<eT>&) gy).memptr(),
+  arma::Cube<eT> mappedError(((arma::Mat<eT>&) gy).memptr(),
       outputWidth, outputHeight, outSize, false, false);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
+  gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
   for (size_t s = 0; s < mappedError.n_slices; s++)
@@ -138,7 +139,7 @@ void MaxPooling<InputDataType, OutputDataType>::Backward(
 
   poolingIndices.pop_back();
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem / batchSize, batchSize);
+  g = arma::Mat<eT>(gTemp.memptr(), gTemp.n_elem / batchSize, batchSize);
 }
 
 template<typename InputDataType, typename OutputDataType>
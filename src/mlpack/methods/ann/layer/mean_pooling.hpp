@@ -33,6 +33,10 @@ template <
 class MeanPooling
 {
  public:
+  //! Convenience typedefs.
+  typedef typename OutputDataType::elem_type ElemType;
+  typedef arma::Cube<ElemType> CubeType;
+
   //! Create the MeanPooling object.
   MeanPooling();
 
@@ -163,7 +167,7 @@ class MeanPooling
       for (size_t i = 0, rowidx = 0; i < output.n_rows;
            ++i, rowidx += strideWidth)
       {
-        arma::mat subInput = input(
+        arma::Mat<eT> subInput = input(
             arma::span(rowidx, rowidx + kernelWidth - 1 - offset),
             arma::span(colidx, colidx + kernelHeight - 1 - offset));
 
@@ -249,13 +253,13 @@ class MeanPooling
   size_t batchSize;
 
   //! Locally-stored output parameter.
-  arma::cube outputTemp;
+  CubeType outputTemp;
 
   //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  CubeType inputTemp;
 
   //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
+  CubeType gTemp;
 
   //! Locally-stored delta object.
   OutputDataType delta;
@@ -25,7 +25,6 @@
 #define MLPACK_METHODS_ANN_LAYER_MULTIHEAD_ATTENTION_HPP
 
 #include <mlpack/prereqs.hpp>
-#include <mlpack/methods/ann/layer/softmax.hpp>
 #include <mlpack/methods/ann/layer/dropout.hpp>
 #include <mlpack/methods/ann/init_rules/glorot_init.hpp>
 #include <mlpack/methods/ann/regularizer/no_regularizer.hpp>
@@ -48,6 +47,11 @@ namespace ann /** Artificial Neural Network. */ {
  * of shape `(embedDim * tgtSeqLen, batchSize)`. The embeddings are stored
  * consequently.
  *
+ * The attention of each head is computed one tile of source positions at a
+ * time with an online softmax, in parallel over the heads and the batch when
+ * OpenMP is available.  The full (tgtSeqLen, srcSeqLen) score matrix is never
+ * stored; the backward pass recomputes the scores of each tile instead.
+ *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
  * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
@@ -74,11 +78,14 @@ class MultiheadAttention
    * @param srcSeqLen Source sequence length.
    * @param embedDim Total dimension of the model.
    * @param numHeads Number of parallel attention heads.
+   * @param tileSize Number of source positions whose scores are computed at
+   *     once.
    */
   MultiheadAttention(const size_t tgtSeqLen,
                      const size_t srcSeqLen,
                      const size_t embedDim,
-                     const size_t numHeads);
+                     const size_t numHeads,
+                     const size_t tileSize = 64);
 
   /**
    * Reset the layer parameters.
@@ -146,6 +153,11 @@ class MultiheadAttention
   //! Modify the number of attention heads.
   size_t& NumHeads() { return numHeads; }
 
+  //! Get the number of source positions whose scores are computed at once.
+  size_t TileSize() const { return tileSize; }
+  //! Modify the number of source positions whose scores are computed at once.
+  size_t& TileSize() { return tileSize; }
+
   //! Get the two dimensional Attention Mask.
   OutputDataType const& AttentionMask() const { return attnMask; }
   //! Modify the two dimensional Attention Mask.
@@ -180,6 +192,40 @@ class MultiheadAttention
   //! Element Type of the input.
   typedef typename OutputDataType::elem_type ElemType;
 
+  /**
+   * Compute the masked scores of the given head between all target positions
+   * and the source positions begin to end.
+   *
+   * @param query The projected query of the head.
+   * @param key The projected key of the head.
+   * @param begin The first source position of the tile.
+   * @param end The last source position of the tile.
+   * @param tile The resulting scores, of shape (tgtSeqLen, end - begin + 1).
+   */
+  template<typename eT>
+  void ScoreTile(const arma::Mat<eT>& query,
+                 const arma::Mat<eT>& key,
+                 const size_t begin,
+                 const size_t end,
+                 arma::Mat<eT>& tile) const;
+
+  /**
+   * Backpropagate the error of the attention output of every head to the
+   * projected query, key and value, recomputing the attention weights one
+   * tile at a time.
+   *
+   * @param gy The error of the attention output, of shape
+   *     (tgtSeqLen, headDim, numHeads * batchSize).
+   * @param dQuery The error of the projected query.
+   * @param dKey The error of the projected key.
+   * @param dValue The error of the projected value.
+   */
+  template<typename eT>
+  void AttentionBackward(const arma::Cube<eT>& gy,
+                         arma::Cube<eT>& dQuery,
+                         arma::Cube<eT>& dKey,
+                         arma::Cube<eT>& dValue);
+
   //! Target sequence length.
   size_t tgtSeqLen;
 
@@ -195,6 +241,9 @@ class MultiheadAttention
   //! Dimensionality of each head.
   size_t headDim;
 
+  //! Number of source positions whose scores are computed at once.
+  size_t tileSize;
+
   //! Two dimensional Attention Mask of shape (tgtSeqLen, srcSeqLen).
   OutputDataType attnMask;
 
@@ -237,15 +286,13 @@ class MultiheadAttention
   //! Locally-stored projected value matrix over linear layer.
   arma::Cube<ElemType> vProj;
 
-  //! Locally-stored result of output of dropout layer.
-  arma::Cube<ElemType> scores;
+  //! Locally-stored log-sum-exp of the scores of each target position and
+  //! head, of shape (tgtSeqLen, numHeads * batchSize).
+  arma::Mat<ElemType> logSumExp;
 
   //! Locally-stored attention output weight to be fed to last linear layer.
   arma::Cube<ElemType> attnOut;
 
-  //! Softmax layer to represent the probabilities of next sequence.
-  Softmax<InputDataType, OutputDataType> softmax;
-
   //! Locally-stored delta object.
   OutputDataType delta;
 
@@ -29,7 +29,8 @@ MultiheadAttention() :
     srcSeqLen(0),
     embedDim(0),
     numHeads(0),
-    headDim(0)
+    headDim(0),
+    tileSize(64)
 {
   // Nothing to do here.
 }
@@ -41,11 +42,13 @@ MultiheadAttention(
     const size_t tgtSeqLen,
     const size_t srcSeqLen,
     const size_t embedDim,
-    const size_t numHeads) :
+    const size_t numHeads,
+    const size_t tileSize) :
     tgtSeqLen(tgtSeqLen),
     srcSeqLen(srcSeqLen),
     embedDim(embedDim),
-    numHeads(numHeads)
+    numHeads(numHeads),
+    tileSize(tileSize)
 {
   if (embedDim % numHeads != 0)
   {
@@ -53,6 +56,9 @@ MultiheadAttention(
         attention heads." << std::endl;
   }
 
+  if (tileSize == 0)
+    Log::Fatal << "The tile size must be greater than 0." << std::endl;
+
   headDim = embedDim / numHeads;
   weights.set_size(4 * (embedDim + 1) * embedDim, 1);
 }
@@ -139,43 +145,90 @@ Forward(const arma::Mat<eT>& input, arma::Mat<eT>& output)
   kProj.reshape(srcSeqLen, headDim, numHeads * batchSize);
   vProj.reshape(srcSeqLen, headDim, numHeads * batchSize);
 
-  // Calculate the scores i.e. perform the matrix multiplication operation
-  // on qProj and kProj. Here score = qProj . kProj'
-  scores = math::MultiplyCube2Cube(qProj, kProj, false, true);
-
-  // Apply the attention mask if provided. The attention mask is used to black-
-  // out future sequences and generally used in Encoder-Decoder attention.
-  // The attention mask has elements 0 or -infinity.
+  // The attention mask is used to black-out future sequences and generally
+  // used in Encoder-Decoder attention.  The key padding mask blacks-out any
+  // particular word in the sequence.  Both have elements 0 or -infinity, and
+  // are added to the scores of each tile in ScoreTile().
   // The shape of the attention mask : (tgtSeqLen, srcSeqLen).
-  if (!attnMask.is_empty())
+  // The shape of keyPaddingMask : (1, srcSeqLen).
+  if (!attnMask.is_empty() &&
+      (attnMask.n_rows != tgtSeqLen || attnMask.n_cols != srcSeqLen))
   {
-    if (attnMask.n_rows != tgtSeqLen || attnMask.n_cols != srcSeqLen)
-      Log::Fatal << "The size of the 'attn_mask' is not correct.\n";
-    scores.each_slice() += attnMask;
+    Log::Fatal << "The size of the 'attn_mask' is not correct.\n";
   }
 
-  // Apply the key padding mask when provided. It blacks-out any particular
-  // word in the sequence.
-  // The key padding mask has elements 0 or -infinity.
-  // The shape of keyPaddingMask : (1, srcSeqLen).
-  if (!keyPaddingMask.is_empty())
+  if (!keyPaddingMask.is_empty() &&
+      (keyPaddingMask.n_rows != 1 || keyPaddingMask.n_cols != srcSeqLen))
   {
-    if (keyPaddingMask.n_rows != 1 || keyPaddingMask.n_cols != srcSeqLen)
-        Log::Fatal << "The size of the 'keyPaddingMask' is not correct.\n";
-    scores.each_slice() += arma::repmat(keyPaddingMask, tgtSeqLen, 1);
+    Log::Fatal << "The size of the 'keyPaddingMask' is not correct.\n";
   }
 
-  for (size_t i = 0; i < numHeads * batchSize; ++i)
+  // Calculate the attention output of every head, i.e. softmax(qProj . kProj')
+  // . vProj.  The scores are computed one tile of source positions at a time,
+  // and the softmax is computed online: the running maximum and the running
+  // sum of the exponentiated scores of each target position are updated with
+  // every tile, and the partial output is rescaled accordingly.  So the full
+  // (tgtSeqLen, srcSeqLen) score matrix is never stored.
+  // The shape of attnOut : (tgtSeqLen, headDim, numHeads * batchSize).
+  const size_t numSlices = numHeads * batchSize;
+  attnOut.set_size(tgtSeqLen, headDim, numSlices);
+  logSumExp.set_size(tgtSeqLen, numSlices);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) numSlices; ++i)
   {
-    softmax.Forward(scores.slice(i), softmax.OutputParameter());
-    scores.slice(i) = softmax.OutputParameter();
+    const arma::Mat<eT> qSlice(qProj.slice_memptr(i), tgtSeqLen, headDim,
+        false, true);
+    const arma::Mat<eT> kSlice(kProj.slice_memptr(i), srcSeqLen, headDim,
+        false, true);
+    const arma::Mat<eT> vSlice(vProj.slice_memptr(i), srcSeqLen, headDim,
+        false, true);
+    arma::Mat<eT> out(attnOut.slice_memptr(i), tgtSeqLen, headDim, false,
+        true);
+    out.zeros();
+
+    arma::Col<eT> runningMax(tgtSeqLen);
+    runningMax.fill(-std::numeric_limits<eT>::infinity());
+    arma::Col<eT> runningSum(tgtSeqLen, arma::fill::zeros);
+
+    arma::Mat<eT> tile;
+    for (size_t begin = 0; begin < srcSeqLen; begin += tileSize)
+    {
+      const size_t end = std::min(begin + tileSize, srcSeqLen) - 1;
+      ScoreTile(qSlice, kSlice, begin, end, tile);
+
+      const arma::Col<eT> newMax = arma::max(runningMax,
+          arma::Col<eT>(arma::max(tile, 1)));
+
+      // Rows that are completely masked so far are not shifted, so that no
+      // NaNs are produced by subtracting infinities.
+      arma::Col<eT> shift = newMax;
+      shift.elem(arma::find_nonfinite(shift)).zeros();
+
+      tile.each_col() -= shift;
+      tile = arma::exp(tile);
+
+      const arma::Col<eT> scale = arma::exp(runningMax - shift);
+      runningSum = runningSum % scale + arma::sum(tile, 1);
+      out.each_col() %= scale;
+      out += tile * vSlice.rows(begin, end);
+      runningMax = newMax;
+    }
+
+    // A target position whose scores are all masked with -infinity attends
+    // to nothing: its output stays zero, and a finite log-sum-exp makes its
+    // softmax zero in the backward pass too.
+    const arma::uvec masked = arma::find(runningSum == 0);
+    runningSum.elem(masked).ones();
+    runningMax.elem(masked).zeros();
+
+    out.each_col() /= runningSum;
+
+    // The log-sum-exp of the scores is all the backward pass needs to
+    // recompute the softmax of a tile.
+    logSumExp.col(i) = runningMax + arma::log(runningSum);
   }
 
-  // Calculate the attention output i.e. matrix multiplication of softmax
-  // output and vProj.
-  // The shape of attnOutput : (tgtSeqLen, headDim, numHeads * batchSize).
-  attnOut = math::MultiplyCube2Cube(scores, vProj, false, false);
-
   // Now we will concatenate output of all the heads i.e. we will reshape
   // attnOut to (tgtSeqLen, embedDim, batchSize).
   attnOut.reshape(tgtSeqLen, embedDim, batchSize);
@@ -223,60 +276,39 @@ Backward(const arma::Mat<eT>& /* input */,
   // The shape of gyTemp : (tgtSeqLen, headDim, numHeads * batchSize).
   gyTemp.reshape(tgtSeqLen, headDim, numHeads * batchSize);
 
-  // Obtain backpropagted error of value.
-  // Shape of gyTemp : (tgtSeqLen, headDim, numHeads * batchSize).
-  // Shape of scores : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  // The shape of tmp : (srcSeqLen, headDim, numHeads * batchSize).
-  CubeType tmp = math::MultiplyCube2Cube(scores, gyTemp, true, false);
+  // Obtain the backpropagated errors of the projected query, key and value of
+  // every head.
+  // The shape of dQuery : (tgtSeqLen, headDim, numHeads * batchSize).
+  // The shape of dKey and dValue : (srcSeqLen, headDim, numHeads * batchSize).
+  CubeType dQuery, dKey, dValue;
+  AttentionBackward(gyTemp, dQuery, dKey, dValue);
 
   // Concatenate results of all the attention heads.
-  tmp.reshape(srcSeqLen, embedDim, batchSize);
+  dValue.reshape(srcSeqLen, embedDim, batchSize);
 
   for (size_t i = 0; i < batchSize; ++i)
   {
     g.submat((tgtSeqLen + srcSeqLen) * embedDim, i, g.n_rows - 1, i)
-        = arma::vectorise(arma::trans(tmp.slice(i) * valueWt));
-  }
-
-  // The shape of gyTemp : (tgtSeqLen, headDim, numHeads * batchSize).
-  // The shape of vProj : (srcSeqLen, headDim, numHeads * batchSize).
-  // So the new shape of gyTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  gyTemp = math::MultiplyCube2Cube(gyTemp, vProj, false, true);
-
-  for (size_t i = 0; i < numHeads * batchSize; ++i)
-  {
-    // We will perform backpropagation of softmax over each slice of gyTemp.
-    softmax.Backward(scores.slice(i), gyTemp.slice(i), gyTemp.slice(i));
+        = arma::vectorise(arma::trans(dValue.slice(i) * valueWt));
   }
 
-  // Obtain backpropagated error of key.
-  // The shape of qProj : (tgtSeqLen, headDim, numHeads * batchSize).
-  // The shape of gyTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  // The new shape of tmp : (srcSeqLen, headDim, numHeads * batchSize).
-  tmp = math::MultiplyCube2Cube(gyTemp, qProj, true, false);
-
   // Concatenate results of all the attention heads.
-  tmp.reshape(srcSeqLen, embedDim, batchSize);
+  dKey.reshape(srcSeqLen, embedDim, batchSize);
 
   for (size_t i = 0; i < batchSize; ++i)
   {
     g.submat(tgtSeqLen * embedDim, i, (tgtSeqLen + srcSeqLen) * embedDim - 1, i)
-        = arma::vectorise(arma::trans(tmp.slice(i) * keyWt));
+        = arma::vectorise(arma::trans(dKey.slice(i) * keyWt));
   }
 
-  // Obtain backpropagated error of the query.
-  // The shape of kProj : (srcSeqLen, headDim, numHeads * batchSize).
-  // The shape of gyTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  // The new shape of tmp : (tgtSeqLen, headDim, numHeads * batchSize).
-  tmp = math::MultiplyCube2Cube(gyTemp, kProj) / std::sqrt(headDim);
-
   // Concatenate results of all the attention heads.
-  tmp.reshape(tgtSeqLen, embedDim, batchSize);
+  dQuery.reshape(tgtSeqLen, embedDim, batchSize);
+  dQuery /= std::sqrt(headDim);
 
   for (size_t i = 0; i < batchSize; ++i)
   {
     g.submat(0, i, tgtSeqLen * embedDim - 1, i)
-        = arma::vectorise(arma::trans(tmp.slice(i) * queryWt));
+        = arma::vectorise(arma::trans(dQuery.slice(i) * queryWt));
   }
 }
 
@@ -343,93 +375,156 @@ Gradient(const arma::Mat<eT>& input,
   // (tgtSeqLen, headDim, numHeads * batchSize).
   gyTemp.reshape(tgtSeqLen, headDim, numHeads * batchSize);
 
-  // Shape of gyTemp : (tgtSeqLen, headDim, numHeads * batchSize).
-  // Shape of scores : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  // The new shape of errorTemp : (srcSeqLen, headDim, numHeads * batchSize).
-  errorTemp = math::MultiplyCube2Cube(scores, gyTemp, true, false);
+  // Obtain the backpropagated errors of the projected query, key and value of
+  // every head.
+  CubeType dQuery, dKey, dValue;
+  AttentionBackward(gyTemp, dQuery, dKey, dValue);
 
   // Now we will concatenate the propagated errors from all heads i.e. we
-  // will reshape errorTemp to (srcSeqLen, embedDim, batchSize).
-  errorTemp.reshape(srcSeqLen, embedDim, batchSize);
+  // will reshape dValue to (srcSeqLen, embedDim, batchSize).
+  dValue.reshape(srcSeqLen, embedDim, batchSize);
 
-  // Gradient wrt. vBias, i.e. dL/d(vBias). We will take summation of errorTemp
+  // Gradient wrt. vBias, i.e. dL/d(vBias). We will take summation of dValue
   // over all the batches and over all the sequences.
   gradient.rows(4 * wtSize + 2 * embedDim, 4 * wtSize + 3 * embedDim - 1)
-      = arma::vectorise(arma::sum(arma::sum(errorTemp, 2), 0));
+      = arma::vectorise(arma::sum(arma::sum(dValue, 2), 0));
 
-  // Shape of v : (srcSeqLen, embedDim, batchSize).
-  // Shape of errorTemp : (srcSeqLen, embedDim, bathSize).
-  // The new shape of errorTemp : (embedDim, embedDim, batchSize).
-  errorTemp = math::MultiplyCube2Cube(errorTemp, v, true, true);
+  // Shape of v : (embedDim, srcSeqLen, batchSize).
+  // Shape of dValue : (srcSeqLen, embedDim, bathSize).
+  // The shape of errorTemp : (embedDim, embedDim, batchSize).
+  errorTemp = math::MultiplyCube2Cube(dValue, v, true, true);
 
   // Gradient wrt. valueWt, i.e. dL/d(valueWt). We will take summation over all
   // batches of errorTemp.
   gradient.rows(2 * wtSize, 3 * wtSize - 1)
       = arma::vectorise(arma::sum(errorTemp, 2));
 
-  // Now, the shape of gyTemp : (tgtSeqLen, headDim, numHeads * batchSize).
-  // The shape of vProj : (srcSeqLen, headDim, numHeads * batchSize).
-  // The new shape of errorTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  errorTemp = math::MultiplyCube2Cube(gyTemp, vProj, false, true);
-
-  for (size_t i = 0; i < numHeads * batchSize; ++i)
-  {
-    // The shape of scores : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-    // The shape of errorTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-    // The new shape of errorTemp remain same.
-    softmax.Backward(scores.slice(i), errorTemp.slice(i), errorTemp.slice(i));
-  }
-
-  // The shape of qProj : (tgtSeqLen, headDim, numHeads * batchSize).
-  // The shape of errorTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  // The shape of gyTemp : (srcSeqLen, headDim, numHeads * batchSize).
-  gyTemp = math::MultiplyCube2Cube(errorTemp, qProj, true, false);
-
   // We will now conctenate the propagated errors from all heads.
-  // The new shape of gyTemp : (srcSeqLen, embedDim, batchSize).
-  gyTemp.reshape(srcSeqLen, embedDim, batchSize);
+  // The new shape of dKey : (srcSeqLen, embedDim, batchSize).
+  dKey.reshape(srcSeqLen, embedDim, batchSize);
 
   // Gradient wrt. kBias, i.e. dL/d(kBias). We will take summation over all the
-  // batches of gyTemp and then over all the sequences.
+  // batches of dKey and then over all the sequences.
   gradient.rows(4 * wtSize + embedDim, 4 * wtSize + 2 * embedDim - 1)
-      = arma::vectorise(arma::sum(arma::sum(gyTemp, 2), 0));
+      = arma::vectorise(arma::sum(arma::sum(dKey, 2), 0));
 
   // The shape of k : (embedDim, srcSeqLen, batchSize).
-  // The shape of gyTemp : (srcSeqLen, embedDim, batchSize).
-  // The shape of dkeyWt : (embedDim, embedDim, batchSize).
-  gyTemp = math::MultiplyCube2Cube(gyTemp, k, true, true);
+  // The shape of dKey : (srcSeqLen, embedDim, batchSize).
+  // The shape of errorTemp : (embedDim, embedDim, batchSize).
+  errorTemp = math::MultiplyCube2Cube(dKey, k, true, true);
 
   // Gradient wrt. keyWt, i.e. dL/d(keyWt). We will take summation over all the
-  // batches of dkeyWt.
-  gradient.rows(wtSize, 2 * wtSize - 1) = arma::vectorise(arma::sum(gyTemp, 2));
-
-  // The shape of kProj : (srcSeqLen, headDim, numHeads * batchSize).
-  // The shape of errorTemp : (tgtSeqLen, srcSeqLen, numHeads * batchSize).
-  // The shape of gyTemp : (tgtSeqLen, headDim, numHeads * batchSize).
-  gyTemp = math::MultiplyCube2Cube(errorTemp, kProj, false, false);
+  // batches of errorTemp.
+  gradient.rows(wtSize, 2 * wtSize - 1)
+      = arma::vectorise(arma::sum(errorTemp, 2));
 
   // Now, we will concatenate propagated error of all heads.
-  gyTemp.reshape(tgtSeqLen, embedDim, batchSize);
-  gyTemp /= std::sqrt(headDim);
+  dQuery.reshape(tgtSeqLen, embedDim, batchSize);
+  dQuery /= std::sqrt(headDim);
 
   // Gradient wrt. qBias, i.e. dL/d(qBias). We will take summation over all the
-  // batches of gyTemp and over all the sequences.
+  // batches of dQuery and over all the sequences.
   gradient.rows(4 * wtSize, 4 * wtSize + embedDim - 1)
-      = arma::vectorise(arma::sum(arma::sum(gyTemp, 2), 0));
+      = arma::vectorise(arma::sum(arma::sum(dQuery, 2), 0));
 
-  // The shape of gyTemp : (tgtSeqLen, embedDim, batchSize).
+  // The shape of dQuery : (tgtSeqLen, embedDim, batchSize).
   // The shape of q : (embedDim, tgtSeqLen, batchSize).
-  // The shape of gyTemp : (embedDim, embedDim, batchSize).
-  gyTemp = math::MultiplyCube2Cube(gyTemp, q, true, true);
+  // The shape of errorTemp : (embedDim, embedDim, batchSize).
+  errorTemp = math::MultiplyCube2Cube(dQuery, q, true, true);
 
   // Gradient wrt. queryWt, i.e. dL/d(queryBias). We will take summation over
-  // all the batches of gyTemp.
-  gradient.rows(0, wtSize - 1) = arma::vectorise(arma::sum(gyTemp, 2));
+  // all the batches of errorTemp.
+  gradient.rows(0, wtSize - 1) = arma::vectorise(arma::sum(errorTemp, 2));
 
   // Regularize according to the given regularization rule.
   regularizer.Evaluate(weights, gradient);
 }
 
+template <typename InputDataType, typename OutputDataType,
+          typename RegularizerType>
+template <typename eT>
+void MultiheadAttention<InputDataType, OutputDataType, RegularizerType>::
+ScoreTile(const arma::Mat<eT>& query,
+          const arma::Mat<eT>& key,
+          const size_t begin,
+          const size_t end,
+          arma::Mat<eT>& tile) const
+{
+  // The shape of tile : (tgtSeqLen, end - begin + 1).
+  tile = query * arma::trans(key.rows(begin, end));
+
+  if (!attnMask.is_empty())
+    tile += attnMask.cols(begin, end);
+
+  if (!keyPaddingMask.is_empty())
+    tile.each_row() += keyPaddingMask.cols(begin, end);
+}
+
+template <typename InputDataType, typename OutputDataType,
+          typename RegularizerType>
+template <typename eT>
+void MultiheadAttention<InputDataType, OutputDataType, RegularizerType>::
+AttentionBackward(const arma::Cube<eT>& gy,
+                  arma::Cube<eT>& dQuery,
+                  arma::Cube<eT>& dKey,
+                  arma::Cube<eT>& dValue)
+{
+  const size_t numSlices = gy.n_slices;
+  dQuery.zeros(tgtSeqLen, headDim, numSlices);
+  dKey.set_size(srcSeqLen, headDim, numSlices);
+  dValue.set_size(srcSeqLen, headDim, numSlices);
+
+  // The attention weights of each tile are recomputed from the stored
+  // log-sum-exp of the scores, so the memory used is bounded by the tile size
+  // and not by srcSeqLen.
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) numSlices; ++i)
+  {
+    const arma::Mat<eT> qSlice(qProj.slice_memptr(i), tgtSeqLen, headDim,
+        false, true);
+    const arma::Mat<eT> kSlice(kProj.slice_memptr(i), srcSeqLen, headDim,
+        false, true);
+    const arma::Mat<eT> vSlice(vProj.slice_memptr(i), srcSeqLen, headDim,
+        false, true);
+    // attnOut was reshaped to (tgtSeqLen, embedDim, batchSize) by Forward(),
+    // but the memory of each head is still contiguous.
+    const arma::Mat<eT> out(attnOut.memptr() + i * tgtSeqLen * headDim,
+        tgtSeqLen, headDim, false, true);
+    const arma::Mat<eT> gySlice(const_cast<eT*>(gy.slice_memptr(i)),
+        tgtSeqLen, headDim, false, true);
+
+    arma::Mat<eT> dq(dQuery.slice_memptr(i), tgtSeqLen, headDim, false, true);
+    arma::Mat<eT> dk(dKey.slice_memptr(i), srcSeqLen, headDim, false, true);
+    arma::Mat<eT> dv(dValue.slice_memptr(i), srcSeqLen, headDim, false, true);
+
+    // The backward pass of the softmax subtracts, from the error of every
+    // score, the sum of the errors weighted by the attention weights.  This is
+    // the same as the dot product of the error and the output of the head.
+    const arma::Col<eT> correction = arma::sum(gySlice % out, 1);
+
+    arma::Mat<eT> tile, dTile;
+    for (size_t begin = 0; begin < srcSeqLen; begin += tileSize)
+    {
+      const size_t end = std::min(begin + tileSize, srcSeqLen) - 1;
+      ScoreTile(qSlice, kSlice, begin, end, tile);
+
+      // The attention weights of the tile.
+      tile.each_col() -= logSumExp.col(i);
+      tile = arma::exp(tile);
+
+      dv.rows(begin, end) = arma::trans(tile) * gySlice;
+
+      // The error of the scores of the tile.
+      dTile = gySlice * arma::trans(vSlice.rows(begin, end));
+      dTile.each_col() -= correction;
+      dTile %= tile;
+
+      dq += dTile * kSlice.rows(begin, end);
+      dk.rows(begin, end) = arma::trans(dTile) * qSlice;
+    }
+  }
+}
+
 template <typename InputDataType, typename OutputDataType,
           typename RegularizerType>
 template <typename Archive>
@@ -0,0 +1,192 @@
+/**
+ * @file methods/ann/quantization/quantized_layer.hpp
+ *
+ * Definition of the QuantizedLayer class, an int8 version of the Linear and
+ * Convolution layers used for inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/layer/linear.hpp>
+#include <mlpack/methods/ann/layer/convolution.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * The QuantizedLayer class holds the weights of a trained Linear or
+ * Convolution layer as 8-bit integers, and computes the forward pass of the
+ * layer with integer arithmetic.  Each output unit (or output map) has its own
+ * symmetric weight scale, and the input is quantized with a single symmetric
+ * scale obtained from the range of the layer input on some calibration data.
+ * The products are accumulated in 32-bit integers and then converted back to
+ * floating point, so the layer can be used in place of the original one.
+ *
+ * The quantized weights take an eighth of the memory of the original weights,
+ * but the original layer is not released (see FFN::Quantize()).  The result is
+ * an approximation of the original layer; inputs outside of the calibration
+ * range are clipped.
+ */
+class QuantizedLayer
+{
+ public:
+  //! Create an empty QuantizedLayer object.
+  QuantizedLayer();
+
+  /**
+   * Quantize the given Linear layer.
+   *
+   * @param layer Linear layer to quantize.
+   * @param inputRange Maximum absolute value of the input of the layer.
+   */
+  QuantizedLayer(const Linear<>& layer, const double inputRange);
+
+  /**
+   * Quantize the given Convolution layer.  The input width and height of the
+   * layer must be known, i.e. the layer must have been used for a forward
+   * pass.
+   *
+   * @param layer Convolution layer to quantize.
+   * @param inputRange Maximum absolute value of the input of the layer.
+   */
+  QuantizedLayer(const Convolution<>& layer, const double inputRange);
+
+  /**
+   * Compute the output of the layer for the given input, one point per
+   * column.
+   *
+   * @param input Input data used for evaluating the layer.
+   * @param output Resulting output activation.
+   */
+  void Forward(const arma::mat& input, arma::mat& output) const;
+
+  //! Return whether the layer is empty, i.e. holds no quantized weights.
+  bool IsEmpty() const { return weights.empty(); }
+
+  //! Get the number of input units of the layer.
+  size_t InputSize() const { return inputSize; }
+  //! Get the number of output units of the layer.
+  size_t OutputSize() const { return outputSize; }
+
+  //! Get the width of the output maps of a convolution (0 otherwise).
+  size_t OutputWidth() const { return outputWidth; }
+  //! Get the height of the output maps of a convolution (0 otherwise).
+  size_t OutputHeight() const { return outputHeight; }
+
+  //! Get the scale of the quantized input.
+  double InputScale() const { return inputScale; }
+  //! Get the scales of the quantized weights of each output unit or map.
+  const arma::vec& WeightScales() const { return weightScales; }
+
+  /**
+   * Serialize the layer.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Quantize the given values with the given scale, rounding to the nearest
+   * integer and clipping to [-127, 127].
+   *
+   * @param values Values to quantize.
+   * @param n Number of values.
+   * @param scale Scale of the quantized values.
+   * @param quantized The quantized values.
+   */
+  static void Quantize(const double* values,
+                       const size_t n,
+                       const double scale,
+                       int8_t* quantized);
+
+  /**
+   * Compute the dot product of the given vectors of 8-bit integers, with
+   * 32-bit accumulation.  The loop is simple enough to be vectorized with
+   * integer SIMD instructions by the compiler.
+   */
+  static int32_t Dot(const int8_t* a, const int8_t* b, const size_t n);
+
+  /**
+   * Quantize the weights of each output unit, given as consecutive blocks of
+   * unitSize elements.
+   */
+  void QuantizeWeights(const double* layerWeights, const size_t unitSize);
+
+  //! Compute the forward pass of a quantized Linear layer.
+  void LinearForward(const arma::mat& input, arma::mat& output) const;
+
+  //! Compute the forward pass of a quantized Convolution layer.
+  void ConvolutionForward(const arma::mat& input, arma::mat& output) const;
+
+  //! The number of input units.
+  size_t inputSize;
+
+  //! The number of output units.
+  size_t outputSize;
+
+  //! The quantized weights; the weights of each output unit (or output map)
+  //! are stored consecutively.
+  std::vector<int8_t> weights;
+
+  //! The scale of the weights of each output unit (or output map).
+  arma::vec weightScales;
+
+  //! The bias of each output unit (or output map).
+  arma::vec bias;
+
+  //! The scale of the quantized input.
+  double inputScale;
+
+  //! Whether the layer is a convolution.
+  bool convolution;
+
+  //! The number of input maps of the convolution.
+  size_t inMaps;
+
+  //! The number of output maps of the convolution.
+  size_t outMaps;
+
+  //! The width of the input maps.
+  size_t inputWidth;
+
+  //! The height of the input maps.
+  size_t inputHeight;
+
+  //! The width of the output maps.
+  size_t outputWidth;
+
+  //! The height of the output maps.
+  size_t outputHeight;
+
+  //! The width of the kernel.
+  size_t kernelWidth;
+
+  //! The height of the kernel.
+  size_t kernelHeight;
+
+  //! The stride of the convolution in the x direction.
+  size_t strideWidth;
+
+  //! The stride of the convolution in the y direction.
+  size_t strideHeight;
+
+  //! The left padding of the input maps.
+  size_t padWLeft;
+
+  //! The top padding of the input maps.
+  size_t padHTop;
+}; // class QuantizedLayer
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_layer_impl.hpp"
+
+#endif
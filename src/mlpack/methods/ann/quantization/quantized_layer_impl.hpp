@@ -0,0 +1,269 @@
+/**
+ * @file methods/ann/quantization/quantized_layer_impl.hpp
+ *
+ * Implementation of the QuantizedLayer class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantized_layer.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline QuantizedLayer::QuantizedLayer() :
+    inputSize(0),
+    outputSize(0),
+    inputScale(1.0),
+    convolution(false),
+    inMaps(0),
+    outMaps(0),
+    inputWidth(0),
+    inputHeight(0),
+    outputWidth(0),
+    outputHeight(0),
+    kernelWidth(0),
+    kernelHeight(0),
+    strideWidth(1),
+    strideHeight(1),
+    padWLeft(0),
+    padHTop(0)
+{
+  // Nothing to do here.
+}
+
+inline QuantizedLayer::QuantizedLayer(const Linear<>& layer,
+                                      const double inputRange) :
+    inputSize(layer.InputSize()),
+    outputSize(layer.OutputSize()),
+    bias(arma::vectorise(layer.Bias())),
+    inputScale(inputRange > 0.0 ? inputRange / 127.0 : 1.0),
+    convolution(false),
+    inMaps(0),
+    outMaps(0),
+    inputWidth(0),
+    inputHeight(0),
+    outputWidth(0),
+    outputHeight(0),
+    kernelWidth(0),
+    kernelHeight(0),
+    strideWidth(1),
+    strideHeight(1),
+    padWLeft(0),
+    padHTop(0)
+{
+  // The weights of each output unit are a row of the weight matrix.
+  const arma::mat unitWeights = arma::trans(layer.Weight());
+  QuantizeWeights(unitWeights.memptr(), inputSize);
+}
+
+inline QuantizedLayer::QuantizedLayer(const Convolution<>& layer,
+                                      const double inputRange) :
+    inputSize(layer.InputSize() * layer.InputWidth() * layer.InputHeight()),
+    outputSize(layer.OutputSize() * layer.OutputWidth() *
+        layer.OutputHeight()),
+    bias(arma::vectorise(layer.Bias())),
+    inputScale(inputRange > 0.0 ? inputRange / 127.0 : 1.0),
+    convolution(true),
+    inMaps(layer.InputSize()),
+    outMaps(layer.OutputSize()),
+    inputWidth(layer.InputWidth()),
+    inputHeight(layer.InputHeight()),
+    outputWidth(layer.OutputWidth()),
+    outputHeight(layer.OutputHeight()),
+    kernelWidth(layer.KernelWidth()),
+    kernelHeight(layer.KernelHeight()),
+    strideWidth(layer.StrideWidth()),
+    strideHeight(layer.StrideHeight()),
+    padWLeft(layer.PadWLeft()),
+    padHTop(layer.PadHTop())
+{
+  if (inputSize == 0 || outputSize == 0)
+  {
+    throw std::invalid_argument("QuantizedLayer::QuantizedLayer(): the input "
+        "and output sizes of the convolution are not known; the layer must be "
+        "used for a forward pass first");
+  }
+
+  // The kernels of each output map are consecutive slices of the weight cube.
+  QuantizeWeights(layer.Weight().memptr(), inMaps * kernelWidth *
+      kernelHeight);
+}
+
+inline void QuantizedLayer::Forward(const arma::mat& input,
+                                    arma::mat& output) const
+{
+  if (input.n_rows != inputSize)
+  {
+    Log::Fatal << "QuantizedLayer::Forward(): the input has " << input.n_rows
+        << " dimensions, but the layer expects " << inputSize << "!"
+        << std::endl;
+  }
+
+  if (convolution)
+    ConvolutionForward(input, output);
+  else
+    LinearForward(input, output);
+}
+
+inline void QuantizedLayer::LinearForward(const arma::mat& input,
+                                          arma::mat& output) const
+{
+  std::vector<int8_t> quantizedInput(input.n_elem);
+  Quantize(input.memptr(), input.n_elem, inputScale, quantizedInput.data());
+
+  output.set_size(outputSize, input.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t unit = 0; unit < (omp_size_t) outputSize; ++unit)
+  {
+    const int8_t* unitWeights = weights.data() + unit * inputSize;
+    const double scale = inputScale * weightScales[unit];
+    for (size_t i = 0; i < input.n_cols; ++i)
+    {
+      output(unit, i) = scale * Dot(unitWeights,
+          quantizedInput.data() + i * inputSize, inputSize) + bias[unit];
+    }
+  }
+}
+
+inline void QuantizedLayer::ConvolutionForward(const arma::mat& input,
+                                               arma::mat& output) const
+{
+  std::vector<int8_t> quantizedInput(input.n_elem);
+  Quantize(input.memptr(), input.n_elem, inputScale, quantizedInput.data());
+
+  const size_t patchSize = inMaps * kernelWidth * kernelHeight;
+  const size_t inputMapSize = inputWidth * inputHeight;
+  const size_t outputMapSize = outputWidth * outputHeight;
+
+  output.set_size(outputSize, input.n_cols);
+
+  // Each task computes one column of the output maps of one point.
+  #pragma omp parallel for
+  for (omp_size_t task = 0; task < (omp_size_t) (input.n_cols * outputHeight);
+      ++task)
+  {
+    const size_t point = task / outputHeight;
+    const size_t j = task % outputHeight;
+    const int8_t* pointInput = quantizedInput.data() + point * inputSize;
+
+    std::vector<int8_t> patch(patchSize);
+    for (size_t i = 0; i < outputWidth; ++i)
+    {
+      // Gather the input patch of the output position (i, j), in the same
+      // order as the kernel weights.  As in NaiveConvolution, the rows of the
+      // maps are the width and the columns the height, and the padding is
+      // zero.
+      size_t k = 0;
+      for (size_t inMap = 0; inMap < inMaps; ++inMap)
+      {
+        const int8_t* mapInput = pointInput + inMap * inputMapSize;
+        for (size_t kj = 0; kj < kernelHeight; ++kj)
+        {
+          const size_t col = j * strideHeight + kj;
+          for (size_t ki = 0; ki < kernelWidth; ++ki, ++k)
+          {
+            const size_t row = i * strideWidth + ki;
+            if (row < padWLeft || row - padWLeft >= inputWidth ||
+                col < padHTop || col - padHTop >= inputHeight)
+            {
+              patch[k] = 0;
+            }
+            else
+            {
+              patch[k] = mapInput[(col - padHTop) * inputWidth +
+                  (row - padWLeft)];
+            }
+          }
+        }
+      }
+
+      for (size_t outMap = 0; outMap < outMaps; ++outMap)
+      {
+        output(outMap * outputMapSize + j * outputWidth + i, point) =
+            inputScale * weightScales[outMap] * Dot(weights.data() +
+            outMap * patchSize, patch.data(), patchSize) + bias[outMap];
+      }
+    }
+  }
+}
+
+inline void QuantizedLayer::QuantizeWeights(const double* layerWeights,
+                                            const size_t unitSize)
+{
+  const size_t units = bias.n_elem;
+  weights.resize(units * unitSize);
+  weightScales.set_size(units);
+
+  for (size_t unit = 0; unit < units; ++unit)
+  {
+    const double* unitWeights = layerWeights + unit * unitSize;
+
+    double range = 0.0;
+    for (size_t k = 0; k < unitSize; ++k)
+      range = std::max(range, std::abs(unitWeights[k]));
+
+    weightScales[unit] = (range > 0.0) ? range / 127.0 : 1.0;
+    Quantize(unitWeights, unitSize, weightScales[unit],
+        weights.data() + unit * unitSize);
+  }
+}
+
+inline void QuantizedLayer::Quantize(const double* values,
+                                     const size_t n,
+                                     const double scale,
+                                     int8_t* quantized)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    const double value = std::round(values[i] / scale);
+    quantized[i] = (int8_t) std::min(127.0, std::max(-127.0, value));
+  }
+}
+
+inline int32_t QuantizedLayer::Dot(const int8_t* a,
+                                   const int8_t* b,
+                                   const size_t n)
+{
+  int32_t sum = 0;
+  for (size_t i = 0; i < n; ++i)
+    sum += (int32_t) a[i] * (int32_t) b[i];
+
+  return sum;
+}
+
+template<typename Archive>
+void QuantizedLayer::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(inputSize);
+  ar & BOOST_SERIALIZATION_NVP(outputSize);
+  ar & BOOST_SERIALIZATION_NVP(weights);
+  ar & BOOST_SERIALIZATION_NVP(weightScales);
+  ar & BOOST_SERIALIZATION_NVP(bias);
+  ar & BOOST_SERIALIZATION_NVP(inputScale);
+  ar & BOOST_SERIALIZATION_NVP(convolution);
+  ar & BOOST_SERIALIZATION_NVP(inMaps);
+  ar & BOOST_SERIALIZATION_NVP(outMaps);
+  ar & BOOST_SERIALIZATION_NVP(inputWidth);
+  ar & BOOST_SERIALIZATION_NVP(inputHeight);
+  ar & BOOST_SERIALIZATION_NVP(outputWidth);
+  ar & BOOST_SERIALIZATION_NVP(outputHeight);
+  ar & BOOST_SERIALIZATION_NVP(kernelWidth);
+  ar & BOOST_SERIALIZATION_NVP(kernelHeight);
+  ar & BOOST_SERIALIZATION_NVP(strideWidth);
+  ar & BOOST_SERIALIZATION_NVP(strideHeight);
+  ar & BOOST_SERIALIZATION_NVP(padWLeft);
+  ar & BOOST_SERIALIZATION_NVP(padHTop);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -21,6 +21,8 @@
 
 #include "init_rules/network_init.hpp"
 
+#include <mlpack/core/data/batch_loader.hpp>
+
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/layer/layer_traits.hpp>
@@ -32,23 +34,39 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 /**
- * Implementation of a standard recurrent neural network container.
+ * Implementation of a standard recurrent neural network container on the given
+ * matrix type.  Most code will use the RNN alias below, which works on
+ * arma::mat.
  *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam MatType Type of the parameters of the network and of the time steps
+ *         of the data (arma::mat or arma::fmat); the data is a cube of the
+ *         same element type.  All the modules of the network must work on this
+ *         matrix type.
+ * @tparam CustomLayers Any set of custom layers that could be a part of the
+ *         recurrent network.
  */
 template<
   typename OutputLayerType = NegativeLogLikelihood<>,
   typename InitializationRuleType = RandomInitialization,
+  typename MatType = arma::mat,
   typename... CustomLayers
 >
-class RNN
+class RNNType
 {
  public:
   //! Convenience typedef for the internal model construction.
-  using NetworkType = RNN<OutputLayerType,
-                          InitializationRuleType,
-                          CustomLayers...>;
+  using NetworkType = RNNType<OutputLayerType,
+                              InitializationRuleType,
+                              MatType,
+                              CustomLayers...>;
+
+  //! The element type of the data and parameters of the network.
+  typedef typename MatType::elem_type ElemType;
+
+  //! The type of the sequences of data.
+  typedef arma::Cube<ElemType> CubeType;
 
   /**
    * Create the RNN object.
@@ -60,18 +78,19 @@ class RNN
    * object, be sure to use std::move to avoid unnecessary copy.
    *
    * @param rho Maximum number of steps to backpropagate through time (BPTT).
+   *     Longer sequences are processed in consecutive windows of rho steps.
    * @param single Predict only the last element of the input sequence.
    * @param outputLayer Output layer used to evaluate the network.
    * @param initializeRule Optional instantiated InitializationRule object
    *        for initializing the network parameter.
    */
-  RNN(const size_t rho,
+  RNNType(const size_t rho,
       const bool single = false,
       OutputLayerType outputLayer = OutputLayerType(),
       InitializationRuleType initializeRule = InitializationRuleType());
 
   //! Destructor to release allocated memory.
-  ~RNN();
+  ~RNNType();
 
   /**
    * Check if the optimizer has MaxIterations() parameter, if it does
@@ -120,6 +139,13 @@ class RNN
    * So, e.g., predictors(i, j, k) is the i'th dimension of the j'th data point
    * at time slice k.
    *
+   * The sequences may be longer than rho.  In that case truncated
+   * backpropagation through time is used: the sequences are processed in
+   * consecutive windows of rho time steps, the recurrent layers carry their
+   * state from one window to the next, and the gradient is backpropagated
+   * within each window only.  So only the activations of one window are kept
+   * in memory.
+   *
    * @tparam OptimizerType Type of optimizer to use to train the model.
    * @tparam CallbackTypes Types of Callback Functions.
    * @param predictors Input training variables.
@@ -130,8 +156,8 @@ class RNN
    * @return The final objective of the trained model (NaN or Inf on error).
    */
   template<typename OptimizerType, typename... CallbackTypes>
-  double Train(arma::cube predictors,
-               arma::cube responses,
+  double Train(CubeType predictors,
+               CubeType responses,
                OptimizerType& optimizer,
                CallbackTypes&&... callbacks);
 
@@ -163,8 +189,31 @@ class RNN
    * @return The final objective of the trained model (NaN or Inf on error).
    */
   template<typename OptimizerType = ens::StandardSGD, typename... CallbackTypes>
-  double Train(arma::cube predictors,
-               arma::cube responses,
+  double Train(CubeType predictors,
+               CubeType responses,
+               CallbackTypes&&... callbacks);
+
+  /**
+   * Train the recurrent network on the batches of the given loader, which are
+   * decoded in the background while the network is trained on the current
+   * batch.  The batches of predictors and responses have the same layout as
+   * the predictors and responses given to the other Train() overloads.  Each
+   * evaluation of the optimizer uses the next batch of the loader, so the
+   * optimizer must be one that visits the points in batches, such as ens::SGD
+   * or ens::Adam, and its batch size must be the same as the batch size of the
+   * loader.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @tparam CallbackTypes Types of Callback Functions.
+   * @param loader Loader of the batches of predictors and responses.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @param callbacks Callback function for ensmallen optimizer `OptimizerType`.
+   *      See https://www.ensmallen.org/docs.html#callback-documentation.
+   * @return The final objective of the trained model (NaN or Inf on error).
+   */
+  template<typename OptimizerType, typename... CallbackTypes>
+  double Train(data::BatchLoader<CubeType, CubeType>& loader,
+               OptimizerType& optimizer,
                CallbackTypes&&... callbacks);
 
   /**
@@ -186,10 +235,28 @@ class RNN
    * @param results Matrix to put output predictions of responses into.
    * @param batchSize Number of points to predict at once.
    */
-  void Predict(arma::cube predictors,
-               arma::cube& results,
+  void Predict(CubeType predictors,
+               CubeType& results,
                const size_t batchSize = 256);
 
+  /**
+   * Predict the responses to the next time step of a set of sequences, one
+   * column per sequence.  The recurrent layers continue from the state left
+   * by the last call, so a stream of any length can be processed one time step
+   * at a time with constant memory.  Call ResetState() before the first time
+   * step of new sequences.
+   *
+   * @param predictors Input predictors of the next time step.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  void PredictStep(const MatType& predictors, MatType& results);
+
+  /**
+   * Reset the state of the recurrent layers, so that the next call to
+   * PredictStep() starts new sequences.
+   */
+  void ResetState();
+
   /**
    * Evaluate the recurrent neural network with the given parameters. This
    * function is usually called by the optimizer to train the model.
@@ -202,10 +269,10 @@ class RNN
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
-  double Evaluate(const arma::mat& parameters,
-                  const size_t begin,
-                  const size_t batchSize,
-                  const bool deterministic);
+  ElemType Evaluate(const MatType& parameters,
+                    const size_t begin,
+                    const size_t batchSize,
+                    const bool deterministic);
 
   /**
    * Evaluate the recurrent neural network with the given parameters. This
@@ -218,9 +285,9 @@ class RNN
    * @param batchSize Number of points to be passed at a time to use for
    *        objective function evaluation.
    */
-  double Evaluate(const arma::mat& parameters,
-                  const size_t begin,
-                  const size_t batchSize);
+  ElemType Evaluate(const MatType& parameters,
+                    const size_t begin,
+                    const size_t batchSize);
 
   /**
    * Evaluate the recurrent neural network with the given parameters. This
@@ -234,10 +301,10 @@ class RNN
    *        objective function evaluation.
    */
   template<typename GradType>
-  double EvaluateWithGradient(const arma::mat& parameters,
-                              const size_t begin,
-                              GradType& gradient,
-                              const size_t batchSize);
+  ElemType EvaluateWithGradient(const MatType& parameters,
+                                const size_t begin,
+                                GradType& gradient,
+                                const size_t batchSize);
 
   /**
    * Evaluate the gradient of the recurrent neural network with the given
@@ -252,9 +319,9 @@ class RNN
    * @param batchSize Number of points to be processed as a batch for objective
    *        function gradient evaluation.
    */
-  void Gradient(const arma::mat& parameters,
+  void Gradient(const MatType& parameters,
                 const size_t begin,
-                arma::mat& gradient,
+                MatType& gradient,
                 const size_t batchSize);
 
   /**
@@ -282,9 +349,9 @@ class RNN
   size_t NumFunctions() const { return numFunctions; }
 
   //! Return the initial point for the optimization.
-  const arma::mat& Parameters() const { return parameter; }
+  const MatType& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
-  arma::mat& Parameters() { return parameter; }
+  MatType& Parameters() { return parameter; }
 
   //! Return the maximum length of backpropagation through time.
   const size_t& Rho() const { return rho; }
@@ -292,14 +359,14 @@ class RNN
   size_t& Rho() { return rho; }
 
   //! Get the matrix of responses to the input data points.
-  const arma::cube& Responses() const { return responses; }
+  const CubeType& Responses() const { return responses; }
   //! Modify the matrix of responses to the input data points.
-  arma::cube& Responses() { return responses; }
+  CubeType& Responses() { return responses; }
 
   //! Get the matrix of data points (predictors).
-  const arma::cube& Predictors() const { return predictors; }
+  const CubeType& Predictors() const { return predictors; }
   //! Modify the matrix of data points (predictors).
-  arma::cube& Predictors() { return predictors; }
+  CubeType& Predictors() { return predictors; }
 
   /**
    * Reset the state of the network.  This ensures that all internally-held
@@ -328,11 +395,30 @@ class RNN
   template<typename InputType>
   void Forward(const InputType& input);
 
+  /**
+   * If the network is trained from a loader, replace the predictors and
+   * responses with the next batch of the loader and return 0, the index of the
+   * first sequence of the batch; otherwise, return the given index.
+   *
+   * @param begin Index of the first sequence of the batch.
+   * @param batchSize Number of sequences in the batch.
+   */
+  size_t LoadBatch(const size_t begin, const size_t batchSize);
+
   /**
    * Reset the state of RNN cells in the network for new input sequence.
    */
   void ResetCells();
 
+  /**
+   * Reset the state of RNN cells in the network for new input sequences that
+   * may be longer than the given number of steps; the cells keep their state
+   * after each window of that many steps.
+   *
+   * @param size Number of steps of a window.
+   */
+  void ResetStatefulCells(const size_t size);
+
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
    * backward pass for module.
@@ -355,7 +441,7 @@ class RNN
   /**
    * Reset the gradient for all modules that implement the Gradient function.
    */
-  void ResetGradients(arma::mat& gradient);
+  void ResetGradients(MatType& gradient);
 
   //! Number of steps to backpropagate through time (BPTT).
   size_t rho;
@@ -386,28 +472,28 @@ class RNN
   std::vector<LayerTypes<CustomLayers...> > network;
 
   //! The matrix of data points (predictors).
-  arma::cube predictors;
+  CubeType predictors;
 
   //! The matrix of responses to the input data points.
-  arma::cube responses;
+  CubeType responses;
 
   //! Matrix of (trained) parameters.
-  arma::mat parameter;
+  MatType parameter;
 
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
   //! The current error for the backward pass.
-  arma::mat error;
+  MatType error;
 
   //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
+  DeltaVisitorType<MatType> deltaVisitor;
 
   //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
+  OutputParameterVisitorType<MatType> outputParameterVisitor;
 
   //! List of all module parameters for the backward pass (BBTT).
-  std::vector<arma::mat> moduleOutputParameter;
+  std::vector<MatType> moduleOutputParameter;
 
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
@@ -422,7 +508,10 @@ class RNN
   bool deterministic;
 
   //! The current gradient for the gradient pass.
-  arma::mat currentGradient;
+  MatType currentGradient;
+
+  //! The loader the network is trained from, if any.
+  data::BatchLoader<CubeType, CubeType>* loader;
 
   // The BRN class should have access to internal members.
   template<
@@ -433,7 +522,23 @@ class RNN
     typename... CustomLayers1
   >
   friend class BRNN;
-}; // class RNN
+}; // class RNNType
+
+/**
+ * Standard recurrent neural network container of arma::mat; see RNNType.
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam CustomLayers Any set of custom layers that could be a part of the
+ *         recurrent network.
+ */
+template<
+  typename OutputLayerType = NegativeLogLikelihood<>,
+  typename InitializationRuleType = RandomInitialization,
+  typename... CustomLayers
+>
+using RNN = RNNType<OutputLayerType, InitializationRuleType, arma::mat,
+                    CustomLayers...>;
 
 } // namespace ann
 } // namespace mlpack
@@ -445,9 +550,12 @@ namespace serialization {
 
 template<typename OutputLayerType,
          typename InitializationRuleType,
+         typename MatType,
          typename... CustomLayer>
-struct version<
-    mlpack::ann::RNN<OutputLayerType, InitializationRuleType, CustomLayer...>>
+struct version<mlpack::ann::RNNType<OutputLayerType,
+                                    InitializationRuleType,
+                                    MatType,
+                                    CustomLayer...>>
 {
   BOOST_STATIC_CONSTANT(int, value = 1);
 };
@@ -20,6 +20,7 @@
 #include "visitor/forward_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
 #include "visitor/reset_cell_visitor.hpp"
+#include "visitor/stateful_set_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
@@ -31,8 +32,9 @@ namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::RNN(
+         typename MatType, typename... CustomLayers>
+RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::RNNType(
     const size_t rho,
     const bool single,
     OutputLayerType outputLayer,
@@ -46,14 +48,16 @@ RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::RNN(
     reset(false),
     single(single),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    loader(NULL)
 {
   /* Nothing to do here */
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::~RNN()
+         typename MatType, typename... CustomLayers>
+RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::~RNNType()
 {
   for (LayerTypes<CustomLayers...>& layer : network)
   {
@@ -62,12 +66,12 @@ RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::~RNN()
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType>
 typename std::enable_if<
       HasMaxIterations<OptimizerType, size_t&(OptimizerType::*)()>
       ::value, void>::type
-RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+RNNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
 WarnMessageMaxIterations(OptimizerType& optimizer, size_t samples) const
 {
   if (optimizer.MaxIterations() < samples &&
@@ -84,12 +88,12 @@ WarnMessageMaxIterations(OptimizerType& optimizer, size_t samples) const
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType>
 typename std::enable_if<
       !HasMaxIterations<OptimizerType, size_t&(OptimizerType::*)()>
       ::value, void>::type
-RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
+RNNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
 WarnMessageMaxIterations(OptimizerType& /* optimizer */,
                          size_t /* samples */) const
 {
@@ -97,11 +101,12 @@ WarnMessageMaxIterations(OptimizerType& /* optimizer */,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType, typename... CallbackTypes>
-double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
-    arma::cube predictors,
-    arma::cube responses,
+double RNNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Train(
+    CubeType predictors,
+    CubeType responses,
     OptimizerType& optimizer,
     CallbackTypes&&... callbacks)
 {
@@ -109,6 +114,7 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
+  this->loader = NULL;
 
   this->deterministic = true;
   ResetDeterministic();
@@ -131,9 +137,58 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetCells()
+         typename MatType, typename... CustomLayers>
+template<typename OptimizerType, typename... CallbackTypes>
+double RNNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Train(
+    data::BatchLoader<CubeType, CubeType>& loader,
+    OptimizerType& optimizer,
+    CallbackTypes&&... callbacks)
+{
+  numFunctions = loader.NumPoints();
+
+  // The predictors and responses only hold the current batch.
+  predictors.clear();
+  responses.clear();
+  this->loader = &loader;
+
+  this->deterministic = true;
+  ResetDeterministic();
+
+  if (!reset)
+  {
+    ResetParameters();
+  }
+
+  // Stop using the loader when the training ends, even if the optimizer
+  // throws; the network then holds the last batch.
+  struct LoaderReset
+  {
+    ~LoaderReset()
+    {
+      network.loader = NULL;
+      network.numFunctions = network.responses.n_cols;
+    }
+
+    RNNType& network;
+  } loaderReset = { *this };
+
+  WarnMessageMaxIterations<OptimizerType>(optimizer, numFunctions);
+
+  // Train the model.
+  Timer::Start("rnn_optimization");
+  const double out = optimizer.Optimize(*this, parameter, callbacks...);
+  Timer::Stop("rnn_optimization");
+
+  Log::Info << "RNN::RNN(): final objective of trained model is " << out
+      << "." << std::endl;
+  return out;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetCells()
 {
   for (size_t i = 1; i < network.size(); ++i)
   {
@@ -142,17 +197,31 @@ void RNN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetStatefulCells(const size_t size)
+{
+  for (size_t i = 1; i < network.size(); ++i)
+  {
+    boost::apply_visitor(StatefulSetVisitor(true), network[i]);
+    boost::apply_visitor(ResetCellVisitor(size), network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
 template<typename OptimizerType, typename... CallbackTypes>
-double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
-    arma::cube predictors,
-    arma::cube responses,
+double RNNType<OutputLayerType, InitializationRuleType, MatType,
+           CustomLayers...>::Train(
+    CubeType predictors,
+    CubeType responses,
     CallbackTypes&&... callbacks)
 {
   numFunctions = responses.n_cols;
 
   this->predictors = std::move(predictors);
   this->responses = std::move(responses);
+  this->loader = NULL;
 
   this->deterministic = true;
   ResetDeterministic();
@@ -177,11 +246,12 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Train(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
-    arma::cube predictors, arma::cube& results, const size_t batchSize)
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Predict(
+    CubeType predictors, CubeType& results, const size_t batchSize)
 {
-  ResetCells();
+  ResetStatefulCells(rho);
 
   if (parameter.is_empty())
   {
@@ -197,13 +267,14 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
   const size_t effectiveBatchSize = std::min(batchSize,
       size_t(predictors.n_cols));
 
-  Forward(arma::mat(predictors.slice(0).colptr(0), predictors.n_rows,
+  Forward(MatType(predictors.slice(0).colptr(0), predictors.n_rows,
       effectiveBatchSize, false, true));
-  arma::mat resultsTemp = boost::apply_visitor(outputParameterVisitor,
+  MatType resultsTemp = boost::apply_visitor(outputParameterVisitor,
       network.back());
 
   outputSize = resultsTemp.n_rows;
-  results = arma::zeros<arma::cube>(outputSize, predictors.n_cols, rho);
+  results = arma::zeros<CubeType>(outputSize, predictors.n_cols,
+      predictors.n_slices);
   results.slice(0).submat(0, 0, results.n_rows - 1,
       effectiveBatchSize - 1) = resultsTemp;
 
@@ -212,9 +283,14 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
   {
     const size_t effectiveBatchSize = std::min(batchSize,
         size_t(predictors.n_cols - begin));
-    for (size_t seqNum = !begin; seqNum < rho; ++seqNum)
+
+    // Each batch holds new sequences.
+    if (begin > 0)
+      ResetStatefulCells(rho);
+
+    for (size_t seqNum = !begin; seqNum < predictors.n_slices; ++seqNum)
     {
-      Forward(arma::mat(predictors.slice(seqNum).colptr(begin),
+      Forward(MatType(predictors.slice(seqNum).colptr(begin),
           predictors.n_rows, effectiveBatchSize, false, true));
 
       results.slice(seqNum).submat(0, begin, results.n_rows - 1, begin +
@@ -225,13 +301,48 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Predict(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
-    const arma::mat& /* parameters */,
-    const size_t begin,
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+PredictStep(const MatType& predictors, MatType& results)
+{
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  Forward(predictors);
+  results = boost::apply_visitor(outputParameterVisitor, network.back());
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+ResetState()
+{
+  // The cells only have to store a single step, since nothing is
+  // backpropagated.
+  ResetStatefulCells(1);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+typename MatType::elem_type RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::Evaluate(
+    const MatType& /* parameters */,
+    const size_t batchBegin,
     const size_t batchSize,
     const bool deterministic)
 {
+  const size_t begin = LoadBatch(batchBegin, batchSize);
+
   if (parameter.is_empty())
   {
     ResetParameters();
@@ -253,15 +364,22 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
     targetSize = responses.n_rows;
   }
 
-  ResetCells();
+  // Sequences longer than rho are processed in windows of rho steps, and the
+  // recurrent layers carry their state from one window to the next.
+  ResetStatefulCells(rho);
+
+  // If only the last element of the sequence has a response, only the last
+  // window counts towards the loss, as in EvaluateWithGradient().
+  const size_t lossBegin = single ?
+      ((predictors.n_slices - 1) / rho) * rho : 0;
 
   double performance = 0;
   size_t responseSeq = 0;
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < predictors.n_slices; ++seqNum)
   {
     // Wrap a matrix around our data to avoid a copy.
-    arma::mat stepData(predictors.slice(seqNum).colptr(begin),
+    MatType stepData(predictors.slice(seqNum).colptr(begin),
         predictors.n_rows, batchSize, false, true);
     Forward(stepData);
     if (!single)
@@ -269,9 +387,12 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
       responseSeq = seqNum;
     }
 
+    if (seqNum < lossBegin)
+      continue;
+
     performance += outputLayer.Forward(boost::apply_visitor(
         outputParameterVisitor, network.back()),
-        arma::mat(responses.slice(responseSeq).colptr(begin),
+        MatType(responses.slice(responseSeq).colptr(begin),
             responses.n_rows, batchSize, false, true));
   }
 
@@ -285,9 +406,10 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
-    const arma::mat& parameters,
+         typename MatType, typename... CustomLayers>
+typename MatType::elem_type RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::Evaluate(
+    const MatType& parameters,
     const size_t begin,
     const size_t batchSize)
 {
@@ -295,14 +417,17 @@ double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Evaluate(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename GradType>
-double RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::
-EvaluateWithGradient(const arma::mat& /* parameters */,
-                     const size_t begin,
+typename MatType::elem_type
+RNNType<OutputLayerType, InitializationRuleType, MatType, CustomLayers...>::
+EvaluateWithGradient(const MatType& /* parameters */,
+                     const size_t batchBegin,
                      GradType& gradient,
                      const size_t batchSize)
 {
+  const size_t begin = LoadBatch(batchBegin, batchSize);
+
   // Initialize passed gradient.
   if (gradient.is_empty())
   {
@@ -311,7 +436,7 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
       ResetParameters();
     }
 
-    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+    gradient = arma::zeros<MatType>(parameter.n_rows, parameter.n_cols);
   }
   else
   {
@@ -334,104 +459,146 @@ EvaluateWithGradient(const arma::mat& /* parameters */,
     targetSize = responses.n_rows;
   }
 
-  ResetCells();
+  // Truncated backpropagation through time: the sequences are processed in
+  // consecutive windows of rho steps.  The recurrent layers carry their state
+  // from one window to the next, but the gradient is only backpropagated within
+  // a window, so only the activations of one window are stored.
+  ResetStatefulCells(rho);
 
   double performance = 0;
-  size_t responseSeq = 0;
-  const size_t effectiveRho = std::min(rho, size_t(responses.size()));
-
-  for (size_t seqNum = 0; seqNum < effectiveRho; ++seqNum)
+  const size_t sequenceLength = predictors.n_slices;
+  for (size_t windowBegin = 0; windowBegin < sequenceLength;
+      windowBegin += rho)
   {
-    // Wrap a matrix around our data to avoid a copy.
-    arma::mat stepData(predictors.slice(seqNum).colptr(begin),
-        predictors.n_rows, batchSize, false, true);
-    Forward(stepData);
-    if (!single)
+    const size_t windowSize = std::min(rho, sequenceLength - windowBegin);
+
+    // If only the last element of the sequence has a response, the windows
+    // before the last one do not get an error.
+    const bool backpropagate = !single ||
+        (windowBegin + windowSize == sequenceLength);
+
+    for (size_t step = 0; step < windowSize; ++step)
     {
-      responseSeq = seqNum;
+      const size_t seqNum = windowBegin + step;
+
+      // Wrap a matrix around our data to avoid a copy.
+      MatType stepData(predictors.slice(seqNum).colptr(begin),
+          predictors.n_rows, batchSize, false, true);
+      Forward(stepData);
+
+      if (backpropagate)
+      {
+        for (size_t l = 0; l < network.size(); ++l)
+        {
+          boost::apply_visitor(SaveOutputParameterVisitorType<MatType>(
+              moduleOutputParameter), network[l]);
+        }
+      }
+
+      // A window that gets no error does not count towards the loss either.
+      if (backpropagate)
+      {
+        performance += outputLayer.Forward(boost::apply_visitor(
+            outputParameterVisitor, network.back()),
+            MatType(responses.slice(single ? 0 : seqNum).colptr(begin),
+                responses.n_rows, batchSize, false, true));
+      }
     }
 
-    for (size_t l = 0; l < network.size(); ++l)
+    if (outputSize == 0)
     {
-      boost::apply_visitor(SaveOutputParameterVisitor(moduleOutputParameter),
-          network[l]);
+      outputSize = boost::apply_visitor(outputParameterVisitor,
+          network.back()).n_elem / batchSize;
     }
 
-    performance += outputLayer.Forward(boost::apply_visitor(
-        outputParameterVisitor, network.back()),
-        arma::mat(responses.slice(responseSeq).colptr(begin),
-            responses.n_rows, batchSize, false, true));
-  }
+    if (!backpropagate)
+      continue;
 
-  if (outputSize == 0)
-  {
-    outputSize = boost::apply_visitor(outputParameterVisitor,
-        network.back()).n_elem / batchSize;
-  }
-
-  // Initialize current/working gradient.
-  if (currentGradient.is_empty())
-  {
-    currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
-        parameter.n_cols);
-  }
-
-  ResetGradients(currentGradient);
-
-  for (size_t seqNum = 0; seqNum < effectiveRho; ++seqNum)
-  {
-    currentGradient.zeros();
-    for (size_t l = 0; l < network.size(); ++l)
+    // Initialize current/working gradient.
+    if (currentGradient.is_empty())
     {
-      boost::apply_visitor(LoadOutputParameterVisitor(moduleOutputParameter),
-          network[network.size() - 1 - l]);
+      currentGradient = arma::zeros<MatType>(parameter.n_rows,
+          parameter.n_cols);
     }
 
-    if (single && seqNum > 0)
-    {
-      error.zeros();
-    }
-    else if (single && seqNum == 0)
-    {
-      outputLayer.Backward(boost::apply_visitor(
-          outputParameterVisitor, network.back()),
-          arma::mat(responses.slice(0).colptr(begin),
-          responses.n_rows, batchSize, false, true), error);
-    }
-    else
+    ResetGradients(currentGradient);
+
+    for (size_t step = 0; step < windowSize; ++step)
     {
-      outputLayer.Backward(boost::apply_visitor(
-          outputParameterVisitor, network.back()),
-          arma::mat(responses.slice(effectiveRho - seqNum - 1).colptr(begin),
-          responses.n_rows, batchSize, false, true), error);
+      const size_t seqNum = windowBegin + windowSize - step - 1;
+
+      currentGradient.zeros();
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(LoadOutputParameterVisitorType<MatType>(
+            moduleOutputParameter), network[network.size() - 1 - l]);
+      }
+
+      if (single && step > 0)
+      {
+        error.zeros();
+      }
+      else
+      {
+        outputLayer.Backward(boost::apply_visitor(
+            outputParameterVisitor, network.back()),
+            MatType(responses.slice(single ? 0 : seqNum).colptr(begin),
+            responses.n_rows, batchSize, false, true), error);
+      }
+
+      Backward();
+      Gradient(MatType(predictors.slice(seqNum).colptr(begin),
+          predictors.n_rows, batchSize, false, true));
+      gradient += currentGradient;
     }
-
-    Backward();
-    Gradient(
-        arma::mat(predictors.slice(effectiveRho - seqNum - 1).colptr(begin),
-        predictors.n_rows, batchSize, false, true));
-    gradient += currentGradient;
   }
 
   return performance;
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Gradient(
-    const arma::mat& parameters,
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Gradient(
+    const MatType& parameters,
     const size_t begin,
-    arma::mat& gradient,
+    MatType& gradient,
     const size_t batchSize)
 {
   this->EvaluateWithGradient(parameters, begin, gradient, batchSize);
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Shuffle()
+         typename MatType, typename... CustomLayers>
+size_t RNNType<OutputLayerType, InitializationRuleType,
+    MatType, CustomLayers...>::
+LoadBatch(const size_t begin, const size_t batchSize)
 {
-  arma::cube newPredictors, newResponses;
+  if (loader == NULL)
+    return begin;
+
+  loader->Next(predictors, responses);
+  if (predictors.n_cols != batchSize)
+  {
+    Log::Fatal << "RNN::LoadBatch(): the loader returned a batch of "
+        << predictors.n_cols << " sequences, but " << batchSize << " sequences "
+        << "were requested; the batch size of the optimizer must be the same "
+        << "as the batch size of the loader!" << std::endl;
+  }
+
+  return 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType,
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Shuffle()
+{
+  // The loader shuffles the sequences of each epoch itself.
+  if (loader != NULL)
+    return;
+
+  CubeType newPredictors, newResponses;
   math::ShuffleData(predictors, responses, newPredictors, newResponses);
 
   predictors = std::move(newPredictors);
@@ -439,9 +606,9 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Shuffle()
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetParameters()
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetParameters()
 {
   ResetDeterministic();
 
@@ -454,8 +621,9 @@ void RNN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Reset()
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Reset()
 {
   ResetParameters();
   ResetCells();
@@ -464,9 +632,9 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Reset()
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetDeterministic()
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetDeterministic()
 {
   DeterministicSetVisitor deterministicSetVisitor(deterministic);
   std::for_each(network.begin(), network.end(),
@@ -474,31 +642,32 @@ void RNN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::ResetGradients(
-    arma::mat& gradient)
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::ResetGradients(
+    MatType& gradient)
 {
   size_t offset = 0;
   for (LayerTypes<CustomLayers...>& layer : network)
   {
-    offset += boost::apply_visitor(GradientSetVisitor(gradient, offset), layer);
+    offset += boost::apply_visitor(
+        GradientSetVisitorType<MatType>(gradient, offset), layer);
   }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename InputType>
-void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::Forward(const InputType& input)
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::Forward(const InputType& input)
 {
-  boost::apply_visitor(ForwardVisitor(input,
+  boost::apply_visitor(ForwardVisitorType<MatType>(input,
       boost::apply_visitor(outputParameterVisitor, network.front())),
       network.front());
 
   for (size_t i = 1; i < network.size(); ++i)
   {
-    boost::apply_visitor(ForwardVisitor(
+    boost::apply_visitor(ForwardVisitorType<MatType>(
         boost::apply_visitor(outputParameterVisitor, network[i - 1]),
         boost::apply_visitor(outputParameterVisitor, network[i])),
         network[i]);
@@ -506,17 +675,18 @@ void RNN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
-void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward()
+         typename MatType, typename... CustomLayers>
+void RNNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::Backward()
 {
-  boost::apply_visitor(BackwardVisitor(
+  boost::apply_visitor(BackwardVisitorType<MatType>(
         boost::apply_visitor(outputParameterVisitor, network.back()),
         error, boost::apply_visitor(deltaVisitor,
         network.back())), network.back());
 
   for (size_t i = 2; i < network.size(); ++i)
   {
-    boost::apply_visitor(BackwardVisitor(
+    boost::apply_visitor(BackwardVisitorType<MatType>(
         boost::apply_visitor(outputParameterVisitor,
         network[network.size() - i]), boost::apply_visitor(
         deltaVisitor, network[network.size() - i + 1]),
@@ -526,17 +696,17 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::Backward()
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename InputType>
-void RNN<OutputLayerType, InitializationRuleType,
-         CustomLayers...>::Gradient(const InputType& input)
+void RNNType<OutputLayerType, InitializationRuleType,
+         MatType, CustomLayers...>::Gradient(const InputType& input)
 {
-  boost::apply_visitor(GradientVisitor(input,
+  boost::apply_visitor(GradientVisitorType<MatType>(input,
       boost::apply_visitor(deltaVisitor, network[1])), network.front());
 
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
-    boost::apply_visitor(GradientVisitor(
+    boost::apply_visitor(GradientVisitorType<MatType>(
         boost::apply_visitor(outputParameterVisitor, network[i - 1]),
         boost::apply_visitor(deltaVisitor, network[i + 1])),
         network[i]);
@@ -544,9 +714,10 @@ void RNN<OutputLayerType, InitializationRuleType,
 }
 
 template<typename OutputLayerType, typename InitializationRuleType,
-         typename... CustomLayers>
+         typename MatType, typename... CustomLayers>
 template<typename Archive>
-void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
+void RNNType<OutputLayerType, InitializationRuleType, MatType,
+         CustomLayers...>::serialize(
     Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(parameter);
@@ -582,8 +753,8 @@ void RNN<OutputLayerType, InitializationRuleType, CustomLayers...>::serialize(
     size_t offset = 0;
     for (LayerTypes<CustomLayers...>& layer : network)
     {
-      offset += boost::apply_visitor(WeightSetVisitor(parameter, offset),
-          layer);
+      offset += boost::apply_visitor(
+          WeightSetVisitorType<MatType>(parameter, offset), layer);
 
       boost::apply_visitor(resetVisitor, layer);
     }
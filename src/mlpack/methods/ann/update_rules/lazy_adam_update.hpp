@@ -0,0 +1,180 @@
+/**
+ * @file methods/ann/update_rules/lazy_adam_update.hpp
+ *
+ * Lazy Adam update rule for ens::AdamType, for the sparse gradients of networks
+ * with large embedding tables.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_UPDATE_RULES_LAZY_ADAM_UPDATE_HPP
+#define MLPACK_METHODS_ANN_UPDATE_RULES_LAZY_ADAM_UPDATE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Lazy Adam update rule, to be used as the UpdateRule of ens::AdamType.  Adam
+ * decays the moment estimates of every parameter and updates every parameter
+ * at each step.  With a sparse gradient, such as the one FFN gives for a
+ * network with a Lookup layer, the lazy update only visits the entries that
+ * are stored in the gradient: their moments and values are updated as in
+ * Adam, and the other entries and their moments are left alone.  So, an entry
+ * that is in the gradient at every step is trained exactly as with Adam, and
+ * the cost of a step only depends on the number of stored entries.  With a
+ * dense gradient, every entry is updated as in Adam.
+ *
+ * @code
+ * ens::AdamType<LazyAdamUpdate> optimizer(0.001, 32);
+ * model.Train<ens::AdamType<LazyAdamUpdate>, arma::sp_mat>(data, labels,
+ *     optimizer);
+ * @endcode
+ */
+class LazyAdamUpdate
+{
+ public:
+  /**
+   * Construct the lazy Adam update rule with the given parameters.
+   *
+   * @param epsilon The epsilon value used to initialise the squared gradient
+   *        parameter.
+   * @param beta1 The smoothing parameter.
+   * @param beta2 The second moment coefficient.
+   */
+  LazyAdamUpdate(const double epsilon = 1e-8,
+                 const double beta1 = 0.9,
+                 const double beta2 = 0.999) :
+      epsilon(epsilon),
+      beta1(beta1),
+      beta2(beta2)
+  {
+    // Nothing to do.
+  }
+
+  //! Get the value used to initialise the squared gradient parameter.
+  double Epsilon() const { return epsilon; }
+  //! Modify the value used to initialise the squared gradient parameter.
+  double& Epsilon() { return epsilon; }
+
+  //! Get the smoothing parameter.
+  double Beta1() const { return beta1; }
+  //! Modify the smoothing parameter.
+  double& Beta1() { return beta1; }
+
+  //! Get the second moment coefficient.
+  double Beta2() const { return beta2; }
+  //! Modify the second moment coefficient.
+  double& Beta2() { return beta2; }
+
+  /**
+   * The UpdatePolicyType policy classes must contain an internal 'Policy'
+   * template class with two template arguments: MatType and GradType.  This is
+   * instantiated at the start of the optimization, and holds the moment
+   * estimates.
+   */
+  template<typename MatType, typename GradType>
+  class Policy
+  {
+   public:
+    /**
+     * This constructor is called by the SGD Optimize() method before the start
+     * of the iteration update process.
+     *
+     * @param parent Instantiated parent class.
+     * @param rows Number of rows in the gradient matrix.
+     * @param cols Number of columns in the gradient matrix.
+     */
+    Policy(LazyAdamUpdate& parent, const size_t rows, const size_t cols) :
+        parent(parent),
+        iteration(0)
+    {
+      m.zeros(rows, cols);
+      v.zeros(rows, cols);
+    }
+
+    /**
+     * Update step for lazy Adam.
+     *
+     * @param iterate Parameters that minimize the function.
+     * @param stepSize Step size to be used for the given iteration.
+     * @param gradient The gradient matrix.
+     */
+    void Update(MatType& iterate,
+                const double stepSize,
+                const GradType& gradient)
+    {
+      // The bias corrections use the number of steps, as in Adam.
+      ++iteration;
+      const double biasCorrection1 = 1.0 - std::pow(parent.beta1, iteration);
+      const double biasCorrection2 = 1.0 - std::pow(parent.beta2, iteration);
+      const double step = stepSize * std::sqrt(biasCorrection2) /
+          biasCorrection1;
+
+      UpdateEntries(iterate, step, gradient);
+    }
+
+   private:
+    //! Update the entries stored in the sparse gradient.
+    template<typename eT>
+    void UpdateEntries(MatType& iterate,
+                       const double step,
+                       const arma::SpMat<eT>& gradient)
+    {
+      typename arma::SpMat<eT>::const_iterator it = gradient.begin();
+      for (; it != gradient.end(); ++it)
+        UpdateEntry(iterate, step, it.row() + it.col() * m.n_rows, *it);
+    }
+
+    //! Update every entry of the dense gradient.
+    template<typename eT>
+    void UpdateEntries(MatType& iterate,
+                       const double step,
+                       const arma::Mat<eT>& gradient)
+    {
+      for (size_t i = 0; i < gradient.n_elem; ++i)
+        UpdateEntry(iterate, step, i, gradient[i]);
+    }
+
+    //! Update the moments and the value of the given entry.
+    void UpdateEntry(MatType& iterate,
+                     const double step,
+                     const size_t i,
+                     const double g)
+    {
+      m[i] = parent.beta1 * m[i] + (1 - parent.beta1) * g;
+      v[i] = parent.beta2 * v[i] + (1 - parent.beta2) * g * g;
+      iterate[i] -= step * m[i] / (std::sqrt(v[i]) + parent.epsilon);
+    }
+
+    //! Instantiated parent object.
+    LazyAdamUpdate& parent;
+
+    //! The exponential moving average of gradient values.
+    arma::Mat<typename MatType::elem_type> m;
+
+    //! The exponential moving average of squared gradient values.
+    arma::Mat<typename MatType::elem_type> v;
+
+    //! The number of iterations.
+    size_t iteration;
+  };
+
+ private:
+  //! The epsilon value used to initialise the squared gradient parameter.
+  double epsilon;
+
+  //! The smoothing parameter.
+  double beta1;
+
+  //! The second moment coefficient.
+  double beta2;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -23,22 +23,26 @@ namespace ann {
 
 /**
  * BackwardVisitor executes the Backward() function given the input, error and
- * delta parameter.
+ * delta parameter.  The modules must work on the given matrix type; a
+ * std::invalid_argument exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the input, error and delta parameter.
  */
-class BackwardVisitor : public boost::static_visitor<void>
+template<typename MatType>
+class BackwardVisitorType : public boost::static_visitor<void>
 {
  public:
   //! Execute the Backward() function given the input, error and delta
   //! parameter.
-  BackwardVisitor(const arma::mat& input,
-                  const arma::mat& error,
-                  arma::mat& delta);
+  BackwardVisitorType(const MatType& input,
+                      const MatType& error,
+                      MatType& delta);
 
   //! Execute the Backward() function for the layer with the specified index.
-  BackwardVisitor(const arma::mat& input,
-                  const arma::mat& error,
-                  arma::mat& delta,
-                  const size_t index);
+  BackwardVisitorType(const MatType& input,
+                      const MatType& error,
+                      MatType& delta,
+                      const size_t index);
 
   //! Execute the Backward() function.
   template<typename LayerType>
@@ -48,13 +52,13 @@ class BackwardVisitor : public boost::static_visitor<void>
 
  private:
   //! The input parameter set.
-  const arma::mat& input;
+  const MatType& input;
 
   //! The error parameter.
-  const arma::mat& error;
+  const MatType& error;
 
   //! The delta parameter.
-  arma::mat& delta;
+  MatType& delta;
 
   //! The index of the layer to run.
   size_t index;
@@ -67,15 +71,22 @@ class BackwardVisitor : public boost::static_visitor<void>
   template<typename T>
   typename std::enable_if<
       !HasRunCheck<T, bool&(T::*)(void)>::value, void>::type
-  LayerBackward(T* layer, arma::mat& input) const;
+  LayerBackward(T* layer, MatType& input) const;
 
   //! Execute the Backward() function if the module is has Run() function.
   template<typename T>
   typename std::enable_if<
       HasRunCheck<T, bool&(T::*)(void)>::value, void>::type
-  LayerBackward(T* layer, arma::mat& input) const;
+  LayerBackward(T* layer, MatType& input) const;
+
+  //! Reject a module of another matrix type.
+  template<typename T, typename P>
+  void LayerBackward(T* layer, P& input) const;
 };
 
+//! BackwardVisitor for networks of arma::mat.
+typedef BackwardVisitorType<arma::mat> BackwardVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
@@ -19,9 +19,10 @@ namespace mlpack {
 namespace ann {
 
 //! BackwardVisitor visitor class.
-inline BackwardVisitor::BackwardVisitor(const arma::mat& input,
-                                        const arma::mat& error,
-                                        arma::mat& delta) :
+template<typename MatType>
+inline BackwardVisitorType<MatType>::BackwardVisitorType(const MatType& input,
+                                                         const MatType& error,
+                                                         MatType& delta) :
   input(input),
   error(error),
   delta(delta),
@@ -31,10 +32,11 @@ inline BackwardVisitor::BackwardVisitor(const arma::mat& input,
   /* Nothing to do here. */
 }
 
-inline BackwardVisitor::BackwardVisitor(const arma::mat& input,
-                                        const arma::mat& error,
-                                        arma::mat& delta,
-                                        const size_t index) :
+template<typename MatType>
+inline BackwardVisitorType<MatType>::BackwardVisitorType(const MatType& input,
+                                                         const MatType& error,
+                                                         MatType& delta,
+                                                         const size_t index) :
   input(input),
   error(error),
   delta(delta),
@@ -44,29 +46,35 @@ inline BackwardVisitor::BackwardVisitor(const arma::mat& input,
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void BackwardVisitor::operator()(LayerType* layer) const
+inline void BackwardVisitorType<MatType>::operator()(LayerType* layer) const
 {
   LayerBackward(layer, layer->OutputParameter());
 }
 
-inline void BackwardVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline void BackwardVisitorType<MatType>::operator()(MoreTypes layer) const
 {
   layer.apply_visitor(*this);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasRunCheck<T, bool&(T::*)(void)>::value, void>::type
-BackwardVisitor::LayerBackward(T* layer, arma::mat& /* input */) const
+BackwardVisitorType<MatType>::LayerBackward(T* layer, MatType& /* input */)
+    const
 {
   layer->Backward(input, error, delta);
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasRunCheck<T, bool&(T::*)(void)>::value, void>::type
-BackwardVisitor::LayerBackward(T* layer, arma::mat& /* input */) const
+BackwardVisitorType<MatType>::LayerBackward(T* layer, MatType& /* input */)
+    const
 {
   if (!hasIndex)
   {
@@ -78,6 +86,15 @@ BackwardVisitor::LayerBackward(T* layer, arma::mat& /* input */) const
   }
 }
 
+template<typename MatType>
+template<typename T, typename P>
+inline void BackwardVisitorType<MatType>::LayerBackward(T* /* layer */,
+                                                        P& /* input */) const
+{
+  throw std::invalid_argument("BackwardVisitor: the module does not use the "
+      "matrix type of the network!");
+}
+
 } // namespace ann
 } // namespace mlpack
 
@@ -0,0 +1,73 @@
+/**
+ * @file methods/ann/visitor/batch_statistics_check_visitor.hpp
+ *
+ * This file provides an abstraction to check whether a layer, or one of the
+ * layers it contains, computes statistics over the whole batch during
+ * training.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_BATCH_STATISTICS_CHECK_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_BATCH_STATISTICS_CHECK_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * BatchStatisticsCheckVisitor returns whether a layer, or one of the layers it
+ * contains, computes statistics over the whole batch during training.  This is
+ * the case if the layer keeps running statistics of the batches, i.e.
+ * implements the TrainingMean() function (like BatchNorm), or if its loss is
+ * averaged over the batch, i.e. implements the Loss() function (like
+ * Reparametrization).  Such a layer can't be trained on a split batch.
+ */
+class BatchStatisticsCheckVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return whether the layer computes statistics over the batch.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  bool operator()(MoreTypes layer) const;
+
+ private:
+  //! Return true if the module implements the TrainingMean() or Loss()
+  //! function.
+  template<typename T>
+  typename std::enable_if<
+      HasTrainingMeanCheck<T>::value ||
+      HasLoss<T, double(T::*)()>::value, bool>::type
+  LayerBatchStatistics(T* layer) const;
+
+  //! Check the inner modules if the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasTrainingMeanCheck<T>::value &&
+      !HasLoss<T, double(T::*)()>::value &&
+      HasModelCheck<T>::value, bool>::type
+  LayerBatchStatistics(T* layer) const;
+
+  //! Return false if the module doesn't implement the TrainingMean(), Loss()
+  //! or Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasTrainingMeanCheck<T>::value &&
+      !HasLoss<T, double(T::*)()>::value &&
+      !HasModelCheck<T>::value, bool>::type
+  LayerBatchStatistics(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_statistics_check_visitor_impl.hpp"
+
+#endif
@@ -22,18 +22,35 @@ namespace mlpack {
 namespace ann {
 
 /**
- * DeltaVisitor exposes the delta parameter of the given module.
+ * DeltaVisitor exposes the delta parameter of the given module.  The modules
+ * must work on the given matrix type; a std::invalid_argument exception is
+ * thrown for the other modules.
+ *
+ * @tparam MatType Type of the delta parameter.
  */
-class DeltaVisitor : public boost::static_visitor<arma::mat&>
+template<typename MatType>
+class DeltaVisitorType : public boost::static_visitor<MatType&>
 {
  public:
   //! Return the delta parameter.
   template<typename LayerType>
-  arma::mat& operator()(LayerType* layer) const;
+  MatType& operator()(LayerType* layer) const;
+
+  MatType& operator()(MoreTypes layer) const;
 
-  arma::mat& operator()(MoreTypes layer) const;
+ private:
+  //! Return the delta parameter of a module of the given matrix type.
+  template<typename T>
+  MatType& LayerDelta(T* layer, MatType& output) const;
+
+  //! Reject a module of another matrix type.
+  template<typename T, typename P>
+  MatType& LayerDelta(T* layer, P& output) const;
 };
 
+//! DeltaVisitor for networks of arma::mat.
+typedef DeltaVisitorType<arma::mat> DeltaVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
@@ -19,17 +19,36 @@ namespace mlpack {
 namespace ann {
 
 //! DeltaVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline arma::mat& DeltaVisitor::operator()(LayerType *layer) const
+inline MatType& DeltaVisitorType<MatType>::operator()(LayerType *layer) const
 {
-  return layer->Delta();
+  return LayerDelta(layer, layer->OutputParameter());
 }
 
-inline arma::mat& DeltaVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline MatType& DeltaVisitorType<MatType>::operator()(MoreTypes layer) const
 {
   return layer.apply_visitor(*this);
 }
 
+template<typename MatType>
+template<typename T>
+inline MatType& DeltaVisitorType<MatType>::LayerDelta(
+    T* layer, MatType& /* output */) const
+{
+  return layer->Delta();
+}
+
+template<typename MatType>
+template<typename T, typename P>
+inline MatType& DeltaVisitorType<MatType>::LayerDelta(
+    T* /* layer */, P& /* output */) const
+{
+  throw std::invalid_argument("DeltaVisitor: the module does not use the "
+      "matrix type of the network!");
+}
+
 } // namespace ann
 } // namespace mlpack
 
@@ -0,0 +1,76 @@
+/**
+ * @file methods/ann/visitor/forward_state_check_visitor.hpp
+ *
+ * This file provides an abstraction to check whether running the forward pass
+ * of a layer, or of one of the layers it contains, again could give another
+ * output or change the state of the layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_FORWARD_STATE_CHECK_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_FORWARD_STATE_CHECK_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * ForwardStateCheckVisitor returns whether a layer, or one of the layers it
+ * contains, must not run its forward pass twice for the same input.  These are
+ * the layers that implement the Deterministic() function (they behave
+ * differently during training), the Stochastic() function (they draw new
+ * random samples), the Reset() function or the ResetCell() function (they hold
+ * state, such as the steps of a recurrent cell).
+ */
+class ForwardStateCheckVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return whether the layer must not run its forward pass twice.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  bool operator()(MoreTypes layer) const;
+
+ private:
+  //! Return whether the module has any of the functions above.
+  template<typename T>
+  struct HasForwardState
+  {
+    static const bool value =
+        HasDeterministicCheck<T, bool&(T::*)(void)>::value ||
+        HasStochasticCheck<T, bool(T::*)(void) const>::value ||
+        HasResetCheck<T, void(T::*)()>::value ||
+        HasResetCellCheck<T, void(T::*)(const size_t)>::value;
+  };
+
+  //! Return true if the module has any of the functions above.
+  template<typename T>
+  typename std::enable_if<HasForwardState<T>::value, bool>::type
+  LayerForwardState(T* layer) const;
+
+  //! Check the inner modules if the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasForwardState<T>::value && HasModelCheck<T>::value, bool>::type
+  LayerForwardState(T* layer) const;
+
+  //! Return false otherwise.
+  template<typename T>
+  typename std::enable_if<
+      !HasForwardState<T>::value && !HasModelCheck<T>::value, bool>::type
+  LayerForwardState(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "forward_state_check_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file methods/ann/visitor/forward_state_check_visitor_impl.hpp
+ *
+ * Implementation of the ForwardStateCheckVisitor class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_FORWARD_STATE_CHECK_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_FORWARD_STATE_CHECK_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "forward_state_check_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! ForwardStateCheckVisitor visitor class.
+template<typename LayerType>
+inline bool ForwardStateCheckVisitor::operator()(LayerType* layer) const
+{
+  return LayerForwardState(layer);
+}
+
+inline bool ForwardStateCheckVisitor::operator()(MoreTypes layer) const
+{
+  return layer.apply_visitor(*this);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    ForwardStateCheckVisitor::HasForwardState<T>::value, bool>::type
+ForwardStateCheckVisitor::LayerForwardState(T* /* layer */) const
+{
+  return true;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !ForwardStateCheckVisitor::HasForwardState<T>::value &&
+    HasModelCheck<T>::value, bool>::type
+ForwardStateCheckVisitor::LayerForwardState(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    if (boost::apply_visitor(ForwardStateCheckVisitor(), layer->Model()[i]))
+      return true;
+  }
+
+  return false;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !ForwardStateCheckVisitor::HasForwardState<T>::value &&
+    !HasModelCheck<T>::value, bool>::type
+ForwardStateCheckVisitor::LayerForwardState(T* /* layer */) const
+{
+  return false;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -23,13 +23,17 @@ namespace ann {
 
 /**
  * ForwardVisitor executes the Forward() function given the input and output
- * parameter.
+ * parameter.  The modules must work on the given matrix type; a
+ * std::invalid_argument exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the input and output parameter.
  */
-class ForwardVisitor : public boost::static_visitor<void>
+template<typename MatType>
+class ForwardVisitorType : public boost::static_visitor<void>
 {
  public:
   //! Execute the Forward() function given the input and output parameter.
-  ForwardVisitor(const arma::mat& input, arma::mat& output);
+  ForwardVisitorType(const MatType& input, MatType& output);
 
   //! Execute the Forward() function.
   template<typename LayerType>
@@ -39,12 +43,23 @@ class ForwardVisitor : public boost::static_visitor<void>
 
  private:
   //! The input parameter set.
-  const arma::mat& input;
+  const MatType& input;
 
   //! The output parameter set.
-  arma::mat& output;
+  MatType& output;
+
+  //! Execute the Forward() function of a module of the given matrix type.
+  template<typename T>
+  void LayerForward(T* layer, MatType& layerOutput) const;
+
+  //! Reject a module of another matrix type.
+  template<typename T, typename P>
+  void LayerForward(T* layer, P& layerOutput) const;
 };
 
+//! ForwardVisitor for networks of arma::mat.
+typedef ForwardVisitorType<arma::mat> ForwardVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
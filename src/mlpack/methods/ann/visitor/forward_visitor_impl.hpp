@@ -19,24 +19,45 @@ namespace mlpack {
 namespace ann {
 
 //! ForwardVisitor visitor class.
-inline ForwardVisitor::ForwardVisitor(const arma::mat& input, arma::mat& output) :
+template<typename MatType>
+inline ForwardVisitorType<MatType>::ForwardVisitorType(const MatType& input,
+                                                       MatType& output) :
     input(input),
     output(output)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void ForwardVisitor::operator()(LayerType* layer) const
+inline void ForwardVisitorType<MatType>::operator()(LayerType* layer) const
 {
-  layer->Forward(input, output);
+  LayerForward(layer, layer->OutputParameter());
 }
 
-inline void ForwardVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline void ForwardVisitorType<MatType>::operator()(MoreTypes layer) const
 {
   layer.apply_visitor(*this);
 }
 
+template<typename MatType>
+template<typename T>
+inline void ForwardVisitorType<MatType>::LayerForward(
+    T* layer, MatType& /* layerOutput */) const
+{
+  layer->Forward(input, output);
+}
+
+template<typename MatType>
+template<typename T, typename P>
+inline void ForwardVisitorType<MatType>::LayerForward(
+    T* /* layer */, P& /* layerOutput */) const
+{
+  throw std::invalid_argument("ForwardVisitor: the module does not use the "
+      "matrix type of the network!");
+}
+
 } // namespace ann
 } // namespace mlpack
 
@@ -22,12 +22,18 @@ namespace ann {
 
 /**
  * GradientSetVisitor update the gradient parameter given the gradient set.
+ * The modules that implement the Gradient() or Model() function must work on
+ * the given matrix type; a std::invalid_argument exception is thrown for the
+ * other modules.
+ *
+ * @tparam MatType Type of the gradient set.
  */
-class GradientSetVisitor : public boost::static_visitor<size_t>
+template<typename MatType>
+class GradientSetVisitorType : public boost::static_visitor<size_t>
 {
  public:
   //! Update the gradient parameter given the gradient set.
-  GradientSetVisitor(arma::mat& gradient, size_t offset = 0);
+  GradientSetVisitorType(MatType& gradient, size_t offset = 0);
 
   //! Update the gradient parameter.
   template<typename LayerType>
@@ -37,7 +43,7 @@ class GradientSetVisitor : public boost::static_visitor<size_t>
 
  private:
   //! The gradient set.
-  arma::mat& gradient;
+  MatType& gradient;
 
   //! The gradient offset.
   size_t offset;
@@ -45,24 +51,24 @@ class GradientSetVisitor : public boost::static_visitor<size_t>
   //! Update the gradient if the module implements the Gradient() function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasGradientCheck<T, MatType&(T::*)()>::value &&
       !HasModelCheck<T>::value, size_t>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Update the gradient if the module implements the Model() function.
   template<typename T>
   typename std::enable_if<
-      !HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      !HasGradientCheck<T, MatType&(T::*)()>::value &&
       HasModelCheck<T>::value, size_t>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Update the gradient if the module implements the Gradient() and Model()
   //! function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasGradientCheck<T, MatType&(T::*)()>::value &&
       HasModelCheck<T>::value, size_t>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Do not update the gradient parameter if the module doesn't implement the
   //! Gradient() or Model() function.
@@ -71,8 +77,20 @@ class GradientSetVisitor : public boost::static_visitor<size_t>
       !HasGradientCheck<T, P&(T::*)()>::value &&
       !HasModelCheck<T>::value, size_t>::type
   LayerGradients(T* layer, P& input) const;
+
+  //! Reject a module of another matrix type that implements the Gradient()
+  //! or Model() function.
+  template<typename T, typename P>
+  typename std::enable_if<
+      (HasGradientCheck<T, P&(T::*)()>::value ||
+      HasModelCheck<T>::value) &&
+      !std::is_same<P, MatType>::value, size_t>::type
+  LayerGradients(T* layer, P& input) const;
 };
 
+//! GradientSetVisitor for networks of arma::mat.
+typedef GradientSetVisitorType<arma::mat> GradientSetVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
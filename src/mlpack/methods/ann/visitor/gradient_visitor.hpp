@@ -23,19 +23,24 @@ namespace ann {
 
 /**
  * SearchModeVisitor executes the Gradient() method of the given module using
- * the input and delta parameter.
+ * the input and delta parameter.  The modules that implement the Gradient()
+ * method must work on the given matrix type; a std::invalid_argument
+ * exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the input and delta parameter.
  */
-class GradientVisitor : public boost::static_visitor<void>
+template<typename MatType>
+class GradientVisitorType : public boost::static_visitor<void>
 {
  public:
   //! Executes the Gradient() method of the given module using the input and
   //! delta parameter.
-  GradientVisitor(const arma::mat& input, const arma::mat& delta);
+  GradientVisitorType(const MatType& input, const MatType& delta);
 
   //! Executes the Gradient() method for the layer with the specified index.
-  GradientVisitor(const arma::mat& input,
-                  const arma::mat& delta,
-                  const size_t index);
+  GradientVisitorType(const MatType& input,
+                      const MatType& delta,
+                      const size_t index);
 
   //! Executes the Gradient() method.
   template<typename LayerType>
@@ -45,10 +50,10 @@ class GradientVisitor : public boost::static_visitor<void>
 
  private:
   //! The input set.
-  const arma::mat& input;
+  const MatType& input;
 
   //! The delta parameter.
-  const arma::mat& delta;
+  const MatType& delta;
 
   //! Index of the layer to run.
   size_t index;
@@ -60,17 +65,17 @@ class GradientVisitor : public boost::static_visitor<void>
   //! function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasGradientCheck<T, MatType&(T::*)()>::value &&
       !HasRunCheck<T, bool&(T::*)(void)>::value, void>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Execute the Gradient() function if the module implements the Gradient()
   //! and has a Run() function.
   template<typename T>
   typename std::enable_if<
-      HasGradientCheck<T, arma::mat&(T::*)()>::value &&
+      HasGradientCheck<T, MatType&(T::*)()>::value &&
       HasRunCheck<T, bool&(T::*)(void)>::value, void>::type
-  LayerGradients(T* layer, arma::mat& input) const;
+  LayerGradients(T* layer, MatType& input) const;
 
   //! Do not execute the Gradient() function if the module doesn't implement
   //! the Gradient() function.
@@ -78,8 +83,19 @@ class GradientVisitor : public boost::static_visitor<void>
   typename std::enable_if<
       !HasGradientCheck<T, P&(T::*)()>::value, void>::type
   LayerGradients(T* layer, P& input) const;
+
+  //! Reject a module of another matrix type that implements the Gradient()
+  //! function.
+  template<typename T, typename P>
+  typename std::enable_if<
+      HasGradientCheck<T, P&(T::*)()>::value &&
+      !std::is_same<P, MatType>::value, void>::type
+  LayerGradients(T* layer, P& input) const;
 };
 
+//! GradientVisitor for networks of arma::mat.
+typedef GradientVisitorType<arma::mat> GradientVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
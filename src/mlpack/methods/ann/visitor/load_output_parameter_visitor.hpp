@@ -23,13 +23,17 @@ namespace ann {
 
 /**
  * LoadOutputParameterVisitor restores the output parameter using the given
- * parameter set.
+ * parameter set.  The modules must work on the given matrix type; a
+ * std::invalid_argument exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the output parameter.
  */
-class LoadOutputParameterVisitor : public boost::static_visitor<void>
+template<typename MatType>
+class LoadOutputParameterVisitorType : public boost::static_visitor<void>
 {
  public:
   //! Restore the output parameter given a parameter set.
-  LoadOutputParameterVisitor(std::vector<arma::mat>& parameter);
+  LoadOutputParameterVisitorType(std::vector<MatType>& parameter);
 
   //! Restore the output parameter.
   template<typename LayerType>
@@ -39,7 +43,15 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameter set.
-  std::vector<arma::mat>& parameter;
+  std::vector<MatType>& parameter;
+
+  //! Handle a module of the given matrix type.
+  template<typename T>
+  void LayerOutputParameter(T* layer, MatType& output) const;
+
+  //! Reject a module of another matrix type.
+  template<typename T, typename P>
+  void LayerOutputParameter(T* layer, P& output) const;
 
   //! Restore the output parameter for a module which doesn't implement the
   //! Model() function.
@@ -56,6 +68,9 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
   OutputParameter(T* layer) const;
 };
 
+//! LoadOutputParameterVisitor for networks of arma::mat.
+typedef LoadOutputParameterVisitorType<arma::mat> LoadOutputParameterVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
@@ -19,40 +19,65 @@ namespace mlpack {
 namespace ann {
 
 //! LoadOutputParameterVisitor visitor class.
-inline LoadOutputParameterVisitor::LoadOutputParameterVisitor(
-    std::vector<arma::mat>& parameter) : parameter(parameter)
+template<typename MatType>
+inline LoadOutputParameterVisitorType<MatType>::
+LoadOutputParameterVisitorType(
+    std::vector<MatType>& parameter) : parameter(parameter)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void LoadOutputParameterVisitor::operator()(LayerType* layer) const
+inline void LoadOutputParameterVisitorType<MatType>::operator()(
+    LayerType* layer) const
 {
-  OutputParameter(layer);
+  LayerOutputParameter(layer, layer->OutputParameter());
 }
 
-inline void LoadOutputParameterVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline void LoadOutputParameterVisitorType<MatType>::operator()(
+    MoreTypes layer) const
 {
   layer.apply_visitor(*this);
 }
 
+template<typename MatType>
+template<typename T>
+inline void LoadOutputParameterVisitorType<MatType>::LayerOutputParameter(
+    T* layer, MatType& /* output */) const
+{
+  OutputParameter(layer);
+}
+
+template<typename MatType>
+template<typename T, typename P>
+inline void LoadOutputParameterVisitorType<MatType>::LayerOutputParameter(
+    T* /* layer */, P& /* output */) const
+{
+  throw std::invalid_argument("LoadOutputParameterVisitor: the module does not "
+      "use the matrix type of the network!");
+}
+
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasModelCheck<T>::value, void>::type
-LoadOutputParameterVisitor::OutputParameter(T* layer) const
+LoadOutputParameterVisitorType<MatType>::OutputParameter(T* layer) const
 {
   layer->OutputParameter() = parameter.back();
   parameter.pop_back();
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasModelCheck<T>::value, void>::type
-LoadOutputParameterVisitor::OutputParameter(T* layer) const
+LoadOutputParameterVisitorType<MatType>::OutputParameter(T* layer) const
 {
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(LoadOutputParameterVisitor(parameter),
+    boost::apply_visitor(LoadOutputParameterVisitorType(parameter),
         layer->Model()[layer->Model().size() - i - 1]);
   }
 
@@ -23,17 +23,33 @@ namespace ann {
 
 /**
  * OutputParameterVisitor exposes the output parameter of the given module.
+ * The modules must work on the given matrix type; a std::invalid_argument
+ * exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the output parameter.
  */
-class OutputParameterVisitor : public boost::static_visitor<arma::mat&>
+template<typename MatType>
+class OutputParameterVisitorType : public boost::static_visitor<MatType&>
 {
  public:
   //! Return the output parameter set.
   template<typename LayerType>
-  arma::mat& operator()(LayerType* layer) const;
+  MatType& operator()(LayerType* layer) const;
+
+  MatType& operator()(MoreTypes layer) const;
 
-  arma::mat& operator()(MoreTypes layer) const;
+ private:
+  //! Return the output parameter of a module of the given matrix type.
+  MatType& OutputParameter(MatType& output) const;
+
+  //! Reject a module of another matrix type.
+  template<typename P>
+  MatType& OutputParameter(P& output) const;
 };
 
+//! OutputParameterVisitor for networks of arma::mat.
+typedef OutputParameterVisitorType<arma::mat> OutputParameterVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
@@ -19,17 +19,37 @@ namespace mlpack {
 namespace ann {
 
 //! OutputParameterVisitor visitor class.
+template<typename MatType>
 template<typename LayerType>
-inline arma::mat& OutputParameterVisitor::operator()(LayerType *layer) const
+inline MatType& OutputParameterVisitorType<MatType>::operator()(
+    LayerType *layer) const
 {
-  return layer->OutputParameter();
+  return OutputParameter(layer->OutputParameter());
 }
 
-inline arma::mat& OutputParameterVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline MatType& OutputParameterVisitorType<MatType>::operator()(
+    MoreTypes layer) const
 {
   return layer.apply_visitor(*this);
 }
 
+template<typename MatType>
+inline MatType& OutputParameterVisitorType<MatType>::OutputParameter(
+    MatType& output) const
+{
+  return output;
+}
+
+template<typename MatType>
+template<typename P>
+inline MatType& OutputParameterVisitorType<MatType>::OutputParameter(
+    P& /* output */) const
+{
+  throw std::invalid_argument("OutputParameterVisitor: the module does not "
+      "use the matrix type of the network!");
+}
+
 } // namespace ann
 } // namespace mlpack
 
@@ -22,13 +22,17 @@ namespace ann {
 
 /**
  * SaveOutputParameterVisitor saves the output parameter into the given
- * parameter set.
+ * parameter set.  The modules must work on the given matrix type; a
+ * std::invalid_argument exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the output parameter.
  */
-class SaveOutputParameterVisitor : public boost::static_visitor<void>
+template<typename MatType>
+class SaveOutputParameterVisitorType : public boost::static_visitor<void>
 {
  public:
   //! Save the output parameter into the given parameter set.
-  SaveOutputParameterVisitor(std::vector<arma::mat>& parameter);
+  SaveOutputParameterVisitorType(std::vector<MatType>& parameter);
 
   //! Save the output parameter.
   template<typename LayerType>
@@ -38,7 +42,15 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
 
  private:
   //! The parameter set.
-  std::vector<arma::mat>& parameter;
+  std::vector<MatType>& parameter;
+
+  //! Handle a module of the given matrix type.
+  template<typename T>
+  void LayerOutputParameter(T* layer, MatType& output) const;
+
+  //! Reject a module of another matrix type.
+  template<typename T, typename P>
+  void LayerOutputParameter(T* layer, P& output) const;
 
   //! Save the output parameter for a module which doesn't implement the
   //! Model() function.
@@ -55,6 +67,9 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
   OutputParameter(T* layer) const;
 };
 
+//! SaveOutputParameterVisitor for networks of arma::mat.
+typedef SaveOutputParameterVisitorType<arma::mat> SaveOutputParameterVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
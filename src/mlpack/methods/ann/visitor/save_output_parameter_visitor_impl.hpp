@@ -19,41 +19,66 @@ namespace mlpack {
 namespace ann {
 
 //! SaveOutputParameterVisitor visitor class.
-inline SaveOutputParameterVisitor::SaveOutputParameterVisitor(
-    std::vector<arma::mat>& parameter) : parameter(parameter)
+template<typename MatType>
+inline SaveOutputParameterVisitorType<MatType>::
+SaveOutputParameterVisitorType(
+    std::vector<MatType>& parameter) : parameter(parameter)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline void SaveOutputParameterVisitor::operator()(LayerType* layer) const
+inline void SaveOutputParameterVisitorType<MatType>::operator()(
+    LayerType* layer) const
 {
-  OutputParameter(layer);
+  LayerOutputParameter(layer, layer->OutputParameter());
 }
 
-inline void SaveOutputParameterVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline void SaveOutputParameterVisitorType<MatType>::operator()(
+    MoreTypes layer) const
 {
   layer.apply_visitor(*this);
 }
 
+template<typename MatType>
+template<typename T>
+inline void SaveOutputParameterVisitorType<MatType>::LayerOutputParameter(
+    T* layer, MatType& /* output */) const
+{
+  OutputParameter(layer);
+}
+
+template<typename MatType>
+template<typename T, typename P>
+inline void SaveOutputParameterVisitorType<MatType>::LayerOutputParameter(
+    T* /* layer */, P& /* output */) const
+{
+  throw std::invalid_argument("SaveOutputParameterVisitor: the module does not "
+      "use the matrix type of the network!");
+}
+
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     !HasModelCheck<T>::value, void>::type
-SaveOutputParameterVisitor::OutputParameter(T* layer) const
+SaveOutputParameterVisitorType<MatType>::OutputParameter(T* layer) const
 {
   parameter.push_back(layer->OutputParameter());
 }
 
+template<typename MatType>
 template<typename T>
 inline typename std::enable_if<
     HasModelCheck<T>::value, void>::type
-SaveOutputParameterVisitor::OutputParameter(T* layer) const
+SaveOutputParameterVisitorType<MatType>::OutputParameter(T* layer) const
 {
   parameter.push_back(layer->OutputParameter());
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SaveOutputParameterVisitor(parameter),
+    boost::apply_visitor(SaveOutputParameterVisitorType(parameter),
         layer->Model()[i]);
   }
 }
@@ -21,13 +21,18 @@ namespace mlpack {
 namespace ann {
 
 /**
- * WeightSetVisitor update the module parameters given the parameters set.
+ * WeightSetVisitor update the module parameters given the parameters set.  The
+ * modules must work on the given matrix type; a std::invalid_argument
+ * exception is thrown for the other modules.
+ *
+ * @tparam MatType Type of the parameters set.
  */
-class WeightSetVisitor : public boost::static_visitor<size_t>
+template<typename MatType>
+class WeightSetVisitorType : public boost::static_visitor<size_t>
 {
  public:
   //! Update the parameters given the parameters set and offset.
-  WeightSetVisitor(arma::mat& weight, const size_t offset = 0);
+  WeightSetVisitorType(MatType& weight, const size_t offset = 0);
 
   //! Update the parameters set.
   template<typename LayerType>
@@ -37,11 +42,19 @@ class WeightSetVisitor : public boost::static_visitor<size_t>
 
  private:
   //! The parameters set.
-  arma::mat& weight;
+  MatType& weight;
 
   //! The parameters offset.
   const size_t offset;
 
+  //! Update the parameters of a module of the given matrix type.
+  template<typename T>
+  size_t LayerWeights(T* layer, MatType& output) const;
+
+  //! Reject a module of another matrix type.
+  template<typename T, typename P>
+  size_t LayerWeights(T* layer, P& output) const;
+
   //! Do not update the parameters if the module doesn't implement the
   //! Parameters() or Model() function.
   template<typename T, typename P>
@@ -73,6 +86,9 @@ class WeightSetVisitor : public boost::static_visitor<size_t>
   LayerSize(T* layer, P&& input) const;
 };
 
+//! WeightSetVisitor for networks of arma::mat.
+typedef WeightSetVisitorType<arma::mat> WeightSetVisitor;
+
 } // namespace ann
 } // namespace mlpack
 
@@ -19,75 +19,99 @@ namespace mlpack {
 namespace ann {
 
 //! WeightSetVisitor visitor class.
-inline WeightSetVisitor::WeightSetVisitor(arma::mat& weight,
-                                          const size_t offset) :
+template<typename MatType>
+inline WeightSetVisitorType<MatType>::WeightSetVisitorType(
+    MatType& weight, const size_t offset) :
     weight(weight),
     offset(offset)
 {
   /* Nothing to do here. */
 }
 
+template<typename MatType>
 template<typename LayerType>
-inline size_t WeightSetVisitor::operator()(LayerType* layer) const
+inline size_t WeightSetVisitorType<MatType>::operator()(LayerType* layer) const
 {
-  return LayerSize(layer, layer->OutputParameter());
+  return LayerWeights(layer, layer->OutputParameter());
 }
 
-inline size_t WeightSetVisitor::operator()(MoreTypes layer) const
+template<typename MatType>
+inline size_t WeightSetVisitorType<MatType>::operator()(MoreTypes layer) const
 {
   return layer.apply_visitor(*this);
 }
 
+template<typename MatType>
+template<typename T>
+inline size_t WeightSetVisitorType<MatType>::LayerWeights(
+    T* layer, MatType& output) const
+{
+  return LayerSize(layer, output);
+}
+
+template<typename MatType>
+template<typename T, typename P>
+inline size_t WeightSetVisitorType<MatType>::LayerWeights(
+    T* /* layer */, P& /* output */) const
+{
+  throw std::invalid_argument("WeightSetVisitor: the module does not use the "
+      "matrix type of the network!");
+}
+
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value &&
     !HasModelCheck<T>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* /* layer */, P&& /*output */) const
+WeightSetVisitorType<MatType>::LayerSize(T* /* layer */, P&& /*output */) const
 {
   return 0;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     !HasParametersCheck<T, P&(T::*)()>::value &&
     HasModelCheck<T>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* layer, P&& /*output */) const
+WeightSetVisitorType<MatType>::LayerSize(T* layer, P&& /*output */) const
 {
   size_t modelOffset = 0;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    modelOffset += boost::apply_visitor(WeightSetVisitor(
+    modelOffset += boost::apply_visitor(WeightSetVisitorType(
         weight, modelOffset + offset), layer->Model()[i]);
   }
 
   return modelOffset;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value &&
     !HasModelCheck<T>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* layer, P&& /* output */) const
+WeightSetVisitorType<MatType>::LayerSize(T* layer, P&& /* output */) const
 {
-  layer->Parameters() = arma::mat(weight.memptr() + offset,
+  layer->Parameters() = MatType(weight.memptr() + offset,
       layer->Parameters().n_rows, layer->Parameters().n_cols, false, false);
 
   return layer->Parameters().n_elem;
 }
 
+template<typename MatType>
 template<typename T, typename P>
 inline typename std::enable_if<
     HasParametersCheck<T, P&(T::*)()>::value &&
     HasModelCheck<T>::value, size_t>::type
-WeightSetVisitor::LayerSize(T* layer, P&& /* output */) const
+WeightSetVisitorType<MatType>::LayerSize(T* layer, P&& /* output */) const
 {
-  layer->Parameters() = arma::mat(weight.memptr() + offset,
+  layer->Parameters() = MatType(weight.memptr() + offset,
       layer->Parameters().n_rows, layer->Parameters().n_cols, false, false);
 
   size_t modelOffset = layer->Parameters().n_elem;
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    modelOffset += boost::apply_visitor(WeightSetVisitor(
+    modelOffset += boost::apply_visitor(WeightSetVisitorType(
         weight, modelOffset + offset), layer->Model()[i]);
   }
 
@@ -149,7 +149,8 @@ namespace ens {
    * Template specialization for the SGD and parallel SGD optimizer. Used
    * because the gradient affects only a small number of parameters per example,
    * and thus the normal abstraction does not work as fast as we might like it
-   * to.
+   * to.  See the RegularizedSVDFunction specialization for the parallel SGD
+   * optimizer.
    */
   template <>
   template <>
@@ -48,6 +48,13 @@ namespace fastmks /** Fast max-kernel search. */ {
  * on points in the dataset (and not centroids of regions or anything like
  * that).
  *
+ * For maximum inner product search, use the LinearKernel; MatType may be
+ * arma::fmat to search single-precision data.  If OpenMP is available, large
+ * query sets are searched in parallel in naive and dual-tree mode.  Search can
+ * be made approximate by setting Epsilon(); then the k'th returned kernel value
+ * is at least (1 - epsilon) times the true k'th largest kernel value, when that
+ * value is positive.
+ *
  * @tparam KernelType Type of kernel to run FastMKS with.
  * @tparam MatType Type of data matrix (usually arma::mat).
  * @tparam TreeType Type of tree to run FastMKS with; it must satisfy the
@@ -297,9 +304,15 @@ class FastMKS
   //! Modify whether or not brute-force (naive) search is used.
   bool& Naive() { return naive; }
 
+  //! Get the relative approximation error of tree search (0 for exact search).
+  double Epsilon() const { return epsilon; }
+  //! Modify the relative approximation error of tree search; it must be in
+  //! [0, 1).
+  double& Epsilon() { return epsilon; }
+
   //! Serialize the model.
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
  private:
   //! The reference dataset.  We never own this; only the tree or a higher level
@@ -316,6 +329,8 @@ class FastMKS
   bool singleMode;
   //! If true, naive (brute-force) search is used.
   bool naive;
+  //! The relative approximation error of tree search.
+  double epsilon;
 
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
@@ -339,6 +354,29 @@ class FastMKS
 } // namespace fastmks
 } // namespace mlpack
 
+//! Set the serialization version of the FastMKS class.  We cannot use
+//! BOOST_TEMPLATE_CLASS_VERSION because of the commas in the template
+//! signature.
+namespace boost {
+namespace serialization {
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+struct version<mlpack::fastmks::FastMKS<KernelType, MatType, TreeType>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+  BOOST_MPL_ASSERT((boost::mpl::less<boost::mpl::int_<1>,
+                    boost::mpl::int_<256>>));
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "fastmks_impl.hpp"
 
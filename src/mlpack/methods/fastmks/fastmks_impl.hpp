@@ -19,6 +19,10 @@
 
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace fastmks {
 
@@ -35,7 +39,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const bool singleMode,
     treeOwner(true),
     setOwner(true),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    epsilon(0.0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -58,7 +63,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(
     treeOwner(true),
     setOwner(false),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    epsilon(0.0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -82,6 +88,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const MatType& referenceSet,
     setOwner(false),
     singleMode(singleMode),
     naive(naive),
+    epsilon(0.0),
     metric(kernel)
 {
   Timer::Start("tree_building");
@@ -108,7 +115,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(
     treeOwner(true),
     setOwner(naive),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    epsilon(0.0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -135,6 +143,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(MatType&& referenceSet,
     setOwner(naive),
     singleMode(singleMode),
     naive(naive),
+    epsilon(0.0),
     metric(kernel)
 {
   Timer::Start("tree_building");
@@ -163,6 +172,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(Tree* referenceTree,
     setOwner(false),
     singleMode(singleMode),
     naive(false),
+    epsilon(0.0),
     metric(referenceTree->Metric())
 {
   // Nothing to do.
@@ -180,6 +190,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const FastMKS& other) :
     setOwner(other.referenceTree == NULL),
     singleMode(other.singleMode),
     naive(other.naive),
+    epsilon(other.epsilon),
     metric(other.metric)
 {
   // Set reference set correctly.
@@ -201,6 +212,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
     setOwner(other.setOwner),
     singleMode(other.singleMode),
     naive(other.naive),
+    epsilon(other.epsilon),
     metric(std::move(other.metric))
 {
   // Clear information from the other.
@@ -210,6 +222,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
   other.setOwner = false;
   other.singleMode = false;
   other.naive = false;
+  other.epsilon = 0.0;
 }
 
 template<typename KernelType,
@@ -248,6 +261,7 @@ FastMKS<KernelType, MatType, TreeType>::operator=(const FastMKS& other)
 
   singleMode = other.singleMode;
   naive = other.naive;
+  epsilon = other.epsilon;
 }
 
 template<typename KernelType,
@@ -408,6 +422,13 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     throw std::invalid_argument(ss.str());
   }
 
+  if (!naive && (epsilon < 0.0 || epsilon >= 1.0))
+  {
+    std::stringstream ss;
+    ss << "FastMKS::Search(): epsilon (" << epsilon << ") must be in [0, 1)";
+    throw std::invalid_argument(ss.str());
+  }
+
   if (querySet.n_rows != referenceSet->n_rows)
   {
     std::stringstream ss;
@@ -426,8 +447,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
+    // Simple double loop.  Stupid, slow, but a good benchmark.  Each query
+    // point is independent, so the query points are split between threads.
+    #pragma omp parallel for
+    for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
     {
       const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
       std::vector<Candidate> cList(k, def);
@@ -465,7 +488,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     // Create rules object (this will store the results).  This constructor
     // precalculates each self-kernel value.
     typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, querySet, k, metric.Kernel());
+    RuleType rules(*referenceSet, querySet, k, metric.Kernel(), epsilon);
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
@@ -481,14 +504,65 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     return;
   }
 
-  // Dual-tree implementation.  First, we need to build the query tree.  We are
-  // assuming it doesn't map anything...
-  Timer::Stop("computing_products");
-  Timer::Start("tree_building");
-  Tree queryTree(querySet);
-  Timer::Stop("tree_building");
+  // Dual-tree implementation.  The dual-tree traversal does not modify the
+  // reference tree, so if there are enough query points, we split them into
+  // one batch per thread, and search each batch with its own query tree and
+  // rules.  Large batches are needed for the query trees to be useful.
+  #ifdef HAS_OPENMP
+    const size_t numThreads = (size_t) omp_get_max_threads();
+  #else
+    const size_t numThreads = 1;
+  #endif
+  const size_t numBatches = std::max((size_t) 1,
+      std::min(numThreads, (size_t) querySet.n_cols / 1024));
+
+  if (numBatches == 1)
+  {
+    // First, we need to build the query tree.  We are assuming it doesn't map
+    // anything...
+    Timer::Stop("computing_products");
+    Timer::Start("tree_building");
+    Tree queryTree(querySet, metric);
+    Timer::Stop("tree_building");
+
+    Search(&queryTree, k, indices, kernels);
+    return;
+  }
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalBaseCases, totalScores)
+  for (omp_size_t b = 0; b < (omp_size_t) numBatches; ++b)
+  {
+    const size_t begin = b * querySet.n_cols / numBatches;
+    const size_t end = (b + 1) * querySet.n_cols / numBatches;
 
-  Search(&queryTree, k, indices, kernels);
+    // We are assuming the query tree doesn't map anything...
+    Tree queryTree(MatType(querySet.cols(begin, end - 1)), metric);
+
+    typedef FastMKSRules<KernelType, Tree> RuleType;
+    RuleType rules(*referenceSet, queryTree.Dataset(), k, metric.Kernel(),
+        epsilon);
+
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+
+    arma::Mat<size_t> batchIndices;
+    arma::mat batchKernels;
+    rules.GetResults(batchIndices, batchKernels);
+    indices.cols(begin, end - 1) = batchIndices;
+    kernels.cols(begin, end - 1) = batchKernels;
+
+    totalBaseCases += rules.BaseCases();
+    totalScores += rules.Scores();
+  }
+
+  Log::Info << totalBaseCases << " base cases." << std::endl;
+  Log::Info << totalScores << " scores." << std::endl;
+
+  Timer::Stop("computing_products");
 }
 
 template<typename KernelType,
@@ -509,6 +583,13 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
         << "points in the reference set (" << referenceSet->n_cols << ")";
     throw std::invalid_argument(ss.str());
   }
+
+  if (!naive && (epsilon < 0.0 || epsilon >= 1.0))
+  {
+    std::stringstream ss;
+    ss << "FastMKS::Search(): epsilon (" << epsilon << ") must be in [0, 1)";
+    throw std::invalid_argument(ss.str());
+  }
   if (queryTree->Dataset().n_rows != referenceSet->n_rows)
   {
     std::stringstream ss;
@@ -531,7 +612,8 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 
   Timer::Start("computing_products");
   typedef FastMKSRules<KernelType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
+  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel(),
+      epsilon);
 
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
@@ -555,6 +637,13 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     arma::Mat<size_t>& indices,
     arma::mat& kernels)
 {
+  if (!naive && (epsilon < 0.0 || epsilon >= 1.0))
+  {
+    std::stringstream ss;
+    ss << "FastMKS::Search(): epsilon (" << epsilon << ") must be in [0, 1)";
+    throw std::invalid_argument(ss.str());
+  }
+
   // No remapping will be necessary because we are using the cover tree.
   Timer::Start("computing_products");
   indices.set_size(k, referenceSet->n_cols);
@@ -563,8 +652,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
+    // Simple double loop.  Stupid, slow, but a good benchmark.  Each query
+    // point is independent, so the query points are split between threads.
+    #pragma omp parallel for
+    for (omp_size_t q = 0; q < (omp_size_t) referenceSet->n_cols; ++q)
     {
       const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
       std::vector<Candidate> cList(k, def);
@@ -572,7 +663,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 
       for (size_t r = 0; r < referenceSet->n_cols; ++r)
       {
-        if (q == r)
+        if ((size_t) q == r)
           continue; // Don't return the point as its own candidate.
 
         const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
@@ -605,7 +696,8 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
     // Create rules object (this will store the results).  This constructor
     // precalculates each self-kernel value.
     typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
+    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel(),
+        epsilon);
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
@@ -641,12 +733,18 @@ template<typename KernelType,
 template<typename Archive>
 void FastMKS<KernelType, MatType, TreeType>::serialize(
     Archive& ar,
-    const unsigned int /* version */)
+    const unsigned int version)
 {
   // Serialize preferences for search.
   ar & BOOST_SERIALIZATION_NVP(naive);
   ar & BOOST_SERIALIZATION_NVP(singleMode);
 
+  // Older versions did not support approximate search.
+  if (version > 0)
+    ar & BOOST_SERIALIZATION_NVP(epsilon);
+  else if (Archive::is_loading::value)
+    epsilon = 0.0;
+
   // If we are doing naive search, serialize the dataset.  Otherwise we
   // serialize the tree.
   if (naive)
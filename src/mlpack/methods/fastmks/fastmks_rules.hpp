@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/pairwise_kernels.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/core/tree/traversal_info.hpp>
 #include <boost/heap/priority_queue.hpp>
@@ -42,11 +43,15 @@ class FastMKSRules
    * @param querySet Set of query data.
    * @param k Number of candidates to search for.
    * @param kernel Kernel to run FastMKS with.
+   * @param epsilon Relative approximation error; a node is pruned if its
+   *     maximum kernel value is not larger than the current k'th best kernel
+   *     value divided by (1 - epsilon).
    */
   FastMKSRules(const typename TreeType::Mat& referenceSet,
                const typename TreeType::Mat& querySet,
                const size_t k,
-               KernelType& kernel);
+               KernelType& kernel,
+               const double epsilon = 0.0);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -59,6 +64,11 @@ class FastMKSRules
   //! Compute the base case (kernel value) between two points.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  //! Compute the base cases between every given query point and every given
+  //! reference point, evaluating the kernel as a single block.
+  void BlockBaseCase(const arma::uvec& queryIndices,
+                     const arma::uvec& referenceIndices);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -158,6 +168,9 @@ class FastMKSRules
   //! Number of points to search for.
   const size_t k;
 
+  //! Relative approximation error.
+  const double epsilon;
+
   //! Cached query set self-kernels (|| q || for each q).
   arma::vec queryKernels;
   //! Cached reference set self-kernels (|| r || for each r).
@@ -176,6 +189,9 @@ class FastMKSRules
   //! Calculate the bound for a given query node.
   double CalculateBound(TreeType& queryNode) const;
 
+  //! Relax the given pruning bound (the k'th best kernel value) by epsilon.
+  double Relax(const double bound) const;
+
   /**
    * Helper function to insert a point into the list of candidate points.
    *
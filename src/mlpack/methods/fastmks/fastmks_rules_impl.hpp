@@ -23,10 +23,12 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     const typename TreeType::Mat& referenceSet,
     const typename TreeType::Mat& querySet,
     const size_t k,
-    KernelType& kernel) :
+    KernelType& kernel,
+    const double epsilon) :
     referenceSet(referenceSet),
     querySet(querySet),
     k(k),
+    epsilon(epsilon),
     kernel(kernel),
     lastQueryIndex(-1),
     lastReferenceIndex(-1),
@@ -124,12 +126,51 @@ double FastMKSRules<KernelType, TreeType>::BaseCase(
   return kernelEval;
 }
 
+template<typename KernelType, typename TreeType>
+void FastMKSRules<KernelType, TreeType>::BlockBaseCase(
+    const arma::uvec& queryIndices,
+    const arma::uvec& referenceIndices)
+{
+  // kernels(r, q) holds the kernel value between the r'th reference point and
+  // the q'th query point.
+  arma::mat kernels;
+  kernel::PairwiseKernels(kernel, referenceSet, referenceIndices, querySet,
+      queryIndices, kernels);
+
+  for (size_t q = 0; q < queryIndices.n_elem; ++q)
+  {
+    const size_t queryIndex = queryIndices[q];
+    for (size_t r = 0; r < referenceIndices.n_elem; ++r)
+    {
+      const size_t referenceIndex = referenceIndices[r];
+
+      // Skip the same pairs that BaseCase() would skip.
+      if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
+      {
+        if ((queryIndex == lastQueryIndex) &&
+            (referenceIndex == lastReferenceIndex))
+          continue;
+
+        lastQueryIndex = queryIndex;
+        lastReferenceIndex = referenceIndex;
+        lastKernel = kernels(r, q);
+      }
+
+      ++baseCases;
+      if ((&querySet == &referenceSet) && (queryIndex == referenceIndex))
+        continue;
+
+      InsertNeighbor(queryIndex, referenceIndex, kernels(r, q));
+    }
+  }
+}
+
 template<typename KernelType, typename TreeType>
 double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
                                                  TreeType& referenceNode)
 {
   // Compare with the current best.
-  const double bestKernel = candidates[queryIndex].top().first;
+  const double bestKernel = Relax(candidates[queryIndex].top().first);
 
   // See if we can perform a parent-child prune.
   const double furthestDist = referenceNode.FurthestDescendantDistance();
@@ -184,7 +225,7 @@ double FastMKSRules<KernelType, TreeType>::Score(const size_t queryIndex,
   }
   else
   {
-    arma::vec refCenter;
+    arma::Col<typename TreeType::ElemType> refCenter;
     referenceNode.Center(refCenter);
 
     kernelEval = kernel.Evaluate(querySet.col(queryIndex), refCenter);
@@ -224,7 +265,7 @@ double FastMKSRules<KernelType, TreeType>::Score(TreeType& queryNode,
 {
   // Update and get the query node's bound.
   queryNode.Stat().Bound() = CalculateBound(queryNode);
-  const double bestKernel = queryNode.Stat().Bound();
+  const double bestKernel = Relax(queryNode.Stat().Bound());
 
   // First, see if we can make a parent-child or parent-parent prune.  These
   // four bounds on the maximum kernel value are looser than the bound normally
@@ -352,8 +393,8 @@ double FastMKSRules<KernelType, TreeType>::Score(TreeType& queryNode,
   else
   {
     // Calculate the maximum possible kernel value.
-    arma::vec queryCenter;
-    arma::vec refCenter;
+    arma::Col<typename TreeType::ElemType> queryCenter;
+    arma::Col<typename TreeType::ElemType> refCenter;
     queryNode.Center(queryCenter);
     referenceNode.Center(refCenter);
 
@@ -412,7 +453,7 @@ double FastMKSRules<KernelType, TreeType>::Rescore(const size_t queryIndex,
                                                    TreeType& /*referenceNode*/,
                                                    const double oldScore) const
 {
-  const double bestKernel = candidates[queryIndex].top().first;
+  const double bestKernel = Relax(candidates[queryIndex].top().first);
 
   return ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX;
 }
@@ -423,7 +464,7 @@ double FastMKSRules<KernelType, TreeType>::Rescore(TreeType& queryNode,
                                                    const double oldScore) const
 {
   queryNode.Stat().Bound() = CalculateBound(queryNode);
-  const double bestKernel = queryNode.Stat().Bound();
+  const double bestKernel = Relax(queryNode.Stat().Bound());
 
   return ((1.0 / oldScore) >= bestKernel) ? oldScore : DBL_MAX;
 }
@@ -516,6 +557,17 @@ double FastMKSRules<KernelType, TreeType>::CalculateBound(TreeType& queryNode)
   return (interA > interB) ? interA : interB;
 }
 
+template<typename KernelType, typename TreeType>
+inline double FastMKSRules<KernelType, TreeType>::Relax(const double bound)
+    const
+{
+  // Only positive bounds can be relaxed by a relative error.
+  if (epsilon == 0.0 || bound <= 0.0)
+    return bound;
+
+  return bound / (1.0 - epsilon);
+}
+
 /**
  * Helper function to insert a point into the list of candidate points.
  *
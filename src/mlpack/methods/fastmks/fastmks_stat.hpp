@@ -70,7 +70,7 @@ class FastMKSStat
     else
     {
       // Calculate the centroid.
-      arma::vec center;
+      arma::Col<typename TreeType::ElemType> center;
       node.Center(center);
 
       selfKernel = sqrt(node.Metric().Kernel().Evaluate(center, center));
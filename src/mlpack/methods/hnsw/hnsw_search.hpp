@@ -0,0 +1,327 @@
+/**
+ * @file methods/hnsw/hnsw_search.hpp
+ *
+ * Defines the HNSWSearch class, which performs approximate nearest neighbor
+ * search with a hierarchical navigable small world graph.
+ *
+ * The details of this method can be found in the following paper:
+ *
+ * @code
+ * @article{malkov2018efficient,
+ *   title={Efficient and robust approximate nearest neighbor search using
+ *       hierarchical navigable small world graphs},
+ *   author={Malkov, Yu A. and Yashunin, Dmitry A.},
+ *   journal={IEEE Transactions on Pattern Analysis and Machine Intelligence},
+ *   volume={42},
+ *   number={4},
+ *   pages={824--836},
+ *   year={2018},
+ *   publisher={IEEE}
+ * }
+ * @endcode
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HNSW_HNSW_SEARCH_HPP
+#define MLPACK_METHODS_HNSW_HNSW_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include <mutex>
+#include <queue>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The HNSWSearch class builds a hierarchical navigable small world (HNSW) graph
+ * on the reference set, and uses it to find approximate nearest neighbors of
+ * query points.
+ *
+ * Each reference point is assigned a random level, with exponentially fewer
+ * points on each higher level.  On each level, every point is linked to a small
+ * number of nearby points on that level.  A search starts at the single point
+ * of the top level, greedily descends through the upper levels, and then runs
+ * a best-first search with a list of ef candidates on the bottom level.  Larger
+ * values of ef give a higher recall at a higher cost.
+ *
+ * The graph is built in parallel with OpenMP when it is available; in that case
+ * the graph (and so the results) may depend on the number of threads.  Queries
+ * are also searched in parallel.
+ *
+ * @tparam MetricType The metric to use; this can be any mlpack metric, such as
+ *     metric::LMetric or metric::IPMetric.
+ * @tparam MatType Type of matrix to use to store the data.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat>
+class HNSWSearch
+{
+ public:
+  /**
+   * Build the graph on the given reference set.  In order to avoid copying the
+   * reference set, it is suggested to pass that parameter with std::move().
+   *
+   * @param referenceSet Set of reference points.
+   * @param maxNeighbors Number of links of each point on the levels above the
+   *     bottom level; points on the bottom level have up to twice as many.
+   * @param efConstruction Size of the candidate list used to find the links of
+   *     each point when building the graph.
+   * @param ef Default size of the candidate list used during search.
+   * @param metric Instantiated metric.
+   */
+  HNSWSearch(MatType referenceSet,
+             const size_t maxNeighbors = 16,
+             const size_t efConstruction = 200,
+             const size_t ef = 50,
+             const MetricType metric = MetricType());
+
+  /**
+   * Create an HNSWSearch object without a reference set.  Train() must be
+   * called before Search().
+   *
+   * @param maxNeighbors Number of links of each point on the levels above the
+   *     bottom level.
+   * @param efConstruction Size of the candidate list used to find the links of
+   *     each point when building the graph.
+   * @param ef Default size of the candidate list used during search.
+   * @param metric Instantiated metric.
+   */
+  HNSWSearch(const size_t maxNeighbors = 16,
+             const size_t efConstruction = 200,
+             const size_t ef = 50,
+             const MetricType metric = MetricType());
+
+  /**
+   * Build the graph on the given reference set, replacing any existing graph.
+   * The values of MaxNeighbors() and EfConstruction() are used.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Compute the approximate nearest neighbors of each point in the query set,
+   * and store the output in the given matrices.  The matrices will be set to
+   * the size of k rows by n columns, where n is the number of points in the
+   * query set.  The neighbors of each point are sorted by increasing distance.
+   * The query points are searched in parallel.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Compute the approximate nearest neighbors of each point in the reference
+   * set (not counting the point itself), and store the output in the given
+   * matrices.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param distances Matrix storing distances of neighbors for each point.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Compute the recall (% of neighbors found) given the neighbors returned by
+   * HNSWSearch::Search and a "ground truth" set of neighbors.  The recall
+   * returned will be in the range [0, 1].
+   *
+   * @param foundNeighbors Set of neighbors to compute recall of.
+   * @param realNeighbors Set of "ground truth" neighbors to compute recall
+   *     against.
+   */
+  static double ComputeRecall(const arma::Mat<size_t>& foundNeighbors,
+                              const arma::Mat<size_t>& realNeighbors);
+
+  //! Get the reference set.
+  const MatType& ReferenceSet() const { return referenceSet; }
+
+  //! Get the number of links of each point on the upper levels.
+  size_t MaxNeighbors() const { return maxNeighbors; }
+  //! Modify the number of links of each point on the upper levels.  This takes
+  //! effect on the next call to Train().
+  size_t& MaxNeighbors() { return maxNeighbors; }
+
+  //! Get the size of the candidate list used when building the graph.
+  size_t EfConstruction() const { return efConstruction; }
+  //! Modify the size of the candidate list used when building the graph.  This
+  //! takes effect on the next call to Train().
+  size_t& EfConstruction() { return efConstruction; }
+
+  //! Get the size of the candidate list used during search.
+  size_t Ef() const { return ef; }
+  //! Modify the size of the candidate list used during search.
+  size_t& Ef() { return ef; }
+
+  //! Get the highest level of the graph.
+  size_t MaxLevel() const { return maxLevel; }
+
+  //! Get the links of the given point on the given level.
+  const std::vector<size_t>& Links(const size_t point, const size_t level)
+      const { return links[point][level]; }
+
+  //! Get the number of distance evaluations performed during the last search.
+  size_t DistanceEvaluations() const { return distanceEvaluations; }
+
+  //! Get the metric.
+  const MetricType& Metric() const { return metric; }
+
+  //! Serialize the HNSW model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Candidate represents a possible neighbor (distance, index).
+  typedef std::pair<double, size_t> Candidate;
+
+  /**
+   * VisitedList marks the points visited during one search.  Instead of being
+   * cleared, it is reset by starting a new round, so it can be reused for many
+   * searches without touching all of its memory each time.
+   */
+  class VisitedList
+  {
+   public:
+    //! Create a visited list for the given number of points.
+    VisitedList(const size_t numPoints) : rounds(numPoints, 0), round(0) { }
+
+    //! Start a new search; no point is visited.
+    void Reset() { ++round; }
+
+    //! Mark the given point as visited, and return false if it already was.
+    bool Visit(const size_t point)
+    {
+      if (rounds[point] == round)
+        return false;
+      rounds[point] = round;
+      return true;
+    }
+
+   private:
+    //! The round in which each point was last visited.
+    std::vector<size_t> rounds;
+    //! The current round.
+    size_t round;
+  };
+
+  /**
+   * Insert the given point into the graph, on all levels up to its own level.
+   * The point's lists of links must already be allocated.
+   *
+   * @param point Index of the point to insert.
+   * @param visited Visited list of the calling thread.
+   * @param locks One lock per point, protecting its lists of links.
+   * @param entryLock Lock protecting the entry point and the maximum level.
+   */
+  void InsertPoint(const size_t point,
+                   VisitedList& visited,
+                   std::vector<std::mutex>& locks,
+                   std::mutex& entryLock);
+
+  /**
+   * Descend greedily from the given point through the levels above the given
+   * level, and return the closest point found on the lowest of them.
+   *
+   * @param query Query point.
+   * @param entry Entry point and its distance to the query; it is updated.
+   * @param fromLevel Level to start the descent on.
+   * @param toLevel Level to stop the descent above.
+   * @param locks Locks of the lists of links, or NULL if the graph is not being
+   *     modified.
+   * @param evaluations Counter of distance evaluations.
+   */
+  template<typename VecType>
+  void GreedyDescent(const VecType& query,
+                     Candidate& entry,
+                     const size_t fromLevel,
+                     const size_t toLevel,
+                     std::vector<std::mutex>* locks,
+                     size_t& evaluations);
+
+  /**
+   * Run a best-first search from the given entry point on the given level, and
+   * return the (at most) ef closest points found, sorted by distance.
+   *
+   * @param query Query point.
+   * @param entry Entry point and its distance to the query.
+   * @param ef Size of the candidate list.
+   * @param level Level to search.
+   * @param visited Visited list of the calling thread.
+   * @param locks Locks of the lists of links, or NULL if the graph is not being
+   *     modified.
+   * @param evaluations Counter of distance evaluations.
+   * @param results Vector to store the closest points in.
+   */
+  template<typename VecType>
+  void SearchLevel(const VecType& query,
+                   const Candidate& entry,
+                   const size_t ef,
+                   const size_t level,
+                   VisitedList& visited,
+                   std::vector<std::mutex>* locks,
+                   size_t& evaluations,
+                   std::vector<Candidate>& results);
+
+  /**
+   * Select at most maxLinks points from the given candidates (sorted by
+   * distance) with the heuristic of Malkov and Yashunin: a candidate is kept
+   * only if it is closer to the base point than to every candidate kept so
+   * far.  This keeps links in different directions, which helps the search.
+   *
+   * @param candidates Candidates sorted by distance to the base point.
+   * @param maxLinks Maximum number of points to select.
+   * @param selected Vector to store the indices of the selected points in.
+   */
+  void SelectNeighbors(const std::vector<Candidate>& candidates,
+                       const size_t maxLinks,
+                       std::vector<size_t>& selected);
+
+  //! Return the maximum number of links of a point on the given level.
+  size_t MaxLinks(const size_t level) const
+  { return (level == 0) ? 2 * maxNeighbors : maxNeighbors; }
+
+  //! Reference dataset.
+  MatType referenceSet;
+
+  //! Number of links of each point on the levels above the bottom level.
+  size_t maxNeighbors;
+  //! Size of the candidate list when building the graph.
+  size_t efConstruction;
+  //! Size of the candidate list during search.
+  size_t ef;
+
+  //! Instantiated metric.
+  MetricType metric;
+
+  //! The links of each point on each of its levels.
+  std::vector<std::vector<std::vector<size_t>>> links;
+  //! The point the searches start from; it is on the highest level.
+  size_t entryPoint;
+  //! The highest level of the graph.
+  size_t maxLevel;
+
+  //! The number of distance evaluations of the last search.
+  size_t distanceEvaluations;
+}; // class HNSWSearch
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "hnsw_search_impl.hpp"
+
+#endif
@@ -0,0 +1,470 @@
+/**
+ * @file methods/hnsw/hnsw_search_impl.hpp
+ *
+ * Implementation of the HNSWSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HNSW_HNSW_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_HNSW_HNSW_SEARCH_IMPL_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+// In case it hasn't been included yet.
+#include "hnsw_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+// Construct the object and build the graph.
+template<typename MetricType, typename MatType>
+HNSWSearch<MetricType, MatType>::HNSWSearch(MatType referenceSet,
+                                            const size_t maxNeighbors,
+                                            const size_t efConstruction,
+                                            const size_t ef,
+                                            const MetricType metric) :
+    maxNeighbors(maxNeighbors),
+    efConstruction(efConstruction),
+    ef(ef),
+    metric(metric),
+    entryPoint(0),
+    maxLevel(0),
+    distanceEvaluations(0)
+{
+  Train(std::move(referenceSet));
+}
+
+// Construct the object without a reference set.
+template<typename MetricType, typename MatType>
+HNSWSearch<MetricType, MatType>::HNSWSearch(const size_t maxNeighbors,
+                                            const size_t efConstruction,
+                                            const size_t ef,
+                                            const MetricType metric) :
+    maxNeighbors(maxNeighbors),
+    efConstruction(efConstruction),
+    ef(ef),
+    metric(metric),
+    entryPoint(0),
+    maxLevel(0),
+    distanceEvaluations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Train(MatType referenceSetIn)
+{
+  if (maxNeighbors < 2)
+    throw std::invalid_argument("HNSWSearch::Train(): maxNeighbors must be at "
+        "least 2");
+  if (efConstruction == 0)
+    throw std::invalid_argument("HNSWSearch::Train(): efConstruction must be "
+        "greater than 0");
+
+  referenceSet = std::move(referenceSetIn);
+  links.clear();
+  entryPoint = 0;
+  maxLevel = 0;
+
+  const size_t numPoints = referenceSet.n_cols;
+  if (numPoints == 0)
+    return;
+
+  // Draw the level of each point from a geometric distribution, so that each
+  // level holds about 1 / maxNeighbors of the points of the level below.  The
+  // levels are drawn before the parallel construction, so they only depend on
+  // the random seed.
+  const double levelMult = 1.0 / std::log((double) maxNeighbors);
+  links.resize(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const size_t level = (size_t) (-std::log(1.0 - math::Random()) *
+        levelMult);
+    links[i].resize(level + 1);
+  }
+
+  // The first point is the initial entry point.
+  maxLevel = links[0].size() - 1;
+
+  std::vector<std::mutex> locks(numPoints);
+  std::mutex entryLock;
+
+  Timer::Start("hnsw_construction");
+
+  #pragma omp parallel
+  {
+    VisitedList visited(numPoints);
+
+    #pragma omp for schedule(dynamic, 64)
+    for (omp_size_t i = 1; i < (omp_size_t) numPoints; ++i)
+      InsertPoint(i, visited, locks, entryLock);
+  }
+
+  Timer::Stop("hnsw_construction");
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Search(const MatType& querySet,
+                                             const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances)
+{
+  if (referenceSet.n_cols == 0)
+    throw std::invalid_argument("HNSWSearch::Search(): the model has no "
+        "reference set; call Train() first");
+
+  if (k > referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "HNSWSearch::Search(): requested value of k (" << k << ") is greater"
+        << " than the number of points in the reference set ("
+        << referenceSet.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (querySet.n_rows != referenceSet.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "HNSWSearch::Search(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << referenceSet.n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  const size_t searchEf = std::max(ef, k);
+  size_t evaluations = 0;
+
+  Timer::Start("computing_neighbors");
+
+  #pragma omp parallel reduction(+:evaluations)
+  {
+    VisitedList visited(referenceSet.n_cols);
+    std::vector<Candidate> results;
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+    {
+      Candidate entry(metric.Evaluate(querySet.col(i),
+          referenceSet.col(entryPoint)), entryPoint);
+      ++evaluations;
+
+      GreedyDescent(querySet.col(i), entry, maxLevel, 0, NULL, evaluations);
+      SearchLevel(querySet.col(i), entry, searchEf, 0, visited, NULL,
+          evaluations, results);
+
+      // The search may find fewer than k points if the graph is not
+      // connected; the missing neighbors are marked as not found.
+      for (size_t j = 0; j < k; ++j)
+      {
+        neighbors(j, i) = (j < results.size()) ? results[j].second : SIZE_MAX;
+        distances(j, i) = (j < results.size()) ? results[j].first : DBL_MAX;
+      }
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+
+  distanceEvaluations = evaluations;
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Search(const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances)
+{
+  if (k >= referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "HNSWSearch::Search(): requested value of k (" << k << ") must be "
+        << "less than the number of points in the reference set ("
+        << referenceSet.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Search for one more neighbor, since each point will usually find itself.
+  arma::Mat<size_t> allNeighbors;
+  arma::mat allDistances;
+  Search(referenceSet, k + 1, allNeighbors, allDistances);
+
+  neighbors.set_size(k, referenceSet.n_cols);
+  distances.set_size(k, referenceSet.n_cols);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    // Skip the point itself; if it was not found, drop the last neighbor.
+    size_t j = 0;
+    for (size_t l = 0; l <= k && j < k; ++l)
+    {
+      if (allNeighbors(l, i) == i)
+        continue;
+
+      neighbors(j, i) = allNeighbors(l, i);
+      distances(j, i) = allDistances(l, i);
+      ++j;
+    }
+  }
+}
+
+template<typename MetricType, typename MatType>
+double HNSWSearch<MetricType, MatType>::ComputeRecall(
+    const arma::Mat<size_t>& foundNeighbors,
+    const arma::Mat<size_t>& realNeighbors)
+{
+  if (foundNeighbors.n_rows != realNeighbors.n_rows ||
+      foundNeighbors.n_cols != realNeighbors.n_cols)
+    throw std::invalid_argument("HNSWSearch::ComputeRecall(): matrices "
+        "provided must have equal size");
+
+  // The recall is the set intersection of found and real neighbors.
+  size_t found = 0;
+  for (size_t col = 0; col < foundNeighbors.n_cols; ++col)
+    for (size_t row = 0; row < foundNeighbors.n_rows; ++row)
+      for (size_t nei = 0; nei < realNeighbors.n_rows; ++nei)
+        if (realNeighbors(row, col) == foundNeighbors(nei, col))
+        {
+          found++;
+          break;
+        }
+
+  return ((double) found) / realNeighbors.n_elem;
+}
+
+template<typename MetricType, typename MatType>
+template<typename Archive>
+void HNSWSearch<MetricType, MatType>::serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(referenceSet);
+  ar & BOOST_SERIALIZATION_NVP(maxNeighbors);
+  ar & BOOST_SERIALIZATION_NVP(efConstruction);
+  ar & BOOST_SERIALIZATION_NVP(ef);
+  ar & BOOST_SERIALIZATION_NVP(metric);
+  ar & BOOST_SERIALIZATION_NVP(links);
+  ar & BOOST_SERIALIZATION_NVP(entryPoint);
+  ar & BOOST_SERIALIZATION_NVP(maxLevel);
+
+  if (Archive::is_loading::value)
+    distanceEvaluations = 0;
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::InsertPoint(
+    const size_t point,
+    VisitedList& visited,
+    std::vector<std::mutex>& locks,
+    std::mutex& entryLock)
+{
+  const size_t level = links[point].size() - 1;
+
+  // If this point will be the new entry point, keep the lock until it has been
+  // inserted, so that no other thread starts a search from a point without any
+  // links.
+  std::unique_lock<std::mutex> entryGuard(entryLock);
+  const size_t currentMaxLevel = maxLevel;
+  Candidate entry(0.0, entryPoint);
+  if (level <= currentMaxLevel)
+    entryGuard.unlock();
+
+  typedef typename MatType::elem_type ElemType;
+  const arma::Col<ElemType> query = referenceSet.col(point);
+
+  size_t evaluations = 0;
+  entry.first = metric.Evaluate(query, referenceSet.col(entry.second));
+  GreedyDescent(query, entry, currentMaxLevel, level, &locks, evaluations);
+
+  std::vector<Candidate> candidates;
+  std::vector<size_t> selected;
+  std::vector<Candidate> linkCandidates;
+  for (size_t l = std::min(level, currentMaxLevel) + 1; l-- > 0; )
+  {
+    SearchLevel(query, entry, efConstruction, l, visited, &locks, evaluations,
+        candidates);
+    SelectNeighbors(candidates, maxNeighbors, selected);
+
+    {
+      std::lock_guard<std::mutex> guard(locks[point]);
+      links[point][l] = selected;
+    }
+
+    // Link the selected points back to the new point.  If a point then has too
+    // many links, select its links again.
+    for (size_t i = 0; i < selected.size(); ++i)
+    {
+      const size_t other = selected[i];
+      std::lock_guard<std::mutex> guard(locks[other]);
+      std::vector<size_t>& otherLinks = links[other][l];
+      if (otherLinks.size() < MaxLinks(l))
+      {
+        otherLinks.push_back(point);
+        continue;
+      }
+
+      linkCandidates.clear();
+      linkCandidates.push_back(Candidate(metric.Evaluate(query,
+          referenceSet.col(other)), point));
+      for (size_t j = 0; j < otherLinks.size(); ++j)
+      {
+        linkCandidates.push_back(Candidate(metric.Evaluate(
+            referenceSet.col(other), referenceSet.col(otherLinks[j])),
+            otherLinks[j]));
+      }
+      std::sort(linkCandidates.begin(), linkCandidates.end());
+      SelectNeighbors(linkCandidates, MaxLinks(l), otherLinks);
+    }
+
+    // The closest point found is the entry point for the next level.
+    entry = candidates[0];
+  }
+
+  if (level > currentMaxLevel)
+  {
+    entryPoint = point;
+    maxLevel = level;
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename VecType>
+void HNSWSearch<MetricType, MatType>::GreedyDescent(
+    const VecType& query,
+    Candidate& entry,
+    const size_t fromLevel,
+    const size_t toLevel,
+    std::vector<std::mutex>* locks,
+    size_t& evaluations)
+{
+  std::vector<size_t> lockedLinks;
+  for (size_t l = fromLevel; l > toLevel; --l)
+  {
+    // Move to the closest linked point until no linked point is closer.
+    bool changed = true;
+    while (changed)
+    {
+      changed = false;
+
+      const std::vector<size_t>* currentLinks = &links[entry.second][l];
+      if (locks)
+      {
+        std::lock_guard<std::mutex> guard((*locks)[entry.second]);
+        lockedLinks = *currentLinks;
+        currentLinks = &lockedLinks;
+      }
+
+      for (size_t i = 0; i < currentLinks->size(); ++i)
+      {
+        const size_t candidate = (*currentLinks)[i];
+        const double distance = metric.Evaluate(query,
+            referenceSet.col(candidate));
+        ++evaluations;
+        if (distance < entry.first)
+        {
+          entry = Candidate(distance, candidate);
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename VecType>
+void HNSWSearch<MetricType, MatType>::SearchLevel(
+    const VecType& query,
+    const Candidate& entry,
+    const size_t ef,
+    const size_t level,
+    VisitedList& visited,
+    std::vector<std::mutex>* locks,
+    size_t& evaluations,
+    std::vector<Candidate>& results)
+{
+  // The candidates still to expand, closest first, and the ef closest points
+  // found so far, furthest first.
+  std::priority_queue<Candidate, std::vector<Candidate>,
+      std::greater<Candidate>> candidates;
+  std::priority_queue<Candidate> best;
+
+  visited.Reset();
+  visited.Visit(entry.second);
+  candidates.push(entry);
+  best.push(entry);
+
+  std::vector<size_t> lockedLinks;
+  while (!candidates.empty())
+  {
+    const Candidate current = candidates.top();
+    if (current.first > best.top().first && best.size() >= ef)
+      break;
+    candidates.pop();
+
+    const std::vector<size_t>* currentLinks = &links[current.second][level];
+    if (locks)
+    {
+      std::lock_guard<std::mutex> guard((*locks)[current.second]);
+      lockedLinks = *currentLinks;
+      currentLinks = &lockedLinks;
+    }
+
+    for (size_t i = 0; i < currentLinks->size(); ++i)
+    {
+      const size_t neighbor = (*currentLinks)[i];
+      if (!visited.Visit(neighbor))
+        continue;
+
+      const double distance = metric.Evaluate(query,
+          referenceSet.col(neighbor));
+      ++evaluations;
+      if (best.size() < ef || distance < best.top().first)
+      {
+        candidates.push(Candidate(distance, neighbor));
+        best.push(Candidate(distance, neighbor));
+        if (best.size() > ef)
+          best.pop();
+      }
+    }
+  }
+
+  results.resize(best.size());
+  for (size_t i = best.size(); i > 0; --i)
+  {
+    results[i - 1] = best.top();
+    best.pop();
+  }
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::SelectNeighbors(
+    const std::vector<Candidate>& candidates,
+    const size_t maxLinks,
+    std::vector<size_t>& selected)
+{
+  selected.clear();
+  for (size_t i = 0; i < candidates.size() && selected.size() < maxLinks; ++i)
+  {
+    bool keep = true;
+    for (size_t j = 0; j < selected.size(); ++j)
+    {
+      if (metric.Evaluate(referenceSet.col(candidates[i].second),
+          referenceSet.col(selected[j])) < candidates[i].first)
+      {
+        keep = false;
+        break;
+      }
+    }
+
+    if (keep)
+      selected.push_back(candidates[i].second);
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
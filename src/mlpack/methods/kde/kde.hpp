@@ -199,6 +199,9 @@ class KDE
    *
    * - Use std::move if the query tree is no longer needed.
    *
+   * - The query tree can be built once and reused for many calls; the
+   *   statistics left in it by an earlier evaluation are cleaned first.
+   *
    * @pre The model has to be previously trained and mode has to be dual-tree.
    * @param queryTree Tree of query points to get the density of.
    * @param oldFromNewQueries Mappings of query points to the tree dataset.
@@ -465,15 +465,13 @@ Evaluate(Tree* queryTree,
                                 "dual-tree");
   }
 
-  // Clean accumulated alpha if Monte Carlo estimations are available.
-  if (monteCarlo && std::is_same<KernelType, kernel::GaussianKernel>::value)
-  {
-    Timer::Start("cleaning_query_tree");
-    KDECleanRules<Tree> cleanRules;
-    SingleTreeTraversalType<KDECleanRules<Tree>> cleanTraverser(cleanRules);
-    cleanTraverser.Traverse(0, *queryTree);
-    Timer::Stop("cleaning_query_tree");
-  }
+  // Clean the error tolerance (and the Monte Carlo alpha) accumulated by any
+  // earlier evaluation, so that the tree can be reused.
+  Timer::Start("cleaning_query_tree");
+  KDECleanRules<Tree> cleanRules;
+  SingleTreeTraversalType<KDECleanRules<Tree>> cleanTraverser(cleanRules);
+  cleanTraverser.Traverse(0, *queryTree);
+  Timer::Stop("cleaning_query_tree");
 
   Timer::Start("computing_kde");
 
@@ -534,15 +532,13 @@ Evaluate(arma::vec& estimations)
   estimations.set_size(referenceTree->Dataset().n_cols);
   estimations.fill(arma::fill::zeros);
 
-  // Clean accumulated alpha if Monte Carlo estimations are available.
-  if (monteCarlo && std::is_same<KernelType, kernel::GaussianKernel>::value)
-  {
-    Timer::Start("cleaning_query_tree");
-    KDECleanRules<Tree> cleanRules;
-    SingleTreeTraversalType<KDECleanRules<Tree>> cleanTraverser(cleanRules);
-    cleanTraverser.Traverse(0, *referenceTree);
-    Timer::Stop("cleaning_query_tree");
-  }
+  // Clean the error tolerance (and the Monte Carlo alpha) accumulated by any
+  // earlier evaluation, so that the tree can be reused.
+  Timer::Start("cleaning_query_tree");
+  KDECleanRules<Tree> cleanRules;
+  SingleTreeTraversalType<KDECleanRules<Tree>> cleanTraverser(cleanRules);
+  cleanTraverser.Traverse(0, *referenceTree);
+  Timer::Stop("cleaning_query_tree");
 
   Timer::Start("computing_kde");
 
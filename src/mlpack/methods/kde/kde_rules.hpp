@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_KDE_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/pairwise_distances.hpp>
 
 namespace mlpack {
 namespace kde {
@@ -63,6 +64,11 @@ class KDERules
   //! Base Case.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  //! Run the base cases between every given query point and every given
+  //! reference point, computing the distances as a single block.
+  void BlockBaseCase(const arma::uvec& queryIndices,
+                     const arma::uvec& referenceIndices);
+
   //! SingleTree Rescore.
   double Score(const size_t queryIndex, TreeType& referenceNode);
 
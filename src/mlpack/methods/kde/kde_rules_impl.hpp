@@ -96,6 +96,44 @@ double KDERules<MetricType, KernelType, TreeType>::BaseCase(
   return distance;
 }
 
+//! Block of base cases.
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::BlockBaseCase(
+    const arma::uvec& queryIndices,
+    const arma::uvec& referenceIndices)
+{
+  // distances(r, q) holds the distance between the r'th reference point and
+  // the q'th query point.
+  arma::mat distances;
+  metric::PairwiseDistances(metric, referenceSet, referenceIndices, querySet,
+      queryIndices, distances);
+
+  for (size_t q = 0; q < queryIndices.n_elem; ++q)
+  {
+    const size_t queryIndex = queryIndices[q];
+    for (size_t r = 0; r < referenceIndices.n_elem; ++r)
+    {
+      const size_t referenceIndex = referenceIndices[r];
+
+      // Skip the same pairs that BaseCase() would skip.
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceIndex))
+        continue;
+
+      const double kernelValue = kernel.Evaluate(distances(r, q));
+      densities(queryIndex) += kernelValue;
+      accumError(queryIndex) += 2 * relError * kernelValue;
+
+      ++baseCases;
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+      traversalInfo.LastBaseCase() = distances(r, q);
+    }
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename KernelType, typename TreeType>
 inline double KDERules<MetricType, KernelType, TreeType>::
@@ -99,6 +99,9 @@ PARAM_DOUBLE_IN("hash_width", "The hash width for the first-level hashing in "
     "a hash width for its use.", "H", 0.0);
 PARAM_INT_IN("num_probes", "Number of additional probes for multiprobe LSH; if "
     "0, traditional LSH is used.", "T", 0);
+PARAM_INT_IN("candidate_budget", "If nonzero, at most this many distinct "
+    "candidates are examined for each query; probing stops once they have been "
+    "found.", "", 0);
 PARAM_INT_IN("second_hash_size", "The size of the second level hash table.",
     "S", 99901);
 PARAM_INT_IN("bucket_size", "The size of a bucket in the second level hash.",
@@ -122,6 +125,8 @@ static void mlpackMain()
       "second hash size must be greater than 0");
   RequireParamValue<int>("bucket_size", [](int x) { return x > 0; }, true,
       "bucket size must be greater than 0");
+  RequireParamValue<int>("candidate_budget", [](int x) { return x >= 0; },
+      true, "candidate budget must be nonnegative");
 
   size_t k = IO::GetParam<int>("k");
   size_t secondHashSize = IO::GetParam<int>("second_hash_size");
@@ -166,6 +171,7 @@ static void mlpackMain()
   const size_t numTables = IO::GetParam<int>("tables");
   const double hashWidth = IO::GetParam<double>("hash_width");
   const size_t numProbes = (size_t) IO::GetParam<int>("num_probes");
+  const size_t candidateBudget = (size_t) IO::GetParam<int>("candidate_budget");
 
   arma::Mat<size_t> neighbors;
   arma::mat distances;
@@ -205,11 +211,13 @@ static void mlpackMain()
           << IO::GetPrintableParam<arma::mat>("query") << "." << endl;
       queryData = std::move(IO::GetParam<arma::mat>("query"));
 
-      allkann->Search(queryData, k, neighbors, distances, 0, numProbes);
+      allkann->Search(queryData, k, neighbors, distances, 0, numProbes,
+          candidateBudget);
     }
     else
     {
-      allkann->Search(k, neighbors, distances, 0, numProbes);
+      allkann->Search(k, neighbors, distances, 0, numProbes,
+          candidateBudget);
     }
 
     Log::Info << "Neighbors computed." << endl;
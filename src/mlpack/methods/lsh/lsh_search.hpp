@@ -216,13 +216,18 @@ class LSHSearch
    *     considered.
    * @param T The number of additional probing bins to examine with multiprobe
    *     LSH. If T = 0, classic single-probe LSH is run (default).
+   * @param candidateBudget If nonzero, at most this many distinct candidates
+   *     are examined for each query: probing stops as soon as they have been
+   *     gathered, so the number of probes adapts to the density around each
+   *     query.  If 0 (the default), all T additional bins are always probed.
    */
   void Search(const MatType& querySet,
               const size_t k,
               arma::Mat<size_t>& resultingNeighbors,
               arma::mat& distances,
               const size_t numTablesToSearch = 0,
-              const size_t T = 0);
+              const size_t T = 0,
+              const size_t candidateBudget = 0);
 
   /**
    * Compute the nearest neighbors and store the output in the given matrices.
@@ -242,12 +247,17 @@ class LSHSearch
    *     By default, this is set to zero in which case all tables are
    *     considered.
    * @param T Number of probing bins.
+   * @param candidateBudget If nonzero, at most this many distinct candidates
+   *     are examined for each query: probing stops as soon as they have been
+   *     gathered.  If 0 (the default), all T additional bins are always
+   *     probed.
    */
   void Search(const size_t k,
               arma::Mat<size_t>& resultingNeighbors,
               arma::mat& distances,
               const size_t numTablesToSearch = 0,
-              size_t T = 0);
+              size_t T = 0,
+              const size_t candidateBudget = 0);
 
   /**
    * Compute the recall (% of neighbors found) given the neighbors returned by
@@ -290,9 +300,22 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
-      { return secondHashTable; }
+  //! Get the contents of all the buckets of the second hash table, stored
+  //! contiguously.  Bucket i (in order of first use) is held in
+  //! BucketContents()[BucketOffsets()[i]] to
+  //! BucketContents()[BucketOffsets()[i + 1] - 1].
+  const arma::Col<arma::u32>& BucketContents() const { return bucketContents; }
+
+  //! Get the offset of each bucket in BucketContents().  There is one more
+  //! element than there are nonempty buckets.
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
+  /**
+   * Get the second hash table, with one vector per nonempty bucket.  This
+   * builds a copy from the compact representation; prefer BucketContents() and
+   * BucketOffsets().
+   */
+  mlpack_deprecated std::vector<arma::Col<size_t>> SecondHashTable() const;
 
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
@@ -320,12 +343,19 @@ class LSHSearch
    *    0, all tables are searched.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
    *    single-probe is used.
+   * @param candidateBudget If nonzero, stop probing once this many distinct
+   *    candidates have been found; no more candidates than that are returned.
+   * @param candidateMask Scratch bitmap with one entry per reference point,
+   *    used to discard duplicate candidates.  It must be all false on entry,
+   *    and is all false again on return; each thread should hold its own.
    */
   template<typename VecType>
   void ReturnIndicesFromTable(const VecType& queryPoint,
                               arma::uvec& referenceIndices,
                               size_t numTablesToSearch,
-                              const size_t T) const;
+                              const size_t T,
+                              const size_t candidateBudget,
+                              std::vector<bool>& candidateMask) const;
 
   /**
    * This is a helper function that computes the distance of the query to the
@@ -450,16 +480,17 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! The final hash table: the point indices held in every nonempty bucket
+  //! (at most bucketSize per bucket), stored back to back.
+  arma::Col<arma::u32> bucketContents;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The offset of each nonempty bucket in bucketContents; the last element is
+  //! the total number of stored indices.
+  arma::Col<size_t> bucketOffsets;
 
-  //! For a particular hash value, points to the row in secondHashTable
-  //! corresponding to this value. Length secondHashSize.
+  //! For a particular hash value, points to the bucket (row) in the compact
+  //! table corresponding to this value, or secondHashSize if the bucket is
+  //! empty. Length secondHashSize.
   arma::Col<size_t> bucketRowInHashTable;
 
   //! The number of distance evaluations.
@@ -486,7 +517,7 @@ class LSHSearch
 
 //! Set the serialization version of the LSHSearch class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::LSHSearch<SortPolicy>, 1);
+    mlpack::neighbor::LSHSearch<SortPolicy>, 2);
 
 // Include implementation.
 #include "lsh_search_impl.hpp"
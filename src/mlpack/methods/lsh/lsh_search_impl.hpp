@@ -83,8 +83,8 @@ LSHSearch<SortPolicy, MatType>::LSHSearch(const LSHSearch& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
-    secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
+    bucketContents(other.bucketContents),
+    bucketOffsets(other.bucketOffsets),
     bucketRowInHashTable(other.bucketRowInHashTable),
     distanceEvaluations(other.distanceEvaluations)
 {
@@ -103,8 +103,8 @@ LSHSearch<SortPolicy, MatType>::LSHSearch(LSHSearch&& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
-    secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
+    bucketContents(std::move(other.bucketContents)),
+    bucketOffsets(std::move(other.bucketOffsets)),
     bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
     distanceEvaluations(other.distanceEvaluations)
 {
@@ -131,8 +131,8 @@ LSHSearch<SortPolicy, MatType>& LSHSearch<SortPolicy, MatType>::operator=(
   secondHashSize = other.secondHashSize;
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
-  secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
+  bucketContents = other.bucketContents;
+  bucketOffsets = other.bucketOffsets;
   bucketRowInHashTable = other.bucketRowInHashTable;
   distanceEvaluations = other.distanceEvaluations;
 
@@ -153,8 +153,8 @@ LSHSearch<SortPolicy, MatType>& LSHSearch<SortPolicy, MatType>::operator=(
   secondHashSize = other.secondHashSize;
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
-  secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
+  bucketContents = std::move(other.bucketContents);
+  bucketOffsets = std::move(other.bucketOffsets);
   bucketRowInHashTable = std::move(other.bucketRowInHashTable);
   distanceEvaluations = other.distanceEvaluations;
 
@@ -179,6 +179,16 @@ void LSHSearch<SortPolicy, MatType>::Train(MatType referenceSet,
                                            const size_t bucketSize,
                                            const arma::cube& projection)
 {
+  // The buckets hold 32-bit point indices.
+  if (referenceSet.n_cols > (size_t) std::numeric_limits<arma::u32>::max())
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Train(): reference set has " << referenceSet.n_cols
+        << " points, but at most " << std::numeric_limits<arma::u32>::max()
+        << " are supported!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
   // Set new reference set.
   this->referenceSet = std::move(referenceSet);
 
@@ -310,36 +320,45 @@ void LSHSearch<SortPolicy, MatType>::Train(MatType referenceSet,
       { return std::min(val, effectiveBucketSize); });
 
   const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
 
-  // Next we must assign each point in each table to the right second hash
-  // table.
+  // The buckets are stored contiguously in bucketContents, in the order in
+  // which they are first used, and bucketOffsets holds where each one starts.
+  // So, first assign each nonempty bucket its row, and compute the offsets from
+  // the (clamped) bucket sizes.
+  bucketOffsets.set_size(numRowsInTable + 1);
+  bucketOffsets[0] = 0;
   size_t currentRow = 0;
   for (size_t i = 0; i < numTables; ++i)
   {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
     for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
     {
       // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
+      const size_t hashInd = (size_t) secondHashVectors(i, j);
 
-      // If this is currently an empty bucket, start a new row keep track of
+      // If this is currently an empty bucket, start a new row and keep track of
       // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
       if (bucketRowInHashTable[hashInd] == secondHashSize)
       {
         bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
+        bucketOffsets[currentRow + 1] = bucketOffsets[currentRow] +
+            secondHashBinCounts[hashInd];
         currentRow++;
       }
+    }
+  }
 
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
+  // Next we must assign each point in each table to the right bucket, skipping
+  // any points that would overflow it.
+  bucketContents.set_size(bucketOffsets[numRowsInTable]);
+  arma::Col<size_t> next = bucketOffsets.head(numRowsInTable);
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      // The point ID is 'j'.
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
+      if (next[row] < bucketOffsets[row + 1])
+        bucketContents[next[row]++] = (arma::u32) j;
     } // Loop over all points in the reference set.
   } // Loop over tables.
 
@@ -708,7 +727,9 @@ void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
     const VecType& queryPoint,
     arma::uvec& referenceIndices,
     size_t numTablesToSearch,
-    const size_t T) const
+    const size_t T,
+    const size_t candidateBudget,
+    std::vector<bool>& candidateMask) const
 {
   // Decide on the number of tables to look into.
   if (numTablesToSearch == 0) // If no user input is given, search all.
@@ -733,22 +754,46 @@ void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
   queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
   allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
 
-  // Use hashMat to store the primary probing codes and any additional codes
-  // from multiprobe LSH.
-  arma::Mat<size_t> hashMat;
-  hashMat.set_size(T + 1, numTablesToSearch);
-
   // Compute the primary hash value of each key of the query into a bucket of
-  // the secondHashTable using the secondHashWeights.
-  hashMat.row(0) = arma::conv_to<arma::Row<size_t>> // Floor by typecasting
-      ::from(secondHashWeights.t() * allProjInTables);
-  // Mod to compute 2nd-level codes.
+  // the second hash table using the secondHashWeights.
+  arma::Row<size_t> primaryCodes = arma::conv_to<arma::Row<size_t>>
+      ::from(secondHashWeights.t() * allProjInTables); // Floor by typecasting.
+
+  // Each candidate is kept once: candidateMask marks the points we have
+  // already collected, so no sort or unique pass is needed at the end.  No
+  // more candidates than the budget are ever kept.
+  std::vector<size_t> candidates;
+  auto probe = [&](const size_t hashInd)
+  {
+    const size_t tableRow = bucketRowInHashTable[hashInd];
+    if (tableRow >= secondHashSize)
+      return;
+
+    for (size_t j = bucketOffsets[tableRow]; j < bucketOffsets[tableRow + 1];
+        ++j)
+    {
+      if (candidateBudget != 0 && candidates.size() >= candidateBudget)
+        return;
+
+      const size_t index = bucketContents[j];
+      if (!candidateMask[index])
+      {
+        candidateMask[index] = true;
+        candidates.push_back(index);
+      }
+    }
+  };
+
+  // The primary bins of every table are always probed.
   for (size_t i = 0; i < numTablesToSearch; ++i)
-    hashMat(0, i) = (hashMat(0, i) % secondHashSize);
+    probe(primaryCodes[i] % secondHashSize);
 
-  // Compute hash codes of additional probing bins.
-  if (T > 0)
+  // Then probe the additional bins, most likely first: the r'th bin of every
+  // table is visited before the (r + 1)'th bin of any table, so that when the
+  // candidate budget is met we have spent the probes where they matter most.
+  if (T > 0 && (candidateBudget == 0 || candidates.size() < candidateBudget))
   {
+    arma::Mat<size_t> hashMat(T, numTablesToSearch);
     for (size_t i = 0; i < numTablesToSearch; ++i)
     {
       // Construct this table's probing sequence of length T.
@@ -758,99 +803,28 @@ void LSHSearch<SortPolicy, MatType>::ReturnIndicesFromTable(
                                 T,
                                 additionalProbingBins);
 
-      // Map each probing bin to a bin in secondHashTable (just like we did for
-      // the primary hash table).
-      hashMat(arma::span(1, T), i) = // Compute code of rows 1:end of column i
-        arma::conv_to< arma::Col<size_t> >:: // floor by typecasting to size_t
-        from(secondHashWeights.t() * additionalProbingBins);
-      for (size_t p = 1; p < T + 1; ++p)
-        hashMat(p, i) = (hashMat(p, i) % secondHashSize);
-    }
-  }
-
-  // Count number of points hashed in the same bucket as the query.
-  size_t maxNumPoints = 0;
-  for (size_t i = 0; i < numTablesToSearch; ++i)
-  {
-    for (size_t p = 0; p < T + 1; ++p)
-    {
-      const size_t hashInd = hashMat(p, i); // find query's bucket
-      const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      // Map each probing bin to a bin in the second hash table (just like we
+      // did for the primary bins).
+      hashMat.col(i) = arma::conv_to<arma::Col<size_t>>
+          ::from(secondHashWeights.t() * additionalProbingBins);
     }
-  }
 
-  // There are two ways to proceed here:
-  // Either allocate a maxNumPoints-size vector, place all candidates, and run
-  // unique on the vector to discard duplicates.
-  // Or allocate a referenceSet.n_cols size vector (i.e. number of reference
-  // points) of zeros, and mark found indices as 1.
-  // Option 1 runs faster for small maxNumPoints but worse for larger values, so
-  // we choose based on a heuristic.
-  const float cutoff = 0.1;
-  const float selectivity = static_cast<float>(maxNumPoints) /
-      static_cast<float>(referenceSet.n_cols);
-
-  if (selectivity > cutoff)
-  {
-    // Heuristic: larger maxNumPoints means we should use find() because it
-    // should be faster.
-    // Reference points hashed in the same bucket as the query are set to >0.
-    arma::Col<size_t> refPointsConsidered;
-    refPointsConsidered.zeros(referenceSet.n_cols);
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // for all tables
+    for (size_t p = 0; p < T; ++p)
     {
-      for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
-      {
-        // get the sequence code
-        size_t hashInd = hashMat(p, i);
-        size_t tableRow = bucketRowInHashTable[hashInd];
+      for (size_t i = 0; i < numTablesToSearch; ++i)
+        probe(hashMat(p, i) % secondHashSize);
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
-        {
-          // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
-        }
-      }
+      if (candidateBudget != 0 && candidates.size() >= candidateBudget)
+        break;
     }
-
-    // Only keep reference points found in at least one bucket.
-    referenceIndices = arma::find(refPointsConsidered > 0);
-    return;
   }
-  else
-  {
-    // Heuristic: smaller maxNumPoints means we should use unique() because it
-    // should be faster.
-    // Allocate space for the query's potential neighbors.
-    arma::uvec refPointsConsideredSmall;
-    refPointsConsideredSmall.zeros(maxNumPoints);
-
-    // Retrieve candidates.
-    size_t start = 0;
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
-    {
-      for (size_t p = 0; p < T + 1; ++p)
-      {
-        const size_t hashInd =  hashMat(p, i); // Find the query's bucket.
-        const size_t tableRow = bucketRowInHashTable[hashInd];
-
-        if (tableRow < secondHashSize)
-        {
-          // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
-      }
-    }
 
-    // Keep only one copy of each candidate.
-    referenceIndices = arma::unique(refPointsConsideredSmall);
-    return;
+  // Copy the candidates out, and reset only the entries of the mask we set.
+  referenceIndices.set_size(candidates.size());
+  for (size_t j = 0; j < candidates.size(); ++j)
+  {
+    referenceIndices[j] = candidates[j];
+    candidateMask[candidates[j]] = false;
   }
 }
 
@@ -862,7 +836,8 @@ void LSHSearch<SortPolicy, MatType>::Search(
     arma::Mat<size_t>& resultingNeighbors,
     arma::mat& distances,
     const size_t numTablesToSearch,
-    const size_t T)
+    const size_t T,
+    const size_t candidateBudget)
 {
   // Ensure the dimensionality of the query set is correct.
   if (querySet.n_rows != referenceSet.n_rows)
@@ -911,29 +886,30 @@ void LSHSearch<SortPolicy, MatType>::Search(
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+  // Parallelization to process more than one query at a time.  Each thread
+  // holds its own mask of the candidates it has seen for the current query.
+  #pragma omp parallel shared(resultingNeighbors, distances)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    std::vector<bool> candidateMask(referenceSet.n_cols, false);
+
+    #pragma omp for schedule(dynamic) reduction(+:avgIndicesReturned)
+    for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // second hash table to obtain the neighbor candidates.
+      arma::uvec refIndices;
+      ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
+          Teffective, candidateBudget, candidateMask);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -951,7 +927,8 @@ Search(const size_t k,
        arma::Mat<size_t>& resultingNeighbors,
        arma::mat& distances,
        const size_t numTablesToSearch,
-       size_t T)
+       size_t T,
+       const size_t candidateBudget)
 {
   // This is monochromatic search; the query set is the reference set.
   resultingNeighbors.set_size(k, referenceSet.n_cols);
@@ -977,29 +954,30 @@ Search(const size_t k,
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (omp_size_t i = 0; i < (omp_size_t) referenceSet.n_cols; ++i)
+  // Parallelization to process more than one query at a time.  Each thread
+  // holds its own mask of the candidates it has seen for the current query.
+  #pragma omp parallel shared(resultingNeighbors, distances)
   {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    std::vector<bool> candidateMask(referenceSet.n_cols, false);
+
+    #pragma omp for schedule(dynamic) reduction(+:avgIndicesReturned)
+    for (omp_size_t i = 0; i < (omp_size_t) referenceSet.n_cols; ++i)
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // second hash table to obtain the neighbor candidates.
+      arma::uvec refIndices;
+      ReturnIndicesFromTable(referenceSet.col(i), refIndices,
+          numTablesToSearch, Teffective, candidateBudget, candidateMask);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned += refIndices.n_elem;
+
+      // Sequentially go through all the candidates and save the best 'k'
+      // candidates.
+      BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -1037,6 +1015,23 @@ double LSHSearch<SortPolicy, MatType>::ComputeRecall(
   return ((double) found) / realNeighbors.n_elem;
 }
 
+template<typename SortPolicy, typename MatType>
+std::vector<arma::Col<size_t>>
+LSHSearch<SortPolicy, MatType>::SecondHashTable() const
+{
+  const size_t numRows = (bucketOffsets.n_elem == 0) ? 0 :
+      bucketOffsets.n_elem - 1;
+  std::vector<arma::Col<size_t>> secondHashTable(numRows);
+  for (size_t i = 0; i < numRows; ++i)
+  {
+    secondHashTable[i].set_size(bucketOffsets[i + 1] - bucketOffsets[i]);
+    for (size_t j = bucketOffsets[i]; j < bucketOffsets[i + 1]; ++j)
+      secondHashTable[i][j - bucketOffsets[i]] = bucketContents[j];
+  }
+
+  return secondHashTable;
+}
+
 template<typename SortPolicy, typename MatType>
 template<typename Archive>
 void LSHSearch<SortPolicy, MatType>::serialize(Archive& ar,
@@ -1071,76 +1066,100 @@ void LSHSearch<SortPolicy, MatType>::serialize(Archive& ar,
   ar & BOOST_SERIALIZATION_NVP(secondHashSize);
   ar & BOOST_SERIALIZATION_NVP(secondHashWeights);
   ar & BOOST_SERIALIZATION_NVP(bucketSize);
-  // needs specific handling for new version
 
-  // Backward compatibility: in older versions of LSHSearch, the secondHashTable
-  // was stored as an arma::Mat<size_t>.  So we need to properly load that, then
-  // prune it down to size.
-  if (version == 0)
+  if (version >= 2)
   {
-    arma::Mat<size_t> tmpSecondHashTable;
-    ar & BOOST_SERIALIZATION_NVP(tmpSecondHashTable);
-
-    // The old secondHashTable was stored in row-major format, so we transpose
-    // it.
-    tmpSecondHashTable = tmpSecondHashTable.t();
-
-    secondHashTable.resize(tmpSecondHashTable.n_cols);
-    for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
-    {
-      // Find length of each column.  We know we are at the end of the list when
-      // the value referenceSet.n_cols is seen.
-
-      size_t len = 0;
-      for (; len < tmpSecondHashTable.n_rows; ++len)
-        if (tmpSecondHashTable(len, i) == referenceSet.n_cols)
-          break;
-
-      // Set the size of the new column correctly.
-      secondHashTable[i].set_size(len);
-      for (size_t j = 0; j < len; ++j)
-        secondHashTable[i](j) = tmpSecondHashTable(j, i);
-    }
+    ar & BOOST_SERIALIZATION_NVP(bucketOffsets);
+    ar & BOOST_SERIALIZATION_NVP(bucketContents);
+    ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
   }
   else
   {
-    size_t tables;
-    if (Archive::is_saving::value)
-      tables = secondHashTable.size();
-    ar & BOOST_SERIALIZATION_NVP(tables);
+    // Backward compatibility: older versions of LSHSearch stored each bucket of
+    // the second hash table separately, together with the size of each bucket.
+    // We load those, then pack them into the contiguous representation.
+    std::vector<arma::Col<size_t>> secondHashTable;
+    arma::Col<size_t> bucketContentSize;
+
+    // In the oldest versions of LSHSearch, the secondHashTable was stored as an
+    // arma::Mat<size_t>.  So we need to properly load that, then prune it down
+    // to size.
+    if (version == 0)
+    {
+      arma::Mat<size_t> tmpSecondHashTable;
+      ar & BOOST_SERIALIZATION_NVP(tmpSecondHashTable);
 
-    // Set size of second hash table if needed.
-    if (Archive::is_loading::value)
+      // The old secondHashTable was stored in row-major format, so we transpose
+      // it.
+      tmpSecondHashTable = tmpSecondHashTable.t();
+
+      secondHashTable.resize(tmpSecondHashTable.n_cols);
+      for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
+      {
+        // Find length of each column.  We know we are at the end of the list
+        // when the value referenceSet.n_cols is seen.
+
+        size_t len = 0;
+        for (; len < tmpSecondHashTable.n_rows; ++len)
+          if (tmpSecondHashTable(len, i) == referenceSet.n_cols)
+            break;
+
+        // Set the size of the new column correctly.
+        secondHashTable[i].set_size(len);
+        for (size_t j = 0; j < len; ++j)
+          secondHashTable[i](j) = tmpSecondHashTable(j, i);
+      }
+    }
+    else
     {
-      secondHashTable.clear();
+      size_t tables;
+      ar & BOOST_SERIALIZATION_NVP(tables);
       secondHashTable.resize(tables);
+
+      ar & BOOST_SERIALIZATION_NVP(secondHashTable);
     }
 
-    ar & BOOST_SERIALIZATION_NVP(secondHashTable);
-  }
+    // Old versions of LSHSearch held bucketContentSize for all possible buckets
+    // (of size secondHashSize), but then a compressed representation was used.
+    if (version == 0)
+    {
+      // The vector was stored in the old uncompressed form.  So we need to
+      // shrink it.  But we can't do that until we have bucketRowInHashTable, so
+      // we also have to load that.
+      arma::Col<size_t> tmpBucketContentSize;
+      ar & BOOST_SERIALIZATION_NVP(tmpBucketContentSize);
+      ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+
+      // Compress into a smaller vector by just dropping all of the zeros.
+      bucketContentSize.zeros(secondHashTable.size());
+      for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
+        if (tmpBucketContentSize[i] > 0)
+          bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
+    }
+    else
+    {
+      ar & BOOST_SERIALIZATION_NVP(bucketContentSize);
+      ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+    }
 
-  // Backward compatibility: old versions of LSHSearch held bucketContentSize
-  // for all possible buckets (of size secondHashSize), but now we hold a
-  // compressed representation.
-  if (version == 0)
-  {
-    // The vector was stored in the old uncompressed form.  So we need to shrink
-    // it.  But we can't do that until we have bucketRowInHashTable, so we also
-    // have to load that.
-    arma::Col<size_t> tmpBucketContentSize;
-    ar & BOOST_SERIALIZATION_NVP(tmpBucketContentSize);
-    ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+    // Now pack the buckets.
+    bucketOffsets.set_size(secondHashTable.size() + 1);
+    bucketOffsets[0] = 0;
+    for (size_t i = 0; i < secondHashTable.size(); ++i)
+    {
+      bucketOffsets[i + 1] = bucketOffsets[i] +
+          std::min((size_t) bucketContentSize[i], secondHashTable[i].n_elem);
+    }
 
-    // Compress into a smaller vector by just dropping all of the zeros.
-    bucketContentSize.set_size(secondHashTable.size());
-    for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
-      if (tmpBucketContentSize[i] > 0)
-        bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
-  }
-  else
-  {
-    ar & BOOST_SERIALIZATION_NVP(bucketContentSize);
-    ar & BOOST_SERIALIZATION_NVP(bucketRowInHashTable);
+    bucketContents.set_size(bucketOffsets[secondHashTable.size()]);
+    for (size_t i = 0; i < secondHashTable.size(); ++i)
+    {
+      for (size_t j = bucketOffsets[i]; j < bucketOffsets[i + 1]; ++j)
+      {
+        bucketContents[j] =
+            (arma::u32) secondHashTable[i][j - bucketOffsets[i]];
+      }
+    }
   }
 
   ar & BOOST_SERIALIZATION_NVP(distanceEvaluations);
@@ -108,6 +108,10 @@ class NaiveBayesClassifier
    * classes, either re-initialize or call Means(), Variances(), and
    * Probabilities() individually to set them to the right size.
    *
+   * The incremental algorithm can be used to train on a dataset one mini-batch
+   * at a time: the statistics of each batch are computed in parallel (with
+   * Welford's algorithm on each thread) and merged into the current model.
+   *
    * @param data The dataset to train on.
    * @param labels The labels for the dataset.
    * @param numClasses The numbe of classes in the dataset.
@@ -230,6 +234,24 @@ class NaiveBayesClassifier
   //! Small value to prevent log of zero.
   double epsilon;
 
+  /**
+   * Merge the per-class counts, means and sums of squared deviations from the
+   * mean (M2) of another set of points into the given ones.
+   *
+   * @param counts Number of points of each class; updated in place.
+   * @param means Mean of each class; updated in place.
+   * @param m2 Sum of squared deviations of each class; updated in place.
+   * @param otherCounts Number of points of each class in the other set.
+   * @param otherMeans Mean of each class in the other set.
+   * @param otherM2 Sum of squared deviations of each class in the other set.
+   */
+  static void MergeMoments(arma::vec& counts,
+                           ModelMatType& means,
+                           ModelMatType& m2,
+                           const arma::vec& otherCounts,
+                           const ModelMatType& otherMeans,
+                           const ModelMatType& otherM2);
+
   /**
    * Compute the unnormalized posterior log probability of given points (log
    * likelihood). Results are returned as arma::mat, and each column represents
@@ -19,6 +19,10 @@
 
 #include <mlpack/prereqs.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 // In case it hasn't been included already.
 #include "naive_bayes_classifier.hpp"
 
@@ -109,24 +113,71 @@ void NaiveBayesClassifier<ModelMatType>::Train(
   // for each of the features with respect to each of the labels.
   if (incremental)
   {
-    // Use incremental algorithm.
-    // Fist, de-normalize probabilities.
-    probabilities *= trainingPoints;
+    // Use incremental algorithm.  First compute the count, mean, and sum of
+    // squared deviations (M2) of each class in this batch.  Each thread runs
+    // Welford's algorithm on its own share of the points, and the partial
+    // moments are then merged; see MergeMoments().
+    #ifdef HAS_OPENMP
+      const size_t numThreads = std::max(size_t(1),
+          std::min((size_t) data.n_cols, (size_t) omp_get_max_threads()));
+    #else
+      const size_t numThreads = 1;
+    #endif
+
+    std::vector<arma::vec> counts(numThreads,
+        arma::vec(numClasses, arma::fill::zeros));
+    std::vector<ModelMatType> batchMeans(numThreads,
+        ModelMatType(data.n_rows, numClasses, arma::fill::zeros));
+    std::vector<ModelMatType> batchM2(numThreads,
+        ModelMatType(data.n_rows, numClasses, arma::fill::zeros));
+
+    #pragma omp parallel for schedule(static)
+    for (omp_size_t t = 0; t < (omp_size_t) numThreads; ++t)
+    {
+      const size_t begin = t * data.n_cols / numThreads;
+      const size_t end = (t + 1) * data.n_cols / numThreads;
+      arma::Col<ElemType> delta(data.n_rows);
+      for (size_t j = begin; j < end; ++j)
+      {
+        const size_t label = labels[j];
+        ++counts[t][label];
+
+        delta = data.col(j) - batchMeans[t].col(label);
+        batchMeans[t].col(label) += delta / counts[t][label];
+        batchM2[t].col(label) += delta % (data.col(j) -
+            batchMeans[t].col(label));
+      }
+    }
 
-    for (size_t j = 0; j < data.n_cols; ++j)
+    for (size_t t = 1; t < numThreads; ++t)
     {
-      const size_t label = labels[j];
-      ++probabilities[label];
+      MergeMoments(counts[0], batchMeans[0], batchM2[0], counts[t],
+          batchMeans[t], batchM2[t]);
+    }
 
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
+    // Now merge the batch into the current model.  The model holds normalized
+    // probabilities and unbiased variances, so turn them back into counts and
+    // M2 first.
+    arma::vec modelCounts = arma::conv_to<arma::vec>::from(
+        arma::vectorise(probabilities)) * trainingPoints;
+    ModelMatType modelM2 = variances;
+    for (size_t i = 0; i < modelCounts.n_elem; ++i)
+    {
+      if (modelCounts[i] > 1)
+        modelM2.col(i) *= (modelCounts[i] - 1);
+      else
+        modelM2.col(i).zeros();
     }
 
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
+    MergeMoments(modelCounts, means, modelM2, counts[0], batchMeans[0],
+        batchM2[0]);
+
+    variances = modelM2;
+    for (size_t i = 0; i < modelCounts.n_elem; ++i)
     {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
+      probabilities[i] = modelCounts[i];
+      if (modelCounts[i] > 1)
+        variances.col(i) /= (modelCounts[i] - 1);
     }
   }
   else
@@ -168,11 +219,9 @@ void NaiveBayesClassifier<ModelMatType>::Train(
         variances.col(i) /= (probabilities[i] - 1);
   }
 
-  // Add epsilon to prevent log of zero.
-  variances += epsilon;
-
-  probabilities /= data.n_cols;
-  trainingPoints += data.n_cols;
+  // The incremental algorithm has counted the points seen in earlier calls too.
+  trainingPoints = (incremental ? trainingPoints : 0) + data.n_cols;
+  probabilities /= (incremental ? trainingPoints : data.n_cols);
 }
 
 template<typename ModelMatType>
@@ -200,6 +249,31 @@ void NaiveBayesClassifier<ModelMatType>::Train(const VecType& point,
   probabilities /= trainingPoints;
 }
 
+template<typename ModelMatType>
+void NaiveBayesClassifier<ModelMatType>::MergeMoments(
+    arma::vec& counts,
+    ModelMatType& means,
+    ModelMatType& m2,
+    const arma::vec& otherCounts,
+    const ModelMatType& otherMeans,
+    const ModelMatType& otherM2)
+{
+  // This is the pairwise update of Chan, Golub and LeVeque (1979), applied to
+  // each class separately.
+  for (size_t i = 0; i < counts.n_elem; ++i)
+  {
+    if (otherCounts[i] == 0)
+      continue;
+
+    const double total = counts[i] + otherCounts[i];
+    const arma::Col<ElemType> delta = otherMeans.col(i) - means.col(i);
+    means.col(i) += delta * (otherCounts[i] / total);
+    m2.col(i) += otherM2.col(i) + arma::square(delta) *
+        (counts[i] * otherCounts[i] / total);
+    counts[i] = total;
+  }
+}
+
 template<typename ModelMatType>
 template<typename MatType>
 void NaiveBayesClassifier<ModelMatType>::LogLikelihood(
@@ -210,24 +284,26 @@ void NaiveBayesClassifier<ModelMatType>::LogLikelihood(
       "NaiveBayesClassifier: element type of given data must match the element "
       "type of the model!");
 
-  logLikelihoods = arma::log(arma::repmat(probabilities, 1, data.n_cols));
-  ModelMatType invVar = 1.0 / variances;
-
-  // Calculate the joint log likelihood of point for each of the
-  // means.n_cols.
-
-  // Loop over every class.
-  for (size_t i = 0; i < means.n_cols; ++i)
-  {
-    // This is an adaptation of gmm::phi() for the case where the covariance is
-    // a diagonal matrix.
-    ModelMatType diffs = data - arma::repmat(means.col(i), 1, data.n_cols);
-    ModelMatType rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
-    arma::Mat<ElemType> exponents = arma::sum(diffs % rhs, 0);
-
-    logLikelihoods.row(i) += (data.n_rows / -2.0 * log(2 * M_PI) - 0.5 *
-        arma::accu(arma::log(variances.col(i))) + exponents);
-  }
+  // The log likelihood of point x under the diagonal Gaussian of class c is
+  //
+  //   log p(c) - (d / 2) log(2 pi) - 0.5 sum(log(var_c))
+  //       - 0.5 sum(mu_c^2 / var_c) + sum(x mu_c / var_c)
+  //       - 0.5 sum(x^2 / var_c),
+  //
+  // so for all classes and all points at once it is a per-class constant plus
+  // two matrix products.  Epsilon is added to the variances here (and not
+  // stored in the model) to prevent log of zero.
+  const ModelMatType smoothedVariances = variances + epsilon;
+  const ModelMatType invVar = 1.0 / smoothedVariances;
+  const ModelMatType meansInvVar = means % invVar;
+  const arma::Col<ElemType> classTerms = arma::vectorise(
+      arma::log(probabilities)) - data.n_rows / 2.0 * std::log(2 * M_PI) -
+      0.5 * arma::sum(arma::log(smoothedVariances), 0).t() -
+      0.5 * arma::sum(means % meansInvVar, 0).t();
+
+  logLikelihoods = meansInvVar.t() * data -
+      0.5 * (invVar.t() * arma::square(data));
+  logLikelihoods.each_col() += classTerms;
 }
 
 template<typename ModelMatType>
@@ -291,17 +367,11 @@ void NaiveBayesClassifier<ModelMatType>::Classify(
       "NaiveBayesClassifier: element type of given data must match the element "
       "type of the model!");
 
-  predictions.set_size(data.n_cols);
-
   ModelMatType logLikelihoods;
   LogLikelihood(data, logLikelihoods);
 
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    arma::uword maxIndex = 0;
-    logLikelihoods.unsafe_col(i).max(maxIndex);
-    predictions[i] = maxIndex;
-  }
+  predictions = arma::conv_to<arma::Row<size_t>>::from(
+      arma::index_max(logLikelihoods, 0));
 }
 
 template<typename ModelMatType>
@@ -319,32 +389,20 @@ void NaiveBayesClassifier<ModelMatType>::Classify(
       "NaiveBayesClassifier: element type of given data must match the element "
       "type of the model!");
 
-  predictions.set_size(data.n_cols);
-
   ModelMatType logLikelihoods;
   LogLikelihood(data, logLikelihoods);
 
-  predictionProbs.set_size(arma::size(logLikelihoods));
-  double maxValue, logProbX;
-  for (size_t j = 0; j < data.n_cols; ++j)
-  {
-    // The LogLikelihood() gives us the unnormalized log likelihood which is
-    // Log(Prob(X|Y)) + Log(Prob(Y)), so we subtract the normalization term.
-    // Besides, to prevent underflow in log of sum of exp of x operation (where
-    // x is a small negative value), we use logsumexp(x - max(x)) + max(x).
-    maxValue = arma::max(logLikelihoods.col(j));
-    logProbX = log(arma::accu(exp(logLikelihoods.col(j) -
-        maxValue))) + maxValue;
-    predictionProbs.col(j) = arma::exp(logLikelihoods.col(j) - logProbX);
-  }
+  // The LogLikelihood() gives us the unnormalized log likelihood which is
+  // Log(Prob(X|Y)) + Log(Prob(Y)), so we subtract the normalization term.
+  // Besides, to prevent underflow in log of sum of exp of x operation (where
+  // x is a small negative value), we use logsumexp(x - max(x)) + max(x).
+  const arma::Row<ElemType> maxValues = arma::max(logLikelihoods, 0);
+  predictionProbs = arma::exp(logLikelihoods.each_row() - maxValues);
+  predictionProbs.each_row() /= arma::sum(predictionProbs, 0);
 
   // Now calculate maximum probabilities for each point.
-  for (size_t i = 0; i < data.n_cols; ++i)
-  {
-    arma::uword maxIndex = 0;
-    logLikelihoods.unsafe_col(i).max(maxIndex);
-    predictions[i] = maxIndex;
-  }
+  predictions = arma::conv_to<arma::Row<size_t>>::from(
+      arma::index_max(logLikelihoods, 0));
 }
 
 template<typename ModelMatType>
@@ -115,6 +115,9 @@ PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
 
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
+PARAM_FLAG("single_precision", "Hold the reference set (and the tree built on "
+    "it) in single precision, which halves the memory used by the model.  Only "
+    "valid for 'kd', 'ball', 'cover' and 'r' trees.", "");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
@@ -135,6 +138,7 @@ static void mlpackMain()
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
+  ReportIgnoredParam({{ "input_model", true }}, "single_precision");
   ReportIgnoredParam({{ "input_model", true }}, "tau");
   ReportIgnoredParam({{ "input_model", true }}, "rho");
   if (IO::HasParam("input_model") && IO::HasParam("leaf_size"))
@@ -184,6 +188,14 @@ static void mlpackMain()
     ReportIgnoredParam("rho", "spill trees are not being used");
   }
 
+  // Sanity check on the tree type for single precision.
+  if (IO::HasParam("reference") && IO::HasParam("single_precision"))
+  {
+    RequireParamInSet<string>("tree_type", { "kd", "ball", "cover", "r" },
+        true, "single precision is only supported for kd, ball, cover and r "
+        "trees");
+  }
+
   // Sanity check on epsilon.
   const double epsilon = IO::GetParam<double>("epsilon");
   RequireParamValue<double>("epsilon", [](double x) { return x >= 0.0; }, true,
@@ -252,6 +264,7 @@ static void mlpackMain()
 
     knn->TreeType() = tree;
     knn->RandomBasis() = randomBasis;
+    knn->SinglePrecision() = IO::HasParam("single_precision");
     knn->LeafSize() = size_t(lsInt);
     knn->Tau() = tau;
     knn->Rho() = rho;
@@ -281,7 +294,7 @@ static void mlpackMain()
 
     Log::Info << "Loaded kNN model from '"
         << IO::GetPrintableParam<KNNModel*>("input_model") << "' (trained on "
-        << knn->Dataset().n_rows << "x" << knn->Dataset().n_cols
+        << knn->DatasetSize().n_rows << "x" << knn->DatasetSize().n_cols
         << " dataset)." << endl;
   }
 
@@ -296,10 +309,10 @@ static void mlpackMain()
       Log::Info << "Using query data from "
           << IO::GetPrintableParam<arma::mat>("query") << "." << endl;
       queryData = std::move(IO::GetParam<arma::mat>("query"));
-      if (queryData.n_rows != knn->Dataset().n_rows)
+      if (queryData.n_rows != knn->DatasetSize().n_rows)
       {
         // Clean memory if needed before crashing.
-        const size_t dimensions = knn->Dataset().n_rows;
+        const size_t dimensions = knn->DatasetSize().n_rows;
         if (IO::HasParam("reference"))
           delete knn;
         Log::Fatal << "Query has invalid dimensions(" << queryData.n_rows <<
@@ -310,10 +323,10 @@ static void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than or
     // equal to the number of reference points.  Since it is unsigned,
     // we only test the upper bound.
-    if (k > knn->Dataset().n_cols)
+    if (k > knn->DatasetSize().n_cols)
     {
       // Clean memory if needed before crashing.
-      const size_t referencePoints = knn->Dataset().n_cols;
+      const size_t referencePoints = knn->DatasetSize().n_cols;
       if (IO::HasParam("reference"))
         delete knn;
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
@@ -323,10 +336,10 @@ static void mlpackMain()
 
     // Sanity check on k value: must not be equal to the number of reference
     // points when query data has not been provided.
-    if (!IO::HasParam("query") && k == knn->Dataset().n_cols)
+    if (!IO::HasParam("query") && k == knn->DatasetSize().n_cols)
     {
       // Clean memory if needed before crashing.
-      const size_t referencePoints = knn->Dataset().n_cols;
+      const size_t referencePoints = knn->DatasetSize().n_cols;
       if (IO::HasParam("reference"))
         delete knn;
       Log::Fatal << "Invalid k: " << k << "; must be less than the number of "
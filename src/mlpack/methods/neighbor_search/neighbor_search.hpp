@@ -206,6 +206,40 @@ class NeighborSearch
    */
   void Train(Tree referenceTree);
 
+  /**
+   * Add the given points to the reference set without rebuilding the reference
+   * tree, and return the IDs of the new points.  The ID of a point is the index
+   * of its column in the reference set, and it is the index returned for the
+   * point by Search().  IDs do not change when other points are inserted or
+   * removed, but the ID of a removed point may be given to a point inserted
+   * later.
+   *
+   * The reference set is grown by at least half its size at a time, so the
+   * cost of copying it is amortized over many insertions; until they are
+   * used, the extra columns are free, just like the columns of removed points.
+   *
+   * This is only available for trees that support insertion of points and do
+   * not rearrange the dataset, such as the R tree, R* tree, X tree and Hilbert
+   * R tree, and it cannot be used in naive mode.
+   *
+   * @param points Points to insert.
+   * @return IDs of the inserted points.
+   */
+  arma::Col<size_t> Insert(const MatType& points);
+
+  /**
+   * Remove the points with the given IDs from the reference set.  The columns
+   * of the removed points are kept in the reference set (so that the IDs of
+   * the other points do not change) and are reused by Insert().  An exception
+   * is thrown if any of the IDs does not belong to a point of the reference
+   * set, and then no point is removed.
+   *
+   * As with Insert(), this cannot be used in naive mode.
+   *
+   * @param ids IDs of the points to remove.
+   */
+  void Remove(const arma::Col<size_t>& ids);
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -235,10 +269,12 @@ class NeighborSearch
    * number of points in the query dataset and k is the number of neighbors
    * being searched for.
    *
-   * Note that if you are calling Search() multiple times with a single query
-   * tree, you need to reset the bounds in the statistic of each query node,
-   * otherwise the result may be wrong!  You can do this by calling
-   * \c TreeType::Stat().Reset() on each node in the query tree.
+   * The bounds in the statistic of each query node are reset before the
+   * search, so a query tree can be built once and passed to Search() many
+   * times (for instance with different values of k).  If the tree rearranges
+   * the query points, the results are in the order of the points in
+   * queryTree.Dataset(); use the overload that takes the query mappings to get
+   * them in the original order.
    *
    * @param queryTree Tree built on query points.
    * @param k Number of neighbors to search for.
@@ -254,6 +290,35 @@ class NeighborSearch
               arma::mat& distances,
               bool sameSet = false);
 
+  /**
+   * Given a pre-built query tree and the mappings of its points that were
+   * obtained when it was built, search for the nearest neighbors of each query
+   * point.  The results are stored in the original order of the query points,
+   * so this gives the same results as Search() with the query set, without the
+   * cost of building a query tree on every call.  For example:
+   *
+   * @code
+   * std::vector<size_t> oldFromNewQueries;
+   * KNN::Tree queryTree(querySet, oldFromNewQueries);
+   * knn.Search(queryTree, oldFromNewQueries, 5, neighbors, distances);
+   * knn.Search(queryTree, oldFromNewQueries, 10, neighbors, distances);
+   * @endcode
+   *
+   * If the tree does not rearrange the dataset, oldFromNewQueries may be empty.
+   *
+   * @param queryTree Tree built on query points.
+   * @param oldFromNewQueries Mappings of query points to the tree dataset.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *      point.
+   */
+  void Search(Tree& queryTree,
+              const std::vector<size_t>& oldFromNewQueries,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
   /**
    * Search for the nearest neighbors of every point in the reference set.  This
    * is basically equivalent to calling any other overload of Search() with the
@@ -263,6 +328,9 @@ class NeighborSearch
    * where n is the number of points in the query dataset and k is the number of
    * neighbors being searched for.
    *
+   * If points have been removed with Remove(), the columns of the results that
+   * correspond to free columns of the reference set are unspecified.
+   *
    * @param k Number of neighbors to search for.
    * @param neighbors Matrix storing lists of neighbors for each query point.
    * @param distances Matrix storing distances of neighbors for each query
@@ -358,6 +426,40 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! Columns of the reference set that do not hold a point of the reference
+  //! tree (because the point was removed, or because the column was reserved
+  //! by Insert()).  They are reused by Insert(), last one first.
+  std::vector<size_t> freeColumns;
+
+  //! Find the columns of the reference set that are not held by the reference
+  //! tree, and store them in freeColumns.
+  void FindFreeColumns();
+
+  //! Reset the bounds in the statistic of each node of the given tree.
+  static void ResetStatistics(Tree& tree);
+
+  /**
+   * Run a single-tree search for each point in the query set with the given
+   * traverser type (a single-tree or greedy single-tree traverser).  The query
+   * points are split into batches that are searched in parallel, each with its
+   * own rules object; the results do not depend on the number of threads.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param searchEpsilon Relative approximate error.
+   * @param sameSet If true, querySet is the reference set, and a point will not
+   *     be returned as its own neighbor.
+   * @param neighbors Matrix to store the neighbors in.
+   * @param distances Matrix to store the distances in.
+   */
+  template<typename TraverserType>
+  void SingleTreeSearch(const MatType& querySet,
+                        const size_t k,
+                        const double searchEpsilon,
+                        const bool sameSet,
+                        arma::Mat<size_t>& neighbors,
+                        arma::mat& distances);
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
@@ -18,6 +18,10 @@
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace neighbor {
 
@@ -129,7 +133,7 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
   // Build the tree on the empty dataset, if necessary.
   if (mode != NAIVE_MODE)
   {
-    referenceTree = BuildTree<Tree>(std::move(arma::mat()),
+    referenceTree = BuildTree<Tree>(std::move(MatType()),
         oldFromNewReferences);
     referenceSet = &referenceTree->Dataset();
   }
@@ -155,7 +159,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    freeColumns(other.freeColumns)
 {
   // Nothing else to do.
 }
@@ -179,7 +184,8 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(other.treeNeedsReset)
+    treeNeedsReset(other.treeNeedsReset),
+    freeColumns(std::move(other.freeColumns))
 {
   // Clear the other model.
   other.referenceTree = BuildTree<Tree>(std::move(MatType()),
@@ -190,6 +196,7 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
+  other.freeColumns.clear();
 }
 
 // Copy operator.
@@ -233,6 +240,7 @@ NeighborSearch<SortPolicy,
   baseCases = other.baseCases;
   scores = other.scores;
   treeNeedsReset = false;
+  freeColumns = other.freeColumns;
 }
 
 // Move operator.
@@ -275,12 +283,13 @@ NeighborSearch<SortPolicy,
   baseCases = other.baseCases;
   scores = other.scores;
   treeNeedsReset = other.treeNeedsReset;
+  freeColumns = std::move(other.freeColumns);
 
   // Reset the other object.  Clean memory if needed.
   if (!other.referenceTree)
     delete other.referenceSet;
 
-  other.referenceTree = BuildTree<Tree>(std::move(arma::mat()),
+  other.referenceTree = BuildTree<Tree>(std::move(MatType()),
       other.oldFromNewReferences);
   other.referenceSet = &other.referenceTree->Dataset();
   other.searchMode = DUAL_TREE_MODE,
@@ -288,6 +297,7 @@ NeighborSearch<SortPolicy,
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
+  other.freeColumns.clear();
 }
 
 // Clean memory.
@@ -319,6 +329,8 @@ template<typename SortPolicy,
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType referenceSetIn)
 {
+  freeColumns.clear();
+
   // Clean up the old tree, if we built one.
   if (referenceTree)
   {
@@ -371,6 +383,176 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
 
   this->referenceTree = new Tree(std::move(referenceTree));
   this->referenceSet = &this->referenceTree->Dataset();
+  freeColumns.clear();
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+arma::Col<size_t> NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(const MatType& points)
+{
+  static_assert(!tree::TreeTraits<Tree>::RearrangesDataset,
+      "NeighborSearch::Insert() is not supported for trees that rearrange the "
+      "dataset");
+
+  if (!referenceTree)
+    throw std::invalid_argument("NeighborSearch::Insert(): points cannot be "
+        "inserted in naive mode");
+
+  arma::Col<size_t> ids(points.n_cols);
+  if (points.n_cols == 0)
+    return ids;
+
+  // If the reference set holds no points, we can simply build the tree on the
+  // new points.
+  if (referenceSet->n_cols == freeColumns.size())
+  {
+    Train(points);
+    for (size_t i = 0; i < ids.n_elem; ++i)
+      ids[i] = i;
+    return ids;
+  }
+
+  if (points.n_rows != referenceSet->n_rows)
+  {
+    std::stringstream ss;
+    ss << "NeighborSearch::Insert(): dimensionality of points ("
+        << points.n_rows << ") does not match the dimensionality of the "
+        << "reference set (" << referenceSet->n_rows << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  // Grow the reference set if there are not enough free columns.  It is grown
+  // by at least half of its size, so that the cost of the copy is amortized.
+  MatType& dataset = referenceTree->Dataset();
+  if (freeColumns.size() < points.n_cols)
+  {
+    const size_t oldCols = dataset.n_cols;
+    const size_t newCols = oldCols + std::max(points.n_cols -
+        freeColumns.size(), oldCols / 2);
+    dataset.resize(dataset.n_rows, newCols);
+
+    // Add the new columns so that the first of them is used first.
+    for (size_t i = newCols; i > oldCols; --i)
+      freeColumns.push_back(i - 1);
+  }
+
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    ids[i] = freeColumns.back();
+    freeColumns.pop_back();
+
+    dataset.col(ids[i]) = points.col(i);
+    referenceTree->InsertPoint(ids[i]);
+  }
+
+  return ids;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Remove(
+    const arma::Col<size_t>& ids)
+{
+  static_assert(!tree::TreeTraits<Tree>::RearrangesDataset,
+      "NeighborSearch::Remove() is not supported for trees that rearrange the "
+      "dataset");
+
+  if (!referenceTree)
+    throw std::invalid_argument("NeighborSearch::Remove(): points cannot be "
+        "removed in naive mode");
+
+  // Check all of the IDs before anything is removed, so that the tree is left
+  // unchanged if one of them is invalid.  This also catches repeated IDs.
+  std::vector<bool> live(referenceSet->n_cols, true);
+  for (size_t i = 0; i < freeColumns.size(); ++i)
+    live[freeColumns[i]] = false;
+
+  for (size_t i = 0; i < ids.n_elem; ++i)
+  {
+    if (ids[i] >= referenceSet->n_cols || !live[ids[i]])
+    {
+      std::stringstream ss;
+      ss << "NeighborSearch::Remove(): there is no point with ID " << ids[i]
+          << " in the reference set";
+      throw std::invalid_argument(ss.str());
+    }
+
+    live[ids[i]] = false;
+  }
+
+  for (size_t i = 0; i < ids.n_elem; ++i)
+  {
+    referenceTree->DeletePoint(ids[i]);
+    freeColumns.push_back(ids[i]);
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::FindFreeColumns()
+{
+  freeColumns.clear();
+
+  // Trees that rearrange the dataset always hold every point.
+  if (!referenceTree || tree::TreeTraits<Tree>::RearrangesDataset ||
+      referenceTree->NumDescendants() == referenceSet->n_cols)
+    return;
+
+  std::vector<bool> used(referenceSet->n_cols, false);
+  for (size_t i = 0; i < referenceTree->NumDescendants(); ++i)
+    used[referenceTree->Descendant(i)] = true;
+
+  for (size_t i = referenceSet->n_cols; i > 0; --i)
+    if (!used[i - 1])
+      freeColumns.push_back(i - 1);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::ResetStatistics(Tree& tree)
+{
+  std::stack<Tree*> nodes;
+  nodes.push(&tree);
+  while (!nodes.empty())
+  {
+    Tree* node = nodes.top();
+    nodes.pop();
+
+    // Reset bounds of this node.
+    node->Stat().Reset();
+
+    // Then add the children.
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      nodes.push(&node->Child(i));
+  }
 }
 
 /**
@@ -392,11 +574,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  const size_t numReferencePoints = referenceSet->n_cols - freeColumns.size();
+  if (k > numReferencePoints)
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << numReferencePoints << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -440,37 +623,27 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, querySet, k, metric, epsilon);
 
-      // The naive brute-force traversal.
+      // The naive brute-force traversal, skipping the free columns of the
+      // reference set.
+      std::vector<bool> isFree(referenceSet->n_cols, false);
+      for (size_t j = 0; j < freeColumns.size(); ++j)
+        isFree[freeColumns[j]] = true;
+
       for (size_t i = 0; i < querySet.n_cols; ++i)
         for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+          if (!isFree[j])
+            rules.BaseCase(i, j);
 
-      baseCases += querySet.n_cols * referenceSet->n_cols;
+      baseCases += querySet.n_cols * (referenceSet->n_cols -
+          freeColumns.size());
 
       rules.GetResults(*neighborPtr, *distancePtr);
       break;
     }
     case SINGLE_TREE_MODE:
     {
-      // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
-
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
-
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
-
-      Log::Info << rules.Scores() << " node combinations were scored."
-          << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
-          << std::endl;
-
-      rules.GetResults(*neighborPtr, *distancePtr);
+      SingleTreeSearch<SingleTreeTraversalType<RuleType>>(querySet, k,
+          epsilon, false, *neighborPtr, *distancePtr);
       break;
     }
     case DUAL_TREE_MODE:
@@ -505,25 +678,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric);
-
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
-
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
-
-      Log::Info << rules.Scores() << " node combinations were scored."
-          << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
-          << std::endl;
-
-      rules.GetResults(*neighborPtr, *distancePtr);
+      SingleTreeSearch<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          querySet, k, 0, false, *neighborPtr, *distancePtr);
       break;
     }
   }
@@ -606,11 +762,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::mat& distances,
     bool sameSet)
 {
-  if (k > referenceSet->n_cols)
+  const size_t numReferencePoints = referenceSet->n_cols - freeColumns.size();
+  if (k > numReferencePoints)
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << numReferencePoints << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -637,6 +794,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, querySet.n_cols);
   distances.set_size(k, querySet.n_cols);
 
+  // The query tree may have been used for an earlier search, so its bounds
+  // must be reset.
+  ResetStatistics(queryTree);
+  if (&queryTree == referenceTree)
+    treeNeedsReset = true;
+
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
@@ -675,6 +838,52 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Search(
+    Tree& queryTree,
+    const std::vector<size_t>& oldFromNewQueries,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  const size_t numQueries = queryTree.Dataset().n_cols;
+  if (oldFromNewQueries.empty())
+  {
+    Search(queryTree, k, neighbors, distances);
+    return;
+  }
+
+  if (oldFromNewQueries.size() != numQueries)
+  {
+    std::stringstream ss;
+    ss << "NeighborSearch::Search(): the number of query mappings ("
+        << oldFromNewQueries.size() << ") does not match the number of points "
+        << "in the query tree (" << numQueries << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  arma::Mat<size_t> treeNeighbors;
+  arma::mat treeDistances;
+  Search(queryTree, k, treeNeighbors, treeDistances);
+
+  // Map query indices back to their original order.
+  neighbors.set_size(k, numQueries);
+  distances.set_size(k, numQueries);
+  for (size_t i = 0; i < numQueries; ++i)
+  {
+    neighbors.col(oldFromNewQueries[i]) = treeNeighbors.col(i);
+    distances.col(oldFromNewQueries[i]) = treeDistances.col(i);
+  }
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
@@ -689,18 +898,19 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  const size_t numReferencePoints = referenceSet->n_cols - freeColumns.size();
+  if (k > numReferencePoints)
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << numReferencePoints << ")";
     throw std::invalid_argument(ss.str());
   }
-  if (k == referenceSet->n_cols)
+  if (k == numReferencePoints)
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is equal to the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ") and "
+        << "points in the reference set (" << numReferencePoints << ") and "
         << "no query set has been provided.";
     throw std::invalid_argument(ss.str());
   }
@@ -725,62 +935,49 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, referenceSet->n_cols);
   distancePtr->set_size(k, referenceSet->n_cols);
 
-  // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
-      true /* don't return the same point as nearest neighbor */);
 
   switch (searchMode)
   {
     case NAIVE_MODE:
     {
-      // The naive brute-force solution.
+      // Create the helper object for the traversal.
+      RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
+          true /* don't return the same point as nearest neighbor */);
+
+      // The naive brute-force solution, skipping the free columns of the
+      // reference set.
+      std::vector<bool> isFree(referenceSet->n_cols, false);
+      for (size_t j = 0; j < freeColumns.size(); ++j)
+        isFree[freeColumns[j]] = true;
+
       for (size_t i = 0; i < referenceSet->n_cols; ++i)
         for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+          if (!isFree[j])
+            rules.BaseCase(i, j);
+
+      baseCases += referenceSet->n_cols * (referenceSet->n_cols -
+          freeColumns.size());
 
-      baseCases += referenceSet->n_cols * referenceSet->n_cols;
+      rules.GetResults(*neighborPtr, *distancePtr);
       break;
     }
     case SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
-
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
-
-      Log::Info << rules.Scores() << " node combinations were scored."
-          << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
-          << std::endl;
+      SingleTreeSearch<SingleTreeTraversalType<RuleType>>(*referenceSet, k,
+          epsilon, true, *neighborPtr, *distancePtr);
       break;
     }
     case DUAL_TREE_MODE:
     {
+      // Create the helper object for the traversal.
+      RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
+          true /* don't return the same point as nearest neighbor */);
+
       // The dual-tree monochromatic search case may require resetting the
       // bounds in the tree.
       if (treeNeedsReset)
-      {
-        std::stack<Tree*> nodes;
-        nodes.push(referenceTree);
-        while (!nodes.empty())
-        {
-          Tree* node = nodes.top();
-          nodes.pop();
-
-          // Reset bounds of this node.
-          node->Stat().Reset();
-
-          // Then add the children.
-          for (size_t i = 0; i < node->NumChildren(); ++i)
-            nodes.push(&node->Child(i));
-        }
-      }
+        ResetStatistics(*referenceTree);
 
       // Create the traverser.
       DualTreeTraversalType<RuleType> traverser(rules);
@@ -809,30 +1006,18 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       // Next time we perform this search, we'll need to reset the tree.
       treeNeedsReset = true;
+
+      rules.GetResults(*neighborPtr, *distancePtr);
       break;
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
-
-      scores += rules.Scores();
-      baseCases += rules.BaseCases();
-
-      Log::Info << rules.Scores() << " node combinations were scored."
-          << std::endl;
-      Log::Info << rules.BaseCases() << " base cases were calculated."
-          << std::endl;
+      SingleTreeSearch<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          *referenceSet, k, epsilon, true, *neighborPtr, *distancePtr);
       break;
     }
   }
 
-  rules.GetResults(*neighborPtr, *distancePtr);
-
   Timer::Stop("computing_neighbors");
 
   // Do we need to map the reference indices?
@@ -859,6 +1044,81 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+//! Search for the neighbors of each point in batches, in parallel.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename TraverserType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SingleTreeSearch(
+    const MatType& querySet,
+    const size_t k,
+    const double searchEpsilon,
+    const bool sameSet,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  // Use a few more batches than threads so that the load stays balanced when
+  // some queries are much more expensive than others, but keep the batches
+  // small enough that the candidate lists of a batch stay in cache.
+  #ifdef HAS_OPENMP
+    const size_t numThreads = (size_t) omp_get_max_threads();
+  #else
+    const size_t numThreads = 1;
+  #endif
+  const size_t batchSize = std::max((size_t) 1, std::min((size_t) 1024,
+      (querySet.n_cols + 4 * numThreads - 1) / (4 * numThreads)));
+  const size_t numBatches = (querySet.n_cols + batchSize - 1) / batchSize;
+
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+
+  // Trees with self-children (i.e. cover trees) cache the last base case in
+  // the statistic of each reference node during Score(), so they can't be
+  // traversed by more than one thread at once.
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:totalScores, totalBaseCases) \
+      if (!tree::TreeTraits<Tree>::HasSelfChildren)
+  for (omp_size_t b = 0; b < (omp_size_t) numBatches; ++b)
+  {
+    const size_t begin = b * batchSize;
+    const size_t end = std::min((size_t) querySet.n_cols, begin + batchSize);
+
+    const MatType queryBatch = querySet.cols(begin, end - 1);
+    RuleType rules(*referenceSet, queryBatch, k, metric, searchEpsilon,
+        sameSet, begin);
+    TraverserType traverser(rules);
+
+    for (size_t i = 0; i < queryBatch.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    arma::Mat<size_t> batchNeighbors;
+    arma::mat batchDistances;
+    rules.GetResults(batchNeighbors, batchDistances);
+    neighbors.cols(begin, end - 1) = batchNeighbors;
+    distances.cols(begin, end - 1) = batchDistances;
+
+    totalScores += rules.Scores();
+    totalBaseCases += rules.BaseCases();
+  }
+
+  scores += totalScores;
+  baseCases += totalBaseCases;
+
+  Log::Info << totalScores << " node combinations were scored." << std::endl;
+  Log::Info << totalBaseCases << " base cases were calculated." << std::endl;
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -968,6 +1228,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
 
       referenceTree = NULL;
       oldFromNewReferences.clear();
+      freeColumns.clear();
     }
   }
   else
@@ -987,6 +1248,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     {
       referenceSet = &referenceTree->Dataset();
       metric = referenceTree->Metric(); // Get the metric from the tree.
+
+      // The free columns of the reference set are not serialized, since they
+      // can be recovered from the tree.
+      FindFreeColumns();
     }
   }
 
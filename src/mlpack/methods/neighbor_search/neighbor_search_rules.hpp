@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/pairwise_distances.hpp>
 
 #include <queue>
 
@@ -46,13 +47,17 @@ class NeighborSearchRules
    * @param epsilon Relative approximate error.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param queryOffset If sameSet is true, the query set may hold a contiguous
+   *      block of the reference set instead of the whole set; queryOffset is
+   *      then the index of its first point in the reference set.
    */
   NeighborSearchRules(const typename TreeType::Mat& referenceSet,
                       const typename TreeType::Mat& querySet,
                       const size_t k,
                       MetricType& metric,
                       const double epsilon = 0,
-                      const bool sameSet = false);
+                      const bool sameSet = false,
+                      const size_t queryOffset = 0);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -73,6 +78,17 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Run the base cases between every given query point and every given
+   * reference point.  This has the same effect as calling BaseCase() on every
+   * pair, but the distances are computed as a single block.
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceIndices Indices of reference points.
+   */
+  void BlockBaseCase(const arma::uvec& queryIndices,
+                     const arma::uvec& referenceIndices);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -195,6 +211,9 @@ class NeighborSearchRules
   //! Denotes whether or not the reference and query sets are the same.
   bool sameSet;
 
+  //! Index of the first query point in the reference set (if sameSet is true).
+  size_t queryOffset;
+
   //! Relative error to be considered in approximate search.
   const double epsilon;
 
@@ -26,12 +26,14 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const size_t k,
     MetricType& metric,
     const double epsilon,
-    const bool sameSet) :
+    const bool sameSet,
+    const size_t queryOffset) :
     referenceSet(referenceSet),
     querySet(querySet),
     k(k),
     metric(metric),
     sameSet(sameSet),
+    queryOffset(queryOffset),
     epsilon(epsilon),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
@@ -86,7 +88,7 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
 {
   // If the datasets are the same, then this search is only using one dataset
   // and we should not return identical points.
-  if (sameSet && (queryIndex == referenceIndex))
+  if (sameSet && (queryIndex + queryOffset == referenceIndex))
     return 0.0;
 
   // If we have already performed this base case, then do not perform it again.
@@ -107,6 +109,41 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BlockBaseCase(
+    const arma::uvec& queryIndices,
+    const arma::uvec& referenceIndices)
+{
+  // Compute all of the distances at once; distances(r, q) holds the distance
+  // between the r'th reference point and the q'th query point.
+  arma::mat distances;
+  metric::PairwiseDistances(metric, referenceSet, referenceIndices, querySet,
+      queryIndices, distances);
+
+  for (size_t q = 0; q < queryIndices.n_elem; ++q)
+  {
+    const size_t queryIndex = queryIndices[q];
+    for (size_t r = 0; r < referenceIndices.n_elem; ++r)
+    {
+      const size_t referenceIndex = referenceIndices[r];
+
+      // Skip the same pairs that BaseCase() would skip.
+      if (sameSet && (queryIndex + queryOffset == referenceIndex))
+        continue;
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceIndex))
+        continue;
+
+      ++baseCases;
+      InsertNeighbor(queryIndex, referenceIndex, distances(r, q));
+
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+      lastBaseCase = distances(r, q);
+    }
+  }
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
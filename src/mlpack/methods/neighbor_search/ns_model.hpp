@@ -27,19 +27,21 @@ namespace mlpack {
 namespace neighbor {
 
 /**
- * Alias template for euclidean neighbor search.
+ * Alias template for euclidean neighbor search.  The reference set is held in
+ * double precision, unless MatType is arma::fmat.
  */
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
 using NSType = NeighborSearch<SortPolicy,
                               metric::EuclideanDistance,
-                              arma::mat,
+                              MatType,
                               TreeType,
                               TreeType<metric::EuclideanDistance,
                                   NeighborSearchStat<SortPolicy>,
-                                  arma::mat>::template DualTreeTraverser>;
+                                  MatType>::template DualTreeTraverser>;
 
 /**
  * MonoSearchVisitor executes a monochromatic neighbor search on the given
@@ -97,7 +99,8 @@ class BiSearchVisitor : public boost::static_visitor<void>
 
   //! Bichromatic neighbor search on the given NSType considering the leafSize.
   template<typename NSType>
-  void SearchLeaf(NSType* ns) const;
+  void SearchLeaf(NSType* ns,
+                  const typename NSType::Tree::Mat& querySet) const;
 
  public:
   //! Alias template necessary for visual c++ compiler.
@@ -106,12 +109,25 @@ class BiSearchVisitor : public boost::static_visitor<void>
                     typename TreeMatType> class TreeType>
   using NSTypeT = NSType<SortPolicy, TreeType>;
 
+  //! Alias template for the single-precision NSTypes.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  using FloatNSTypeT = NSType<SortPolicy, TreeType, arma::fmat>;
+
   //! Default Bichromatic neighbor search on the given NSType instance.
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
   void operator()(NSTypeT<TreeType>* ns) const;
 
+  //! Default bichromatic neighbor search on the given single-precision NSType
+  //! instance.  The query set is converted to single precision first.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  void operator()(FloatNSTypeT<TreeType>* ns) const;
+
   //! Bichromatic neighbor search on the given NSType specialized for KDTrees.
   void operator()(NSTypeT<tree::KDTree>* ns) const;
 
@@ -124,6 +140,12 @@ class BiSearchVisitor : public boost::static_visitor<void>
   //! Bichromatic neighbor search specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
+  //! Bichromatic neighbor search specialized for single-precision KDTrees.
+  void operator()(FloatNSTypeT<tree::KDTree>* ns) const;
+
+  //! Bichromatic neighbor search specialized for single-precision BallTrees.
+  void operator()(FloatNSTypeT<tree::BallTree>* ns) const;
+
   //! Construct the BiSearchVisitor.
   BiSearchVisitor(const arma::mat& querySet,
                   const size_t k,
@@ -155,7 +177,8 @@ class TrainVisitor : public boost::static_visitor<void>
 
   //! Train on the given NSType considering the leafSize.
   template<typename NSType>
-  void TrainLeaf(NSType* ns) const;
+  void TrainLeaf(NSType* ns,
+                 typename NSType::Tree::Mat&& referenceSet) const;
 
  public:
   //! Alias template necessary for visual c++ compiler.
@@ -164,12 +187,25 @@ class TrainVisitor : public boost::static_visitor<void>
                     typename TreeMatType> class TreeType>
   using NSTypeT = NSType<SortPolicy, TreeType>;
 
+  //! Alias template for the single-precision NSTypes.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  using FloatNSTypeT = NSType<SortPolicy, TreeType, arma::fmat>;
+
   //! Default Train on the given NSType instance.
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
   void operator()(NSTypeT<TreeType>* ns) const;
 
+  //! Default Train on the given single-precision NSType instance.  The
+  //! reference set is converted to single precision first.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  void operator()(FloatNSTypeT<TreeType>* ns) const;
+
   //! Train on the given NSType specialized for KDTrees.
   void operator()(NSTypeT<tree::KDTree>* ns) const;
 
@@ -182,6 +218,12 @@ class TrainVisitor : public boost::static_visitor<void>
   //! Train specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
+  //! Train specialized for single-precision KDTrees.
+  void operator()(FloatNSTypeT<tree::KDTree>* ns) const;
+
+  //! Train specialized for single-precision BallTrees.
+  void operator()(FloatNSTypeT<tree::BallTree>* ns) const;
+
   //! Construct the TrainVisitor object with the given reference set, leafSize
   //! for BinarySpaceTrees, and tau and rho for spill trees.
   TrainVisitor(arma::mat&& referenceSet,
@@ -190,6 +232,96 @@ class TrainVisitor : public boost::static_visitor<void>
                const double rho);
 };
 
+/**
+ * InsertVisitor adds points to the reference set of the given NSType without
+ * rebuilding the reference tree.  This is only supported for R trees, R* trees,
+ * X trees and Hilbert R trees; std::invalid_argument is thrown for any other
+ * tree type.
+ */
+template<typename SortPolicy>
+class InsertVisitor : public boost::static_visitor<arma::Col<size_t>>
+{
+ private:
+  //! The points to insert.
+  const arma::mat& points;
+
+ public:
+  //! Alias template necessary for visual c++ compiler.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  using NSTypeT = NSType<SortPolicy, TreeType>;
+
+  //! Throw, since the tree type of the given NSType does not support
+  //! insertion.
+  template<typename NSType>
+  arma::Col<size_t> operator()(NSType* ns) const;
+
+  //! Insert points into the given NSType specialized for R trees.
+  arma::Col<size_t> operator()(NSTypeT<tree::RTree>* ns) const;
+
+  //! Insert points into the given NSType specialized for R* trees.
+  arma::Col<size_t> operator()(NSTypeT<tree::RStarTree>* ns) const;
+
+  //! Insert points into the given NSType specialized for X trees.
+  arma::Col<size_t> operator()(NSTypeT<tree::XTree>* ns) const;
+
+  //! Insert points into the given NSType specialized for Hilbert R trees.
+  arma::Col<size_t> operator()(NSTypeT<tree::HilbertRTree>* ns) const;
+
+  //! Insert points into the given NSType specialized for single-precision R
+  //! trees.  The points are converted to single precision first.
+  arma::Col<size_t> operator()(
+      NSType<SortPolicy, tree::RTree, arma::fmat>* ns) const;
+
+  //! Construct the InsertVisitor object with the given points.
+  InsertVisitor(const arma::mat& points) : points(points) { }
+};
+
+/**
+ * RemoveVisitor removes points from the reference set of the given NSType
+ * without rebuilding the reference tree.  This is only supported for R trees,
+ * R* trees, X trees and Hilbert R trees; std::invalid_argument is thrown for
+ * any other tree type.
+ */
+template<typename SortPolicy>
+class RemoveVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The IDs of the points to remove.
+  const arma::Col<size_t>& ids;
+
+ public:
+  //! Alias template necessary for visual c++ compiler.
+  template<template<typename TreeMetricType,
+                    typename TreeStatType,
+                    typename TreeMatType> class TreeType>
+  using NSTypeT = NSType<SortPolicy, TreeType>;
+
+  //! Throw, since the tree type of the given NSType does not support removal.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Remove points from the given NSType specialized for R trees.
+  void operator()(NSTypeT<tree::RTree>* ns) const;
+
+  //! Remove points from the given NSType specialized for R* trees.
+  void operator()(NSTypeT<tree::RStarTree>* ns) const;
+
+  //! Remove points from the given NSType specialized for X trees.
+  void operator()(NSTypeT<tree::XTree>* ns) const;
+
+  //! Remove points from the given NSType specialized for Hilbert R trees.
+  void operator()(NSTypeT<tree::HilbertRTree>* ns) const;
+
+  //! Remove points from the given NSType specialized for single-precision R
+  //! trees.
+  void operator()(NSType<SortPolicy, tree::RTree, arma::fmat>* ns) const;
+
+  //! Construct the RemoveVisitor object with the given IDs.
+  RemoveVisitor(const arma::Col<size_t>& ids) : ids(ids) { }
+};
+
 /**
  * SearchModeVisitor exposes the SearchMode() method of the given NSType.
  */
@@ -213,7 +345,9 @@ class EpsilonVisitor : public boost::static_visitor<double&>
 };
 
 /**
- * ReferenceSetVisitor exposes the referenceSet of the given NSType.
+ * ReferenceSetVisitor exposes the referenceSet of the given NSType.  The
+ * reference set of a single-precision NSType cannot be returned as an
+ * arma::mat, so std::invalid_argument is thrown in that case.
  */
 class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
 {
@@ -221,6 +355,25 @@ class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
   //! Return the reference set.
   template<typename NSType>
   const arma::mat& operator()(NSType *ns) const;
+
+ private:
+  //! Return a double-precision reference set.
+  static const arma::mat& ReferenceSet(const arma::mat& referenceSet)
+  { return referenceSet; }
+  //! Throw, since a single-precision reference set cannot be returned.
+  static const arma::mat& ReferenceSet(const arma::fmat& referenceSet);
+};
+
+/**
+ * ReferenceSetSizeVisitor returns the size of the referenceSet of the given
+ * NSType, for both double-precision and single-precision NSTypes.
+ */
+class ReferenceSetSizeVisitor : public boost::static_visitor<arma::SizeMat>
+{
+ public:
+  //! Return the size of the reference set.
+  template<typename NSType>
+  arma::SizeMat operator()(NSType *ns) const;
 };
 
 /**
@@ -242,6 +395,11 @@ class DeleteVisitor : public boost::static_visitor<void>
  * flexibility as the NeighborSearch class.  So if you are using it outside of
  * mlpack_knn and mlpack_kfn, be aware that it is limited!
  *
+ * The reference set may be held in single precision (see SinglePrecision()),
+ * which halves the memory used by the model; this is supported for kd-trees,
+ * ball trees, cover trees and R trees.  Query sets are still given in double
+ * precision, and are converted as needed.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  */
 template<typename SortPolicy>
@@ -282,6 +440,8 @@ class NSModel
 
   //! If true, random projections are used.
   bool randomBasis;
+  //! If true, the reference set is held in single precision.
+  bool singlePrecision;
   //! This is the random projection matrix; only used if randomBasis is true.
   arma::mat q;
 
@@ -304,7 +464,11 @@ class NSModel
                  NSType<SortPolicy, tree::MaxRPTree>*,
                  SpillKNN*,
                  NSType<SortPolicy, tree::UBTree>*,
-                 NSType<SortPolicy, tree::Octree>*> nSearch;
+                 NSType<SortPolicy, tree::Octree>*,
+                 NSType<SortPolicy, tree::KDTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::StandardCoverTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::RTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::BallTree, arma::fmat>*> nSearch;
 
  public:
   /**
@@ -314,8 +478,12 @@ class NSModel
    * @param treeType Type of tree to use.
    * @param randomBasis Whether or not to project the points onto a random basis
    *      before searching.
+   * @param singlePrecision Whether or not to hold the reference set in single
+   *      precision.
    */
-  NSModel(TreeTypes treeType = TreeTypes::KD_TREE, bool randomBasis = false);
+  NSModel(TreeTypes treeType = TreeTypes::KD_TREE,
+          bool randomBasis = false,
+          bool singlePrecision = false);
 
   /**
    * Copy the given NSModel.
@@ -352,9 +520,13 @@ class NSModel
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
-  //! Expose the dataset.
+  //! Expose the dataset.  This throws std::invalid_argument if the dataset is
+  //! held in single precision; use DatasetSize() to get its dimensions.
   const arma::mat& Dataset() const;
 
+  //! Get the size of the dataset.
+  arma::SizeMat DatasetSize() const;
+
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
   NeighborSearchMode& SearchMode();
@@ -383,6 +555,11 @@ class NSModel
   bool RandomBasis() const { return randomBasis; }
   bool& RandomBasis() { return randomBasis; }
 
+  //! Expose singlePrecision.  Changes take effect on the next call to
+  //! BuildModel().
+  bool SinglePrecision() const { return singlePrecision; }
+  bool& SinglePrecision() { return singlePrecision; }
+
   //! Build the reference tree.
   void BuildModel(arma::mat&& referenceSet,
                   const size_t leafSize,
@@ -400,6 +577,25 @@ class NSModel
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Add the given points to the reference set without rebuilding the tree, and
+   * return their IDs (see NeighborSearch::Insert()).  This is only supported
+   * for R trees, R* trees, X trees and Hilbert R trees.
+   *
+   * @param points Points to insert.
+   * @return IDs of the inserted points.
+   */
+  arma::Col<size_t> Insert(arma::mat&& points);
+
+  /**
+   * Remove the points with the given IDs from the reference set without
+   * rebuilding the tree (see NeighborSearch::Remove()).  This is only supported
+   * for R trees, R* trees, X trees and Hilbert R trees.
+   *
+   * @param ids IDs of the points to remove.
+   */
+  void Remove(const arma::Col<size_t>& ids);
+
   //! Return a string representation of the current tree type.
   std::string TreeName() const;
 };
@@ -409,7 +605,7 @@ class NSModel
 
 //! Set the serialization version of the NSModel class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::NSModel<SortPolicy>, 1);
+    mlpack::neighbor::NSModel<SortPolicy>, 2);
 
 // Include implementation.
 #include "ns_model_impl.hpp"
@@ -62,12 +62,28 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Default bichromatic neighbor search on the given single-precision NSType
+//! instance.
+template<typename SortPolicy>
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void BiSearchVisitor<SortPolicy>::operator()(FloatNSTypeT<TreeType>* ns) const
+{
+  if (ns)
+  {
+    return ns->Search(arma::conv_to<arma::fmat>::from(querySet), k, neighbors,
+        distances);
+  }
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Bichromatic neighbor search on the given NSType specialized for KDTrees.
 template<typename SortPolicy>
 void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 {
   if (ns)
-    return SearchLeaf(ns);
+    return SearchLeaf(ns, querySet);
   throw std::runtime_error("no neighbor search model initialized");
 }
 
@@ -76,7 +92,7 @@ template<typename SortPolicy>
 void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
 {
   if (ns)
-    return SearchLeaf(ns);
+    return SearchLeaf(ns, querySet);
   throw std::runtime_error("no neighbor search model initialized");
 }
 
@@ -106,14 +122,36 @@ template<typename SortPolicy>
 void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 {
   if (ns)
-    return SearchLeaf(ns);
+    return SearchLeaf(ns, querySet);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Bichromatic neighbor search specialized for single-precision KDTrees.
+template<typename SortPolicy>
+void BiSearchVisitor<SortPolicy>::operator()(
+    FloatNSTypeT<tree::KDTree>* ns) const
+{
+  if (ns)
+    return SearchLeaf(ns, arma::conv_to<arma::fmat>::from(querySet));
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Bichromatic neighbor search specialized for single-precision BallTrees.
+template<typename SortPolicy>
+void BiSearchVisitor<SortPolicy>::operator()(
+    FloatNSTypeT<tree::BallTree>* ns) const
+{
+  if (ns)
+    return SearchLeaf(ns, arma::conv_to<arma::fmat>::from(querySet));
   throw std::runtime_error("no neighbor search model initialized");
 }
 
 //! Bichromatic neighbor search on the given NSType considering the leafSize.
 template<typename SortPolicy>
 template<typename NSType>
-void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
+void BiSearchVisitor<SortPolicy>::SearchLeaf(
+    NSType* ns,
+    const typename NSType::Tree::Mat& querySet) const
 {
   if (ns->SearchMode() == DUAL_TREE_MODE)
   {
@@ -162,12 +200,29 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Default Train on the given single-precision NSType instance.
+template<typename SortPolicy>
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void TrainVisitor<SortPolicy>::operator()(FloatNSTypeT<TreeType>* ns) const
+{
+  if (ns)
+  {
+    arma::fmat floatReferenceSet =
+        arma::conv_to<arma::fmat>::from(referenceSet);
+    referenceSet.reset();
+    return ns->Train(std::move(floatReferenceSet));
+  }
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Train on the given NSType specialized for KDTrees.
 template<typename SortPolicy>
 void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 {
   if (ns)
-    return TrainLeaf(ns);
+    return TrainLeaf(ns, std::move(referenceSet));
   throw std::runtime_error("no neighbor search model initialized");
 }
 
@@ -176,7 +231,7 @@ template<typename SortPolicy>
 void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
 {
   if (ns)
-    return TrainLeaf(ns);
+    return TrainLeaf(ns, std::move(referenceSet));
   throw std::runtime_error("no neighbor search model initialized");
 }
 
@@ -203,14 +258,46 @@ template<typename SortPolicy>
 void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 {
   if (ns)
-    return TrainLeaf(ns);
+    return TrainLeaf(ns, std::move(referenceSet));
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Train specialized for single-precision KDTrees.
+template<typename SortPolicy>
+void TrainVisitor<SortPolicy>::operator()(
+    FloatNSTypeT<tree::KDTree>* ns) const
+{
+  if (ns)
+  {
+    arma::fmat floatReferenceSet =
+        arma::conv_to<arma::fmat>::from(referenceSet);
+    referenceSet.reset();
+    return TrainLeaf(ns, std::move(floatReferenceSet));
+  }
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Train specialized for single-precision BallTrees.
+template<typename SortPolicy>
+void TrainVisitor<SortPolicy>::operator()(
+    FloatNSTypeT<tree::BallTree>* ns) const
+{
+  if (ns)
+  {
+    arma::fmat floatReferenceSet =
+        arma::conv_to<arma::fmat>::from(referenceSet);
+    referenceSet.reset();
+    return TrainLeaf(ns, std::move(floatReferenceSet));
+  }
   throw std::runtime_error("no neighbor search model initialized");
 }
 
 //! Train on the given NSType considering the leafSize.
 template<typename SortPolicy>
 template<typename NSType>
-void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
+void TrainVisitor<SortPolicy>::TrainLeaf(
+    NSType* ns,
+    typename NSType::Tree::Mat&& referenceSet) const
 {
   if (ns->SearchMode() == NAIVE_MODE)
     ns->Train(std::move(referenceSet));
@@ -225,6 +312,127 @@ void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
   }
 }
 
+//! The tree type of the given NSType does not support insertion.
+template<typename SortPolicy>
+template<typename NSType>
+arma::Col<size_t> InsertVisitor<SortPolicy>::operator()(NSType* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+  throw std::invalid_argument("points can only be inserted into R trees, R* "
+      "trees, X trees and Hilbert R trees");
+}
+
+//! Insert points into the given NSType specialized for R trees.
+template<typename SortPolicy>
+arma::Col<size_t> InsertVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::RTree>* ns) const
+{
+  if (ns)
+    return ns->Insert(points);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Insert points into the given NSType specialized for R* trees.
+template<typename SortPolicy>
+arma::Col<size_t> InsertVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::RStarTree>* ns) const
+{
+  if (ns)
+    return ns->Insert(points);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Insert points into the given NSType specialized for X trees.
+template<typename SortPolicy>
+arma::Col<size_t> InsertVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::XTree>* ns) const
+{
+  if (ns)
+    return ns->Insert(points);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Insert points into the given NSType specialized for Hilbert R trees.
+template<typename SortPolicy>
+arma::Col<size_t> InsertVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::HilbertRTree>* ns) const
+{
+  if (ns)
+    return ns->Insert(points);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Insert points into the given NSType specialized for single-precision R
+//! trees.
+template<typename SortPolicy>
+arma::Col<size_t> InsertVisitor<SortPolicy>::operator()(
+    NSType<SortPolicy, tree::RTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return ns->Insert(arma::conv_to<arma::fmat>::from(points));
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! The tree type of the given NSType does not support removal.
+template<typename SortPolicy>
+template<typename NSType>
+void RemoveVisitor<SortPolicy>::operator()(NSType* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+  throw std::invalid_argument("points can only be removed from R trees, R* "
+      "trees, X trees and Hilbert R trees");
+}
+
+//! Remove points from the given NSType specialized for R trees.
+template<typename SortPolicy>
+void RemoveVisitor<SortPolicy>::operator()(NSTypeT<tree::RTree>* ns) const
+{
+  if (ns)
+    return ns->Remove(ids);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Remove points from the given NSType specialized for R* trees.
+template<typename SortPolicy>
+void RemoveVisitor<SortPolicy>::operator()(NSTypeT<tree::RStarTree>* ns) const
+{
+  if (ns)
+    return ns->Remove(ids);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Remove points from the given NSType specialized for X trees.
+template<typename SortPolicy>
+void RemoveVisitor<SortPolicy>::operator()(NSTypeT<tree::XTree>* ns) const
+{
+  if (ns)
+    return ns->Remove(ids);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Remove points from the given NSType specialized for Hilbert R trees.
+template<typename SortPolicy>
+void RemoveVisitor<SortPolicy>::operator()(
+    NSTypeT<tree::HilbertRTree>* ns) const
+{
+  if (ns)
+    return ns->Remove(ids);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Remove points from the given NSType specialized for single-precision R
+//! trees.
+template<typename SortPolicy>
+void RemoveVisitor<SortPolicy>::operator()(
+    NSType<SortPolicy, tree::RTree, arma::fmat>* ns) const
+{
+  if (ns)
+    return ns->Remove(ids);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Return the search mode.
 template<typename NSType>
 NeighborSearchMode& SearchModeVisitor::operator()(NSType* ns) const
@@ -248,7 +456,24 @@ template<typename NSType>
 const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
 {
   if (ns)
-    return ns->ReferenceSet();
+    return ReferenceSet(ns->ReferenceSet());
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! A single-precision reference set cannot be returned as an arma::mat.
+inline const arma::mat& ReferenceSetVisitor::ReferenceSet(
+    const arma::fmat& /* referenceSet */)
+{
+  throw std::invalid_argument("the reference set is held in single precision "
+      "and cannot be returned as an arma::mat");
+}
+
+//! Return the size of the referenceSet of the given NSType.
+template<typename NSType>
+arma::SizeMat ReferenceSetSizeVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return arma::size(ns->ReferenceSet());
   throw std::runtime_error("no neighbor search model initialized");
 }
 
@@ -265,12 +490,15 @@ void DeleteVisitor::operator()(NSType* ns) const
  * basis should be used.
  */
 template<typename SortPolicy>
-NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
+NSModel<SortPolicy>::NSModel(TreeTypes treeType,
+                             bool randomBasis,
+                             bool singlePrecision) :
     treeType(treeType),
     leafSize(20),
     tau(0),
     rho(0.7),
-    randomBasis(randomBasis)
+    randomBasis(randomBasis),
+    singlePrecision(singlePrecision)
 {
   // Nothing to do.
 }
@@ -282,6 +510,7 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     tau(other.tau),
     rho(other.rho),
     randomBasis(other.randomBasis),
+    singlePrecision(other.singlePrecision),
     q(other.q),
     nSearch(other.nSearch)
 {
@@ -295,6 +524,7 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     tau(other.tau),
     rho(other.rho),
     randomBasis(other.randomBasis),
+    singlePrecision(other.singlePrecision),
     q(std::move(other.q)),
     nSearch(other.nSearch)
 {
@@ -304,6 +534,7 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
   other.tau = 0;
   other.rho = 0.7;
   other.randomBasis = false;
+  other.singlePrecision = false;
   other.nSearch = decltype(other.nSearch)();
 }
 
@@ -317,6 +548,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
   tau = other.tau;
   rho = other.rho;
   randomBasis = other.randomBasis;
+  singlePrecision = other.singlePrecision;
   q = other.q;
   nSearch = other.nSearch;
 
@@ -333,6 +565,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   tau = other.tau;
   rho = other.rho;
   randomBasis = other.randomBasis;
+  singlePrecision = other.singlePrecision;
   q = std::move(other.q);
   // Copy the pointer and type.
   nSearch = other.nSearch;
@@ -343,6 +576,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   other.tau = 0;
   other.rho = 0.7;
   other.randomBasis = false;
+  other.singlePrecision = false;
   other.nSearch = decltype(other.nSearch)();
 
   return *this;
@@ -370,6 +604,12 @@ void NSModel<SortPolicy>::serialize(Archive& ar, const unsigned int version)
     ar & BOOST_SERIALIZATION_NVP(rho);
   }
   ar & BOOST_SERIALIZATION_NVP(randomBasis);
+  // Older versions of NSModel always held the reference set in double
+  // precision.
+  if (version > 1)
+    ar & BOOST_SERIALIZATION_NVP(singlePrecision);
+  else if (Archive::is_loading::value)
+    singlePrecision = false;
   ar & BOOST_SERIALIZATION_NVP(q);
 
   // This should never happen, but just in case, be clean with memory.
@@ -386,6 +626,13 @@ const arma::mat& NSModel<SortPolicy>::Dataset() const
   return boost::apply_visitor(ReferenceSetVisitor(), nSearch);
 }
 
+//! Get the size of the dataset.
+template<typename SortPolicy>
+arma::SizeMat NSModel<SortPolicy>::DatasetSize() const
+{
+  return boost::apply_visitor(ReferenceSetSizeVisitor(), nSearch);
+}
+
 //! Access the search mode.
 template<typename SortPolicy>
 NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
@@ -420,6 +667,14 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
                                      const double epsilon)
 {
   this->leafSize = leafSize;
+
+  if (singlePrecision && treeType != KD_TREE && treeType != COVER_TREE &&
+      treeType != R_TREE && treeType != BALL_TREE)
+  {
+    throw std::invalid_argument("NSModel::BuildModel(): single precision is "
+        "only supported for kd-trees, cover trees, R trees and ball trees");
+  }
+
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -465,55 +720,83 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
     Log::Info << "Building reference tree..." << std::endl;
   }
 
-  switch (treeType)
+  if (singlePrecision)
   {
-    case KD_TREE:
-      nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
-      break;
-    case COVER_TREE:
-      nSearch = new NSType<SortPolicy, tree::StandardCoverTree>(searchMode,
-          epsilon);
-      break;
-    case R_TREE:
-      nSearch = new NSType<SortPolicy, tree::RTree>(searchMode, epsilon);
-      break;
-    case R_STAR_TREE:
-      nSearch = new NSType<SortPolicy, tree::RStarTree>(searchMode, epsilon);
-      break;
-    case BALL_TREE:
-      nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
-      break;
-    case X_TREE:
-      nSearch = new NSType<SortPolicy, tree::XTree>(searchMode, epsilon);
-      break;
-    case HILBERT_R_TREE:
-      nSearch = new NSType<SortPolicy, tree::HilbertRTree>(searchMode, epsilon);
-      break;
-    case R_PLUS_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPlusTree>(searchMode, epsilon);
-      break;
-    case R_PLUS_PLUS_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPlusPlusTree>(searchMode,
-          epsilon);
-      break;
-    case VP_TREE:
-      nSearch = new NSType<SortPolicy, tree::VPTree>(searchMode, epsilon);
-      break;
-    case RP_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPTree>(searchMode, epsilon);
-      break;
-    case MAX_RP_TREE:
-      nSearch = new NSType<SortPolicy, tree::MaxRPTree>(searchMode, epsilon);
-      break;
-    case SPILL_TREE:
-      nSearch = new SpillKNN(searchMode, epsilon);
-      break;
-    case UB_TREE:
-      nSearch = new NSType<SortPolicy, tree::UBTree>(searchMode, epsilon);
-      break;
-    case OCTREE:
-      nSearch = new NSType<SortPolicy, tree::Octree>(searchMode, epsilon);
-      break;
+    switch (treeType)
+    {
+      case KD_TREE:
+        nSearch = new NSType<SortPolicy, tree::KDTree, arma::fmat>(searchMode,
+            epsilon);
+        break;
+      case COVER_TREE:
+        nSearch = new NSType<SortPolicy, tree::StandardCoverTree, arma::fmat>(
+            searchMode, epsilon);
+        break;
+      case R_TREE:
+        nSearch = new NSType<SortPolicy, tree::RTree, arma::fmat>(searchMode,
+            epsilon);
+        break;
+      case BALL_TREE:
+        nSearch = new NSType<SortPolicy, tree::BallTree, arma::fmat>(
+            searchMode, epsilon);
+        break;
+      default:
+        break; // Other tree types were rejected above.
+    }
+  }
+  else
+  {
+    switch (treeType)
+    {
+      case KD_TREE:
+        nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
+        break;
+      case COVER_TREE:
+        nSearch = new NSType<SortPolicy, tree::StandardCoverTree>(searchMode,
+            epsilon);
+        break;
+      case R_TREE:
+        nSearch = new NSType<SortPolicy, tree::RTree>(searchMode, epsilon);
+        break;
+      case R_STAR_TREE:
+        nSearch = new NSType<SortPolicy, tree::RStarTree>(searchMode, epsilon);
+        break;
+      case BALL_TREE:
+        nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
+        break;
+      case X_TREE:
+        nSearch = new NSType<SortPolicy, tree::XTree>(searchMode, epsilon);
+        break;
+      case HILBERT_R_TREE:
+        nSearch = new NSType<SortPolicy, tree::HilbertRTree>(searchMode,
+            epsilon);
+        break;
+      case R_PLUS_TREE:
+        nSearch = new NSType<SortPolicy, tree::RPlusTree>(searchMode, epsilon);
+        break;
+      case R_PLUS_PLUS_TREE:
+        nSearch = new NSType<SortPolicy, tree::RPlusPlusTree>(searchMode,
+            epsilon);
+        break;
+      case VP_TREE:
+        nSearch = new NSType<SortPolicy, tree::VPTree>(searchMode, epsilon);
+        break;
+      case RP_TREE:
+        nSearch = new NSType<SortPolicy, tree::RPTree>(searchMode, epsilon);
+        break;
+      case MAX_RP_TREE:
+        nSearch = new NSType<SortPolicy, tree::MaxRPTree>(searchMode, epsilon);
+        break;
+      case SPILL_TREE:
+        nSearch = new SpillKNN(searchMode, epsilon);
+        break;
+      case UB_TREE:
+        nSearch = new NSType<SortPolicy, tree::UBTree>(searchMode, epsilon);
+        break;
+      case OCTREE:
+        nSearch = new NSType<SortPolicy, tree::Octree>(searchMode, epsilon);
+        break;
+    }
   }
 
   TrainVisitor<SortPolicy> tn(std::move(referenceSet), leafSize, tau, rho);
@@ -594,6 +877,26 @@ void NSModel<SortPolicy>::Search(const size_t k,
   boost::apply_visitor(search, nSearch);
 }
 
+//! Insert points into the reference set.
+template<typename SortPolicy>
+arma::Col<size_t> NSModel<SortPolicy>::Insert(arma::mat&& points)
+{
+  // The points must be projected like the reference set.
+  if (randomBasis)
+    points = q * points;
+
+  InsertVisitor<SortPolicy> insert(points);
+  return boost::apply_visitor(insert, nSearch);
+}
+
+//! Remove points from the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Remove(const arma::Col<size_t>& ids)
+{
+  RemoveVisitor<SortPolicy> remove(ids);
+  boost::apply_visitor(remove, nSearch);
+}
+
 //! Get the name of the tree type.
 template<typename SortPolicy>
 std::string NSModel<SortPolicy>::TreeName() const
@@ -226,6 +226,33 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Given a pre-built query tree and the mappings of its points that were
+   * obtained when it was built, search for all reference points in the given
+   * range for each query point.  The results are stored in the original order
+   * of the query points, so this gives the same results as Search() with the
+   * query set; the query tree can be built once and reused for searches with
+   * different ranges.  The output format is the same as for the other
+   * overloads of Search().
+   *
+   * If the tree does not rearrange the dataset, oldFromNewQueries may be empty.
+   * This will throw an invalid_argument exception if either naive or
+   * singleMode are set to true.
+   *
+   * @param queryTree Tree built on query points.
+   * @param oldFromNewQueries Mappings of query points to the tree dataset.
+   * @param range Range of distances in which to search.
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      point which fell into the given range, for each query point.
+   * @param distances Object which will hold the list of distances for each
+   *      point which fell into the given range, for each query point.
+   */
+  void Search(Tree* queryTree,
+              const std::vector<size_t>& oldFromNewQueries,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances);
+
   /**
    * Search for all points in the given range for each point in the reference
    * set (which was passed to the constructor), returning the results in the
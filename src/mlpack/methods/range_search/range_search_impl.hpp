@@ -108,7 +108,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
   // Build the tree on the empty dataset, if necessary.
   if (!naive)
   {
-    referenceTree = BuildTree<Tree>(std::move(arma::mat()),
+    referenceTree = BuildTree<Tree>(std::move(MatType()),
         oldFromNewReferences);
     referenceSet = &referenceTree->Dataset();
     treeOwner = true;
@@ -154,7 +154,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
 {
   // Clear other object.
   other.referenceTree =
-      BuildTree<Tree>(std::move(arma::mat()), other.oldFromNewReferences);
+      BuildTree<Tree>(std::move(MatType()), other.oldFromNewReferences);
   other.referenceSet = &other.referenceTree->Dataset();
   other.treeOwner = true;
   other.naive = false;
@@ -517,6 +517,54 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    Tree* queryTree,
+    const std::vector<size_t>& oldFromNewQueries,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
+{
+  const size_t numQueries = queryTree->Dataset().n_cols;
+  if (oldFromNewQueries.empty())
+  {
+    Search(queryTree, range, neighbors, distances);
+    return;
+  }
+
+  if (oldFromNewQueries.size() != numQueries)
+  {
+    std::ostringstream oss;
+    oss << "RangeSearch::Search(): the number of query mappings ("
+        << oldFromNewQueries.size() << ") does not match the number of points "
+        << "in the query tree (" << numQueries << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::vector<std::vector<size_t>> treeNeighbors;
+  std::vector<std::vector<double>> treeDistances;
+  Search(queryTree, range, treeNeighbors, treeDistances);
+
+  // Map query indices back to their original order.  If the reference set is
+  // empty, nothing was found.
+  neighbors.clear();
+  neighbors.resize(numQueries);
+  distances.clear();
+  distances.resize(numQueries);
+  if (treeNeighbors.size() != numQueries)
+    return;
+
+  for (size_t i = 0; i < numQueries; ++i)
+  {
+    neighbors[oldFromNewQueries[i]] = std::move(treeNeighbors[i]);
+    distances[oldFromNewQueries[i]] = std::move(treeDistances[i]);
+  }
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -20,8 +20,8 @@ namespace range {
 
 template<typename MetricType, typename TreeType>
 RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
@@ -75,6 +75,46 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+//! Compute a block of base cases at once.
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BlockBaseCase(
+    const arma::uvec& queryIndices,
+    const arma::uvec& referenceIndices)
+{
+  // distances(r, q) holds the distance between the r'th reference point and
+  // the q'th query point.
+  arma::mat blockDistances;
+  metric::PairwiseDistances(metric, referenceSet, referenceIndices, querySet,
+      queryIndices, blockDistances);
+
+  for (size_t q = 0; q < queryIndices.n_elem; ++q)
+  {
+    const size_t queryIndex = queryIndices[q];
+    for (size_t r = 0; r < referenceIndices.n_elem; ++r)
+    {
+      const size_t referenceIndex = referenceIndices[r];
+
+      // Skip the same pairs that BaseCase() would skip.
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceIndex))
+        continue;
+
+      ++baseCases;
+      lastQueryIndex = queryIndex;
+      lastReferenceIndex = referenceIndex;
+
+      const double distance = blockDistances(r, q);
+      if (range.Contains(distance))
+      {
+        neighbors[queryIndex].push_back(referenceIndex);
+        distances[queryIndex].push_back(distance);
+      }
+    }
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename TreeType>
 double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
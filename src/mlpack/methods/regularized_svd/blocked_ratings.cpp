@@ -0,0 +1,90 @@
+/**
+ * @file methods/regularized_svd/blocked_ratings.cpp
+ *
+ * Implementation of the BlockedRatings class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "blocked_ratings.hpp"
+#include <mlpack/core/math/random.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::svd;
+
+BlockedRatings::BlockedRatings(const arma::mat& data,
+                               const size_t numUsers,
+                               const size_t numItems,
+                               const size_t numBlocksIn) :
+    // There is no point in having more blocks than users or items.
+    numBlocks(std::max(size_t(1),
+        std::min(numBlocksIn, std::min(numUsers, numItems)))),
+    usersPerBlock((numUsers + numBlocks - 1) / numBlocks),
+    itemsPerBlock((numItems + numBlocks - 1) / numBlocks)
+{
+  // Visit the ratings in order of user, so that after the (stable) counting
+  // sort below the ratings of each cell are grouped by user.
+  const arma::uvec userOrder = arma::stable_sort_index(data.row(0));
+
+  // Count the ratings that fall into each cell.
+  arma::Col<size_t> cellOf(data.n_cols);
+  cellOffsets.zeros(numBlocks * numBlocks + 1);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    const size_t userBlock = size_t(data(0, i)) / usersPerBlock;
+    const size_t itemBlock = size_t(data(1, i)) / itemsPerBlock;
+    cellOf[i] = userBlock * numBlocks + itemBlock;
+    ++cellOffsets[cellOf[i] + 1];
+  }
+
+  // Turn the counts into offsets.
+  for (size_t c = 1; c < cellOffsets.n_elem; ++c)
+    cellOffsets[c] += cellOffsets[c - 1];
+
+  // Scatter the ratings into their cells.
+  users.set_size(data.n_cols);
+  items.set_size(data.n_cols);
+  ratings.set_size(data.n_cols);
+  arma::Col<size_t> next = cellOffsets.subvec(0, cellOffsets.n_elem - 2);
+  for (size_t j = 0; j < userOrder.n_elem; ++j)
+  {
+    const size_t i = userOrder[j];
+    const size_t pos = next[cellOf[i]]++;
+    users[pos] = (size_t) data(0, i);
+    items[pos] = (size_t) data(1, i);
+    ratings[pos] = data(2, i);
+  }
+}
+
+void BlockedRatings::Shuffle()
+{
+  for (size_t c = 0; c + 1 < cellOffsets.n_elem; ++c)
+  {
+    // Fisher-Yates shuffle of the ratings in this cell, applied to all three
+    // arrays at once.
+    const size_t begin = cellOffsets[c];
+    const size_t end = cellOffsets[c + 1];
+    for (size_t i = end; i > begin + 1; --i)
+    {
+      const size_t j = begin + (size_t) math::RandInt((int) (i - begin));
+      std::swap(users[i - 1], users[j]);
+      std::swap(items[i - 1], items[j]);
+      std::swap(ratings[i - 1], ratings[j]);
+    }
+  }
+}
+
+size_t BlockedRatings::DefaultNumBlocks()
+{
+  #ifdef HAS_OPENMP
+    return (size_t) omp_get_max_threads();
+  #else
+    return 1;
+  #endif
+}
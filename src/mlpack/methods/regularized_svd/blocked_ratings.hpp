@@ -0,0 +1,126 @@
+/**
+ * @file methods/regularized_svd/blocked_ratings.hpp
+ *
+ * Definition of the BlockedRatings class, a compact stratified store of rating
+ * triples used by the parallel SGD optimizers of RegularizedSVDFunction,
+ * BiasSVDFunction and SVDPlusPlusFunction.
+ *
+ * The stratification follows the DSGD algorithm:
+ *
+ * @code
+ * @inproceedings{gemulla2011large,
+ *   title={Large-scale matrix factorization with distributed stochastic
+ *       gradient descent},
+ *   author={Gemulla, R. and Nijkamp, E. and Haas, P.J. and Sismanis, Y.},
+ *   booktitle={Proceedings of the 17th ACM SIGKDD International Conference on
+ *       Knowledge Discovery and Data Mining},
+ *   pages={69--77},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_REGULARIZED_SVD_BLOCKED_RATINGS_HPP
+#define MLPACK_METHODS_REGULARIZED_SVD_BLOCKED_RATINGS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace svd {
+
+/**
+ * BlockedRatings holds a set of (user, item, rating) triples, partitioned into
+ * a numBlocks x numBlocks grid.  Users and items are each split into numBlocks
+ * contiguous ranges of ids; the cell (u, i) holds all the ratings whose user
+ * lies in user block u and whose item lies in item block i.  The ratings of
+ * every cell are stored contiguously (sorted by user), and the offset of each
+ * cell is kept CSR-style, so a cell can be walked without any indirection.
+ *
+ * Stratum s is made of the cells (b, (b + s) % numBlocks) for every block b.
+ * No two cells of a stratum share a user block or an item block, so all the
+ * cells of a stratum can be handed to different threads, and the factor
+ * updates made by those threads never touch the same parameter column.
+ * Visiting every stratum once visits every rating once.
+ */
+class BlockedRatings
+{
+ public:
+  /**
+   * Partition the given ratings.  The dataset is expected in the coordinate
+   * list format used by RegularizedSVDFunction: one rating per column, with the
+   * user in the first row, the item in the second row and the rating in the
+   * third row.
+   *
+   * @param data Coordinate list of ratings.
+   * @param numUsers Number of users (the largest user id plus one).
+   * @param numItems Number of items (the largest item id plus one).
+   * @param numBlocks Number of user (and item) blocks; this is the number of
+   *     cells that can be processed concurrently.
+   */
+  BlockedRatings(const arma::mat& data,
+                 const size_t numUsers,
+                 const size_t numItems,
+                 const size_t numBlocks = DefaultNumBlocks());
+
+  /**
+   * Shuffle the order of the ratings inside each cell.  Cells stay where they
+   * are, so the stratification is not affected.
+   */
+  void Shuffle();
+
+  //! Get the index of the cell that block `block` processes in stratum
+  //! `stratum`.
+  size_t Cell(const size_t stratum, const size_t block) const
+  {
+    return block * numBlocks + (block + stratum) % numBlocks;
+  }
+
+  //! Get the index of the first rating in the given cell.
+  size_t CellBegin(const size_t cell) const { return cellOffsets[cell]; }
+  //! Get the index one past the last rating in the given cell.
+  size_t CellEnd(const size_t cell) const { return cellOffsets[cell + 1]; }
+
+  //! Get the user of the i'th stored rating.
+  size_t User(const size_t i) const { return users[i]; }
+  //! Get the item of the i'th stored rating.
+  size_t Item(const size_t i) const { return items[i]; }
+  //! Get the value of the i'th stored rating.
+  double Rating(const size_t i) const { return ratings[i]; }
+
+  //! Get the number of blocks (and strata).
+  size_t NumBlocks() const { return numBlocks; }
+  //! Get the number of stored ratings.
+  size_t NumRatings() const { return ratings.n_elem; }
+
+  /**
+   * Get the default number of blocks: the number of OpenMP threads available,
+   * or 1 if mlpack was compiled without OpenMP.
+   */
+  static size_t DefaultNumBlocks();
+
+ private:
+  //! Number of user (and item) blocks.
+  size_t numBlocks;
+  //! Number of users in each user block (the last may hold fewer).
+  size_t usersPerBlock;
+  //! Number of items in each item block (the last may hold fewer).
+  size_t itemsPerBlock;
+  //! Offset of the first rating of each cell; cellOffsets[numBlocks^2] is the
+  //! total number of ratings.
+  arma::Col<size_t> cellOffsets;
+  //! User of each rating.
+  arma::Col<size_t> users;
+  //! Item of each rating.
+  arma::Col<size_t> items;
+  //! Value of each rating.
+  arma::vec ratings;
+};
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
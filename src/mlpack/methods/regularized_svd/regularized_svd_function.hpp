@@ -143,7 +143,9 @@ namespace ens {
    * Template specialization for the SGD and parallel SGD optimizer. Used
    * because the gradient affects only a small number of parameters per example,
    * and thus the normal abstraction does not work as fast as we might like it
-   * to.
+   * to.  The parallel SGD specialization partitions the ratings into
+   * conflict-free user/item blocks (see BlockedRatings), so that the threads
+   * never update the same user or item factors at the same time.
    */
   template <>
   template <>
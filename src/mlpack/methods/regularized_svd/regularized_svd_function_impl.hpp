@@ -14,6 +14,7 @@
 
 #include "regularized_svd_function.hpp"
 #include <mlpack/core/math/make_alias.hpp>
+#include "blocked_ratings.hpp"
 
 namespace mlpack {
 namespace svd {
@@ -227,11 +228,20 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
   double overallObjective = DBL_MAX;
   double lastObjective;
 
-  // The order in which the functions will be visited.
-  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
-      (function.NumFunctions() - 1), function.NumFunctions());
+  const size_t numUsers = function.NumUsers();
+  const double lambda = function.Lambda();
 
-  const arma::mat data = function.Dataset();
+  // Partition the ratings into a grid of user/item blocks (DSGD).  The cells of
+  // one stratum share no users and no items, so the threads working on them
+  // can update the factors in place without atomics.  Note that this means
+  // threadShareSize is not used.
+  mlpack::svd::BlockedRatings ratings(function.Dataset(), numUsers,
+      function.NumItems());
+  const size_t numBlocks = ratings.NumBlocks();
+
+  // The order in which the strata will be visited.
+  arma::Col<size_t> strataOrder = arma::linspace<arma::Col<size_t>>(0,
+      numBlocks - 1, numBlocks);
 
   // Iterate till the objective is within tolerance or the maximum number of
   // allowed iterations is reached. If maxIterations is 0, this will iterate
@@ -271,48 +281,38 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
     double stepSize = decayPolicy.StepSize(i);
 
     if (shuffle) // Determine order of visitation.
-      std::shuffle(visitationOrder.begin(), visitationOrder.end(),
+    {
+      ratings.Shuffle();
+      std::shuffle(strataOrder.begin(), strataOrder.end(),
           mlpack::math::randGen);
+    }
 
-    #pragma omp parallel
+    for (size_t s = 0; s < numBlocks; ++s)
     {
-      // Each processor gets a subset of the instances.
-      // Each subset is of size threadShareSize.
-      size_t threadId = 0;
-      #ifdef HAS_OPENMP
-        threadId = omp_get_thread_num();
-      #endif
-
-      for (size_t j = threadId * threadShareSize;
-          j < (threadId + 1) * threadShareSize && j < visitationOrder.n_elem;
-          ++j)
+      // Each thread gets one cell of the stratum.
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
       {
-        const size_t numUsers = function.NumUsers();
-
-        // Indices for accessing the the correct parameter columns.
-        const size_t user = data(0, visitationOrder[j]);
-        const size_t item = data(1, visitationOrder[j]) + numUsers;
-
-        // Prediction error for the example.
-        const double rating = data(2, visitationOrder[j]);
-        double ratingError = rating - arma::dot(iterate.col(user),
-            iterate.col(item));
-
-        double lambda = function.Lambda();
-
-        arma::mat userUpdate = stepSize * (lambda * iterate.col(user) -
-            ratingError * iterate.col(item));
-        arma::mat itemUpdate = stepSize * (lambda * iterate.col(item) -
-            ratingError * iterate.col(user));
-
-        // Gradient is non-zero only for the parameter columns corresponding to
-        // the example.
-        for (size_t i = 0; i < iterate.n_rows; ++i)
+        const size_t cell = ratings.Cell(strataOrder[s], b);
+        arma::vec userVec(iterate.n_rows);
+        for (size_t j = ratings.CellBegin(cell); j < ratings.CellEnd(cell);
+            ++j)
         {
-          #pragma omp atomic
-          iterate(i, user) -= userUpdate(i);
-          #pragma omp atomic
-          iterate(i, item) -= itemUpdate(i);
+          // Indices for accessing the the correct parameter columns.
+          const size_t user = ratings.User(j);
+          const size_t item = ratings.Item(j) + numUsers;
+
+          // Prediction error for the example.
+          const double ratingError = ratings.Rating(j) -
+              arma::dot(iterate.col(user), iterate.col(item));
+
+          // Gradient is non-zero only for the parameter columns corresponding
+          // to the example.  Keep the old user vector for the item update.
+          userVec = iterate.col(user);
+          iterate.col(user) -= stepSize * (lambda * userVec -
+              ratingError * iterate.col(item));
+          iterate.col(item) -= stepSize * (lambda * iterate.col(item) -
+              ratingError * userVec);
         }
       }
     }
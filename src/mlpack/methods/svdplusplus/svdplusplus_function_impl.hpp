@@ -15,6 +15,7 @@
 
 #include "svdplusplus_function.hpp"
 #include <mlpack/core/math/make_alias.hpp>
+#include <mlpack/methods/regularized_svd/blocked_ratings.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -402,32 +403,92 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
   double overallObjective = DBL_MAX;
   double lastObjective;
 
-  // The order in which the functions will be visited.
-  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
-      (function.NumFunctions() - 1), function.NumFunctions());
-
-  const arma::mat data = function.Dataset();
-  const arma::sp_mat implicitData = function.ImplicitDataset();
+  const arma::sp_mat& implicitData = function.ImplicitDataset();
   const size_t numUsers = function.NumUsers();
   const size_t numItems = function.NumItems();
+  const size_t implicitStart = numUsers + numItems;
   const double lambda = function.Lambda();
 
   // Rank of decomposition.
   const size_t rank = function.Rank();
 
+  // Partition the ratings into a grid of conflict-free user/item blocks; see
+  // the RegularizedSVDFunction specialization.  threadShareSize is not used.
+  // The user and item factors are updated in place; only the implicit item
+  // vectors, which may be shared by users of different blocks, need atomics.
+  mlpack::svd::BlockedRatings ratings(function.Dataset(), numUsers, numItems);
+  const size_t numBlocks = ratings.NumBlocks();
+
+  // The order in which the strata will be visited.
+  arma::Col<size_t> strataOrder = arma::linspace<arma::Col<size_t>>(0,
+      numBlocks - 1, numBlocks);
+
+  // Flatten the implicit feedback into one CSR row per user, so that the inner
+  // loops do not have to go through sparse matrix iterators.
+  arma::Col<size_t> implicitOffsets(numUsers + 1);
+  arma::Col<size_t> implicitItems(implicitData.n_nonzero);
+  implicitOffsets[0] = 0;
+  for (size_t u = 0; u < numUsers; ++u)
+  {
+    size_t pos = implicitOffsets[u];
+    arma::sp_mat::const_iterator it = implicitData.begin_col(u);
+    arma::sp_mat::const_iterator it_end = implicitData.end_col(u);
+    for (; it != it_end; ++it)
+      implicitItems[pos++] = it.row();
+    implicitOffsets[u + 1] = pos;
+  }
+
+  // Column u holds sum(y(k)) / sqrt(|N(u)|) for the items k that user u
+  // interacted with.  These sums are recomputed at the start of every epoch and
+  // are then kept up to date with the user's own implicit updates, instead of
+  // being recomputed for every rating.
+  arma::mat implicitSums(rank, numUsers);
+  // The implicit regularization penalty of each user, lambda * mean(|y(k)|^2).
+  arma::vec implicitPenalty(numUsers);
+
   // Iterate till the objective is within tolerance or the maximum number of
   // allowed iterations is reached. If maxIterations is 0, this will iterate
   // till convergence.
   for (size_t i = 1; i != maxIterations; ++i)
   {
-    // Calculate the overall objective.
+    // Refresh the cached implicit sums.
+    #pragma omp parallel for
+    for (omp_size_t u = 0; u < (omp_size_t) numUsers; ++u)
+    {
+      implicitSums.col(u).zeros();
+      implicitPenalty[u] = 0;
+      const size_t implicitCount = implicitOffsets[u + 1] - implicitOffsets[u];
+      for (size_t k = implicitOffsets[u]; k < implicitOffsets[u + 1]; ++k)
+      {
+        const size_t col = implicitStart + implicitItems[k];
+        implicitSums.col(u) += iterate.col(col).subvec(0, rank - 1);
+        implicitPenalty[u] += arma::dot(iterate.col(col).subvec(0, rank - 1),
+            iterate.col(col).subvec(0, rank - 1));
+      }
+      if (implicitCount != 0)
+      {
+        implicitSums.col(u) /= std::sqrt(implicitCount);
+        implicitPenalty[u] *= lambda / implicitCount;
+      }
+    }
+
+    // Calculate the overall objective.  This is the same objective as
+    // SVDPlusPlusFunction::Evaluate(), but using the cached implicit sums.
     lastObjective = overallObjective;
     overallObjective = 0;
 
     #pragma omp parallel for reduction(+:overallObjective)
-    for (omp_size_t j = 0; j < (omp_size_t) function.NumFunctions(); ++j)
+    for (omp_size_t j = 0; j < (omp_size_t) ratings.NumRatings(); ++j)
     {
-      overallObjective += function.Evaluate(iterate, j);
+      const size_t user = ratings.User(j);
+      const size_t item = ratings.Item(j) + numUsers;
+      const double ratingError = ratings.Rating(j) - iterate(rank, user) -
+          iterate(rank, item) - arma::dot(iterate.col(user).subvec(0, rank - 1)
+          + implicitSums.col(user), iterate.col(item).subvec(0, rank - 1));
+
+      overallObjective += ratingError * ratingError + implicitPenalty[user] +
+          lambda * (arma::dot(iterate.col(user), iterate.col(user)) +
+                    arma::dot(iterate.col(item), iterate.col(item)));
     }
 
     // Output current objective function.
@@ -453,97 +514,77 @@ inline double ParallelSGD<ExponentialBackoff>::Optimize(
     double stepSize = decayPolicy.StepSize(i);
 
     if (shuffle) // Determine order of visitation.
-      std::shuffle(visitationOrder.begin(), visitationOrder.end(),
+    {
+      ratings.Shuffle();
+      std::shuffle(strataOrder.begin(), strataOrder.end(),
           mlpack::math::randGen);
+    }
 
-    #pragma omp parallel
+    for (size_t s = 0; s < numBlocks; ++s)
     {
-      // Each processor gets a subset of the instances.
-      // Each subset is of size threadShareSize.
-      size_t threadId = 0;
-      #ifdef HAS_OPENMP
-        threadId = omp_get_thread_num();
-      #endif
-
-      for (size_t j = threadId * threadShareSize;
-          j < (threadId + 1) * threadShareSize && j < visitationOrder.n_elem;
-          ++j)
+      // Each thread gets one cell of the stratum.
+      #pragma omp parallel for schedule(dynamic)
+      for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
       {
-        // Indices for accessing the the correct parameter columns.
-        const size_t user = data(0, visitationOrder[j]);
-        const size_t item = data(1, visitationOrder[j]) + numUsers;
-        const size_t implicitStart = numUsers + numItems;
-
-        // Prediction error for the example.
-        const double rating = data(2, visitationOrder[j]);
-        const double userBias = iterate(rank, user);
-        const double itemBias = iterate(rank, item);
-        // Iterate through each item which the user interacted with to calculate
-        // user vector.
-        arma::vec userVec(rank, arma::fill::zeros);
-        arma::sp_mat::const_iterator it = implicitData.begin_col(user);
-        arma::sp_mat::const_iterator it_end = implicitData.end_col(user);
-        size_t implicitCount = 0;
-        for (; it != it_end; ++it)
-        {
-          userVec += iterate.col(implicitStart + it.row()).subvec(0, rank - 1);
-          implicitCount += 1;
-        }
-        if (implicitCount != 0)
-          userVec /= std::sqrt(implicitCount);
-        userVec += iterate.col(user).subvec(0, rank - 1);
-
-        double ratingError = rating - userBias - itemBias -
-        arma::dot(userVec, iterate.col(item).subvec(0, rank - 1));
-
-        arma::mat userVecUpdate = stepSize * 2 * (
-            lambda * iterate.col(user).subvec(0, rank - 1) -
-            ratingError * iterate.col(item).subvec(0, rank - 1));
-        arma::mat itemVecUpdate = stepSize * 2 * (
-            lambda * iterate.col(item).subvec(0, rank - 1) -
-            ratingError * userVec);
-        double userBiasUpdate = stepSize * 2 * (
-            lambda * iterate(rank, user) - ratingError);
-        double itemBiasUpdate = stepSize * 2 * (
-            lambda * iterate(rank, item) - ratingError);
-
-        // Update of item implicit vectors.
-        arma::mat itemImplicitUpdate(rank, implicitCount);
-        arma::Col<size_t> implicitItems(implicitCount);
-        it = implicitData.begin_col(user);
-        it_end = implicitData.end_col(user);
-        size_t implicitIndex = 0;
-        for (; it != it_end; ++it, ++implicitIndex)
-        {
-          itemImplicitUpdate.col(implicitIndex) =
-              stepSize * 2.0 * (lambda / implicitCount *
-              iterate.col(implicitStart + it.row()).subvec(0, rank - 1) -
-              ratingError / std::sqrt(implicitCount) *
-              iterate.col(item).subvec(0, rank - 1));
-          implicitItems(implicitIndex) = it.row();
-        }
-
-        // Gradient is non-zero only for the parameter columns corresponding to
-        // the example.
-        for (size_t i = 0; i < rank; ++i)
-        {
-          #pragma omp atomic
-          iterate(i, user) -= userVecUpdate(i);
-          #pragma omp atomic
-          iterate(i, item) -= itemVecUpdate(i);
-        }
-        #pragma omp atomic
-        iterate(rank, user) -= userBiasUpdate;
-        #pragma omp atomic
-        iterate(rank, item) -= itemBiasUpdate;
-        for (size_t k = 0; k < implicitCount; ++k)
+        const size_t cell = ratings.Cell(strataOrder[s], b);
+        arma::vec userVec(rank), oldUserVec(rank), oldItemVec(rank);
+        arma::vec implicitUpdate(rank);
+        for (size_t j = ratings.CellBegin(cell); j < ratings.CellEnd(cell);
+            ++j)
         {
-          for (size_t i = 0; i < rank; ++i)
+          // Indices for accessing the the correct parameter columns.
+          const size_t user = ratings.User(j);
+          const size_t item = ratings.Item(j) + numUsers;
+          const size_t implicitCount = implicitOffsets[user + 1] -
+              implicitOffsets[user];
+
+          // Prediction error for the example.
+          const double userBias = iterate(rank, user);
+          const double itemBias = iterate(rank, item);
+          oldUserVec = iterate.col(user).subvec(0, rank - 1);
+          oldItemVec = iterate.col(item).subvec(0, rank - 1);
+          userVec = oldUserVec + implicitSums.col(user);
+          const double ratingError = ratings.Rating(j) - userBias - itemBias -
+              arma::dot(userVec, oldItemVec);
+
+          // Gradient is non-zero only for the parameter columns corresponding
+          // to the example.
+          iterate.col(user).subvec(0, rank - 1) -= stepSize * 2 * (
+              lambda * oldUserVec - ratingError * oldItemVec);
+          iterate.col(item).subvec(0, rank - 1) -= stepSize * 2 * (
+              lambda * oldItemVec - ratingError * userVec);
+          iterate(rank, user) -= stepSize * 2 * (
+              lambda * userBias - ratingError);
+          iterate(rank, item) -= stepSize * 2 * (
+              lambda * itemBias - ratingError);
+
+          // Update the item implicit vectors, and fold the same update into
+          // the cached implicit sum of this user.
+          if (implicitCount == 0)
+            continue;
+
+          implicitUpdate.zeros();
+          for (size_t k = implicitOffsets[user]; k < implicitOffsets[user + 1];
+              ++k)
           {
-            #pragma omp atomic
-            iterate(i, implicitStart + implicitItems(k)) -=
-                itemImplicitUpdate(i, k);
+            const size_t col = implicitStart + implicitItems[k];
+            for (size_t r = 0; r < rank; ++r)
+            {
+              // Other threads may update the same implicit item vector, so
+              // the value is also read atomically.
+              double implicitValue;
+              #pragma omp atomic read
+              implicitValue = iterate(r, col);
+
+              const double update = stepSize * 2.0 * (lambda / implicitCount *
+                  implicitValue - ratingError / std::sqrt(implicitCount) *
+                  oldItemVec[r]);
+              #pragma omp atomic
+              iterate(r, col) -= update;
+              implicitUpdate[r] += update;
+            }
           }
+          implicitSums.col(user) -= implicitUpdate / std::sqrt(implicitCount);
         }
       }
     }
@@ -1077,6 +1077,84 @@ TEST_CASE("LSTMLayerParametersTest", "[ANNLayerTest]")
   REQUIRE(layer1.Rho() == layer2.Rho());
 }
 
+/**
+ * Make sure that the LSTM layer computes each gate with its own weights, also
+ * when the weights are changed between two sequences.
+ */
+TEST_CASE("LSTMGateWeightsTest", "[ANNLayerTest]")
+{
+  const size_t rho = 4, inSize = 3, outSize = 2, batchSize = 5;
+  arma::cube input = arma::randn(inSize, batchSize, rho);
+
+  LSTM<> lstm(inSize, outSize, rho);
+  lstm.Reset();
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    lstm.Parameters().randn();
+    lstm.ResetCell(rho);
+
+    // Extract the weights in the order they are stored; the gates are stored
+    // in the order output gate, forget gate, input gate, hidden layer.
+    const arma::mat& p = lstm.Parameters();
+    size_t offset = 0;
+    arma::mat inputWeights[4], outputWeights[4];
+    arma::vec biases[4];
+    for (size_t g = 0; g < 4; ++g)
+    {
+      inputWeights[g] = arma::reshape(p.rows(offset,
+          offset + outSize * inSize - 1), outSize, inSize);
+      offset += outSize * inSize;
+      biases[g] = p.rows(offset, offset + outSize - 1);
+      offset += outSize;
+    }
+    for (size_t g = 0; g < 4; ++g)
+    {
+      outputWeights[g] = arma::reshape(p.rows(offset,
+          offset + outSize * outSize - 1), outSize, outSize);
+      offset += outSize * outSize;
+    }
+    const arma::vec peepholeOutput = p.rows(offset, offset + outSize - 1);
+    const arma::vec peepholeForget = p.rows(offset + outSize,
+        offset + 2 * outSize - 1);
+    const arma::vec peepholeInput = p.rows(offset + 2 * outSize,
+        offset + 3 * outSize - 1);
+
+    arma::mat h = arma::zeros(outSize, batchSize);
+    arma::mat c = arma::zeros(outSize, batchSize);
+    for (size_t t = 0; t < rho; ++t)
+    {
+      const arma::mat x = input.slice(t);
+      arma::mat output;
+      lstm.Forward(x, output);
+
+      arma::mat i = inputWeights[2] * x + outputWeights[2] * h;
+      i.each_col() += biases[2];
+      arma::mat f = inputWeights[1] * x + outputWeights[1] * h;
+      f.each_col() += biases[1];
+      if (t > 0)
+      {
+        i += c.each_col() % peepholeInput;
+        f += c.each_col() % peepholeForget;
+      }
+      i = 1.0 / (1 + arma::exp(-i));
+      f = 1.0 / (1 + arma::exp(-f));
+
+      arma::mat z = inputWeights[3] * x + outputWeights[3] * h;
+      z.each_col() += biases[3];
+      c = f % c + i % arma::tanh(z);
+
+      arma::mat o = inputWeights[0] * x + outputWeights[0] * h +
+          c.each_col() % peepholeOutput;
+      o.each_col() += biases[0];
+      o = 1.0 / (1 + arma::exp(-o));
+      h = o % arma::tanh(c);
+
+      CheckMatrices(output, h, 1e-10);
+    }
+  }
+}
+
 /**
  * Test the FastLSTM layer with a user defined rho parameter and without.
  */
@@ -4611,6 +4689,50 @@ TEST_CASE("SimpleMultiheadAttentionTest", "[ANNLayerTest]")
   REQUIRE(gradient.n_cols == module.Parameters().n_cols);
 }
 
+/**
+ * Make sure that a target position whose scores are all masked with -infinity
+ * gives finite outputs and gradients, and does not depend on the input.
+ */
+TEST_CASE("MaskedRowMultiheadAttentionTest", "[ANNLayerTest]")
+{
+  const size_t tLen = 4;
+  const size_t sLen = 6;
+  const size_t embedDim = 4;
+  const size_t numHeads = 2;
+  const size_t bsz = 3;
+
+  // Mask every source position for the target position 1.
+  arma::mat attnMask = arma::zeros(tLen, sLen);
+  attnMask.row(1).fill(-std::numeric_limits<double>::infinity());
+
+  MultiheadAttention<> module(tLen, sLen, embedDim, numHeads);
+  module.AttentionMask() = attnMask;
+  module.TileSize() = 4;
+  module.Reset();
+  module.Parameters().randu();
+
+  arma::mat input = arma::randu(embedDim * (tLen + 2 * sLen), bsz);
+  arma::mat output;
+  module.Forward(input, output);
+  REQUIRE(output.is_finite());
+
+  arma::mat gy = 0.01 * arma::randu(embedDim * tLen, bsz);
+  arma::mat g;
+  module.Backward(input, gy, g);
+  REQUIRE(g.is_finite());
+
+  arma::mat gradient;
+  module.Gradient(input, gy, gradient);
+  REQUIRE(gradient.is_finite());
+
+  // The output of the masked position is the same for another input.
+  arma::mat otherInput = arma::randu(embedDim * (tLen + 2 * sLen), bsz);
+  arma::mat otherOutput;
+  module.Forward(otherInput, otherOutput);
+  CheckMatrices(output.rows(embedDim, 2 * embedDim - 1),
+      otherOutput.rows(embedDim, 2 * embedDim - 1), 1e-10);
+}
+
 /**
  * Jacobian MultiheadAttention module test.
  */
@@ -4746,3 +4868,190 @@ TEST_CASE("GradientMultiheadAttentionTest", "[ANNLayerTest]")
 
   REQUIRE(CheckGradient(function) <= 2e-06);
 }
+
+/**
+ * Make sure that the tiled attention of the MultiheadAttention layer does not
+ * depend on the tile size, and that the attention weights of each target
+ * position sum to one over the source positions.
+ */
+TEST_CASE("TiledMultiheadAttentionTest", "[ANNLayerTest]")
+{
+  const size_t tgtSeqLen = 4;
+  const size_t srcSeqLen = 7;
+  const size_t embedDim = 6;
+  const size_t numHeads = 3;
+  const size_t batchSize = 3;
+
+  arma::mat attnMask = arma::zeros(tgtSeqLen, srcSeqLen);
+  for (size_t i = 0; i < tgtSeqLen; ++i)
+    for (size_t j = i + 2; j < srcSeqLen; ++j)
+      attnMask(i, j) = std::numeric_limits<double>::lowest();
+
+  arma::mat keyPaddingMask = arma::zeros(1, srcSeqLen);
+  keyPaddingMask(1) = std::numeric_limits<double>::lowest();
+
+  arma::mat input = arma::randu(embedDim * (tgtSeqLen + 2 * srcSeqLen),
+      batchSize);
+  arma::mat gy = arma::randu(embedDim * tgtSeqLen, batchSize);
+
+  MultiheadAttention<> module(tgtSeqLen, srcSeqLen, embedDim, numHeads);
+  module.AttentionMask() = attnMask;
+  module.KeyPaddingMask() = keyPaddingMask;
+  module.Parameters().randu();
+  module.Reset();
+
+  arma::mat output, g, gradient;
+  module.Forward(input, output);
+  module.Backward(input, gy, g);
+  module.Gradient(input, gy, gradient);
+
+  // Tiles of a single source position, tiles that do not divide the source
+  // sequence, and a single tile must all give the same results.
+  const size_t tileSizes[] = { 1, 3, srcSeqLen };
+  for (const size_t tileSize : tileSizes)
+  {
+    module.TileSize() = tileSize;
+
+    arma::mat tiledOutput, tiledG, tiledGradient;
+    module.Forward(input, tiledOutput);
+    module.Backward(input, gy, tiledG);
+    module.Gradient(input, gy, tiledGradient);
+
+    CheckMatrices(output, tiledOutput, 1e-6);
+    CheckMatrices(g, tiledG, 1e-6);
+    CheckMatrices(gradient, tiledGradient, 1e-6);
+  }
+
+  // When every source position has the same value, the attention output of
+  // each target position is the projection of that value, whatever the
+  // scores are.
+  arma::mat value = arma::repmat(arma::randu(embedDim, batchSize),
+      srcSeqLen, 1);
+  input.rows(embedDim * (tgtSeqLen + srcSeqLen), input.n_rows - 1) = value;
+  module.TileSize() = 2;
+  module.Forward(input, output);
+
+  const arma::mat& parameters = module.Parameters();
+  const size_t wtSize = embedDim * embedDim;
+  const arma::mat valueWt(const_cast<double*>(parameters.memptr()) +
+      2 * wtSize, embedDim, embedDim, false, true);
+  const arma::mat outWt(const_cast<double*>(parameters.memptr()) +
+      3 * wtSize, embedDim, embedDim, false, true);
+  const arma::vec vBias = parameters.rows(4 * wtSize + 2 * embedDim,
+      4 * wtSize + 3 * embedDim - 1);
+  const arma::vec outBias = parameters.rows(4 * wtSize + 3 * embedDim,
+      4 * wtSize + 4 * embedDim - 1);
+
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    const arma::vec expected = outWt.t() * (valueWt *
+        value.submat(0, i, embedDim - 1, i) + vBias) + outBias;
+    for (size_t t = 0; t < tgtSeqLen; ++t)
+    {
+      CheckMatrices(arma::mat(output.submat(t * embedDim, i,
+          (t + 1) * embedDim - 1, i)), arma::mat(expected), 1e-6);
+    }
+  }
+
+  // The Jacobian must also be correct when the source sequence is split into
+  // several tiles.
+  MultiheadAttention<> tiledModule(2, 5, 4, 2, 2);
+  tiledModule.Parameters().randu();
+  arma::mat jacobianInput = 0.1 * arma::randu(4 * (2 + 2 * 5), 1);
+  REQUIRE(JacobianTest(tiledModule, jacobianInput) <= 1e-5);
+}
+
+/**
+ * Make sure that the Convolution, BatchNorm, MaxPooling, Linear and LogSoftMax
+ * layers give the same results in single precision as in double precision.
+ */
+TEST_CASE("FloatLayersTest", "[ANNLayerTest]")
+{
+  typedef Convolution<NaiveConvolution<ValidConvolution>,
+      NaiveConvolution<FullConvolution>, NaiveConvolution<ValidConvolution>,
+      arma::fmat, arma::fmat> FloatConvolution;
+
+  arma::mat input = arma::randu(6 * 6 * 2, 4);
+  arma::fmat fInput = arma::conv_to<arma::fmat>::from(input);
+
+  Convolution<> conv(2, 3, 3, 3, 1, 1, 1, 1, 6, 6);
+  FloatConvolution fConv(2, 3, 3, 3, 1, 1, 1, 1, 6, 6);
+  conv.Parameters().randn();
+  fConv.Parameters() = arma::conv_to<arma::fmat>::from(conv.Parameters());
+  conv.Reset();
+  fConv.Reset();
+
+  BatchNorm<> bn(3);
+  BatchNorm<arma::fmat, arma::fmat> fBn(3);
+  bn.Reset();
+  fBn.Reset();
+
+  MaxPooling<> pool(2, 2, 2, 2);
+  MaxPooling<arma::fmat, arma::fmat> fPool(2, 2, 2, 2);
+  pool.InputWidth() = fPool.InputWidth() = 6;
+  pool.InputHeight() = fPool.InputHeight() = 6;
+
+  Linear<> linear(3 * 3 * 3, 5);
+  Linear<arma::fmat, arma::fmat> fLinear(3 * 3 * 3, 5);
+  linear.Parameters().randn();
+  fLinear.Parameters() = arma::conv_to<arma::fmat>::from(linear.Parameters());
+  linear.Reset();
+  fLinear.Reset();
+
+  LogSoftMax<> logSoftMax;
+  LogSoftMax<arma::fmat, arma::fmat> fLogSoftMax;
+
+  // Forward pass.
+  arma::mat convOut, bnOut, poolOut, linearOut, output;
+  conv.Forward(input, convOut);
+  bn.Forward(convOut, bnOut);
+  pool.Forward(bnOut, poolOut);
+  linear.Forward(poolOut, linearOut);
+  logSoftMax.Forward(linearOut, output);
+
+  arma::fmat fConvOut, fBnOut, fPoolOut, fLinearOut, fOutput;
+  fConv.Forward(fInput, fConvOut);
+  fBn.Forward(fConvOut, fBnOut);
+  fPool.Forward(fBnOut, fPoolOut);
+  fLinear.Forward(fPoolOut, fLinearOut);
+  fLogSoftMax.Forward(fLinearOut, fOutput);
+
+  CheckMatrices(output, arma::conv_to<arma::mat>::from(fOutput), 1e-2);
+
+  // Backward pass.
+  arma::mat gy = arma::randu(5, 4);
+  arma::fmat fGy = arma::conv_to<arma::fmat>::from(gy);
+
+  arma::mat linearError, poolError, bnError, convError, g;
+  logSoftMax.Backward(output, gy, linearError);
+  linear.Backward(poolOut, linearError, poolError);
+  pool.Backward(bnOut, poolError, bnError);
+  bn.Backward(convOut, bnError, convError);
+  conv.Backward(input, convError, g);
+
+  arma::fmat fLinearError, fPoolError, fBnError, fConvError, fG;
+  fLogSoftMax.Backward(fOutput, fGy, fLinearError);
+  fLinear.Backward(fPoolOut, fLinearError, fPoolError);
+  fPool.Backward(fBnOut, fPoolError, fBnError);
+  fBn.Backward(fConvOut, fBnError, fConvError);
+  fConv.Backward(fInput, fConvError, fG);
+
+  CheckMatrices(g, arma::conv_to<arma::mat>::from(fG), 1e-2);
+
+  // Gradients.
+  arma::mat linearGradient, bnGradient, convGradient;
+  linear.Gradient(poolOut, linearError, linearGradient);
+  bn.Gradient(convOut, bnError, bnGradient);
+  conv.Gradient(input, convError, convGradient);
+
+  arma::fmat fLinearGradient, fBnGradient, fConvGradient;
+  fLinear.Gradient(fPoolOut, fLinearError, fLinearGradient);
+  fBn.Gradient(fConvOut, fBnError, fBnGradient);
+  fConv.Gradient(fInput, fConvError, fConvGradient);
+
+  CheckMatrices(linearGradient,
+      arma::conv_to<arma::mat>::from(fLinearGradient), 1e-2);
+  CheckMatrices(bnGradient, arma::conv_to<arma::mat>::from(fBnGradient), 1e-2);
+  CheckMatrices(convGradient,
+      arma::conv_to<arma::mat>::from(fConvGradient), 1e-2);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file tests/batch_loader_test.cpp
+ *
+ * Tests for the BatchLoader class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/batch_loader.hpp>
+#include "test_catch_tools.hpp"
+#include "catch.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+// Decode each point as its index, in the predictors and in the responses.
+static void DecodeIndices(const arma::Col<size_t>& indices,
+                          arma::mat& predictors,
+                          arma::mat& responses)
+{
+  predictors = arma::conv_to<arma::rowvec>::from(indices);
+  responses = predictors + 1;
+}
+
+/**
+ * Make sure that each epoch visits every point once, in batches of the given
+ * size, and that the epochs are shuffled differently.
+ */
+TEST_CASE("BatchLoaderEpochTest", "[BatchLoaderTest]")
+{
+  BatchLoader<> loader(103, 10, DecodeIndices, true, 3);
+
+  REQUIRE(loader.NumPoints() == 103);
+  REQUIRE(loader.BatchSize() == 10);
+  REQUIRE(loader.BatchesPerEpoch() == 11);
+  REQUIRE(loader.NumThreads() == 3);
+
+  std::vector<arma::rowvec> epochs(2);
+  for (size_t epoch = 0; epoch < 2; ++epoch)
+  {
+    for (size_t i = 0; i < loader.BatchesPerEpoch(); ++i)
+    {
+      arma::mat predictors, responses;
+      loader.Next(predictors, responses);
+
+      REQUIRE(predictors.n_rows == 1);
+      REQUIRE(predictors.n_cols == ((i == 10) ? 3 : 10));
+      CheckMatrices(responses, predictors + 1);
+
+      epochs[epoch] = arma::join_rows(epochs[epoch], predictors);
+    }
+
+    // Every point is visited once.
+    const arma::rowvec sorted = arma::sort(epochs[epoch]);
+    for (size_t i = 0; i < 103; ++i)
+      REQUIRE(sorted[i] == (double) i);
+  }
+
+  REQUIRE(arma::accu(epochs[0] != epochs[1]) > 0);
+}
+
+/**
+ * Make sure that the points are visited in order without shuffling, and that
+ * the stream continues with the next epoch.
+ */
+TEST_CASE("BatchLoaderNoShuffleTest", "[BatchLoaderTest]")
+{
+  BatchLoader<> loader(25, 10, DecodeIndices, false, 2);
+
+  const size_t expectedBegins[5] = { 0, 10, 20, 0, 10 };
+  const size_t expectedSizes[5] = { 10, 10, 5, 10, 10 };
+  for (size_t i = 0; i < 5; ++i)
+  {
+    arma::mat predictors, responses;
+    loader.Next(predictors, responses);
+
+    REQUIRE(predictors.n_cols == expectedSizes[i]);
+    for (size_t j = 0; j < predictors.n_cols; ++j)
+      REQUIRE(predictors[j] == (double) (expectedBegins[i] + j));
+  }
+}
+
+/**
+ * Make sure that the order of the points only depends on the random seed, and
+ * not on the number of threads.
+ */
+TEST_CASE("BatchLoaderThreadsTest", "[BatchLoaderTest]")
+{
+  arma::mat serialOrder, parallelOrder;
+
+  math::RandomSeed(12);
+  {
+    BatchLoader<> loader(57, 4, DecodeIndices, true, 1);
+    for (size_t i = 0; i < 40; ++i)
+    {
+      arma::mat predictors, responses;
+      loader.Next(predictors, responses);
+      serialOrder = arma::join_rows(serialOrder, predictors);
+    }
+  }
+
+  math::RandomSeed(12);
+  {
+    BatchLoader<> loader(57, 4, DecodeIndices, true, 4, 8);
+    for (size_t i = 0; i < 40; ++i)
+    {
+      arma::mat predictors, responses;
+      loader.Next(predictors, responses);
+      parallelOrder = arma::join_rows(parallelOrder, predictors);
+    }
+  }
+
+  CheckMatrices(serialOrder, parallelOrder);
+}
+
+/**
+ * Make sure that the transform function is applied to each batch.
+ */
+TEST_CASE("BatchLoaderTransformTest", "[BatchLoaderTest]")
+{
+  BatchLoader<> loader(30, 7, DecodeIndices, false, 2, 2,
+      [](arma::mat& predictors, arma::mat& /* responses */)
+      {
+        predictors *= 2;
+      });
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    arma::mat predictors, responses;
+    loader.Next(predictors, responses);
+    CheckMatrices(predictors, 2 * (responses - 1));
+  }
+}
+
+/**
+ * Make sure that an exception thrown while decoding is rethrown by Next(), and
+ * that the batches before the failing one are still returned.
+ */
+TEST_CASE("BatchLoaderExceptionTest", "[BatchLoaderTest]")
+{
+  BatchLoader<> loader(50, 10, [](const arma::Col<size_t>& indices,
+                                  arma::mat& predictors,
+                                  arma::mat& responses)
+      {
+        if (indices[0] == 20)
+          throw std::runtime_error("cannot decode the batch");
+
+        DecodeIndices(indices, predictors, responses);
+      }, false, 3);
+
+  arma::mat predictors, responses;
+  loader.Next(predictors, responses);
+  REQUIRE(predictors[0] == 0.0);
+  loader.Next(predictors, responses);
+  REQUIRE(predictors[0] == 10.0);
+
+  REQUIRE_THROWS_AS(loader.Next(predictors, responses), std::runtime_error);
+}
+
+/**
+ * Make sure that invalid parameters are rejected.
+ */
+TEST_CASE("BatchLoaderInvalidParametersTest", "[BatchLoaderTest]")
+{
+  REQUIRE_THROWS_AS(BatchLoader<>(0, 10, DecodeIndices),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(BatchLoader<>(10, 0, DecodeIndices),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(BatchLoader<>(10, 5, DecodeIndices, true, 0),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(BatchLoader<>(10, 5, DecodeIndices, true, 1, 0),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(BatchLoader<>(10, 5, BatchLoader<>::DecodeFunctionType()),
+      std::invalid_argument);
+}
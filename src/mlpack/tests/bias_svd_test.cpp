@@ -374,4 +374,85 @@ TEST_CASE("BiasSVDFunctionParallelOptimize", "[BiasSVDTest]")
   REQUIRE(relativeError == Approx(0.0).margin(1e-2));
 }
 
+// Test Bias SVD with the parallel SGD specialization, which updates the
+// factors of conflict-free blocks of ratings in place.  Since no two threads
+// ever update the same factors, the result must not depend on the scheduling
+// of the threads.
+TEST_CASE("BiasSVDFunctionBlockedParallelOptimize", "[BiasSVDTest]")
+{
+  // Define useful constants.
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t rank = 10;
+  const double alpha = 0.01;
+  const double lambda = 0.01;
+
+  // Initiate random parameters.
+  arma::mat parameters = arma::randu(rank + 1, numUsers + numItems);
+
+  // Make a random rating dataset.
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+
+  // Manually set last row to maximum user and maximum item.
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  // Make rating entries based on the parameters.
+  for (size_t i = 0; i < numRatings; ++i)
+  {
+    const size_t user = data(0, i);
+    const size_t item = data(1, i) + numUsers;
+    const double userBias = parameters(rank, user);
+    const double itemBias = parameters(rank, item);
+    data(2, i) = userBias + itemBias +
+        arma::dot(parameters.col(user).subvec(0, rank - 1),
+                  parameters.col(item).subvec(0, rank - 1));
+  }
+
+  // Make the Bias SVD function and the optimizer.  The step size is never
+  // decayed.
+  BiasSVDFunction<arma::mat> biasSVDFunc(data, rank, lambda);
+
+  ens::ExponentialBackoff decayPolicy(100000, alpha, 1.0);
+  ens::ParallelSGD<ens::ExponentialBackoff> optimizer(0, 1, 1e-5, true,
+      decayPolicy);
+
+  // Optimize twice from the same starting point with the same seed.
+  const arma::mat startParameters = arma::randu(rank + 1,
+      numUsers + numItems);
+  arma::mat optParameters = startParameters;
+  math::RandomSeed(17);
+  optimizer.Optimize(biasSVDFunc, optParameters);
+
+  arma::mat otherParameters = startParameters;
+  math::RandomSeed(17);
+  optimizer.Optimize(biasSVDFunc, otherParameters);
+
+  REQUIRE(arma::approx_equal(optParameters, otherParameters, "absdiff",
+      1e-12));
+
+  // Get predicted ratings from optimized parameters.
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; ++i)
+  {
+    const size_t user = data(0, i);
+    const size_t item = data(1, i) + numUsers;
+    const double userBias = optParameters(rank, user);
+    const double itemBias = optParameters(rank, item);
+    predictedData(0, i) = userBias + itemBias +
+        arma::dot(optParameters.col(user).subvec(0, rank - 1),
+                  optParameters.col(item).subvec(0, rank - 1));
+  }
+
+  // Calculate relative error.
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+
+  // Relative error should be small.
+  REQUIRE(relativeError == Approx(0.0).margin(1e-2));
+}
+
 #endif
@@ -368,3 +368,40 @@ TEST_CASE("FullConvolutionBatchTest", "[ConvolutionTest]")
   ConvolutionMethodBatchTest<SVDConvolution<FullConvolution> >(input,
       filterCube, outputCube);
 }
+
+/**
+ * Make sure that the strides and dilations of the naive convolution (valid)
+ * are applied along the right dimensions when they differ.
+ */
+TEST_CASE("ValidConvolutionUnequalStrideTest", "[ConvolutionTest]")
+{
+  arma::mat input = arma::randu<arma::mat>(9, 7);
+  arma::mat filter = arma::randu<arma::mat>(3, 2);
+
+  // The strided convolution keeps every dW-th row and every dH-th column of
+  // the convolution with stride 1.
+  arma::mat output, stridedOutput;
+  NaiveConvolution<ValidConvolution>::Convolution(input, filter, output);
+  NaiveConvolution<ValidConvolution>::Convolution(input, filter,
+      stridedOutput, 3, 2);
+
+  REQUIRE(stridedOutput.n_rows == 3);
+  REQUIRE(stridedOutput.n_cols == 3);
+  for (size_t j = 0; j < stridedOutput.n_cols; ++j)
+    for (size_t i = 0; i < stridedOutput.n_rows; ++i)
+      REQUIRE(stridedOutput(i, j) ==
+          Approx(output(3 * i, 2 * j)).epsilon(1e-7));
+
+  // The dilated convolution is the convolution with the dilated filter.
+  arma::mat dilatedFilter = arma::zeros<arma::mat>(5, 4);
+  for (size_t j = 0; j < filter.n_cols; ++j)
+    for (size_t i = 0; i < filter.n_rows; ++i)
+      dilatedFilter(2 * i, 3 * j) = filter(i, j);
+
+  arma::mat dilatedOutput;
+  NaiveConvolution<ValidConvolution>::Convolution(input, dilatedFilter,
+      output);
+  NaiveConvolution<ValidConvolution>::Convolution(input, filter,
+      dilatedOutput, 1, 1, 2, 3);
+  CheckMatrices(output, dilatedOutput, 1e-5);
+}
@@ -1130,4 +1130,161 @@ BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
   }
 }
 
+/**
+ * Make sure that a query set large enough to be split into several query trees
+ * gives the same results as naive search.
+ */
+BOOST_AUTO_TEST_CASE(LargeQuerySetDualTreeTest)
+{
+  arma::mat referenceSet = arma::randn<arma::mat>(5, 2000);
+  arma::mat querySet = arma::randn<arma::mat>(5, 5000);
+
+  FastMKS<LinearKernel> naive(referenceSet, false, true);
+  FastMKS<LinearKernel> dual(referenceSet);
+
+  arma::Mat<size_t> naiveIndices, dualIndices;
+  arma::mat naiveProducts, dualProducts;
+  naive.Search(querySet, 5, naiveIndices, naiveProducts);
+
+  // Ask for four threads, so that the query set is split into four batches
+  // even on a machine with a single core.
+  #ifdef HAS_OPENMP
+    const int oldThreads = omp_get_max_threads();
+    omp_set_num_threads(4);
+  #endif
+  dual.Search(querySet, 5, dualIndices, dualProducts);
+  #ifdef HAS_OPENMP
+    omp_set_num_threads(oldThreads);
+  #endif
+
+  CheckMatrices(naiveIndices, dualIndices);
+  CheckMatrices(naiveProducts, dualProducts);
+}
+
+/**
+ * Make sure that max inner product search works on single-precision data.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionFastMKSTest)
+{
+  arma::fmat referenceSet = arma::randn<arma::fmat>(6, 1000);
+  arma::fmat querySet = arma::randn<arma::fmat>(6, 200);
+
+  // The naive search is done in double precision.
+  arma::mat doubleReferenceSet = arma::conv_to<arma::mat>::from(referenceSet);
+  arma::mat doubleQuerySet = arma::conv_to<arma::mat>::from(querySet);
+  FastMKS<LinearKernel> naive(doubleReferenceSet, false, true);
+  arma::Mat<size_t> naiveIndices;
+  arma::mat naiveProducts;
+  naive.Search(doubleQuerySet, 3, naiveIndices, naiveProducts);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    FastMKS<LinearKernel, arma::fmat> f(referenceSet, (mode == 0));
+
+    arma::Mat<size_t> indices;
+    arma::mat products;
+    f.Search(querySet, 3, indices, products);
+
+    BOOST_REQUIRE_EQUAL(indices.n_rows, 3);
+    BOOST_REQUIRE_EQUAL(indices.n_cols, 200);
+    for (size_t i = 0; i < products.n_elem; ++i)
+    {
+      // Points with nearly equal products may be swapped.
+      if (indices[i] != naiveIndices[i])
+        BOOST_REQUIRE_SMALL(products[i] - naiveProducts[i], 1e-3);
+      else
+        BOOST_REQUIRE_SMALL(products[i] - naiveProducts[i], 1e-4 *
+            std::max(1.0, std::abs(naiveProducts[i])));
+    }
+  }
+}
+
+/**
+ * Make sure that approximate search returns kernel values within the requested
+ * relative error, and that it does not do more work than exact search.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateFastMKSTest)
+{
+  arma::mat referenceSet = arma::randn<arma::mat>(4, 2000);
+  arma::mat querySet = arma::randn<arma::mat>(4, 300);
+  const double epsilon = 0.2;
+
+  FastMKS<LinearKernel> naive(referenceSet, false, true);
+  arma::Mat<size_t> naiveIndices;
+  arma::mat naiveProducts;
+  naive.Search(querySet, 5, naiveIndices, naiveProducts);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    FastMKS<LinearKernel> f(referenceSet, (mode == 0));
+    f.Epsilon() = epsilon;
+
+    arma::Mat<size_t> indices;
+    arma::mat products;
+    f.Search(querySet, 5, indices, products);
+
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      for (size_t j = 0; j < 5; ++j)
+      {
+        // Each returned product must be the product with the returned point.
+        BOOST_REQUIRE_CLOSE(products(j, q), arma::dot(querySet.col(q),
+            referenceSet.col(indices(j, q))), 1e-5);
+        if (naiveProducts(j, q) > 0.0)
+        {
+          BOOST_REQUIRE_GE(products(j, q),
+              (1.0 - epsilon) * naiveProducts(j, q) - 1e-10);
+        }
+      }
+    }
+  }
+
+  // Count the base cases of exact and approximate search, with fresh trees
+  // each time, since the traversals store bounds in the statistics.
+  typedef FastMKS<LinearKernel>::Tree TreeType;
+  typedef FastMKSRules<LinearKernel, TreeType> RuleType;
+  LinearKernel kernel;
+  IPMetric<LinearKernel> ipMetric(kernel);
+  size_t baseCases[2][2];
+  for (size_t approximate = 0; approximate < 2; ++approximate)
+  {
+    TreeType referenceTree(referenceSet, ipMetric);
+    TreeType queryTree(querySet, ipMetric);
+
+    RuleType singleRules(referenceTree.Dataset(), querySet, 5, kernel,
+        (approximate == 1) ? epsilon : 0.0);
+    TreeType::SingleTreeTraverser<RuleType> singleTraverser(singleRules);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      singleTraverser.Traverse(i, referenceTree);
+    baseCases[approximate][0] = singleRules.BaseCases();
+
+    RuleType dualRules(referenceTree.Dataset(), queryTree.Dataset(), 5, kernel,
+        (approximate == 1) ? epsilon : 0.0);
+    TreeType::DualTreeTraverser<RuleType> dualTraverser(dualRules);
+    dualTraverser.Traverse(queryTree, referenceTree);
+    baseCases[approximate][1] = dualRules.BaseCases();
+  }
+
+  BOOST_REQUIRE_LE(baseCases[1][0], baseCases[0][0]);
+  BOOST_REQUIRE_LE(baseCases[1][1], baseCases[0][1]);
+
+  // The approximation error is serialized with the model.
+  FastMKS<LinearKernel> f(referenceSet);
+  f.Epsilon() = epsilon;
+  FastMKS<LinearKernel> fXml, fText, fBinary;
+  SerializeObjectAll(f, fXml, fText, fBinary);
+  BOOST_REQUIRE_EQUAL(fXml.Epsilon(), epsilon);
+  BOOST_REQUIRE_EQUAL(fText.Epsilon(), epsilon);
+  BOOST_REQUIRE_EQUAL(fBinary.Epsilon(), epsilon);
+
+  // Invalid values must be rejected.
+  arma::Mat<size_t> indices;
+  arma::mat products;
+  f.Epsilon() = 1.0;
+  BOOST_REQUIRE_THROW(f.Search(querySet, 5, indices, products),
+      std::invalid_argument);
+  f.Epsilon() = -0.1;
+  BOOST_REQUIRE_THROW(f.Search(5, indices, products), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -15,6 +15,7 @@
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/loss_functions/mean_squared_error.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/update_rules/lazy_adam_update.hpp>
 #include <mlpack/methods/kmeans/kmeans.hpp>
 
 #include <ensmallen.hpp>
@@ -442,6 +443,266 @@ TEST_CASE("FFSerializationTest", "[FeedForwardNetworkTest]")
       binaryPredictions);
 }
 
+/**
+ * Test that a network of arma::fmat can be trained and serialized.
+ */
+TEST_CASE("FFNFloatTest", "[FeedForwardNetworkTest]")
+{
+  // Load the dataset.
+  arma::fmat trainData;
+  data::Load("thyroid_train.csv", trainData, true);
+
+  arma::fmat trainLabels = trainData.row(trainData.n_rows - 1);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  arma::fmat testData;
+  data::Load("thyroid_test.csv", testData, true);
+
+  arma::fmat testLabels = testData.row(testData.n_rows - 1);
+  testData.shed_row(testData.n_rows - 1);
+
+  typedef FFNType<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+      RandomInitialization, arma::fmat, Linear<arma::fmat, arma::fmat>,
+      SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat>,
+      LogSoftMax<arma::fmat, arma::fmat> > FloatFFN;
+
+  FloatFFN model;
+  model.Add<Linear<arma::fmat, arma::fmat> >(trainData.n_rows, 8);
+  model.Add<SigmoidLayer<LogisticFunction, arma::fmat, arma::fmat> >();
+  model.Add<Linear<arma::fmat, arma::fmat> >(8, 3);
+  model.Add<LogSoftMax<arma::fmat, arma::fmat> >();
+
+  TestNetwork<arma::fmat>(model, trainData, trainLabels, testData, testLabels,
+      10, 0.1);
+  REQUIRE(model.Parameters().n_elem == (trainData.n_rows + 1) * 8 + 9 * 3);
+
+  FloatFFN xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+  arma::fmat predictions, xmlPredictions, textPredictions, binaryPredictions;
+  model.Predict(testData, predictions);
+  xmlModel.Predict(testData, xmlPredictions);
+  textModel.Predict(testData, textPredictions);
+  binaryModel.Predict(testData, binaryPredictions);
+
+  REQUIRE(arma::approx_equal(predictions, xmlPredictions, "absdiff", 1e-5));
+  REQUIRE(arma::approx_equal(predictions, textPredictions, "absdiff", 1e-5));
+  REQUIRE(arma::approx_equal(predictions, binaryPredictions, "absdiff",
+      1e-5));
+}
+
+/**
+ * Test that a quantized network gives nearly the same predictions as the
+ * original network, and that the quantized layers are serialized.
+ */
+TEST_CASE("FFNQuantizeTest", "[FeedForwardNetworkTest]")
+{
+  // Load the dataset.
+  arma::mat trainData;
+  data::Load("thyroid_train.csv", trainData, true);
+
+  arma::mat trainLabels = trainData.row(trainData.n_rows - 1);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  arma::mat testData;
+  data::Load("thyroid_test.csv", testData, true);
+  testData.shed_row(testData.n_rows - 1);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(trainData.n_rows, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  ens::RMSProp opt(0.01, 32, 0.88, 1e-8, trainData.n_cols /* 1 epoch */, -1);
+  model.Train(trainData, trainLabels, opt);
+
+  arma::mat predictions;
+  model.Predict(testData, predictions);
+
+  REQUIRE(!model.Quantized());
+  model.Quantize(trainData);
+  REQUIRE(model.Quantized());
+
+  arma::mat quantizedPredictions;
+  model.Predict(testData, quantizedPredictions);
+
+  REQUIRE(quantizedPredictions.n_rows == predictions.n_rows);
+  REQUIRE(quantizedPredictions.n_cols == predictions.n_cols);
+  REQUIRE(arma::abs(quantizedPredictions - predictions).max() <= 0.1);
+
+  // Nearly all of the predicted classes must be the same.
+  const arma::urowvec classes = arma::index_max(predictions, 0);
+  const arma::urowvec quantizedClasses = arma::index_max(quantizedPredictions,
+      0);
+  const double agreement = arma::accu(classes == quantizedClasses) /
+      (double) classes.n_elem;
+  REQUIRE(agreement >= 0.98);
+
+  // The quantized layers are saved with the model.
+  FFN<NegativeLogLikelihood<>> xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+  REQUIRE(xmlModel.Quantized());
+  REQUIRE(textModel.Quantized());
+  REQUIRE(binaryModel.Quantized());
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlModel.Predict(testData, xmlPredictions);
+  textModel.Predict(testData, textPredictions);
+  binaryModel.Predict(testData, binaryPredictions);
+
+  CheckMatrices(quantizedPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+
+  // Training the network again discards the quantized layers.
+  model.Train(trainData, trainLabels, opt);
+  REQUIRE(!model.Quantized());
+}
+
+/**
+ * Test that the quantized version of a network with a padded and strided
+ * convolution followed by pooling gives nearly the same predictions as the
+ * original network, also after the model is loaded again.
+ */
+TEST_CASE("FFNQuantizeConvolutionTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(2 * 7 * 5, 50);
+
+  // The input maps are 7x5, padded to 8x7; with a 3x2 kernel and strides of 2
+  // and 1, the output maps are 3x6, and 2x5 after the pooling.
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Convolution<> >(2, 4, 3, 2, 2, 1, std::tuple<size_t, size_t>(1, 0),
+      std::tuple<size_t, size_t>(0, 2), 7, 5);
+  model.Add<ReLULayer<> >();
+  model.Add<MaxPooling<> >(2, 2, 1, 1);
+  model.Add<Linear<> >(4 * 2 * 5, 5);
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  model.Quantize(data);
+
+  arma::mat quantizedPredictions;
+  model.Predict(data, quantizedPredictions);
+
+  REQUIRE(quantizedPredictions.n_rows == 5);
+  REQUIRE(quantizedPredictions.n_cols == data.n_cols);
+  REQUIRE(arma::abs(quantizedPredictions - predictions).max() <=
+      0.05 * arma::abs(predictions).max());
+
+  // The loaded models must pass the map sizes on to the pooling layer.
+  FFN<NegativeLogLikelihood<>> xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+  REQUIRE(xmlModel.Quantized());
+  REQUIRE(textModel.Quantized());
+  REQUIRE(binaryModel.Quantized());
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlModel.Predict(data, xmlPredictions);
+  textModel.Predict(data, textPredictions);
+  binaryModel.Predict(data, binaryPredictions);
+
+  CheckMatrices(quantizedPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+}
+
+/**
+ * Test that the fused inference graph of a network with BatchNorm, activation
+ * and Dropout modules gives the same predictions as the original network.
+ */
+TEST_CASE("FFNFuseTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 50);
+
+  BatchNorm<>* batchNorm = new BatchNorm<>(16);
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(10, 16);
+  model.Add(batchNorm);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.2);
+  model.Add<Linear<> >(16, 8);
+  model.Add<AlphaDropout<> >(0.1);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  // Use some trained-looking statistics for the BatchNorm module.
+  arma::mat predictions;
+  model.Predict(data, predictions);
+  batchNorm->TrainingMean().randn();
+  batchNorm->TrainingVariance().randu();
+  batchNorm->TrainingVariance() += 0.5;
+  batchNorm->Parameters().randn();
+  model.Predict(data, predictions);
+
+  REQUIRE(!model.Fused());
+  model.Fuse();
+  REQUIRE(model.Fused());
+
+  arma::mat fusedPredictions;
+  model.Predict(data, fusedPredictions);
+  CheckMatrices(predictions, fusedPredictions, 1e-6);
+
+  // The fused graph is saved with the model.
+  FFN<NegativeLogLikelihood<>> xmlModel, textModel, binaryModel;
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+  REQUIRE(xmlModel.Fused());
+  REQUIRE(textModel.Fused());
+  REQUIRE(binaryModel.Fused());
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlModel.Predict(data, xmlPredictions);
+  textModel.Predict(data, textPredictions);
+  binaryModel.Predict(data, binaryPredictions);
+
+  CheckMatrices(fusedPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+
+  // Quantizing the network discards the fused graph, and the other way round.
+  model.Quantize(data);
+  REQUIRE(!model.Fused());
+  model.Fuse();
+  REQUIRE(!model.Quantized());
+
+  // Resetting the parameters discards the fused graph.
+  model.ResetParameters();
+  REQUIRE(!model.Fused());
+}
+
+/**
+ * Test that the fused inference graph of a network with a convolution on
+ * non-square inputs, with unequal strides and asymmetric padding, followed by
+ * BatchNorm gives the same predictions as the original network.
+ */
+TEST_CASE("FFNFuseConvolutionTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(2 * 7 * 5, 50);
+
+  // The input maps are 7x5, padded to 8x7; with a 3x2 kernel and strides of 2
+  // and 1, the output maps are 3x6.
+  BatchNorm<>* batchNorm = new BatchNorm<>(4);
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Convolution<> >(2, 4, 3, 2, 2, 1, std::tuple<size_t, size_t>(1, 0),
+      std::tuple<size_t, size_t>(0, 2), 7, 5);
+  model.Add(batchNorm);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(4 * 3 * 6, 5);
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+  batchNorm->TrainingMean().randn();
+  batchNorm->TrainingVariance().randu();
+  batchNorm->TrainingVariance() += 0.5;
+  batchNorm->Parameters().randn();
+  model.Predict(data, predictions);
+
+  model.Fuse();
+
+  arma::mat fusedPredictions;
+  model.Predict(data, fusedPredictions);
+  CheckMatrices(predictions, fusedPredictions, 1e-6);
+}
+
 /**
  * Test if the custom layers work. The target is to see if the code compiles
  * when the Train and Prediction are called.
@@ -475,6 +736,395 @@ TEST_CASE("CustomLayerTest", "[FeedForwardNetworkTest]")
   arma::mat prediction = arma::zeros<arma::mat>(1, predictionTemp.n_cols);
 }
 
+/**
+ * Make sure that splitting the batches across several threads gives the same
+ * objective and gradient as the serial pass, and that a network trained this
+ * way still works.
+ */
+TEST_CASE("FFNThreadsTest", "[FeedForwardNetworkTest]")
+{
+  // Load the dataset.
+  arma::mat trainData;
+  data::Load("thyroid_train.csv", trainData, true);
+
+  arma::mat trainLabels = trainData.row(trainData.n_rows - 1);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  arma::mat testData;
+  data::Load("thyroid_test.csv", testData, true);
+
+  arma::mat testLabels = testData.row(testData.n_rows - 1);
+  testData.shed_row(testData.n_rows - 1);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(trainData.n_rows, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  model.Predictors() = trainData;
+  model.Responses() = trainLabels;
+  model.ResetParameters();
+
+  FFN<NegativeLogLikelihood<> > parallelModel(model);
+  parallelModel.Threads() = 4;
+  REQUIRE(model.Threads() == 1);
+
+  // Use batches that do not split evenly, and a batch smaller than the number
+  // of threads.
+  const size_t begins[3] = { 0, 100, 200 };
+  const size_t batchSizes[3] = { 50, 3, 37 };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    arma::mat gradient, parallelGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(),
+        begins[i], gradient, batchSizes[i]);
+    const double parallelObjective = parallelModel.EvaluateWithGradient(
+        parallelModel.Parameters(), begins[i], parallelGradient,
+        batchSizes[i]);
+
+    REQUIRE(parallelObjective == Approx(objective).epsilon(1e-10));
+    CheckMatrices(gradient, parallelGradient, 1e-8);
+  }
+
+  // Train with all the available threads.
+  parallelModel.Threads() = 0;
+  TestNetwork<>(parallelModel, trainData, trainLabels, testData, testLabels,
+      10, 0.1);
+}
+
+/**
+ * Make sure that a network with a layer that keeps statistics of the batches
+ * does not split them across threads, so that it gives the same objective,
+ * gradient and running statistics as the serial pass.
+ */
+TEST_CASE("FFNThreadsBatchNormTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 64);
+  arma::mat labels = arma::randi<arma::mat>(1, 64, arma::distr_param(1, 3));
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(10, 8);
+  model.Add<BatchNorm<> >(8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+
+  model.Predictors() = data;
+  model.Responses() = labels;
+  model.ResetParameters();
+
+  FFN<NegativeLogLikelihood<> > parallelModel(model);
+  parallelModel.Threads() = 4;
+
+  for (size_t begin = 0; begin < 64; begin += 32)
+  {
+    arma::mat gradient, parallelGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(),
+        begin, gradient, 32);
+    const double parallelObjective = parallelModel.EvaluateWithGradient(
+        parallelModel.Parameters(), begin, parallelGradient, 32);
+
+    REQUIRE(parallelObjective == Approx(objective).epsilon(1e-10));
+    CheckMatrices(gradient, parallelGradient, 1e-8);
+  }
+
+  // The running statistics are those of the network itself.
+  BatchNorm<>* batchNorm = boost::get<BatchNorm<>*>(model.Model()[1]);
+  BatchNorm<>* parallelBatchNorm =
+      boost::get<BatchNorm<>*>(parallelModel.Model()[1]);
+  CheckMatrices(batchNorm->TrainingMean(), parallelBatchNorm->TrainingMean(),
+      1e-8);
+  CheckMatrices(batchNorm->TrainingVariance(),
+      parallelBatchNorm->TrainingVariance(), 1e-8);
+}
+
+/**
+ * Make sure that training from a BatchLoader gives the same network as
+ * training from the whole dataset with the same batches.
+ */
+TEST_CASE("FFNBatchLoaderTest", "[FeedForwardNetworkTest]")
+{
+  // Load the dataset.
+  arma::mat trainData;
+  data::Load("thyroid_train.csv", trainData, true);
+
+  arma::mat trainLabels = trainData.row(trainData.n_rows - 1);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  data::BatchLoader<> loader(trainData.n_cols, 32,
+      [&](const arma::Col<size_t>& indices,
+          arma::mat& predictors,
+          arma::mat& responses)
+      {
+        const arma::uvec columns = arma::conv_to<arma::uvec>::from(indices);
+        predictors = trainData.cols(columns);
+        responses = trainLabels.cols(columns);
+      }, false, 2);
+
+  FFN<NegativeLogLikelihood<> > model, loaderModel;
+  model.Add<Linear<> >(trainData.n_rows, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  loaderModel.Add<Linear<> >(trainData.n_rows, 8);
+  loaderModel.Add<SigmoidLayer<> >();
+  loaderModel.Add<Linear<> >(8, 3);
+  loaderModel.Add<LogSoftMax<> >();
+
+  // Use the same initial parameters, and three epochs without shuffling.
+  ens::StandardSGD opt(0.01, 32, 3 * trainData.n_cols, -1, false);
+  math::RandomSeed(4);
+  const double objective = model.Train(trainData, trainLabels, opt);
+  math::RandomSeed(4);
+  const double loaderObjective = loaderModel.Train(loader, opt);
+
+  REQUIRE(loaderObjective == Approx(objective).epsilon(1e-10));
+  CheckMatrices(model.Parameters(), loaderModel.Parameters());
+
+  // A batch size that does not match the loader is an error, and the network
+  // must not keep using the loader afterwards.
+  ens::StandardSGD smallBatchOpt(0.01, 16, trainData.n_cols, -1, false);
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(loaderModel.Train(loader, smallBatchOpt),
+      std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+  REQUIRE(std::isfinite(loaderModel.Train(trainData, trainLabels,
+      smallBatchOpt)));
+}
+
+/**
+ * Make sure that checkpointing gives the same objective and gradient as the
+ * normal training pass, while holding fewer module outputs.
+ */
+TEST_CASE("FFNCheckpointTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 64);
+  arma::mat labels = arma::randi<arma::mat>(1, 64, arma::distr_param(1, 3));
+
+  FFN<NegativeLogLikelihood<> > model, checkpointModel;
+  model.Add<Linear<> >(10, 20);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(20, 20);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(20, 20);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(20, 3);
+  model.Add<LogSoftMax<> >();
+  checkpointModel.Add<Linear<> >(10, 20);
+  checkpointModel.Add<SigmoidLayer<> >();
+  checkpointModel.Add<Linear<> >(20, 20);
+  checkpointModel.Add<ReLULayer<> >();
+  checkpointModel.Add<Dropout<> >(0.3);
+  checkpointModel.Add<Linear<> >(20, 20);
+  checkpointModel.Add<TanHLayer<> >();
+  checkpointModel.Add<Linear<> >(20, 3);
+  checkpointModel.Add<LogSoftMax<> >();
+
+  model.Predictors() = data;
+  model.Responses() = labels;
+  model.ResetParameters();
+  checkpointModel.Predictors() = data;
+  checkpointModel.Responses() = labels;
+  checkpointModel.ResetParameters();
+  checkpointModel.Parameters() = model.Parameters();
+
+  // The outputs of the Linear and Dropout layers are always kept, so the
+  // outputs of the modules 1, 3 and 6 are recomputed.
+  checkpointModel.Checkpoints() = { 2 };
+
+  // The first pass also sets up the network, so check two passes.
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    arma::mat gradient, checkpointGradient;
+    math::RandomSeed(7);
+    const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+        gradient, 64);
+    math::RandomSeed(7);
+    const double checkpointObjective = checkpointModel.EvaluateWithGradient(
+        checkpointModel.Parameters(), 0, checkpointGradient, 64);
+
+    REQUIRE(checkpointObjective == Approx(objective).epsilon(1e-10));
+    CheckMatrices(gradient, checkpointGradient, 1e-8);
+  }
+
+  REQUIRE(checkpointModel.ActivationMemory() < model.ActivationMemory());
+  REQUIRE(model.RecomputationTime() == 0.0);
+  REQUIRE(checkpointModel.RecomputationTime() > 0.0);
+}
+
+/**
+ * Make sure that a stochastic Reparametrization layer does not draw a new
+ * sample when the outputs are recomputed, so that the gradient still matches
+ * the gradient without checkpoints.
+ */
+TEST_CASE("FFNCheckpointReparametrizationTest", "[FeedForwardNetworkTest]")
+{
+  arma::mat data = arma::randu<arma::mat>(10, 64);
+  arma::mat labels = arma::randi<arma::mat>(1, 64, arma::distr_param(1, 3));
+
+  FFN<NegativeLogLikelihood<> > model, checkpointModel;
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Reparametrization<> >(4);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(4, 3);
+  model.Add<LogSoftMax<> >();
+  checkpointModel.Add<Linear<> >(10, 8);
+  checkpointModel.Add<SigmoidLayer<> >();
+  checkpointModel.Add<Reparametrization<> >(4);
+  checkpointModel.Add<TanHLayer<> >();
+  checkpointModel.Add<Linear<> >(4, 3);
+  checkpointModel.Add<LogSoftMax<> >();
+
+  model.Predictors() = data;
+  model.Responses() = labels;
+  model.ResetParameters();
+  checkpointModel.Predictors() = data;
+  checkpointModel.Responses() = labels;
+  checkpointModel.ResetParameters();
+  checkpointModel.Parameters() = model.Parameters();
+
+  // Only the outputs of the Sigmoid and TanH layers are recomputed.
+  checkpointModel.Checkpoints() = { 0 };
+
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    arma::mat gradient, checkpointGradient;
+    math::RandomSeed(7);
+    const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+        gradient, 64);
+    math::RandomSeed(7);
+    const double checkpointObjective = checkpointModel.EvaluateWithGradient(
+        checkpointModel.Parameters(), 0, checkpointGradient, 64);
+
+    REQUIRE(checkpointObjective == Approx(objective).epsilon(1e-10));
+    CheckMatrices(gradient, checkpointGradient, 1e-8);
+  }
+
+  REQUIRE(checkpointModel.ActivationMemory() < model.ActivationMemory());
+}
+
+/**
+ * Make sure that the sparse gradient of a network with a Lookup layer is the
+ * same as the dense gradient, while only holding the embeddings of the tokens
+ * in the batch, and that training with it gives the same network.
+ */
+TEST_CASE("FFNSparseGradientTest", "[FeedForwardNetworkTest]")
+{
+  const size_t vocabSize = 500;
+  const size_t embeddingSize = 6;
+  const size_t seqLength = 4;
+
+  // Each point only uses the first tokens of the vocabulary.
+  arma::mat data = arma::randi<arma::mat>(seqLength, 64,
+      arma::distr_param(1, 40));
+  arma::mat labels = arma::randi<arma::mat>(1, 64, arma::distr_param(1, 3));
+
+  FFN<NegativeLogLikelihood<> > model, sparseModel;
+  model.Add<Lookup<> >(vocabSize, embeddingSize);
+  model.Add<Linear<> >(embeddingSize * seqLength, 3);
+  model.Add<LogSoftMax<> >();
+  sparseModel.Add<Lookup<> >(vocabSize, embeddingSize);
+  sparseModel.Add<Linear<> >(embeddingSize * seqLength, 3);
+  sparseModel.Add<LogSoftMax<> >();
+
+  model.Predictors() = data;
+  model.Responses() = labels;
+  model.ResetParameters();
+  sparseModel.Predictors() = data;
+  sparseModel.Responses() = labels;
+  sparseModel.ResetParameters();
+  sparseModel.Parameters() = model.Parameters();
+
+  // Check several batches, since the buffer of the sparse gradient is reused.
+  for (size_t begin = 0; begin < 64; begin += 16)
+  {
+    arma::mat gradient;
+    arma::sp_mat sparseGradient;
+    const double objective = model.EvaluateWithGradient(model.Parameters(),
+        begin, gradient, 16);
+    const double sparseObjective = sparseModel.EvaluateWithGradient(
+        sparseModel.Parameters(), begin, sparseGradient, 16);
+
+    REQUIRE(sparseObjective == Approx(objective).epsilon(1e-10));
+    REQUIRE(sparseGradient.n_rows == gradient.n_rows);
+    REQUIRE(sparseGradient.n_cols == gradient.n_cols);
+    REQUIRE(sparseGradient.n_nonzero <= 40 * embeddingSize +
+        (embeddingSize * seqLength + 1) * 3);
+    CheckMatrices(gradient, arma::mat(sparseGradient), 1e-8);
+  }
+
+  // Train both networks with the same batches.
+  ens::StandardSGD opt(0.01, 16, 2 * data.n_cols, -1, false);
+  const double objective = model.Train(data, labels, opt);
+  const double sparseObjective = sparseModel.Train<ens::StandardSGD,
+      arma::sp_mat>(data, labels, opt);
+
+  REQUIRE(sparseObjective == Approx(objective).epsilon(1e-8));
+  CheckMatrices(model.Parameters(), sparseModel.Parameters(), 1e-6);
+}
+
+/**
+ * Make sure that lazy Adam on the sparse gradient trains the embeddings of the
+ * tokens that are in every batch, and the other layers, like Adam on the dense
+ * gradient, and leaves the other embeddings alone.
+ */
+TEST_CASE("FFNLazyAdamTest", "[FeedForwardNetworkTest]")
+{
+  const size_t vocabSize = 500;
+  const size_t embeddingSize = 6;
+  const size_t seqLength = 4;
+  const size_t usedTokens = 10;
+
+  // Every batch of 16 points uses each of the first tokens.
+  arma::mat data(seqLength, 64);
+  for (size_t j = 0; j < data.n_cols; ++j)
+  {
+    for (size_t i = 0; i < seqLength; ++i)
+      data(i, j) = (i * 16 + j) % usedTokens + 1;
+  }
+  arma::mat labels = arma::randi<arma::mat>(1, 64, arma::distr_param(1, 3));
+
+  FFN<NegativeLogLikelihood<> > model, lazyModel;
+  model.Add<Lookup<> >(vocabSize, embeddingSize);
+  model.Add<Linear<> >(embeddingSize * seqLength, 3);
+  model.Add<LogSoftMax<> >();
+  lazyModel.Add<Lookup<> >(vocabSize, embeddingSize);
+  lazyModel.Add<Linear<> >(embeddingSize * seqLength, 3);
+  lazyModel.Add<LogSoftMax<> >();
+
+  // A first pass sets up the networks, so that training keeps the parameters.
+  arma::mat output;
+  model.Predict(data, output);
+  lazyModel.Predict(data, output);
+  lazyModel.Parameters() = model.Parameters();
+  const arma::mat initialParameters = model.Parameters();
+
+  ens::Adam adam(0.01, 16, 0.9, 0.999, 1e-8, 2 * data.n_cols, -1, false);
+  ens::AdamType<LazyAdamUpdate> lazyAdam(0.01, 16, 0.9, 0.999, 1e-8,
+      2 * data.n_cols, -1, false);
+  model.Train(data, labels, adam);
+  lazyModel.Train<ens::AdamType<LazyAdamUpdate>, arma::sp_mat>(data, labels,
+      lazyAdam);
+
+  // The embeddings of the used tokens and the parameters of the other layers
+  // are trained the same way.
+  const size_t usedEntries = usedTokens * embeddingSize;
+  const size_t embeddingEntries = vocabSize * embeddingSize;
+  CheckMatrices(model.Parameters().rows(0, usedEntries - 1),
+      lazyModel.Parameters().rows(0, usedEntries - 1), 1e-6);
+  CheckMatrices(model.Parameters().rows(embeddingEntries,
+      model.Parameters().n_elem - 1), lazyModel.Parameters().rows(
+      embeddingEntries, model.Parameters().n_elem - 1), 1e-6);
+  REQUIRE(arma::norm(model.Parameters() - initialParameters) > 0.0);
+
+  // The other embeddings never had a gradient.
+  CheckMatrices(lazyModel.Parameters().rows(usedEntries, embeddingEntries - 1),
+      initialParameters.rows(usedEntries, embeddingEntries - 1));
+}
+
 /**
  * Test the overload of Forward function which allows partial forward pass.
  */
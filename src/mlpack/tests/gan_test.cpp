@@ -348,4 +348,125 @@ BOOST_AUTO_TEST_CASE(GANMemorySharingTest)
       trainData);
 }
 
+/*
+ * Make sure that evaluating the real and the generated samples in parallel
+ * gives the same objective and gradient as the sequential evaluation.
+ */
+BOOST_AUTO_TEST_CASE(GANParallelTest)
+{
+  size_t batchSize = 8;
+  size_t noiseDim = 2;
+
+  arma::mat trainData(1, 100);
+  trainData.imbue( [&]() { return arma::as_scalar(RandNormal(4, 0.5));});
+
+  // Create the Discriminator network.
+  FFN<SigmoidCrossEntropyError<> > discriminator;
+  discriminator.Add<Linear<> >(1, 16);
+  discriminator.Add<ReLULayer<> >();
+  discriminator.Add<Linear<> >(16, 1);
+
+  // Create the Generator network.
+  FFN<SigmoidCrossEntropyError<> > generator;
+  generator.Add<Linear<> >(noiseDim, 8);
+  generator.Add<SoftPlusLayer<> >();
+  generator.Add<Linear<> >(8, 1);
+
+  GaussianInitialization gaussian(0, 0.1);
+  std::function<double ()> noiseFunction = [](){ return math::Random(-8, 8) +
+      math::RandNormal(0, 1) * 0.01;};
+  GAN<FFN<SigmoidCrossEntropyError<> >,
+      GaussianInitialization,
+      std::function<double()> >
+  gan(generator, discriminator, gaussian, noiseFunction, noiseDim, batchSize,
+      1, 0, 1);
+  GAN<FFN<SigmoidCrossEntropyError<> >,
+      GaussianInitialization,
+      std::function<double()> >
+  parallelGan(generator, discriminator, gaussian, noiseFunction, noiseDim,
+      batchSize, 1, 0, 1);
+
+  gan.ResetData(trainData);
+  parallelGan.ResetData(trainData);
+  parallelGan.Parameters() = gan.Parameters();
+
+  BOOST_REQUIRE(!parallelGan.Parallel());
+  parallelGan.Parallel() = true;
+
+  // The second pass uses the existing copy of the Discriminator layers.
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat gradient, parallelGradient;
+    math::RandomSeed(3);
+    const double objective = gan.EvaluateWithGradient(gan.Parameters(),
+        8 * i, gradient, batchSize);
+    math::RandomSeed(3);
+    const double parallelObjective = parallelGan.EvaluateWithGradient(
+        parallelGan.Parameters(), 8 * i, parallelGradient, batchSize);
+
+    BOOST_REQUIRE_CLOSE(objective, parallelObjective, 1e-8);
+    CheckMatrices(gradient, parallelGradient, 1e-8);
+  }
+}
+
+/*
+ * Make sure that a noise function filling the whole noise matrix gives the
+ * same result as the noise function called for each element.
+ */
+BOOST_AUTO_TEST_CASE(GANBatchNoiseTest)
+{
+  size_t batchSize = 8;
+  size_t noiseDim = 4;
+
+  arma::mat trainData(1, 100);
+  trainData.imbue( [&]() { return arma::as_scalar(RandNormal(4, 0.5));});
+
+  // Create the Discriminator network.
+  FFN<SigmoidCrossEntropyError<> > discriminator;
+  discriminator.Add<Linear<> >(1, 16);
+  discriminator.Add<ReLULayer<> >();
+  discriminator.Add<Linear<> >(16, 1);
+
+  // Create the Generator network.
+  FFN<SigmoidCrossEntropyError<> > generator;
+  generator.Add<Linear<> >(noiseDim, 8);
+  generator.Add<SoftPlusLayer<> >();
+  generator.Add<Linear<> >(8, 1);
+
+  GaussianInitialization gaussian(0, 0.1);
+  std::function<double ()> noiseFunction = [](){ return math::Random(-8, 8) +
+      math::RandNormal(0, 1) * 0.01;};
+  std::function<void (arma::mat&)> batchNoiseFunction =
+      [&](arma::mat& noise) { noise.imbue(noiseFunction); };
+
+  GAN<FFN<SigmoidCrossEntropyError<> >,
+      GaussianInitialization,
+      std::function<double()> >
+  gan(generator, discriminator, gaussian, noiseFunction, noiseDim, batchSize,
+      1, 0, 1);
+  GAN<FFN<SigmoidCrossEntropyError<> >,
+      GaussianInitialization,
+      std::function<void(arma::mat&)> >
+  batchGan(generator, discriminator, gaussian, batchNoiseFunction, noiseDim,
+      batchSize, 1, 0, 1);
+
+  gan.ResetData(trainData);
+  batchGan.ResetData(trainData);
+  batchGan.Parameters() = gan.Parameters();
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat gradient, batchGradient;
+    math::RandomSeed(5);
+    const double objective = gan.EvaluateWithGradient(gan.Parameters(),
+        8 * i, gradient, batchSize);
+    math::RandomSeed(5);
+    const double batchObjective = batchGan.EvaluateWithGradient(
+        batchGan.Parameters(), 8 * i, batchGradient, batchSize);
+
+    BOOST_REQUIRE_CLOSE(objective, batchObjective, 1e-8);
+    CheckMatrices(gradient, batchGradient, 1e-8);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,185 @@
+/**
+ * @file tests/hnsw_test.cpp
+ *
+ * Tests for the HNSWSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/metrics/ip_metric.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
+#include <mlpack/methods/hnsw/hnsw_search.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include "serialization_catch.hpp"
+#include "test_catch_tools.hpp"
+#include "catch.hpp"
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::metric;
+
+/**
+ * Make sure that HNSW search finds almost all of the true nearest neighbors on
+ * a simple dataset, and that the distances it returns are correct.
+ */
+TEST_CASE("HNSWRecallTest", "[HNSWTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(10, 2000);
+  arma::mat querySet = arma::randu<arma::mat>(10, 200);
+
+  KNN knn(referenceSet);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(querySet, 10, trueNeighbors, trueDistances);
+
+  HNSWSearch<> hnsw(referenceSet, 16, 100, 100);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(querySet, 10, neighbors, distances);
+
+  REQUIRE(neighbors.n_rows == 10);
+  REQUIRE(neighbors.n_cols == 200);
+  REQUIRE(HNSWSearch<>::ComputeRecall(neighbors, trueNeighbors) >= 0.95);
+
+  // The distances must be sorted, and must be the distances to the returned
+  // points.
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      REQUIRE(distances(j, i) == Approx(EuclideanDistance::Evaluate(
+          querySet.col(i), referenceSet.col(neighbors(j, i)))).epsilon(1e-7));
+      if (j > 0)
+        REQUIRE(distances(j, i) >= distances(j - 1, i));
+    }
+  }
+
+  // The search must not have computed all the distances.
+  REQUIRE(hnsw.DistanceEvaluations() < querySet.n_cols * referenceSet.n_cols);
+}
+
+/**
+ * Make sure that the number of links of each point is bounded, and that the
+ * links are on levels the linked points belong to.
+ */
+TEST_CASE("HNSWLinksTest", "[HNSWTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 1000);
+  HNSWSearch<> hnsw(referenceSet, 8, 50);
+
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    const std::vector<size_t>& bottomLinks = hnsw.Links(i, 0);
+    REQUIRE(bottomLinks.size() <= 16);
+    REQUIRE(bottomLinks.size() > 0);
+    for (size_t j = 0; j < bottomLinks.size(); ++j)
+    {
+      REQUIRE(bottomLinks[j] < referenceSet.n_cols);
+      REQUIRE(bottomLinks[j] != i);
+    }
+  }
+}
+
+/**
+ * Make sure that monochromatic search does not return the query point itself.
+ */
+TEST_CASE("HNSWMonochromaticTest", "[HNSWTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 500);
+
+  KNN knn(referenceSet);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(5, trueNeighbors, trueDistances);
+
+  HNSWSearch<> hnsw(referenceSet);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(5, neighbors, distances);
+
+  REQUIRE(neighbors.n_rows == 5);
+  REQUIRE(neighbors.n_cols == 500);
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+      REQUIRE(neighbors(j, i) != i);
+
+  REQUIRE(HNSWSearch<>::ComputeRecall(neighbors, trueNeighbors) >= 0.95);
+}
+
+/**
+ * Make sure that HNSW search works with the metric induced by a kernel.
+ */
+TEST_CASE("HNSWIPMetricTest", "[HNSWTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(6, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(6, 50);
+
+  KNN knn(referenceSet);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(querySet, 3, trueNeighbors, trueDistances);
+
+  // The linear kernel induces the Euclidean distance.
+  HNSWSearch<IPMetric<kernel::LinearKernel>> hnsw(referenceSet);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(querySet, 3, neighbors, distances);
+
+  REQUIRE(HNSWSearch<>::ComputeRecall(neighbors, trueNeighbors) >= 0.95);
+}
+
+/**
+ * Make sure that invalid parameters are rejected.
+ */
+TEST_CASE("HNSWInvalidParametersTest", "[HNSWTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 100);
+
+  REQUIRE_THROWS_AS(HNSWSearch<>(referenceSet, 1), std::invalid_argument);
+
+  HNSWSearch<> hnsw(referenceSet);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  REQUIRE_THROWS_AS(hnsw.Search(referenceSet, 101, neighbors, distances),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(hnsw.Search(100, neighbors, distances),
+      std::invalid_argument);
+
+  arma::mat querySet = arma::randu<arma::mat>(4, 10);
+  REQUIRE_THROWS_AS(hnsw.Search(querySet, 3, neighbors, distances),
+      std::invalid_argument);
+
+  HNSWSearch<> empty;
+  REQUIRE_THROWS_AS(empty.Search(referenceSet, 1, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a serialized model gives the same results.
+ */
+TEST_CASE("HNSWSerializationTest", "[HNSWTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 50);
+
+  HNSWSearch<> hnsw(referenceSet, 10, 60, 40);
+  HNSWSearch<> xmlHnsw, textHnsw, binaryHnsw;
+  SerializeObjectAll(hnsw, xmlHnsw, textHnsw, binaryHnsw);
+
+  arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat distances, xmlDistances, textDistances, binaryDistances;
+  hnsw.Search(querySet, 5, neighbors, distances);
+  xmlHnsw.Search(querySet, 5, xmlNeighbors, xmlDistances);
+  textHnsw.Search(querySet, 5, textNeighbors, textDistances);
+  binaryHnsw.Search(querySet, 5, binaryNeighbors, binaryDistances);
+
+  REQUIRE(xmlHnsw.MaxNeighbors() == 10);
+  REQUIRE(textHnsw.EfConstruction() == 60);
+  REQUIRE(binaryHnsw.Ef() == 40);
+
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+}
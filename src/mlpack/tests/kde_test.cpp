@@ -343,6 +343,48 @@ BOOST_AUTO_TEST_CASE(BallTreeGaussianKDETest)
   delete referenceTree;
 }
 
+/**
+ * Make sure that a query tree can be reused for several evaluations.
+ */
+BOOST_AUTO_TEST_CASE(ReusedQueryTreeKDETest)
+{
+  arma::mat reference = arma::randu(2, 300);
+  arma::mat query = arma::randu(2, 100);
+  arma::vec bfEstimations = arma::vec(query.n_cols, arma::fill::zeros);
+  const double kernelBandwidth = 0.3;
+  const double relError = 0.05;
+
+  // Brute force KDE.
+  EpanechnikovKernel kernel(kernelBandwidth);
+  BruteForceKDE<EpanechnikovKernel>(reference,
+                                    query,
+                                    bfEstimations,
+                                    kernel);
+
+  typedef KDTree<EuclideanDistance, kde::KDEStat, arma::mat> Tree;
+  std::vector<size_t> oldFromNewQueries;
+  Tree* queryTree = new Tree(query, oldFromNewQueries, 2);
+  KDE<EpanechnikovKernel,
+      EuclideanDistance,
+      arma::mat,
+      KDTree>
+      kde(relError, 0.0, EpanechnikovKernel(kernelBandwidth));
+  kde.Train(reference);
+
+  // The error tolerance left in the tree by one evaluation must not be used
+  // by the next one.
+  for (size_t trial = 0; trial < 3; ++trial)
+  {
+    arma::vec treeEstimations;
+    kde.Evaluate(queryTree, oldFromNewQueries, treeEstimations);
+
+    for (size_t i = 0; i < query.n_cols; ++i)
+      BOOST_REQUIRE_CLOSE(bfEstimations[i], treeEstimations[i], relError * 100);
+  }
+
+  delete queryTree;
+}
+
 /**
  * Test Octree dual-tree implementation results against brute force results.
  */
@@ -20,6 +20,7 @@
 #include <mlpack/core/kernels/spherical_kernel.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
 #include <mlpack/core/kernels/cauchy_kernel.hpp>
+#include <mlpack/core/kernels/pairwise_kernels.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -632,3 +633,40 @@ TEST_CASE("CauchyKernelTest", "[KernelTest]")
   REQUIRE(ck.Evaluate(a, b) == Approx(0.92592588).epsilon(1e-7));
   REQUIRE(ck.Evaluate(b, a) == Approx(0.92592588).epsilon(1e-7));
 }
+
+/**
+ * Make sure that PairwiseKernels() agrees with evaluating the kernel on each
+ * pair of points.
+ */
+template<typename KernelType>
+void CheckPairwiseKernels(KernelType& kernel)
+{
+  arma::mat a = arma::randu<arma::mat>(6, 25);
+  arma::mat b = arma::randu<arma::mat>(6, 15);
+  const arma::uvec aIndices = arma::randperm<arma::uvec>(25, 10);
+  const arma::uvec bIndices = arma::randperm<arma::uvec>(15, 7);
+
+  arma::mat kernels;
+  PairwiseKernels(kernel, a, aIndices, b, bIndices, kernels);
+
+  REQUIRE(kernels.n_rows == aIndices.n_elem);
+  REQUIRE(kernels.n_cols == bIndices.n_elem);
+  for (size_t i = 0; i < aIndices.n_elem; ++i)
+  {
+    for (size_t j = 0; j < bIndices.n_elem; ++j)
+    {
+      REQUIRE(kernels(i, j) == Approx(kernel.Evaluate(a.col(aIndices[i]),
+          b.col(bIndices[j]))).epsilon(1e-10));
+    }
+  }
+}
+
+TEST_CASE("PairwiseKernelsTest", "[KernelTest]")
+{
+  LinearKernel linear;
+  CheckPairwiseKernels(linear);
+  PolynomialKernel polynomial(3.0, 1.5);
+  CheckPairwiseKernels(polynomial);
+  GaussianKernel gaussian(0.8);
+  CheckPairwiseKernels(gaussian);
+}
@@ -14,6 +14,7 @@
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
+#include "serialization_catch.hpp"
 #include "test_catch_tools.hpp"
 #include "catch.hpp"
 
@@ -1814,3 +1815,429 @@ TEST_CASE("KNNSpillTreeSearchEnoughResults", "[KNNTest]")
   REQUIRE(arma::accu(distancesGreedy < 0.0 || distancesGreedy > std::sqrt(3.0))
       == 0);
 }
+
+/**
+ * Search with single-precision data using the given tree type and search mode,
+ * and make sure the distances match those of a double-precision naive search.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckSinglePrecisionSearch(const NeighborSearchMode mode)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 100);
+
+  KNN naive(dataset, NAIVE_MODE);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  naive.Search(querySet, 5, trueNeighbors, trueDistances);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::fmat, TreeType>
+      search(arma::conv_to<arma::fmat>::from(dataset), mode);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  search.Search(arma::conv_to<arma::fmat>::from(querySet), 5, neighbors,
+      distances);
+
+  REQUIRE(neighbors.n_rows == 5);
+  REQUIRE(neighbors.n_cols == 100);
+  REQUIRE(distances.n_rows == 5);
+  REQUIRE(distances.n_cols == 100);
+
+  // The neighbors may be ordered differently when two distances are equal in
+  // single precision, so only the distances are compared.
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    REQUIRE(distances[i] == Approx(trueDistances[i]).epsilon(1e-5));
+}
+
+/**
+ * Make sure that kd-trees, ball trees, cover trees and R trees can be used
+ * with single-precision data.
+ */
+TEST_CASE("KNNSinglePrecisionTest", "[KNNTest]")
+{
+  const NeighborSearchMode modes[] = { SINGLE_TREE_MODE, DUAL_TREE_MODE };
+  for (size_t m = 0; m < 2; ++m)
+  {
+    CheckSinglePrecisionSearch<KDTree>(modes[m]);
+    CheckSinglePrecisionSearch<BallTree>(modes[m]);
+    CheckSinglePrecisionSearch<StandardCoverTree>(modes[m]);
+    CheckSinglePrecisionSearch<RTree>(modes[m]);
+  }
+}
+
+/**
+ * Make sure that an NSModel holding its reference set in single precision
+ * gives the same results as one holding it in double precision.
+ */
+TEST_CASE("KNNModelSinglePrecisionTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat dataset = arma::randu<arma::mat>(10, 200);
+  arma::mat querySet = arma::randu<arma::mat>(10, 50);
+
+  const KNNModel::TreeTypes treeTypes[] = { KNNModel::KD_TREE,
+      KNNModel::BALL_TREE, KNNModel::COVER_TREE, KNNModel::R_TREE };
+  for (size_t t = 0; t < 4; ++t)
+  {
+    KNNModel model(treeTypes[t]);
+    arma::mat referenceCopy(dataset);
+    model.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+    KNNModel floatModel(treeTypes[t], false, true);
+    referenceCopy = dataset;
+    floatModel.BuildModel(std::move(referenceCopy), 20, DUAL_TREE_MODE);
+
+    REQUIRE(floatModel.DatasetSize().n_rows == 10);
+    REQUIRE(floatModel.DatasetSize().n_cols == 200);
+    REQUIRE_THROWS_AS(floatModel.Dataset(), std::invalid_argument);
+
+    arma::Mat<size_t> neighbors, floatNeighbors;
+    arma::mat distances, floatDistances;
+
+    // Bichromatic search.
+    arma::mat queryCopy(querySet);
+    model.Search(std::move(queryCopy), 3, neighbors, distances);
+    queryCopy = querySet;
+    floatModel.Search(std::move(queryCopy), 3, floatNeighbors,
+        floatDistances);
+
+    REQUIRE(floatDistances.n_rows == distances.n_rows);
+    REQUIRE(floatDistances.n_cols == distances.n_cols);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      REQUIRE(floatDistances[i] == Approx(distances[i]).epsilon(1e-5));
+
+    // Monochromatic search, in single-tree mode.
+    floatModel.SearchMode() = SINGLE_TREE_MODE;
+    model.Search(3, neighbors, distances);
+    floatModel.Search(3, floatNeighbors, floatDistances);
+
+    REQUIRE(floatDistances.n_rows == distances.n_rows);
+    REQUIRE(floatDistances.n_cols == distances.n_cols);
+    for (size_t i = 0; i < distances.n_elem; ++i)
+      REQUIRE(floatDistances[i] == Approx(distances[i]).epsilon(1e-5));
+  }
+
+  // Single precision is not available for the other tree types.
+  KNNModel model(KNNModel::VP_TREE, false, true);
+  REQUIRE_THROWS_AS(model.BuildModel(arma::mat(dataset), 20, DUAL_TREE_MODE),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that an NSModel holding its reference set in single precision
+ * gives the same results after serialization.
+ */
+TEST_CASE("KNNModelSinglePrecisionSerializationTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat dataset = arma::randu<arma::mat>(10, 200);
+  arma::mat querySet = arma::randu<arma::mat>(10, 50);
+
+  const KNNModel::TreeTypes treeTypes[] = { KNNModel::KD_TREE,
+      KNNModel::BALL_TREE, KNNModel::COVER_TREE, KNNModel::R_TREE };
+  for (size_t t = 0; t < 4; ++t)
+  {
+    KNNModel model(treeTypes[t], false, true);
+    model.BuildModel(arma::mat(dataset), 20, DUAL_TREE_MODE);
+
+    KNNModel xmlModel, textModel, binaryModel;
+    SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+    REQUIRE(xmlModel.SinglePrecision() == true);
+    REQUIRE(textModel.SinglePrecision() == true);
+    REQUIRE(binaryModel.SinglePrecision() == true);
+    REQUIRE(binaryModel.TreeType() == treeTypes[t]);
+    REQUIRE(binaryModel.DatasetSize().n_cols == 200);
+
+    arma::Mat<size_t> neighbors, xmlNeighbors, textNeighbors,
+        binaryNeighbors;
+    arma::mat distances, xmlDistances, textDistances, binaryDistances;
+    model.Search(arma::mat(querySet), 3, neighbors, distances);
+    xmlModel.Search(arma::mat(querySet), 3, xmlNeighbors, xmlDistances);
+    textModel.Search(arma::mat(querySet), 3, textNeighbors, textDistances);
+    binaryModel.Search(arma::mat(querySet), 3, binaryNeighbors,
+        binaryDistances);
+
+    CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+    CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+  }
+}
+
+/**
+ * Make sure that single-tree search, which searches the query points in
+ * parallel batches, gives the same results as naive search, both for
+ * monochromatic and bichromatic search.  The query set is large enough that it
+ * is split into several batches.
+ */
+TEST_CASE("KNNBatchedSingleTreeTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(5, 5000);
+
+  KNN naive(dataset, NAIVE_MODE);
+  KNN singleTree(dataset, SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, neighbors;
+  arma::mat naiveDistances, distances;
+
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+  singleTree.Search(querySet, 5, neighbors, distances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+  REQUIRE(singleTree.Scores() > 0);
+  REQUIRE(singleTree.BaseCases() > 0);
+
+  // Now monochromatic search, with a ball tree.
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, BallTree>
+      naiveBall(querySet, NAIVE_MODE);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, BallTree>
+      singleBall(querySet, SINGLE_TREE_MODE);
+
+  naiveBall.Search(5, naiveNeighbors, naiveDistances);
+  singleBall.Search(5, neighbors, distances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Make sure that greedy single-tree search, which searches the query points in
+ * parallel batches, gives the same results as one serial traversal for all the
+ * query points.
+ */
+TEST_CASE("KNNBatchedGreedyTreeTest", "[KNNTest]")
+{
+  typedef KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance,
+      TreeType> RuleType;
+
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(5, 5000);
+
+  // Build the tree ourselves, so that the results are in terms of the
+  // rearranged dataset in both cases.
+  TreeType tree(dataset, 5);
+
+  EuclideanDistance metric;
+  RuleType rules(tree.Dataset(), querySet, 3, metric, 0.0, false);
+  tree::GreedySingleTreeTraverser<TreeType, RuleType> traverser(rules);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+    traverser.Traverse(i, tree);
+
+  arma::Mat<size_t> serialNeighbors, neighbors;
+  arma::mat serialDistances, distances;
+  rules.GetResults(serialNeighbors, serialDistances);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, KDTree>
+      greedy(std::move(tree), GREEDY_SINGLE_TREE_MODE);
+  greedy.Search(querySet, 3, neighbors, distances);
+
+  CheckMatrices(neighbors, serialNeighbors);
+  CheckMatrices(distances, serialDistances);
+  REQUIRE(greedy.Scores() == rules.Scores());
+}
+
+/**
+ * Make sure that compacted trees give the same results as the trees they were
+ * made from, in both layouts.
+ */
+TEST_CASE("KNNCompactTreeTest", "[KNNTest]")
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      KDTree> KNNType;
+  typedef KNNType::Tree TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(4, 1000);
+  arma::mat querySet = arma::randu<arma::mat>(4, 300);
+
+  TreeType referenceTree(dataset, 10);
+  TreeType queryTree(querySet, 10);
+
+  KNNType knn(referenceTree);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(queryTree, 5, neighbors, distances);
+
+  const NodeLayout layouts[] = { BREADTH_FIRST_LAYOUT, VAN_EMDE_BOAS_LAYOUT };
+  for (size_t i = 0; i < 2; ++i)
+  {
+    TreeType compactReferenceTree(referenceTree);
+    TreeType compactQueryTree(queryTree);
+    compactReferenceTree.Compact(layouts[i]);
+    compactQueryTree.Compact(layouts[i]);
+
+    KNNType compactKnn(std::move(compactReferenceTree));
+    arma::Mat<size_t> compactNeighbors;
+    arma::mat compactDistances;
+    compactKnn.Search(compactQueryTree, 5, compactNeighbors, compactDistances);
+
+    CheckMatrices(neighbors, compactNeighbors);
+    CheckMatrices(distances, compactDistances);
+    REQUIRE(compactKnn.BaseCases() == knn.BaseCases());
+
+    // Single-tree search uses the compacted reference tree too.
+    compactKnn.SearchMode() = SINGLE_TREE_MODE;
+    compactKnn.Search(compactQueryTree.Dataset(), 5, compactNeighbors,
+        compactDistances);
+    CheckMatrices(neighbors, compactNeighbors);
+    CheckMatrices(distances, compactDistances);
+  }
+}
+
+/**
+ * Make sure that points inserted into and removed from an R* tree-based
+ * NeighborSearch object give the same results as a rebuilt model, and that the
+ * IDs of the points do not change.
+ */
+TEST_CASE("KNNInsertRemoveTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 300);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, RStarTree>
+      knn(dataset.cols(0, 99));
+
+  // Insert the rest of the points in two batches.
+  arma::Col<size_t> ids1 = knn.Insert(dataset.cols(100, 149));
+  arma::Col<size_t> ids2 = knn.Insert(dataset.cols(150, 299));
+  REQUIRE(ids1.n_elem == 50);
+  REQUIRE(ids2.n_elem == 150);
+
+  // Remove every third point.
+  std::vector<size_t> kept;
+  std::vector<size_t> removed;
+  arma::Col<size_t> ids = arma::join_cols(arma::regspace<arma::Col<size_t>>(
+      0, 99), arma::join_cols(ids1, ids2));
+  for (size_t i = 0; i < ids.n_elem; ++i)
+  {
+    if (i % 3 == 0)
+      removed.push_back(ids[i]);
+    else
+      kept.push_back(i);
+  }
+  knn.Remove(arma::Col<size_t>(removed));
+
+  // Removing a point twice is an error, and then none of the given points is
+  // removed; the search below checks that the first kept point is still there.
+  REQUIRE_THROWS_AS(knn.Remove(arma::Col<size_t>({ removed[0] })),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(knn.Remove(arma::Col<size_t>({ ids[kept[0]],
+      removed[0] })), std::invalid_argument);
+  REQUIRE_THROWS_AS(knn.Remove(arma::Col<size_t>({ ids[kept[0]],
+      ids[kept[0]] })), std::invalid_argument);
+
+  // Compare with naive search on the remaining points.
+  arma::mat querySet = arma::randu<arma::mat>(3, 50);
+  arma::mat keptSet = dataset.cols(arma::conv_to<arma::uvec>::from(kept));
+  KNN naive(keptSet, NAIVE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, neighbors;
+  arma::mat naiveDistances, distances;
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+
+  const NeighborSearchMode modes[] = { SINGLE_TREE_MODE, DUAL_TREE_MODE };
+  for (size_t m = 0; m < 2; ++m)
+  {
+    knn.SearchMode() = modes[m];
+    knn.Search(querySet, 5, neighbors, distances);
+
+    CheckMatrices(distances, naiveDistances);
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+      REQUIRE(neighbors[i] == ids[kept[naiveNeighbors[i]]]);
+  }
+
+  // Points inserted later reuse the columns of the removed points.
+  arma::Col<size_t> ids3 = knn.Insert(dataset.cols(0, 9));
+  for (size_t i = 0; i < ids3.n_elem; ++i)
+  {
+    REQUIRE(std::find(removed.begin(), removed.end(), ids3[i]) !=
+        removed.end());
+  }
+}
+
+/**
+ * Make sure that NSModel supports insertion and removal of points for R trees,
+ * and throws for kd-trees.
+ */
+TEST_CASE("KNNModelInsertRemoveTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat dataset = arma::randu<arma::mat>(4, 200);
+
+  KNNModel model(KNNModel::R_TREE);
+  arma::mat referenceSet = dataset.cols(0, 149);
+  model.BuildModel(std::move(referenceSet), 20, SINGLE_TREE_MODE);
+
+  arma::mat points = dataset.cols(150, 199);
+  arma::Col<size_t> ids = model.Insert(std::move(points));
+  REQUIRE(ids.n_elem == 50);
+
+  // Remove the first 50 points.
+  model.Remove(arma::regspace<arma::Col<size_t>>(0, 49));
+
+  arma::mat querySet = arma::randu<arma::mat>(4, 20);
+  arma::mat keptSet = dataset.cols(50, 199);
+  KNN naive(keptSet, NAIVE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, neighbors;
+  arma::mat naiveDistances, distances;
+  naive.Search(querySet, 3, naiveNeighbors, naiveDistances);
+  arma::mat queryCopy(querySet);
+  model.Search(std::move(queryCopy), 3, neighbors, distances);
+
+  CheckMatrices(distances, naiveDistances);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+  {
+    const size_t index = naiveNeighbors[i] + 50;
+    REQUIRE(neighbors[i] == (index < 150 ? index : ids[index - 150]));
+  }
+
+  KNNModel kdModel(KNNModel::KD_TREE);
+  referenceSet = dataset;
+  kdModel.BuildModel(std::move(referenceSet), 20, DUAL_TREE_MODE);
+  points = dataset.cols(0, 9);
+  REQUIRE_THROWS_AS(kdModel.Insert(std::move(points)), std::invalid_argument);
+  REQUIRE_THROWS_AS(kdModel.Remove(arma::Col<size_t>({ 0 })),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a query tree can be reused for several searches, and that the
+ * results are in the original order of the query points.
+ */
+TEST_CASE("KNNReusedQueryTreeTest", "[KNNTest]")
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 500);
+  arma::mat querySet = arma::randu<arma::mat>(5, 200);
+
+  KNN knn(referenceSet);
+
+  std::vector<size_t> oldFromNewQueries;
+  KNN::Tree queryTree(querySet, oldFromNewQueries);
+
+  // Search with a larger k after a smaller one, so that the bounds from the
+  // first search would prune too much if they were not reset.
+  for (size_t k = 1; k <= 10; k += 3)
+  {
+    arma::Mat<size_t> neighbors, treeNeighbors;
+    arma::mat distances, treeDistances;
+    knn.Search(querySet, k, neighbors, distances);
+    knn.Search(queryTree, oldFromNewQueries, k, treeNeighbors, treeDistances);
+
+    CheckMatrices(neighbors, treeNeighbors);
+    CheckMatrices(distances, treeDistances);
+  }
+
+  // The mappings must match the query tree.
+  std::vector<size_t> wrongMappings(10);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  REQUIRE_THROWS_AS(knn.Search(queryTree, wrongMappings, 3, neighbors,
+      distances), std::invalid_argument);
+}
@@ -553,6 +553,67 @@ BOOST_AUTO_TEST_CASE(MultiprobeTest)
   BOOST_REQUIRE(foundIncrease);
 }
 
+/**
+ * Test: make sure the compact bucket storage built by Train() is consistent:
+ * every bucket is nonempty and respects the bucket size, and every stored index
+ * is a valid reference point.
+ */
+BOOST_AUTO_TEST_CASE(CompactBucketsTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 1000);
+  const size_t bucketSize = 20;
+  LSHSearch<> lsh(rdata, 3, 10, 0.0, 1009, bucketSize);
+
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+  const arma::Col<arma::u32>& contents = lsh.BucketContents();
+
+  BOOST_REQUIRE_GT(offsets.n_elem, 1);
+  BOOST_REQUIRE_EQUAL(offsets[0], (size_t) 0);
+  BOOST_REQUIRE_EQUAL(offsets[offsets.n_elem - 1], contents.n_elem);
+  for (size_t i = 0; i + 1 < offsets.n_elem; ++i)
+  {
+    BOOST_REQUIRE_GT(offsets[i + 1], offsets[i]);
+    BOOST_REQUIRE_LE(offsets[i + 1] - offsets[i], bucketSize);
+  }
+
+  for (size_t i = 0; i < contents.n_elem; ++i)
+    BOOST_REQUIRE_LT(contents[i], rdata.n_cols);
+}
+
+/**
+ * Test: with a candidate budget, multiprobe LSH should examine no more than
+ * the budget for each query, and a budget too large to ever be met should give
+ * exactly the same results as no budget at all.
+ */
+BOOST_AUTO_TEST_CASE(MultiprobeCandidateBudgetTest)
+{
+  arma::mat rdata;
+  arma::mat qdata;
+  data::Load("iris_train.csv", rdata, true);
+  data::Load("iris_test.csv", qdata, true);
+
+  LSHSearch<> lsh(rdata, 3, 8, 0.0, 99901, 500);
+
+  arma::Mat<size_t> neighbors, budgetNeighbors, largeBudgetNeighbors;
+  arma::mat distances, budgetDistances, largeBudgetDistances;
+
+  lsh.DistanceEvaluations() = 0;
+  lsh.Search(qdata, 3, neighbors, distances, 0, 5);
+  const size_t evaluations = lsh.DistanceEvaluations();
+
+  lsh.DistanceEvaluations() = 0;
+  lsh.Search(qdata, 3, budgetNeighbors, budgetDistances, 0, 5, 10);
+  const size_t budgetEvaluations = lsh.DistanceEvaluations();
+
+  lsh.Search(qdata, 3, largeBudgetNeighbors, largeBudgetDistances, 0, 5,
+      10 * rdata.n_cols);
+
+  BOOST_REQUIRE_LE(budgetEvaluations, evaluations);
+  BOOST_REQUIRE_LE(budgetEvaluations, 10 * qdata.n_cols);
+  CheckMatrices(neighbors, largeBudgetNeighbors);
+  CheckMatrices(distances, largeBudgetDistances);
+}
+
 /**
  * Test: This is a deterministic test that verifies multiprobe LSH works
  * correctly. To do this, we generate two queries, q1 and q2. q1 is hashed
@@ -0,0 +1,107 @@
+/**
+ * @file tests/main_tests/hnsw_test.cpp
+ *
+ * Test mlpackMain() of hnsw_main.cpp.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <string>
+
+#define BINDING_TYPE BINDING_TYPE_TEST
+static const std::string testName = "HNSW";
+
+#include <mlpack/core.hpp>
+#include <mlpack/core/util/mlpack_main.hpp>
+#include "test_helper.hpp"
+#include <mlpack/methods/hnsw/hnsw_main.cpp>
+
+#include "../test_catch_tools.hpp"
+#include "../catch.hpp"
+
+using namespace mlpack;
+
+struct HNSWTestFixture
+{
+ public:
+  HNSWTestFixture()
+  {
+    // Cache in the options for this program.
+    IO::RestoreSettings(testName);
+  }
+
+  ~HNSWTestFixture()
+  {
+    // Clear the settings.
+    bindings::tests::CleanMemory();
+    IO::ClearSettings();
+  }
+};
+
+/**
+ * Check that output neighbors and distances have valid dimensions.
+ */
+TEST_CASE_METHOD(HNSWTestFixture, "HNSWOutputDimensionTest",
+                 "[HNSWMainTest][BindingTests]")
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 200);
+  arma::mat queryData = arma::randu<arma::mat>(3, 50);
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("query", std::move(queryData));
+  SetInputParam("k", (int) 5);
+
+  mlpackMain();
+
+  REQUIRE(IO::GetParam<arma::Mat<size_t>>("neighbors").n_rows == 5);
+  REQUIRE(IO::GetParam<arma::Mat<size_t>>("neighbors").n_cols == 50);
+  REQUIRE(IO::GetParam<arma::mat>("distances").n_rows == 5);
+  REQUIRE(IO::GetParam<arma::mat>("distances").n_cols == 50);
+}
+
+/**
+ * Check that an invalid k is rejected.
+ */
+TEST_CASE_METHOD(HNSWTestFixture, "HNSWInvalidKTest",
+                 "[HNSWMainTest][BindingTests]")
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 100);
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("k", (int) 100);
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
+/**
+ * Check that a saved model gives the same results.
+ */
+TEST_CASE_METHOD(HNSWTestFixture, "HNSWModelReuseTest",
+                 "[HNSWMainTest][BindingTests]")
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 40);
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("query", queryData);
+  SetInputParam("k", (int) 4);
+
+  mlpackMain();
+
+  const arma::Mat<size_t> neighbors =
+      IO::GetParam<arma::Mat<size_t>>("neighbors");
+  const arma::mat distances = IO::GetParam<arma::mat>("distances");
+
+  IO::GetSingleton().Parameters()["reference"].wasPassed = false;
+  SetInputParam("input_model", IO::GetParam<HNSWSearch<>*>("output_model"));
+  SetInputParam("query", std::move(queryData));
+
+  mlpackMain();
+
+  CheckMatrices(neighbors, IO::GetParam<arma::Mat<size_t>>("neighbors"));
+  CheckMatrices(distances, IO::GetParam<arma::mat>("distances"));
+}
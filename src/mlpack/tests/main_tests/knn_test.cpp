@@ -698,3 +698,65 @@ TEST_CASE_METHOD(KNNTestFixture, "KNNDifferentLeafSizes",
   REQUIRE(IO::GetParam<KNNModel*>("output_model")->LeafSize() == (int) 10);
   delete output_model;
 }
+
+/*
+ * Ensure that a model built with single_precision gives the same distances as
+ * a double-precision model, and that it is saved as a single-precision model.
+ */
+TEST_CASE_METHOD(KNNTestFixture, "KNNSinglePrecisionTest",
+                 "[KNNMainTest][BindingTests]")
+{
+  arma::mat referenceData;
+  referenceData.randu(3, 200); // 200 points in 3 dimensions.
+
+  arma::mat queryData;
+  queryData.randu(3, 50); // 50 points in 3 dimensions.
+
+  SetInputParam("reference", referenceData);
+  SetInputParam("query", queryData);
+  SetInputParam("k", (int) 5);
+
+  mlpackMain();
+
+  arma::mat distances = std::move(IO::GetParam<arma::mat>("distances"));
+  REQUIRE(IO::GetParam<KNNModel*>("output_model")->SinglePrecision() ==
+      false);
+
+  bindings::tests::CleanMemory();
+
+  IO::GetSingleton().Parameters()["reference"].wasPassed = false;
+  IO::GetSingleton().Parameters()["query"].wasPassed = false;
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("query", std::move(queryData));
+  IO::SetPassed("single_precision");
+
+  mlpackMain();
+
+  const arma::mat& floatDistances = IO::GetParam<arma::mat>("distances");
+  REQUIRE(floatDistances.n_rows == distances.n_rows);
+  REQUIRE(floatDistances.n_cols == distances.n_cols);
+  for (size_t i = 0; i < distances.n_elem; ++i)
+    REQUIRE(floatDistances[i] == Approx(distances[i]).epsilon(1e-5));
+  REQUIRE(IO::GetParam<KNNModel*>("output_model")->SinglePrecision() == true);
+}
+
+/*
+ * Ensure that single_precision is rejected for tree types that do not support
+ * it.
+ */
+TEST_CASE_METHOD(KNNTestFixture, "KNNSinglePrecisionTreeTypeTest",
+                 "[KNNMainTest][BindingTests]")
+{
+  arma::mat referenceData;
+  referenceData.randu(3, 100); // 100 points in 3 dimensions.
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("k", (int) 5);
+  SetInputParam("tree_type", (string) "vp");
+  IO::SetPassed("single_precision");
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
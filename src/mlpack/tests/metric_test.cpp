@@ -14,6 +14,7 @@
 #include <mlpack/core/metrics/iou_metric.hpp>
 #include <mlpack/core/metrics/non_maximal_supression.hpp>
 #include <mlpack/core/metrics/bleu.hpp>
+#include <mlpack/core/metrics/pairwise_distances.hpp>
 #include "test_tools.hpp"
 
 using namespace std;
@@ -360,4 +361,51 @@ BOOST_AUTO_TEST_CASE(BLEUScoreTest)
   }
 }
 
+/**
+ * Make sure that PairwiseDistances() gives the same results as evaluating the
+ * metric on each pair, including for points that are nearly identical.
+ */
+template<typename MetricType>
+void CheckPairwiseDistances()
+{
+  arma::mat a = arma::randu<arma::mat>(5, 30);
+  arma::mat b = arma::randu<arma::mat>(5, 20);
+  // Make some points nearly identical.
+  b.col(3) = a.col(7) + 1e-6;
+  b.col(4) = a.col(7);
+
+  const arma::uvec aIndices = arma::randperm<arma::uvec>(30, 12);
+  arma::uvec bIndices = arma::randperm<arma::uvec>(20, 8);
+  bIndices[0] = 3;
+  bIndices[1] = 4;
+  const arma::uvec aIndicesWith7 = arma::join_cols(aIndices,
+      arma::uvec({ 7 }));
+
+  MetricType metric;
+  arma::mat distances;
+  PairwiseDistances(metric, a, aIndicesWith7, b, bIndices, distances);
+
+  BOOST_REQUIRE_EQUAL(distances.n_rows, aIndicesWith7.n_elem);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, bIndices.n_elem);
+  for (size_t i = 0; i < aIndicesWith7.n_elem; ++i)
+  {
+    for (size_t j = 0; j < bIndices.n_elem; ++j)
+    {
+      const double d = metric.Evaluate(a.col(aIndicesWith7[i]),
+          b.col(bIndices[j]));
+      if (d == 0.0)
+        BOOST_REQUIRE_SMALL(distances(i, j), 1e-12);
+      else
+        BOOST_REQUIRE_CLOSE(distances(i, j), d, 1e-8);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PairwiseDistancesTest)
+{
+  CheckPairwiseDistances<EuclideanDistance>();
+  CheckPairwiseDistances<SquaredEuclideanDistance>();
+  CheckPairwiseDistances<ManhattanDistance>();
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -314,6 +314,124 @@ BOOST_AUTO_TEST_CASE(SeparateTrainIndividualIncrementalTest)
   }
 }
 
+/**
+ * Check that training incrementally on mini-batches gives the same model as
+ * training on the whole dataset at once.
+ */
+BOOST_AUTO_TEST_CASE(SeparateTrainMiniBatchIncrementalTest)
+{
+  const char* trainFilename = "trainSet.csv";
+  size_t classes = 2;
+
+  arma::mat trainData;
+  data::Load(trainFilename, trainData, true);
+
+  // Get the labels out.
+  arma::Row<size_t> labels(trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    labels[i] = trainData(trainData.n_rows - 1, i);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  NaiveBayesClassifier<> nbc(trainData, labels, classes, false);
+  NaiveBayesClassifier<> nbcTrain(trainData.n_rows, classes);
+  const size_t batchSize = 7;
+  for (size_t i = 0; i < trainData.n_cols; i += batchSize)
+  {
+    const size_t last = std::min((size_t) trainData.n_cols, i + batchSize) - 1;
+    nbcTrain.Train(trainData.cols(i, last), labels.subvec(i, last), classes,
+        true);
+  }
+
+  BOOST_REQUIRE_EQUAL(nbc.Means().n_elem, nbcTrain.Means().n_elem);
+  BOOST_REQUIRE_EQUAL(nbc.Variances().n_elem, nbcTrain.Variances().n_elem);
+  BOOST_REQUIRE_EQUAL(nbc.Probabilities().n_elem,
+                      nbcTrain.Probabilities().n_elem);
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+  {
+    if (std::abs(nbc.Means()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcTrain.Means()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Means()[i], nbcTrain.Means()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Variances().n_elem; ++i)
+  {
+    if (std::abs(nbc.Variances()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcTrain.Variances()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Variances()[i], nbcTrain.Variances()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Probabilities().n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(nbc.Probabilities()[i], nbcTrain.Probabilities()[i],
+        1e-5);
+  }
+}
+
+/**
+ * Check that mixing training on single points and incremental training on
+ * mini-batches gives the same model as training on the whole dataset at once,
+ * even with a large epsilon.
+ */
+BOOST_AUTO_TEST_CASE(SeparateTrainMixedIncrementalTest)
+{
+  const char* trainFilename = "trainSet.csv";
+  size_t classes = 2;
+
+  arma::mat trainData;
+  data::Load(trainFilename, trainData, true);
+
+  // Get the labels out.
+  arma::Row<size_t> labels(trainData.n_cols);
+  for (size_t i = 0; i < trainData.n_cols; ++i)
+    labels[i] = trainData(trainData.n_rows - 1, i);
+  trainData.shed_row(trainData.n_rows - 1);
+
+  NaiveBayesClassifier<> nbc(trainData, labels, classes, false, 0.1);
+  NaiveBayesClassifier<> nbcTrain(trainData.n_rows, classes, 0.1);
+  const size_t batchSize = 7;
+  for (size_t i = 0; i < trainData.n_cols; i += 2 * batchSize)
+  {
+    // Train on one batch point by point, and on the next one at once.
+    const size_t middle = std::min((size_t) trainData.n_cols, i + batchSize);
+    for (size_t j = i; j < middle; ++j)
+      nbcTrain.Train(trainData.col(j), labels[j]);
+
+    const size_t end = std::min((size_t) trainData.n_cols, middle + batchSize);
+    if (end > middle)
+    {
+      nbcTrain.Train(trainData.cols(middle, end - 1),
+          labels.subvec(middle, end - 1), classes, true);
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(nbc.Variances().n_elem, nbcTrain.Variances().n_elem);
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+  {
+    if (std::abs(nbc.Means()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcTrain.Means()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Means()[i], nbcTrain.Means()[i], 1e-5);
+  }
+
+  for (size_t i = 0; i < nbc.Variances().n_elem; ++i)
+  {
+    if (std::abs(nbc.Variances()[i]) < 1e-5)
+      BOOST_REQUIRE_SMALL(nbcTrain.Variances()[i], 1e-5);
+    else
+      BOOST_REQUIRE_CLOSE(nbc.Variances()[i], nbcTrain.Variances()[i], 1e-5);
+  }
+
+  // Both models must also classify the same way.
+  arma::Row<size_t> predictions, trainPredictions;
+  nbc.Classify(trainData, predictions);
+  nbcTrain.Classify(trainData, trainPredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], trainPredictions[i]);
+}
+
 /**
  * Check if NaiveBayesClassifier::Classify() works properly for a high
  * dimension datasets.
@@ -16,6 +16,7 @@
 #include <mlpack/methods/amf/update_rules/nmf_mult_div.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_mult_dist.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_products.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -305,4 +306,77 @@ BOOST_AUTO_TEST_CASE(NonNegNMFALSTest)
       && arma::all(arma::vectorise(h) >= 0));
 }
 
+/**
+ * Make sure the parallel sparse-dense products match the dense products.
+ */
+BOOST_AUTO_TEST_CASE(SparseProductsTest)
+{
+  sp_mat v;
+  v.sprandu(53, 41, 0.2);
+  const mat dv(v);
+  const mat w = randu<mat>(53, 7);
+  const mat h = randu<mat>(7, 41);
+
+  mat wtv, hvt;
+  SparseTransTimes(w, v, wtv);
+  TimesSparseTrans(h, v, hvt);
+
+  const mat denseWtv = w.t() * dv;
+  const mat denseHvt = h * dv.t();
+
+  BOOST_REQUIRE_EQUAL(wtv.n_rows, denseWtv.n_rows);
+  BOOST_REQUIRE_EQUAL(wtv.n_cols, denseWtv.n_cols);
+  BOOST_REQUIRE_EQUAL(hvt.n_rows, denseHvt.n_rows);
+  BOOST_REQUIRE_EQUAL(hvt.n_cols, denseHvt.n_cols);
+  BOOST_REQUIRE_SMALL(arma::norm(wtv - denseWtv, "fro"), 1e-10);
+  BOOST_REQUIRE_SMALL(arma::norm(hvt - denseHvt, "fro"), 1e-10);
+}
+
+/**
+ * Compare the convergence of the sparse specializations of the ALS and
+ * multiplicative distance update rules against the generic rules on the dense
+ * copy of the same matrix: starting from the same point, both should follow the
+ * same sequence of residues.
+ */
+template<typename UpdateRuleType>
+void CheckSparseUpdateConvergence()
+{
+  sp_mat v;
+  v.sprandu(30, 25, 0.3);
+  // Ensure there is at least one nonzero element in every row and column.
+  for (size_t i = 0; i < 25; ++i)
+    v(i, i) += 1e-5;
+  const mat dv(v);
+  const size_t r = 5;
+
+  mat w, h;
+  RandomAcolInitialization<>::Initialize(v, r, w, h);
+  mat dw(w), dh(h);
+
+  UpdateRuleType sparseUpdate, denseUpdate;
+  sparseUpdate.Initialize(v, r);
+  denseUpdate.Initialize(dv, r);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    sparseUpdate.WUpdate(v, w, h);
+    sparseUpdate.HUpdate(v, w, h);
+    denseUpdate.WUpdate(dv, dw, dh);
+    denseUpdate.HUpdate(dv, dw, dh);
+
+    const double sparseResidue = arma::norm(dv - w * h, "fro");
+    const double denseResidue = arma::norm(dv - dw * dh, "fro");
+    BOOST_REQUIRE_CLOSE(sparseResidue, denseResidue, 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SparseNMFALSConvergenceTest)
+{
+  CheckSparseUpdateConvergence<NMFALSUpdate>();
+}
+
+BOOST_AUTO_TEST_CASE(SparseNMFMultDistConvergenceTest)
+{
+  CheckSparseUpdateConvergence<NMFMultiplicativeDistanceUpdate>();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
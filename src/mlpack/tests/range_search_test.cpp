@@ -1696,4 +1696,118 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+
+/**
+ * Run range search with single-precision data using the given tree type, and
+ * make sure the results match a double-precision naive search (up to points
+ * that lie within rounding error of the edges of the range).
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void CheckSinglePrecisionRangeSearch(const bool singleMode)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 400);
+  arma::mat querySet = arma::randu<arma::mat>(4, 100);
+  const Range range(0.2, 0.5);
+
+  RangeSearch<> naive(dataset, true);
+  vector<vector<size_t>> neighborsNaive;
+  vector<vector<double>> distancesNaive;
+  naive.Search(querySet, range, neighborsNaive, distancesNaive);
+
+  RangeSearch<EuclideanDistance, arma::fmat, TreeType> rs(
+      arma::conv_to<arma::fmat>::from(dataset), false, singleMode);
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  rs.Search(arma::conv_to<arma::fmat>::from(querySet), range, neighbors,
+      distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.size(), querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    // Every result must be (nearly) within the range, with the right distance.
+    for (size_t j = 0; j < neighbors[i].size(); ++j)
+    {
+      const double trueDistance = EuclideanDistance::Evaluate(
+          querySet.col(i), dataset.col(neighbors[i][j]));
+      BOOST_REQUIRE_CLOSE(distances[i][j], trueDistance, 1e-3);
+      BOOST_REQUIRE_GE(trueDistance, range.Lo() - 1e-5);
+      BOOST_REQUIRE_LE(trueDistance, range.Hi() + 1e-5);
+    }
+
+    // Every point that is clearly within the range must be found.
+    for (size_t j = 0; j < neighborsNaive[i].size(); ++j)
+    {
+      if (distancesNaive[i][j] < range.Lo() + 1e-5 ||
+          distancesNaive[i][j] > range.Hi() - 1e-5)
+        continue;
+
+      BOOST_REQUIRE(std::find(neighbors[i].begin(), neighbors[i].end(),
+          neighborsNaive[i][j]) != neighbors[i].end());
+    }
+  }
+}
+
+/**
+ * Make sure that kd-trees, ball trees, cover trees and R trees can be used for
+ * range search with single-precision data.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionRangeSearchTest)
+{
+  for (size_t m = 0; m < 2; ++m)
+  {
+    CheckSinglePrecisionRangeSearch<KDTree>(m == 0);
+    CheckSinglePrecisionRangeSearch<BallTree>(m == 0);
+    CheckSinglePrecisionRangeSearch<StandardCoverTree>(m == 0);
+    CheckSinglePrecisionRangeSearch<RTree>(m == 0);
+  }
+}
+
+/**
+ * Make sure that a query tree can be reused for searches with different
+ * ranges, and that the results are in the original order of the query points.
+ */
+BOOST_AUTO_TEST_CASE(ReusedQueryTreeTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(3, 400);
+  arma::mat querySet = arma::randu<arma::mat>(3, 100);
+
+  RangeSearch<> rs(referenceSet);
+
+  std::vector<size_t> oldFromNewQueries;
+  RangeSearch<>::Tree queryTree(querySet, oldFromNewQueries);
+
+  for (size_t r = 1; r <= 3; ++r)
+  {
+    const Range range(0.05 * r, 0.15 * r);
+    vector<vector<size_t>> neighbors, treeNeighbors;
+    vector<vector<double>> distances, treeDistances;
+    rs.Search(querySet, range, neighbors, distances);
+    rs.Search(&queryTree, oldFromNewQueries, range, treeNeighbors,
+        treeDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, treeSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(treeNeighbors, treeDistances, treeSorted);
+
+    BOOST_REQUIRE_EQUAL(treeSorted.size(), querySet.n_cols);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(treeSorted[i].size(), sorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(treeSorted[i][j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(treeSorted[i][j].first, sorted[i][j].first, 1e-5);
+      }
+    }
+  }
+
+  std::vector<size_t> wrongMappings(10);
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  BOOST_REQUIRE_THROW(rs.Search(&queryTree, wrongMappings, Range(0.1, 0.2),
+      neighbors, distances), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1372,6 +1372,187 @@ BOOST_AUTO_TEST_CASE(RStarTreeSplitTest)
       0.9, 1e-15);
 }
 
+//! Count the leaves of the tree.
+template<typename TreeType>
+size_t NumLeaves(const TreeType& tree)
+{
+  if (tree.IsLeaf())
+    return 1;
+
+  size_t numLeaves = 0;
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+    numLeaves += NumLeaves(tree.Child(i));
+
+  return numLeaves;
+}
+
+// Make sure that a bulk-loaded tree is valid and has full leaves.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef RTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  TreeType tree(dataset, STR_BULK_LOAD, 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckFills(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), GetMinLevel(tree));
+
+  // All the leaves are full.
+  BOOST_REQUIRE_EQUAL(NumLeaves(tree), 50);
+
+  // Each point is in the tree exactly once.
+  std::vector<size_t> seen(1000, 0);
+  std::vector<const TreeType*> stack(1, &tree);
+  while (!stack.empty())
+  {
+    const TreeType* node = stack.back();
+    stack.pop_back();
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+      ++seen[node->Point(i)];
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      stack.push_back(&node->Child(i));
+  }
+  for (size_t i = 0; i < seen.size(); ++i)
+    BOOST_REQUIRE_EQUAL(seen[i], 1);
+
+  // A tree small enough to fit in one leaf is just a leaf.
+  arma::mat smallDataset = dataset.cols(0, 9);
+  TreeType smallTree(smallDataset, STR_BULK_LOAD, 20, 6, 5, 2);
+  BOOST_REQUIRE(smallTree.IsLeaf());
+  BOOST_REQUIRE_EQUAL(smallTree.Count(), 10);
+}
+
+// Make sure that bulk-loaded trees give the right search results, and that
+// points can be inserted into them afterwards.
+template<template<typename, typename, typename> class TreeType>
+void CheckBulkLoadedTree()
+{
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+
+  const size_t numIter = 50;
+  arma::mat dataset;
+  dataset.randu(5, 1000 + numIter);
+
+  arma::mat initialDataset = dataset.cols(0, 999);
+  Tree tree(initialDataset, STR_BULK_LOAD, 20, 6, 5, 2);
+
+  tree.Dataset().resize(5, 1000 + numIter);
+  for (size_t i = 0; i < numIter; ++i)
+  {
+    tree.Dataset().col(1000 + i) = dataset.col(1000 + i);
+    tree.InsertPoint(1000 + i);
+  }
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000 + numIter);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      TreeType> knn1(std::move(tree), SINGLE_TREE_MODE);
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadSearchTest)
+{
+  CheckBulkLoadedTree<RTree>();
+  CheckBulkLoadedTree<RStarTree>();
+  CheckBulkLoadedTree<XTree>();
+  CheckBulkLoadedTree<HilbertRTree>();
+}
+
+// Make sure that a bulk-loaded Hilbert R tree is packed in Hilbert order, and
+// that it keeps that order when points are inserted and when it is copied.
+BOOST_AUTO_TEST_CASE(HilbertRTreeBulkLoadTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1050); // 1050 points in 8 dimensions.
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+  arma::mat initialDataset = dataset.cols(0, 999);
+  TreeType tree(initialDataset, STR_BULK_LOAD, 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1000);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckFills(tree);
+  CheckNumDescendants(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+  BOOST_REQUIRE_EQUAL(NumLeaves(tree), 50);
+  CheckHilbertOrdering(tree);
+  CheckDiscreteHilbertValueSync(tree);
+
+  // The leaves hold consecutive runs of the points in Hilbert order.
+  std::vector<size_t> order(1000);
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  DiscreteHilbertValue<double>::SortPoints(initialDataset, order);
+
+  size_t position = 0;
+  std::vector<const TreeType*> stack(1, &tree);
+  while (!stack.empty())
+  {
+    const TreeType* node = stack.back();
+    stack.pop_back();
+    for (size_t i = 0; i < node->NumPoints(); ++i)
+      BOOST_REQUIRE_EQUAL(node->Point(i), order[position++]);
+    for (size_t i = node->NumChildren(); i > 0; --i)
+      stack.push_back(&node->Child(i - 1));
+  }
+  BOOST_REQUIRE_EQUAL(position, 1000);
+
+  tree.Dataset().resize(8, 1050);
+  for (size_t i = 1000; i < 1050; ++i)
+  {
+    tree.Dataset().col(i) = dataset.col(i);
+    tree.InsertPoint(i);
+  }
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 1050);
+  CheckContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  CheckHilbertOrdering(tree);
+  CheckDiscreteHilbertValueSync(tree);
+
+  TreeType copy(tree);
+  CheckHilbertOrdering(copy);
+  CheckDiscreteHilbertValueSync(copy);
+
+  // A tree small enough to fit in one leaf is just a leaf, in Hilbert order.
+  arma::mat smallDataset = dataset.cols(0, 9);
+  TreeType smallTree(smallDataset, STR_BULK_LOAD, 20, 6, 5, 2);
+  BOOST_REQUIRE(smallTree.IsLeaf());
+  BOOST_REQUIRE_EQUAL(smallTree.Count(), 10);
+  CheckHilbertOrdering(smallTree);
+  CheckDiscreteHilbertValueSync(smallTree);
+}
+
 BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
 {
   arma::mat dataset = arma::randu<arma::mat>(3, 1000);
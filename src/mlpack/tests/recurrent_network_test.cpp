@@ -20,6 +20,7 @@
 #include <mlpack/core/math/random.hpp>
 
 #include "catch.hpp"
+#include "ann_test_tools.hpp"
 #include "serialization_catch.hpp"
 #include "custom_layer.hpp"
 
@@ -974,6 +975,163 @@ TEST_CASE("GRUBatchSizeTest", "[RecurrentNetworkTest]")
   BatchSizeTest<GRU<>>();
 }
 
+/**
+ * Create a simple recurrent neural network and make sure that with a rho
+ * shorter than the sequences, it gives the same predictions and objective as
+ * with a rho that covers the whole sequences, since the recurrent layer keeps
+ * its state from one window of rho steps to the next.  Also make sure that
+ * PredictStep() gives the same predictions one time step at a time, and that
+ * the gradient of a window that starts from a carried state is right.
+ */
+template<typename RecurrentLayerType>
+void LongSequenceTest(const double gradientTolerance)
+{
+  const size_t rho = 4;
+  const size_t sequenceLength = 3 * rho;
+  arma::cube input = arma::randu(3, 5, sequenceLength);
+  arma::cube target = arma::randu(2, 5, sequenceLength);
+
+  RNN<MeanSquaredError<> > model(rho);
+  model.Add<IdentityLayer<>>();
+  model.Add<Linear<>>(3, 6);
+  model.Add<RecurrentLayerType>(6, 4);
+  model.Add<Linear<>>(4, 2);
+  model.Reset();
+
+  RNN<MeanSquaredError<> > fullModel(sequenceLength);
+  fullModel.Add<IdentityLayer<>>();
+  fullModel.Add<Linear<>>(3, 6);
+  fullModel.Add<RecurrentLayerType>(6, 4);
+  fullModel.Add<Linear<>>(4, 2);
+  fullModel.Reset();
+  fullModel.Parameters() = model.Parameters();
+
+  arma::cube output, fullOutput;
+  model.Predict(input, output);
+  fullModel.Predict(input, fullOutput);
+
+  REQUIRE(output.n_slices == sequenceLength);
+  CheckMatrices(output, fullOutput, 1e-8);
+
+  model.ResetState();
+  for (size_t t = 0; t < sequenceLength; ++t)
+  {
+    arma::mat stepOutput;
+    model.PredictStep(input.slice(t), stepOutput);
+    CheckMatrices(stepOutput, fullOutput.slice(t), 1e-8);
+  }
+
+  // The objective of truncated backpropagation through time covers the whole
+  // sequences too.
+  model.Predictors() = input;
+  model.Responses() = target;
+  fullModel.Predictors() = input;
+  fullModel.Responses() = target;
+
+  arma::mat gradient;
+  const double objective = model.EvaluateWithGradient(model.Parameters(), 0,
+      gradient, 5);
+  const double fullObjective = fullModel.Evaluate(fullModel.Parameters(), 0,
+      5);
+
+  REQUIRE(objective == Approx(fullObjective).epsilon(1e-8));
+  REQUIRE(model.Evaluate(model.Parameters(), 0, 5) ==
+      Approx(fullObjective).epsilon(1e-8));
+  REQUIRE(gradient.n_elem == model.Parameters().n_elem);
+  REQUIRE(gradient.is_finite());
+  REQUIRE(arma::norm(gradient) > 0.0);
+
+  // The gradient of a window treats the state carried over from the previous
+  // window as a constant.  So, over two windows, it must match the numerical
+  // gradient of the loss of the first window plus the loss of the second
+  // window started from the state that the unperturbed parameters reach.
+  struct GradientFunction
+  {
+    GradientFunction(RNN<MeanSquaredError<> >& model,
+                     const arma::cube& input,
+                     const arma::cube& target,
+                     const size_t rho) :
+        model(model),
+        input(input),
+        target(target),
+        rho(rho),
+        originalParameters(model.Parameters())
+    {
+      model.Predictors() = input;
+      model.Responses() = target;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      model.EvaluateWithGradient(model.Parameters(), 0, gradient,
+          input.n_cols);
+
+      MeanSquaredError<> loss;
+      arma::mat output;
+      double error = 0;
+
+      model.ResetState();
+      for (size_t t = 0; t < rho; ++t)
+      {
+        model.PredictStep(input.slice(t), output);
+        error += loss.Forward(output, target.slice(t));
+      }
+
+      // The assignments copy into the memory that the layers use.
+      const arma::mat parameters = model.Parameters();
+      model.Parameters() = originalParameters;
+      model.ResetState();
+      for (size_t t = 0; t < rho; ++t)
+        model.PredictStep(input.slice(t), output);
+
+      model.Parameters() = parameters;
+      for (size_t t = rho; t < 2 * rho; ++t)
+      {
+        model.PredictStep(input.slice(t), output);
+        error += loss.Forward(output, target.slice(t));
+      }
+
+      return error;
+    }
+
+    arma::mat& Parameters() { return model.Parameters(); }
+
+    RNN<MeanSquaredError<> >& model;
+    const arma::cube input, target;
+    const size_t rho;
+    const arma::mat originalParameters;
+  } function(model, input.slices(0, 2 * rho - 1),
+      target.slices(0, 2 * rho - 1), rho);
+
+  REQUIRE(CheckGradient(function) <= gradientTolerance);
+}
+
+/**
+ * Ensure LSTMs keep their state over sequences longer than rho.
+ */
+TEST_CASE("LSTMLongSequenceTest", "[RecurrentNetworkTest]")
+{
+  LongSequenceTest<LSTM<>>(1e-4);
+}
+
+/**
+ * Ensure fast LSTMs keep their state over sequences longer than rho.
+ */
+TEST_CASE("FastLSTMLongSequenceTest", "[RecurrentNetworkTest]")
+{
+  // The fast LSTM layer uses an approximation of the sigmoid function, so the
+  // estimated gradient is not exact.
+  LongSequenceTest<FastLSTM<>>(0.2);
+}
+
+/**
+ * Ensure GRUs keep their state over sequences longer than rho.
+ */
+TEST_CASE("GRULongSequenceTest", "[RecurrentNetworkTest]")
+{
+  LongSequenceTest<GRU<>>(1e-4);
+}
+
 /**
  * Make sure the RNN can be properly serialized.
  */
@@ -1041,6 +1199,59 @@ TEST_CASE("RNNSerializationTest", "[RecurrentNetworkTest]")
   CheckMatrices(prediction, xmlPrediction, textPrediction, binaryPrediction);
 }
 
+/**
+ * Make sure an RNN of arma::fmat can be trained and serialized.
+ */
+TEST_CASE("RNNFloatTest", "[RecurrentNetworkTest]")
+{
+  const size_t rho = 10;
+
+  arma::cube inputTemp;
+  arma::mat labelsTemp;
+  GenerateNoisySines(inputTemp, labelsTemp, rho, 6);
+
+  arma::fcube input = arma::conv_to<arma::fcube>::from(inputTemp);
+  arma::fcube labels = arma::zeros<arma::fcube>(1, labelsTemp.n_cols, rho);
+  for (size_t i = 0; i < labelsTemp.n_cols; ++i)
+  {
+    const int value = arma::as_scalar(arma::find(
+        arma::max(labelsTemp.col(i)) == labelsTemp.col(i), 1)) + 1;
+    labels.tube(0, i).fill(value);
+  }
+
+  typedef RNNType<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+      RandomInitialization, arma::fmat,
+      IdentityLayer<IdentityFunction, arma::fmat, arma::fmat>,
+      LSTM<arma::fmat, arma::fmat>, Linear<arma::fmat, arma::fmat>,
+      LogSoftMax<arma::fmat, arma::fmat> > FloatRNN;
+
+  FloatRNN model(rho);
+  model.Add<IdentityLayer<IdentityFunction, arma::fmat, arma::fmat> >();
+  model.Add<LSTM<arma::fmat, arma::fmat> >(1, 4, rho);
+  model.Add<Linear<arma::fmat, arma::fmat> >(4, 10);
+  model.Add<LogSoftMax<arma::fmat, arma::fmat> >();
+
+  StandardSGD opt(0.1, 1, input.n_cols /* 1 epoch */, -100);
+  const double objective = model.Train(input, labels, opt);
+  REQUIRE(std::isfinite(objective));
+
+  // Serialize the network.
+  FloatRNN xmlModel(1), textModel(3), binaryModel(5);
+  SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+  arma::fcube prediction, xmlPrediction, textPrediction, binaryPrediction;
+  model.Predict(input, prediction);
+  xmlModel.Predict(input, xmlPrediction);
+  textModel.Predict(input, textPrediction);
+  binaryModel.Predict(input, binaryPrediction);
+
+  REQUIRE(prediction.n_rows == 10);
+  REQUIRE(prediction.is_finite());
+  REQUIRE(arma::approx_equal(prediction, xmlPrediction, "absdiff", 1e-5));
+  REQUIRE(arma::approx_equal(prediction, textPrediction, "absdiff", 1e-5));
+  REQUIRE(arma::approx_equal(prediction, binaryPrediction, "absdiff", 1e-5));
+}
+
 /**
  * Test RNN with a custom layer.
  */
@@ -1371,6 +1582,61 @@ TEST_CASE("RNNTrainReturnObjective", "[RecurrentNetworkTest]")
   REQUIRE(std::isfinite(objVal) == true);
 }
 
+/**
+ * Make sure that training from a BatchLoader gives the same network as
+ * training from the whole dataset with the same batches.
+ */
+TEST_CASE("RNNBatchLoaderTest", "[RecurrentNetworkTest]")
+{
+  const size_t rho = 10;
+
+  arma::cube input;
+  arma::mat labelsTemp;
+  GenerateNoisySines(input, labelsTemp, rho, 6);
+
+  arma::cube labels = arma::zeros<arma::cube>(1, labelsTemp.n_cols, rho);
+  for (size_t i = 0; i < labelsTemp.n_cols; ++i)
+  {
+    const int value = arma::as_scalar(arma::find(
+        arma::max(labelsTemp.col(i)) == labelsTemp.col(i), 1)) + 1;
+    labels.tube(0, i).fill(value);
+  }
+
+  data::BatchLoader<arma::cube, arma::cube> loader(input.n_cols, 4,
+      [&](const arma::Col<size_t>& indices,
+          arma::cube& predictors,
+          arma::cube& responses)
+      {
+        predictors.set_size(input.n_rows, indices.n_elem, input.n_slices);
+        responses.set_size(labels.n_rows, indices.n_elem, labels.n_slices);
+        for (size_t i = 0; i < indices.n_elem; ++i)
+        {
+          predictors.cols(i, i) = input.cols(indices[i], indices[i]);
+          responses.cols(i, i) = labels.cols(indices[i], indices[i]);
+        }
+      }, false, 2);
+
+  RNN<> model(rho), loaderModel(rho);
+  model.Add<IdentityLayer<> >();
+  model.Add<LSTM<> >(1, 4, rho);
+  model.Add<Linear<> >(4, 10);
+  model.Add<LogSoftMax<> >();
+  loaderModel.Add<IdentityLayer<> >();
+  loaderModel.Add<LSTM<> >(1, 4, rho);
+  loaderModel.Add<Linear<> >(4, 10);
+  loaderModel.Add<LogSoftMax<> >();
+
+  // Use the same initial parameters, and two epochs without shuffling.
+  StandardSGD opt(0.1, 4, 2 * input.n_cols, -100, false);
+  math::RandomSeed(4);
+  const double objective = model.Train(input, labels, opt);
+  math::RandomSeed(4);
+  const double loaderObjective = loaderModel.Train(loader, opt);
+
+  REQUIRE(loaderObjective == Approx(objective).epsilon(1e-10));
+  CheckMatrices(model.Parameters(), loaderModel.Parameters());
+}
+
 /**
  * Test that BRNN::Train() returns finite objective value.
  */
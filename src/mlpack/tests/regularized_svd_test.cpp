@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
+#include <mlpack/methods/regularized_svd/blocked_ratings.hpp>
 
 #include <ensmallen.hpp>
 
@@ -249,6 +250,66 @@ TEST_CASE("RegularizedSVDFunctionOptimize", "[RegularizedSVDTest]")
   REQUIRE(relativeError == Approx(0.0).margin(1e-2));
 }
 
+// Make sure that BlockedRatings stores every rating exactly once, and that the
+// cells of each stratum share no users and no items.
+TEST_CASE("BlockedRatingsStrataTest", "[RegularizedSVDTest]")
+{
+  const size_t numUsers = 57;
+  const size_t numItems = 43;
+  const size_t numRatings = 1000;
+  const size_t numBlocks = 4;
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+
+  BlockedRatings ratings(data, numUsers, numItems, numBlocks);
+  REQUIRE(ratings.NumBlocks() == numBlocks);
+  REQUIRE(ratings.NumRatings() == numRatings);
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    // The second time around, make sure shuffling keeps the invariants.
+    if (trial == 1)
+      ratings.Shuffle();
+
+    arma::mat seen(numUsers, numItems, arma::fill::zeros);
+    arma::mat expected(numUsers, numItems, arma::fill::zeros);
+    for (size_t i = 0; i < numRatings; ++i)
+      expected(data(0, i), data(1, i)) += data(2, i);
+
+    for (size_t s = 0; s < ratings.NumBlocks(); ++s)
+    {
+      arma::Col<size_t> userOwner(numUsers);
+      arma::Col<size_t> itemOwner(numItems);
+      userOwner.fill(numBlocks);
+      itemOwner.fill(numBlocks);
+
+      for (size_t b = 0; b < ratings.NumBlocks(); ++b)
+      {
+        const size_t cell = ratings.Cell(s, b);
+        for (size_t j = ratings.CellBegin(cell); j < ratings.CellEnd(cell);
+            ++j)
+        {
+          const size_t user = ratings.User(j);
+          const size_t item = ratings.Item(j);
+
+          // No other cell of this stratum may touch this user or item.
+          REQUIRE((userOwner[user] == numBlocks || userOwner[user] == b));
+          REQUIRE((itemOwner[item] == numBlocks || itemOwner[item] == b));
+          userOwner[user] = b;
+          itemOwner[item] = b;
+
+          seen(user, item) += ratings.Rating(j);
+        }
+      }
+    }
+
+    for (size_t i = 0; i < seen.n_elem; ++i)
+      REQUIRE(seen[i] == Approx(expected[i]).margin(1e-10));
+  }
+}
+
 // The test is only compiled if the user has specified OpenMP to be
 // used.
 #ifdef HAS_OPENMP
@@ -362,6 +362,36 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeOverwriteTest)
   CheckTrees(tree, xmlTree, textTree, binaryTree);
 }
 
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeCompactTest)
+{
+  arma::mat data;
+  data.randu(3, 100);
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(data);
+  tree.Compact(BREADTH_FIRST_LAYOUT);
+
+  TreeType* xmlTree;
+  TreeType* textTree;
+  TreeType* binaryTree;
+
+  SerializePointerObjectAll(&tree, xmlTree, textTree, binaryTree);
+
+  CheckTrees(tree, *xmlTree, *textTree, *binaryTree);
+
+  // The loaded trees must be compacted in the same layout.
+  BOOST_REQUIRE(xmlTree->IsCompact());
+  BOOST_REQUIRE(textTree->IsCompact());
+  BOOST_REQUIRE(binaryTree->IsCompact());
+  BOOST_REQUIRE_EQUAL(xmlTree->Layout(), BREADTH_FIRST_LAYOUT);
+  BOOST_REQUIRE_EQUAL(textTree->Layout(), BREADTH_FIRST_LAYOUT);
+  BOOST_REQUIRE_EQUAL(binaryTree->Layout(), BREADTH_FIRST_LAYOUT);
+  BOOST_REQUIRE_EQUAL(binaryTree->Left() + 1, binaryTree->Right());
+
+  delete xmlTree;
+  delete textTree;
+  delete binaryTree;
+}
+
 BOOST_AUTO_TEST_CASE(CoverTreeTest)
 {
   arma::mat data;
@@ -1054,16 +1084,12 @@ BOOST_AUTO_TEST_CASE(LSHTest)
   BOOST_REQUIRE_EQUAL(lsh.BucketSize(), textLsh.BucketSize());
   BOOST_REQUIRE_EQUAL(lsh.BucketSize(), binaryLsh.BucketSize());
 
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      xmlLsh.SecondHashTable().size());
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      textLsh.SecondHashTable().size());
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      binaryLsh.SecondHashTable().size());
-
-  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
-  CheckMatrices(lsh.SecondHashTable()[i], xmlLsh.SecondHashTable()[i],
-      textLsh.SecondHashTable()[i], binaryLsh.SecondHashTable()[i]);
+  CheckMatrices(lsh.BucketOffsets(), xmlLsh.BucketOffsets(),
+      textLsh.BucketOffsets(), binaryLsh.BucketOffsets());
+  CheckMatrices(arma::conv_to<arma::Mat<size_t>>::from(lsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(xmlLsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(textLsh.BucketContents()),
+      arma::conv_to<arma::Mat<size_t>>::from(binaryLsh.BucketContents()));
 }
 
 // Make sure serialization works for the decision stump.
@@ -1862,6 +1862,30 @@ void CheckCovering(const TreeType& node)
   }
 }
 
+/**
+ * Make sure that the children of each node are separated: two children at
+ * scales s1 and s2 are further apart than pow(base, max(s1, s2)).
+ */
+template<typename TreeType, typename MetricType>
+void CheckSeparation(const TreeType& node)
+{
+  const typename TreeType::Mat& dataset = node.Dataset();
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    for (size_t j = i + 1; j < node.NumChildren(); ++j)
+    {
+      const double distance = MetricType::Evaluate(
+          dataset.col(node.Child(i).Point()),
+          dataset.col(node.Child(j).Point()));
+      const int scale = std::max(node.Child(i).Scale(), node.Child(j).Scale());
+
+      BOOST_REQUIRE_GT(distance, pow(node.Base(), scale));
+    }
+
+    CheckSeparation<TreeType, MetricType>(node.Child(i));
+  }
+}
+
 /**
  * Create a simple cover tree and then make sure it is valid.
  */
@@ -1951,6 +1975,69 @@ BOOST_AUTO_TEST_CASE(CoverTreeConstructionTest)
   // implementation.
 }
 
+//! Check that two cover trees have the same points, scales, children and
+//! parent distances.
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Point(), b.Point());
+  BOOST_REQUIRE_EQUAL(a.Scale(), b.Scale());
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_EQUAL(a.ParentDistance(), b.ParentDistance());
+  BOOST_REQUIRE_EQUAL(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Create a cover tree on a dataset large enough that its top levels are built
+ * in parallel, and make sure it's accurate.
+ */
+BOOST_AUTO_TEST_CASE(LargeCoverTreeConstructionTest)
+{
+  arma::mat dataset;
+  dataset.randu(5, 10000);
+
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+  TreeType tree(dataset);
+
+  arma::vec counts;
+  counts.zeros(10000);
+  RecurseTreeCountLeaves(tree, counts);
+
+  for (size_t i = 0; i < 10000; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+
+  CheckSelfChild<TreeType>(tree);
+  CheckCovering<TreeType, LMetric<2, true> >(tree);
+  CheckSeparation<TreeType, LMetric<2, true> >(tree);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), 10000);
+
+  // Building the tree again must give the same tree.
+  TreeType tree2(dataset);
+  CheckSameCoverTree(tree, tree2);
+  BOOST_REQUIRE_EQUAL(tree.DistanceComps(), tree2.DistanceComps());
+
+  #ifdef HAS_OPENMP
+  // The tree must not depend on the number of threads either.
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  TreeType tree3(dataset);
+  omp_set_num_threads(threads);
+
+  CheckSameCoverTree(tree, tree3);
+  BOOST_REQUIRE_EQUAL(tree.DistanceComps(), tree3.DistanceComps());
+  #endif
+}
+
 /**
  * Create a cover tree on sparse data and make sure it's accurate.
  */
@@ -2169,6 +2256,88 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeCopyConstructor)
   delete &b.Right()->Dataset();
 }
 
+//! Check that two binary space trees have the same structure and bounds, and
+//! that the parent links of the second tree are right.
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  for (size_t d = 0; d < a.Bound().Dim(); ++d)
+  {
+    BOOST_REQUIRE_EQUAL(a.Bound()[d].Lo(), b.Bound()[d].Lo());
+    BOOST_REQUIRE_EQUAL(a.Bound()[d].Hi(), b.Bound()[d].Hi());
+  }
+
+  for (size_t i = 0; i < b.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(b.Child(i).Parent(), &b);
+    BOOST_REQUIRE_EQUAL(&b.Child(i).Dataset(), &b.Dataset());
+    CheckSameBinarySpaceTree(a.Child(i), b.Child(i));
+  }
+}
+
+/**
+ * Make sure that compacting a tree keeps its structure, and that the nodes are
+ * stored in the right order.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeCompactTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 1000);
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(data, 5);
+
+  TreeType compact(tree);
+  BOOST_REQUIRE(!compact.IsCompact());
+
+  compact.Compact(BREADTH_FIRST_LAYOUT);
+  BOOST_REQUIRE(compact.IsCompact());
+  BOOST_REQUIRE_EQUAL(compact.Layout(), BREADTH_FIRST_LAYOUT);
+  CheckSameBinarySpaceTree(tree, compact);
+
+  // In breadth-first order, the children of a node are next to each other, and
+  // the children of the left child follow the children of the right child.
+  BOOST_REQUIRE_EQUAL(compact.Left() + 1, compact.Right());
+  BOOST_REQUIRE_EQUAL(compact.Left() + 2, compact.Left()->Left());
+  BOOST_REQUIRE_EQUAL(compact.Left() + 4, compact.Right()->Left());
+
+  // The ranges of the bounds are stored in the same order as the nodes.
+  const size_t dim = compact.Bound().Dim();
+  BOOST_REQUIRE_EQUAL(&compact.Left()->Bound()[0] + dim,
+      &compact.Right()->Bound()[0]);
+  BOOST_REQUIRE_EQUAL(&compact.Left()->Bound()[0] + 2 * dim,
+      &compact.Left()->Left()->Bound()[0]);
+
+  // Change the layout of the compacted tree.
+  compact.Compact(VAN_EMDE_BOAS_LAYOUT);
+  BOOST_REQUIRE_EQUAL(compact.Layout(), VAN_EMDE_BOAS_LAYOUT);
+  CheckSameBinarySpaceTree(tree, compact);
+
+  // The tree has more than three levels, so the top half of the levels holds
+  // both children of the root, which are stored first.
+  BOOST_REQUIRE_EQUAL(compact.Left() + 1, compact.Right());
+  BOOST_REQUIRE_EQUAL(&compact.Left()->Bound()[0] + dim,
+      &compact.Right()->Bound()[0]);
+
+  // A copy of a compacted tree is compacted too.
+  TreeType copy(compact);
+  BOOST_REQUIRE(copy.IsCompact());
+  BOOST_REQUIRE_EQUAL(copy.Layout(), VAN_EMDE_BOAS_LAYOUT);
+  CheckSameBinarySpaceTree(tree, copy);
+  BOOST_REQUIRE_EQUAL(&copy.Left()->Bound()[0] + dim,
+      &copy.Right()->Bound()[0]);
+
+  // So is a moved tree.
+  TreeType moved(std::move(compact));
+  BOOST_REQUIRE(moved.IsCompact());
+  BOOST_REQUIRE(!compact.IsCompact());
+  CheckSameBinarySpaceTree(tree, moved);
+
+  // Only the root can be compacted.
+  BOOST_REQUIRE_THROW(moved.Left()->Compact(), std::invalid_argument);
+}
+
 //! Count the number of leaves under this node.
 template<typename TreeType>
 size_t NumLeaves(TreeType* node)